@@ -164,6 +164,12 @@ Bucket::getEntryAtOffset(LedgerKey const& k, std::streamoff pos,
     return std::nullopt;
 }
 
+std::optional<std::pair<std::streamoff, std::streamoff>>
+Bucket::getOfferRange() const
+{
+    return getIndex().getOfferRange();
+}
+
 std::optional<BucketEntry>
 Bucket::getBucketEntry(LedgerKey const& k)
 {
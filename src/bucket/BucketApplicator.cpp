@@ -5,6 +5,7 @@
 #include "util/asio.h"
 #include "bucket/BucketApplicator.h"
 #include "bucket/Bucket.h"
+#include "bucket/BucketIndex.h"
 #include "bucket/BucketList.h"
 #include "ledger/LedgerTxn.h"
 #include "ledger/LedgerTxnEntry.h"
@@ -16,6 +17,23 @@
 namespace caiz
 {
 
+// Returns true if filter accepts exactly the entry types that BucketListDB
+// does not support (i.e. offers), which are the only entries that still need
+// to be written to SQL when BucketListDB is enabled.
+static bool
+onlyAppliesSQLBackedTypes(std::function<bool(LedgerEntryType)> const& filter)
+{
+    for (auto t : xdr::xdr_traits<LedgerEntryType>::enum_values())
+    {
+        auto let = static_cast<LedgerEntryType>(t);
+        if (filter(let) != BucketIndex::typeNotSupported(let))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 BucketApplicator::BucketApplicator(Application& app,
                                    uint32_t maxProtocolVersion,
                                    uint32_t minProtocolVersionSeen,
@@ -37,11 +55,31 @@ BucketApplicator::BucketApplicator(Application& app,
                 "bucket protocol version {:d} exceeds maxProtocolVersion {:d}"),
             protocolVersion, mMaxProtocolVersion));
     }
+
+    // Buckets are sorted by entry type, so all offers in a bucket are stored
+    // contiguously. If the bucket is indexed and we only need offers, seek
+    // directly to the offer range rather than decoding every entry.
+    if (!bucket->isEmpty() && bucket->isIndexed() &&
+        onlyAppliesSQLBackedTypes(mEntryTypeFilter))
+    {
+        mOffersOnly = true;
+        auto offerRange = bucket->getOfferRange();
+        if (offerRange)
+        {
+            mBucketIter.seek(offerRange->first);
+            mUpperBoundOffset = static_cast<size_t>(offerRange->second);
+        }
+        else
+        {
+            // No offers in bucket
+            mOffersRemaining = false;
+        }
+    }
 }
 
 BucketApplicator::operator bool() const
 {
-    return (bool)mBucketIter;
+    return (bool)mBucketIter && mOffersRemaining;
 }
 
 size_t
@@ -99,6 +137,16 @@ BucketApplicator::advance(BucketApplicator::Counters& counters)
 
     for (; mBucketIter; ++mBucketIter)
     {
+        // Note: mUpperBoundOffset is not inclusive, but mBucketIter.pos()
+        // returns the file offset at the end of the currently loaded entry.
+        // An entry has started at or after the upper bound only if pos is
+        // strictly greater than the upper bound.
+        if (mOffersOnly && mBucketIter.pos() > mUpperBoundOffset)
+        {
+            mOffersRemaining = false;
+            break;
+        }
+
         BucketEntry const& e = *mBucketIter;
         Bucket::checkProtocolLegality(e, mMaxProtocolVersion);
 
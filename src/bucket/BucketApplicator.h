@@ -29,6 +29,13 @@ class BucketApplicator
     size_t mCount{0};
     std::function<bool(LedgerEntryType)> mEntryTypeFilter;
 
+    // When only offers are applied from an indexed bucket, the iterator is
+    // positioned at the start of the bucket's offer range and stops at
+    // mUpperBoundOffset instead of scanning the whole file.
+    bool mOffersOnly{false};
+    bool mOffersRemaining{true};
+    size_t mUpperBoundOffset{0};
+
   public:
     class Counters
     {
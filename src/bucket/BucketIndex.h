@@ -113,6 +113,11 @@ class BucketIndex : public NonMovableOrCopyable
     virtual std::pair<std::streamoff, std::streamoff>
     getPoolshareTrustlineRange(AccountID const& accountID) const = 0;
 
+    // Returns lower bound and upper bound for offer entry positions in the
+    // given bucket, or std::nullopt if no offers exist
+    virtual std::optional<std::pair<std::streamoff, std::streamoff>>
+    getOfferRange() const = 0;
+
     // Returns page size for index. InidividualIndex returns 0 for page size
     virtual std::streamoff getPageSize() const = 0;
 
@@ -40,6 +40,17 @@ getDummyPoolShareTrustlineKey(AccountID const& accountID, uint8_t fill)
     return key;
 }
 
+// Returns an offer key with the given offerID and a sellerID filled with the
+// fill byte
+static LedgerKey
+getDummyOfferKey(int64_t offerID, uint8_t fill)
+{
+    LedgerKey key(OFFER);
+    key.offer().sellerID.ed25519().fill(fill);
+    key.offer().offerID = offerID;
+    return key;
+}
+
 // Returns pagesize for given index based on config parameters and bucket size,
 // in bytes
 static inline std::streamoff
@@ -447,6 +458,46 @@ BucketIndexImpl<IndexT>::getPoolshareTrustlineRange(
     return std::make_pair(startOff, endOff);
 }
 
+template <class IndexT>
+std::optional<std::pair<std::streamoff, std::streamoff>>
+BucketIndexImpl<IndexT>::getOfferRange() const
+{
+    // Get the smallest and largest possible offer keys
+    auto upperBound = getDummyOfferKey(std::numeric_limits<int64_t>::max(),
+                                       std::numeric_limits<uint8_t>::max());
+    auto lowerBound = getDummyOfferKey(std::numeric_limits<int64_t>::min(),
+                                       std::numeric_limits<uint8_t>::min());
+
+    // Get the index iterators for the bounds
+    auto startIter = std::lower_bound(
+        mData.keysToOffset.begin(), mData.keysToOffset.end(), lowerBound,
+        lower_bound_pred<typename IndexT::value_type>);
+
+    // If the first index entry not less than the lower bound starts after
+    // the upper bound, the bucket contains no offers
+    if (startIter == mData.keysToOffset.end() ||
+        upper_bound_pred<typename IndexT::value_type>(upperBound, *startIter))
+    {
+        return std::nullopt;
+    }
+
+    auto endIter =
+        std::upper_bound(startIter, mData.keysToOffset.end(), upperBound,
+                         upper_bound_pred<typename IndexT::value_type>);
+
+    // Get file offsets based on lower and upper bound iterators
+    std::streamoff startOff = startIter->second;
+    std::streamoff endOff = std::numeric_limits<std::streamoff>::max();
+
+    // If we hit the end of the index then upper bound should be EOF
+    if (endIter != mData.keysToOffset.end())
+    {
+        endOff = endIter->second;
+    }
+
+    return std::make_pair(startOff, endOff);
+}
+
 #ifdef BUILD_TESTS
 template <class IndexT>
 bool
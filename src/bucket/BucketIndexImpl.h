@@ -74,6 +74,9 @@ template <class IndexT> class BucketIndexImpl : public BucketIndex
     virtual std::pair<std::streamoff, std::streamoff>
     getPoolshareTrustlineRange(AccountID const& accountID) const override;
 
+    virtual std::optional<std::pair<std::streamoff, std::streamoff>>
+    getOfferRange() const override;
+
     virtual std::streamoff
     getPageSize() const override
     {
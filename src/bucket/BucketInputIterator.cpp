@@ -64,6 +64,13 @@ BucketInputIterator::size() const
     return mIn.size();
 }
 
+void
+BucketInputIterator::seek(std::streamoff offset)
+{
+    mIn.seek(offset);
+    loadEntry();
+}
+
 BucketInputIterator::operator bool() const
 {
     return mEntryPtr != nullptr;
@@ -54,5 +54,10 @@ class BucketInputIterator
 
     size_t pos();
     size_t size() const;
+
+    // Moves the iterator to the entry starting at the given file offset.
+    // offset must point to the start of an entry, e.g. an offset taken from
+    // the bucket's index.
+    void seek(std::streamoff offset);
 };
 }
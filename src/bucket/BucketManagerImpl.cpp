@@ -7,6 +7,7 @@
 #include "bucket/BucketInputIterator.h"
 #include "bucket/BucketList.h"
 #include "bucket/BucketOutputIterator.h"
+#include "catchup/CatchupProgress.h"
 #include "crypto/Hex.h"
 #include "history/HistoryManager.h"
 #include "historywork/VerifyBucketWork.h"
@@ -672,6 +673,17 @@ BucketManagerImpl::getAllReferencedBuckets() const
             }
         }
     }
+
+    // retain buckets verified by an interrupted resumable catchup, so that the
+    // next catchup can reuse them.
+    for (auto const& h : CatchupProgress::getRecordedBuckets(mApp))
+    {
+        if (referenced.emplace(h).second)
+        {
+            CLOG_TRACE(Bucket, "{} referenced by catchup progress",
+                       binToHex(h));
+        }
+    }
     return referenced;
 }
 
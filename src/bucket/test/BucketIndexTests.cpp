@@ -5,7 +5,9 @@
 // This file contains tests for the BucketIndex and higher-level operations
 // concerning key-value lookup based on the BucketList.
 
+#include "bucket/BucketApplicator.h"
 #include "bucket/BucketIndexImpl.h"
+#include "bucket/BucketInputIterator.h"
 #include "bucket/BucketList.h"
 #include "bucket/BucketManager.h"
 #include "bucket/test/BucketTestUtils.h"
@@ -578,6 +580,74 @@ TEST_CASE("loadPoolShareTrustLinesByAccountAndAsset does not load shadows",
     testAllIndexTypes(f);
 }
 
+TEST_CASE("offer range", "[bucket][bucketindex]")
+{
+    auto f = [&](Config& cfg) {
+        auto test = BucketIndexTest(cfg);
+        test.buildGeneralTest();
+
+        auto checkBucket = [](std::shared_ptr<Bucket> const& b) {
+            if (b->isEmpty())
+            {
+                return;
+            }
+
+            // Find the file offsets of the first offer and the end of the
+            // last offer by scanning the whole bucket
+            std::optional<std::streamoff> firstOfferStart;
+            std::streamoff lastOfferEnd = 0;
+            BucketInputIterator iter(b);
+
+            // The first entry has already been loaded, so back out its size
+            // (plus the 4 byte record mark) from the current position
+            std::streamoff entryStart =
+                static_cast<std::streamoff>(iter.pos()) -
+                xdr::xdr_size(*iter) - 4;
+            for (; iter; ++iter)
+            {
+                auto entryEnd = static_cast<std::streamoff>(iter.pos());
+                auto const& be = *iter;
+                auto type = be.type() == DEADENTRY ? be.deadEntry().type()
+                                                   : be.liveEntry().data.type();
+                if (type == OFFER)
+                {
+                    if (!firstOfferStart)
+                    {
+                        firstOfferStart = entryStart;
+                    }
+                    lastOfferEnd = entryEnd;
+                }
+                entryStart = entryEnd;
+            }
+
+            auto range = b->getOfferRange();
+            if (!firstOfferStart)
+            {
+                // Range index pages may straddle the offer boundary, so only
+                // individual indexes are guaranteed to report no offers
+                if (b->getIndexForTesting().getPageSize() == 0)
+                {
+                    REQUIRE(!range);
+                }
+                return;
+            }
+
+            REQUIRE(range);
+            REQUIRE(range->first <= *firstOfferStart);
+            REQUIRE(range->second >= lastOfferEnd);
+        };
+
+        auto& bl = test.getBM().getBucketList();
+        for (uint32_t i = 0; i < BucketList::kNumLevels; ++i)
+        {
+            checkBucket(bl.getLevel(i).getCurr());
+            checkBucket(bl.getLevel(i).getSnap());
+        }
+    };
+
+    testAllIndexTypes(f);
+}
+
 #ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
 TEST_CASE("load EXPIRATION_EXTENSION entries", "[bucket][bucketindex]")
 {
@@ -674,4 +744,62 @@ TEST_CASE("serialize bucket indexes", "[bucket][bucketindex][!hide]")
         REQUIRE((inMemoryIndex == *onDiskIndex));
     }
 }
+
+TEST_CASE("apply offers from bucket bench",
+          "[bucket][bucketindex][bench][!hide]")
+{
+    // One large bucket with a small offer range, which is the shape of the
+    // deeper BucketList levels during catchup
+    auto offers = LedgerTestUtils::generateValidUniqueLedgerEntriesWithTypes(
+        {OFFER}, 1'000);
+    auto entries = LedgerTestUtils::generateValidLedgerEntriesWithExclusions(
+        {OFFER, CONFIG_SETTING}, 200'000);
+    entries.insert(entries.end(), offers.begin(), offers.end());
+
+    auto offersOnly = [](LedgerEntryType t) {
+        return BucketIndex::typeNotSupported(t);
+    };
+
+    // The full scan decodes every entry of an unindexed bucket and filters
+    // out everything but offers, while the indexed path seeks straight to the
+    // offer range. Each run uses its own app so that both write the same
+    // offers to an empty database.
+    auto run = [&](bool useIndex) {
+        VirtualClock clock;
+        Config cfg(getTestConfig(0, Config::TESTDB_ON_DISK_SQLITE));
+        cfg.EXPERIMENTAL_BUCKETLIST_DB = true;
+        auto app = createTestApplication(clock, cfg);
+        auto version = getAppLedgerVersion(app);
+
+        auto b = Bucket::fresh(app->getBucketManager(), version, {}, entries,
+                               {}, /*countMergeEvents=*/false,
+                               clock.getIOContext(), /*doFsync=*/false);
+        REQUIRE(b->isIndexed());
+        if (!useIndex)
+        {
+            b = std::make_shared<Bucket>(b->getFilename().string(),
+                                         b->getHash(), nullptr);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        BucketApplicator applicator(*app, version, version, /*level=*/0, b,
+                                    offersOnly);
+        BucketApplicator::Counters counters(clock.now());
+        size_t applied = 0;
+        while (applicator)
+        {
+            applied += applicator.advance(counters);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        REQUIRE(applied == offers.size());
+        CLOG_INFO(Bucket, "{}: applied {} offers from {} entries in {} ms",
+                  useIndex ? "Indexed offer range" : "Full scan", applied,
+                  entries.size(), elapsed.count());
+    };
+
+    run(/*useIndex=*/false);
+    run(/*useIndex=*/true);
+}
 }
\ No newline at end of file
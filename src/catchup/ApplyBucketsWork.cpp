@@ -9,6 +9,7 @@
 #include "bucket/BucketManager.h"
 #include "catchup/AssumeStateWork.h"
 #include "catchup/CatchupManager.h"
+#include "catchup/IndexBucketsWork.h"
 #include "crypto/Hex.h"
 #include "crypto/SecretKey.h"
 #include "historywork/Progress.h"
@@ -82,7 +83,7 @@ ApplyBucketsWork::getBucketLevel(uint32_t level)
     return mApp.getBucketManager().getBucketList().getLevel(level);
 }
 
-std::shared_ptr<Bucket const>
+std::shared_ptr<Bucket>
 ApplyBucketsWork::getBucket(std::string const& hash)
 {
     auto i = mBuckets.find(hash);
@@ -107,6 +108,8 @@ ApplyBucketsWork::doReset()
     mLastAppliedSizeMb = 0;
     mLastPos = 0;
     mMinProtocolVersionSeen = UINT32_MAX;
+    mBucketsToIndex.clear();
+    mIndexBucketsWork.reset();
 
     if (!isAborting())
     {
@@ -129,11 +132,15 @@ ApplyBucketsWork::doReset()
             }
         }
 
-        auto addBucket = [this](std::shared_ptr<Bucket const> const& bucket) {
+        auto addBucket = [this](std::shared_ptr<Bucket> const& bucket) {
             if (bucket->getSize() > 0)
             {
                 mTotalBuckets++;
                 mTotalSize += bucket->getSize();
+                if (mApp.getConfig().isUsingBucketListDB())
+                {
+                    mBucketsToIndex.emplace_back(bucket);
+                }
             }
         };
 
@@ -208,7 +215,21 @@ ApplyBucketsWork::doWork()
 {
     ZoneScoped;
 
-    // Step 1: apply buckets. Step 2: assume state
+    // Step 1: index buckets (BucketListDB only). Step 2: apply buckets.
+    // Step 3: assume state
+    if (mApp.getConfig().isUsingBucketListDB() && !mSpawnedAssumeStateWork)
+    {
+        if (!mIndexBucketsWork)
+        {
+            mIndexBucketsWork = addWork<IndexBucketsWork>(mBucketsToIndex);
+            return State::WORK_RUNNING;
+        }
+        else if (mIndexBucketsWork->getState() != State::WORK_SUCCESS)
+        {
+            return mIndexBucketsWork->getState();
+        }
+    }
+
     if (!mSpawnedAssumeStateWork)
     {
         if (mApp.getLedgerManager().rebuildingInMemoryState() && !mDelayChecked)
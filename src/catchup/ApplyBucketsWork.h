@@ -13,6 +13,7 @@ namespace caiz
 class BucketLevel;
 class BucketList;
 class Bucket;
+class IndexBucketsWork;
 struct HistoryArchiveState;
 struct LedgerHeaderHistoryEntry;
 
@@ -39,10 +40,15 @@ class ApplyBucketsWork : public Work
     std::unique_ptr<BucketApplicator> mSnapApplicator;
     std::unique_ptr<BucketApplicator> mCurrApplicator;
 
+    // When BucketListDB is enabled, buckets are indexed before being applied
+    // so that only the entry types still backed by SQL (offers) are read
+    std::vector<std::shared_ptr<Bucket>> mBucketsToIndex;
+    std::shared_ptr<IndexBucketsWork> mIndexBucketsWork;
+
     BucketApplicator::Counters mCounters;
 
     void advance(std::string const& name, BucketApplicator& applicator);
-    std::shared_ptr<Bucket const> getBucket(std::string const& bucketHash);
+    std::shared_ptr<Bucket> getBucket(std::string const& bucketHash);
     BucketLevel& getBucketLevel(uint32_t level);
     void startLevel();
     bool isLevelComplete();
@@ -0,0 +1,200 @@
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "catchup/CatchupProgress.h"
+#include "bucket/BucketManager.h"
+#include "crypto/Hex.h"
+#include "crypto/SHA.h"
+#include "history/FileTransferInfo.h"
+#include "main/Application.h"
+#include "main/Config.h"
+#include "main/PersistentState.h"
+#include "util/Fs.h"
+#include "util/Logging.h"
+#include "util/TmpDir.h"
+#include <Tracy.hpp>
+#include <fstream>
+
+namespace caiz
+{
+
+static std::string const CATCHUP_DOWNLOAD_DIRNAME{"catchup"};
+
+// Returns the hex SHA-256 of the file at `path`, or an empty string if it
+// can't be read.
+static std::string
+hashFileContents(std::string const& path)
+{
+    ZoneScoped;
+    std::ifstream in(path, std::ifstream::binary);
+    if (!in)
+    {
+        return {};
+    }
+    SHA256 hasher;
+    char buf[4096];
+    while (in)
+    {
+        in.read(buf, sizeof(buf));
+        hasher.add(ByteSlice(buf, in.gcount()));
+    }
+    if (in.bad())
+    {
+        return {};
+    }
+    return binToHex(hasher.finish());
+}
+
+bool
+CatchupProgress::isEnabled(Application& app)
+{
+    return app.getConfig().EXPERIMENTAL_RESUMABLE_CATCHUP;
+}
+
+std::string
+CatchupProgress::getDownloadDir(Application& app)
+{
+    return app.getBucketManager().getBucketDir() + "/" +
+           CATCHUP_DOWNLOAD_DIRNAME;
+}
+
+bool
+CatchupProgress::tracks(Application& app, FileTransferInfo const& ft)
+{
+    if (!isEnabled(app))
+    {
+        return false;
+    }
+    auto type = ft.getType();
+    if (type != HISTORY_FILE_TYPE_LEDGER &&
+        type != HISTORY_FILE_TYPE_TRANSACTIONS &&
+        type != HISTORY_FILE_TYPE_RESULTS)
+    {
+        return false;
+    }
+    auto dir = getDownloadDir(app) + "/";
+    return ft.localPath_nogz().compare(0, dir.size(), dir) == 0;
+}
+
+bool
+CatchupProgress::hasRecord(Application& app, FileTransferInfo const& ft)
+{
+    return !app.getPersistentState()
+                .getCatchupFileHash(ft.getType(), ft.getHexDigits())
+                .empty() &&
+           fs::exists(ft.localPath_nogz());
+}
+
+void
+CatchupProgress::hashFile(Application& app, FileTransferInfo const& ft,
+                          std::function<void(std::string const&)> onHashed)
+{
+    // Checkpoint files can be large, so they're not hashed on the main thread
+    app.postOnBackgroundThread(
+        [&app, path = ft.localPath_nogz(), onHashed]() {
+            auto fileHash = hashFileContents(path);
+            app.postOnMainThread(
+                [onHashed, fileHash]() { onHashed(fileHash); },
+                "CatchupProgress: file hashed");
+        },
+        "CatchupProgress: hash file", WorkerPool::Priority::LATENCY_SENSITIVE);
+}
+
+bool
+CatchupProgress::matchesRecord(Application& app, FileTransferInfo const& ft,
+                               std::string const& fileHash)
+{
+    auto expected = app.getPersistentState().getCatchupFileHash(
+        ft.getType(), ft.getHexDigits());
+    if (expected.empty() || fileHash != expected)
+    {
+        CLOG_WARNING(History,
+                     "Catchup file {} does not match its recorded hash, "
+                     "downloading it again",
+                     ft.localPath_nogz());
+        return false;
+    }
+    return true;
+}
+
+void
+CatchupProgress::recordFile(Application& app, FileTransferInfo const& ft,
+                            std::string const& fileHash)
+{
+    ZoneScoped;
+    if (fileHash.empty())
+    {
+        CLOG_WARNING(History, "Could not hash catchup file {}",
+                     ft.localPath_nogz());
+        return;
+    }
+    app.getPersistentState().setCatchupFileHash(
+        ft.getType(), ft.getHexDigits(), fileHash);
+}
+
+bool
+CatchupProgress::tracksBuckets(Application& app, TmpDir const& downloadDir)
+{
+    return isEnabled(app) && downloadDir.getName() == getDownloadDir(app);
+}
+
+std::shared_ptr<Bucket>
+CatchupProgress::getRecordedBucket(Application& app, std::string const& hexHash)
+{
+    ZoneScoped;
+    if (app.getPersistentState()
+            .getCatchupFileHash(HISTORY_FILE_TYPE_BUCKET, hexHash)
+            .empty())
+    {
+        return nullptr;
+    }
+    return app.getBucketManager().getBucketByHash(hexToBin256(hexHash));
+}
+
+void
+CatchupProgress::recordBucket(Application& app, std::string const& hexHash)
+{
+    ZoneScoped;
+    // A bucket is named after the hash of its contents
+    app.getPersistentState().setCatchupFileHash(HISTORY_FILE_TYPE_BUCKET,
+                                                hexHash, hexHash);
+}
+
+std::set<Hash>
+CatchupProgress::getRecordedBuckets(Application& app)
+{
+    ZoneScoped;
+    std::set<Hash> res;
+    if (!isEnabled(app))
+    {
+        return res;
+    }
+    for (auto const& hexHash :
+         app.getPersistentState().getCatchupFiles(HISTORY_FILE_TYPE_BUCKET))
+    {
+        res.emplace(hexToBin256(hexHash));
+    }
+    return res;
+}
+
+void
+CatchupProgress::clear(Application& app)
+{
+    ZoneScoped;
+    app.getPersistentState().clearCatchupFileHashes();
+    auto dir = getDownloadDir(app);
+    try
+    {
+        if (fs::exists(dir))
+        {
+            fs::deltree(dir);
+        }
+    }
+    catch (std::runtime_error& e)
+    {
+        CLOG_WARNING(History, "Could not delete catchup directory {}: {}", dir,
+                     e.what());
+    }
+}
+}
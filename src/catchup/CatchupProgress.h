@@ -0,0 +1,89 @@
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#pragma once
+
+#include "util/types.h"
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+
+namespace caiz
+{
+
+class Application;
+class Bucket;
+class FileTransferInfo;
+class TmpDir;
+
+// CatchupProgress makes the downloads of a catchup survive restarts when
+// EXPERIMENTAL_RESUMABLE_CATCHUP is set. Such a catchup downloads into a fixed
+// directory under the bucket directory instead of a temporary one, and every
+// checkpoint file (ledger headers, transactions, results) it unzips there is
+// recorded in PersistentState along with its SHA-256. If the process is
+// interrupted, the next catchup reuses every recorded file whose contents
+// still match their hash instead of downloading it again; reused files then
+// go through the same verification (ledger chain, tx results) as fresh ones.
+//
+// Buckets are recorded once verified and adopted into the bucket directory.
+// BucketManager keeps recorded buckets on disk even though nothing references
+// them, and the next catchup verifies their hash again instead of downloading
+// them. Applying buckets is not resumed: partially applied buckets are
+// discarded on startup through the rebuild-ledger flags.
+//
+// Applied checkpoints need no tracking: each applied ledger advances the LCL,
+// and a restarted catchup computes its range from the LCL.
+//
+// Progress is cleared once the catchup succeeds, or when it fails to verify
+// something, since reused files may be the reason. Other failures, like an
+// unreachable archive, keep it for the next attempt.
+class CatchupProgress
+{
+  public:
+    static bool isEnabled(Application& app);
+
+    static std::string getDownloadDir(Application& app);
+
+    // Returns true if `ft` is a checkpoint file downloaded into the resumable
+    // catchup directory.
+    static bool tracks(Application& app, FileTransferInfo const& ft);
+
+    // Returns true if `ft` was recorded by an earlier run and its unzipped
+    // file is still present. It can be reused if its hash still matches.
+    static bool hasRecord(Application& app, FileTransferInfo const& ft);
+
+    // Hashes the unzipped file of `ft` on a background thread, then calls
+    // `onHashed` on the main thread with its hex SHA-256, or an empty string
+    // if it can't be read.
+    static void hashFile(Application& app, FileTransferInfo const& ft,
+                         std::function<void(std::string const&)> onHashed);
+
+    // Returns true if `fileHash` is the hash recorded for `ft`.
+    static bool matchesRecord(Application& app, FileTransferInfo const& ft,
+                              std::string const& fileHash);
+
+    // Records the unzipped file of `ft`, given its hash from hashFile.
+    static void recordFile(Application& app, FileTransferInfo const& ft,
+                           std::string const& fileHash);
+
+    // Returns true if buckets downloaded into `downloadDir` are recorded.
+    static bool tracksBuckets(Application& app, TmpDir const& downloadDir);
+
+    // Returns the bucket `hexHash` if it was recorded by an earlier run and
+    // its file is still present, or nullptr. Its hash has to be verified again
+    // before it is used.
+    static std::shared_ptr<Bucket>
+    getRecordedBucket(Application& app, std::string const& hexHash);
+
+    // Records the verified and adopted bucket `hexHash`.
+    static void recordBucket(Application& app, std::string const& hexHash);
+
+    // Returns the hashes of all recorded buckets.
+    static std::set<Hash> getRecordedBuckets(Application& app);
+
+    // Forgets all recorded files and deletes the download directory.
+    static void clear(Application& app);
+};
+}
@@ -9,6 +9,7 @@
 #include "catchup/ApplyBufferedLedgersWork.h"
 #include "catchup/ApplyCheckpointWork.h"
 #include "catchup/CatchupConfiguration.h"
+#include "catchup/CatchupProgress.h"
 #include "catchup/CatchupRange.h"
 #include "catchup/DownloadApplyTxsWork.h"
 #include "catchup/VerifyLedgerChainWork.h"
@@ -75,6 +76,12 @@ setHerderStateTo(FileTransferInfo const& ft, uint32_t ledger, Application& app)
     return true;
 }
 
+static bool
+isResumable(Application& app, CatchupConfiguration const& cfg)
+{
+    return CatchupProgress::isEnabled(app) && !cfg.localBucketsOnly();
+}
+
 CatchupWork::CatchupWork(Application& app,
                          CatchupConfiguration catchupConfiguration,
                          std::set<std::shared_ptr<Bucket>> bucketsToRetain,
@@ -82,7 +89,9 @@ CatchupWork::CatchupWork(Application& app,
     : Work(app, "catchup", BasicWork::RETRY_NEVER)
     , mLocalState{app.getLedgerManager().getLastClosedLedgerHAS()}
     , mDownloadDir{std::make_unique<TmpDir>(
-          mApp.getTmpDirManager().tmpDir(getName()))}
+          isResumable(app, catchupConfiguration)
+              ? TmpDir::persistent(CatchupProgress::getDownloadDir(app))
+              : mApp.getTmpDirManager().tmpDir(getName()))}
     , mCatchupConfiguration{catchupConfiguration}
     , mArchive{archive}
     , mRetainedBuckets{bucketsToRetain}
@@ -144,6 +153,7 @@ CatchupWork::doReset()
     mCatchupSeq.reset();
     mGetBucketStateWork.reset();
     mVerifyTxResults.reset();
+    mDownloadBuckets.reset();
     mVerifyLedgers.reset();
     mLastApplied = mApp.getLedgerManager().getLastClosedLedgerHeader();
     mCurrentWork.reset();
@@ -219,9 +229,9 @@ CatchupWork::downloadApplyBuckets()
     {
         std::vector<std::string> hashes =
             mBucketHAS->differingBuckets(mLocalState);
-        auto getBuckets = std::make_shared<DownloadBucketsWork>(
+        mDownloadBuckets = std::make_shared<DownloadBucketsWork>(
             mApp, mBuckets, hashes, *mDownloadDir, mArchive);
-        seq.push_back(getBuckets);
+        seq.push_back(mDownloadBuckets);
 
         auto verifyHASCallback = [has = *mBucketHAS](Application& app) {
             if (!has.containsValidBuckets(app))
@@ -653,10 +663,26 @@ CatchupWork::doWork()
     return nextState;
 }
 
+bool
+CatchupWork::verificationFailed() const
+{
+    return (mVerifyLedgers &&
+            mVerifyLedgers->getState() == State::WORK_FAILURE) ||
+           (mDownloadBuckets && mDownloadBuckets->verificationFailed()) ||
+           (mVerifyTxResults && mVerifyTxResults->verificationFailed());
+}
+
 void
 CatchupWork::onFailureRaise()
 {
     CLOG_WARNING(History, "Catchup failed");
+    if (isResumable(mApp, mCatchupConfiguration) && verificationFailed())
+    {
+        // Files and buckets reused from an earlier run may be the reason of
+        // the failure, so the next catchup starts from scratch. Progress is
+        // kept on other failures, like an unreachable archive.
+        CatchupProgress::clear(mApp);
+    }
     Work::onFailureRaise();
     if (mCatchupConfiguration.localBucketsOnly())
     {
@@ -668,6 +694,10 @@ void
 CatchupWork::onSuccess()
 {
     CLOG_INFO(History, "Catchup finished");
+    if (isResumable(mApp, mCatchupConfiguration))
+    {
+        CatchupProgress::clear(mApp);
+    }
     Work::onSuccess();
 }
 }
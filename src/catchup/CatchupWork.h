@@ -18,6 +18,8 @@ class HistoryManager;
 class Bucket;
 class TmpDir;
 class CatchupRange;
+class DownloadBucketsWork;
+class DownloadVerifyTxResultsWork;
 
 using WorkSeqPtr = std::shared_ptr<WorkSequence>;
 
@@ -91,7 +93,8 @@ class CatchupWork : public Work
     std::promise<LedgerNumHashPair> mRangeEndPromise;
     std::shared_future<LedgerNumHashPair> mRangeEndFuture;
     std::shared_ptr<VerifyLedgerChainWork> mVerifyLedgers;
-    std::shared_ptr<Work> mVerifyTxResults;
+    std::shared_ptr<DownloadVerifyTxResultsWork> mVerifyTxResults;
+    std::shared_ptr<DownloadBucketsWork> mDownloadBuckets;
     WorkSeqPtr mBucketVerifyApplySeq;
     std::shared_ptr<Work> mTransactionsVerifyApplySeq;
     std::shared_ptr<BasicWork> mApplyBufferedLedgersWork;
@@ -101,6 +104,7 @@ class CatchupWork : public Work
 
     bool alreadyHaveBucketsHistoryArchiveState(uint32_t atCheckpoint) const;
     void assertBucketState();
+    bool verificationFailed() const;
 
     void downloadVerifyLedgerChain(CatchupRange const& catchupRange,
                                    LedgerNumHashPair rangeEnd);
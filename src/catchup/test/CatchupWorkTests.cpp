@@ -3,15 +3,26 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "catchup/test/CatchupWorkTests.h"
+#include "bucket/Bucket.h"
+#include "bucket/BucketManager.h"
+#include "bucket/test/BucketTestUtils.h"
 #include "catchup/CatchupConfiguration.h"
+#include "catchup/CatchupProgress.h"
 #include "catchup/CatchupRange.h"
 #include "catchup/CatchupWork.h"
+#include "crypto/Hex.h"
+#include "crypto/SHA.h"
+#include "crypto/SecretKey.h"
+#include "history/FileTransferInfo.h"
 #include "ledger/CheckpointRange.h"
+#include "ledger/test/LedgerTestUtils.h"
 #include "test/TestUtils.h"
 #include "test/test.h"
 #include "util/Logging.h"
 #include "util/Timer.h"
 #include <fmt/format.h>
+#include <fstream>
+#include <optional>
 #include <lib/catch.hpp>
 
 using namespace caiz;
@@ -235,4 +246,129 @@ TEST_CASE("CatchupRange starting on checkpoint boundary still replays it",
     REQUIRE(crange2.getBucketApplyLedger() == 63);
     REQUIRE(crange2.getReplayFirst() == 64);
     REQUIRE(crange2.getReplayCount() == 3);
-}
\ No newline at end of file
+}
+
+TEST_CASE("resumable catchup reuses intact downloaded files", "[catchup]")
+{
+    VirtualClock clock;
+    auto cfg = getTestConfig();
+    cfg.EXPERIMENTAL_RESUMABLE_CATCHUP = true;
+    auto app = createTestApplication(clock, cfg);
+
+    auto writeFile = [](FileTransferInfo const& ft, std::string const& data) {
+        fs::mkpath(std::filesystem::path(ft.localPath_nogz())
+                       .parent_path()
+                       .string());
+        std::ofstream out(ft.localPath_nogz(), std::ios::binary);
+        out << data;
+    };
+
+    // Hashing happens in the background and completes on the main thread
+    auto hashFile = [&](FileTransferInfo const& ft) {
+        std::optional<std::string> fileHash;
+        CatchupProgress::hashFile(
+            *app, ft, [&](std::string const& h) { fileHash = h; });
+        while (!fileHash)
+        {
+            clock.crank(true);
+        }
+        return *fileHash;
+    };
+    auto haveFile = [&](FileTransferInfo const& ft) {
+        return CatchupProgress::hasRecord(*app, ft) &&
+               CatchupProgress::matchesRecord(*app, ft, hashFile(ft));
+    };
+
+    auto dir = TmpDir::persistent(CatchupProgress::getDownloadDir(*app));
+    FileTransferInfo ft(dir, HISTORY_FILE_TYPE_LEDGER, 63);
+    REQUIRE(CatchupProgress::tracks(*app, ft));
+    REQUIRE(!haveFile(ft));
+
+    writeFile(ft, "ledger headers");
+    // Files are only reused once recorded
+    REQUIRE(!haveFile(ft));
+    CatchupProgress::recordFile(*app, ft, hashFile(ft));
+    REQUIRE(haveFile(ft));
+    REQUIRE(hashFile(ft) == binToHex(sha256("ledger headers")));
+
+    // Other checkpoints and types are recorded independently
+    FileTransferInfo txs(dir, HISTORY_FILE_TYPE_TRANSACTIONS, 63);
+    writeFile(txs, "ledger headers");
+    REQUIRE(!haveFile(txs));
+
+    // Buckets and files outside of the catchup directory are not tracked
+    auto tmp = app->getTmpDirManager().tmpDir("resumable");
+    REQUIRE(!CatchupProgress::tracks(
+        *app, FileTransferInfo(tmp, HISTORY_FILE_TYPE_LEDGER, 63)));
+    REQUIRE(!CatchupProgress::tracks(
+        *app, FileTransferInfo(dir, HISTORY_FILE_TYPE_BUCKET,
+                               binToHex(HashUtils::random()))));
+
+    SECTION("modified file is downloaded again")
+    {
+        writeFile(ft, "corrupt headers");
+        REQUIRE(!haveFile(ft));
+    }
+
+    SECTION("clear forgets files")
+    {
+        CatchupProgress::clear(*app);
+        REQUIRE(!fs::exists(dir.getName()));
+        writeFile(ft, "ledger headers");
+        REQUIRE(!haveFile(ft));
+    }
+}
+
+TEST_CASE("resumable catchup keeps verified buckets", "[catchup]")
+{
+    VirtualClock clock;
+    auto cfg = getTestConfig();
+    cfg.EXPERIMENTAL_RESUMABLE_CATCHUP = true;
+    auto app = createTestApplication(clock, cfg);
+    auto& bm = app->getBucketManager();
+
+    auto dir = TmpDir::persistent(CatchupProgress::getDownloadDir(*app));
+    REQUIRE(CatchupProgress::tracksBuckets(*app, dir));
+    REQUIRE(!CatchupProgress::tracksBuckets(
+        *app, app->getTmpDirManager().tmpDir("resumable")));
+
+    std::string hexHash;
+    std::string filename;
+    {
+        auto b = Bucket::fresh(
+            bm, BucketTestUtils::getAppLedgerVersion(app), {},
+            LedgerTestUtils::generateValidUniqueLedgerEntries(10), {},
+            /*countMergeEvents=*/false, clock.getIOContext(),
+            /*doFsync=*/false);
+        hexHash = binToHex(b->getHash());
+        filename = b->getFilename().string();
+    }
+    REQUIRE(fs::exists(filename));
+
+    SECTION("unrecorded bucket is garbage-collected")
+    {
+        REQUIRE(!CatchupProgress::getRecordedBucket(*app, hexHash));
+        bm.forgetUnreferencedBuckets();
+        REQUIRE(!fs::exists(filename));
+    }
+
+    SECTION("recorded bucket is kept until progress is cleared")
+    {
+        CatchupProgress::recordBucket(*app, hexHash);
+        REQUIRE(CatchupProgress::getRecordedBuckets(*app) ==
+                std::set<Hash>{hexToBin256(hexHash)});
+        bm.forgetUnreferencedBuckets();
+        REQUIRE(fs::exists(filename));
+
+        auto b = CatchupProgress::getRecordedBucket(*app, hexHash);
+        REQUIRE(b);
+        REQUIRE(binToHex(b->getHash()) == hexHash);
+        b.reset();
+
+        CatchupProgress::clear(*app);
+        REQUIRE(CatchupProgress::getRecordedBuckets(*app).empty());
+        REQUIRE(!CatchupProgress::getRecordedBucket(*app, hexHash));
+        bm.forgetUnreferencedBuckets();
+        REQUIRE(!fs::exists(filename));
+    }
+}
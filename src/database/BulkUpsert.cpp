@@ -0,0 +1,503 @@
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "database/BulkUpsert.h"
+#include "database/DatabaseTypeSpecificOperation.h"
+#include "util/GlobalChecks.h"
+#include <Tracy.hpp>
+#include <algorithm>
+#include <fmt/format.h>
+#include <memory>
+#include <stdexcept>
+
+namespace caiz
+{
+
+namespace
+{
+void
+bindSqlite(sqlite_api::sqlite3_stmt* st, int param, std::string const& value)
+{
+    sqlite3_bind_text(st, param, value.data(), static_cast<int>(value.size()),
+                      SQLITE_STATIC);
+}
+
+void
+bindSqlite(sqlite_api::sqlite3_stmt* st, int param, int64_t value)
+{
+    sqlite3_bind_int64(st, param, value);
+}
+
+void
+bindSqlite(sqlite_api::sqlite3_stmt* st, int param, int32_t value)
+{
+    sqlite3_bind_int(st, param, value);
+}
+
+void
+bindSqlite(sqlite_api::sqlite3_stmt* st, int param, double value)
+{
+    sqlite3_bind_double(st, param, value);
+}
+
+#ifdef USE_POSTGRES
+// Size of the chunks handed to PQputCopyData
+constexpr size_t COPY_BUFFER_SIZE = 1024 * 1024;
+
+void
+execPostgres(PGconn* conn, std::string const& sql, ExecStatusType expected)
+{
+    std::unique_ptr<PGresult, decltype(&PQclear)> res(PQexec(conn, sql.c_str()),
+                                                      &PQclear);
+    if (PQresultStatus(res.get()) != expected)
+    {
+        throw std::runtime_error(fmt::format("Could not execute '{}': {}", sql,
+                                             PQerrorMessage(conn)));
+    }
+}
+
+// Appends value to a COPY in text format, escaping the characters that
+// delimit fields and rows
+void
+appendCopyText(std::string& out, std::string const& value)
+{
+    for (char c : value)
+    {
+        switch (c)
+        {
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        default:
+            out += c;
+            break;
+        }
+    }
+}
+
+void
+appendCopyText(std::string& out, int64_t value)
+{
+    out += std::to_string(value);
+}
+
+void
+appendCopyText(std::string& out, int32_t value)
+{
+    out += std::to_string(value);
+}
+
+void
+appendCopyText(std::string& out, double value)
+{
+    // fmt prints the shortest representation that reads back as exactly the
+    // same double
+    out += fmt::format("{}", value);
+}
+
+void
+putCopyData(PGconn* conn, std::string const& data)
+{
+    if (PQputCopyData(conn, data.data(), static_cast<int>(data.size())) != 1)
+    {
+        throw std::runtime_error(
+            fmt::format("Could not send COPY data: {}", PQerrorMessage(conn)));
+    }
+}
+#endif
+}
+
+BulkUpsert::BulkUpsert(Database& db, std::string table, std::string entityName,
+                       std::vector<std::string> keyColumns)
+    : mDB(db)
+    , mTable(std::move(table))
+    , mEntityName(std::move(entityName))
+    , mKeyColumns(std::move(keyColumns))
+{
+}
+
+void
+BulkUpsert::addColumn(std::string name, std::vector<std::string> const& values,
+                      std::vector<soci::indicator> const* indicators)
+{
+    releaseAssert(!indicators || indicators->size() == values.size());
+    mColumns.emplace_back(Column{std::move(name), &values, indicators});
+}
+
+void
+BulkUpsert::addColumn(std::string name, std::vector<int64_t> const& values)
+{
+    mColumns.emplace_back(Column{std::move(name), &values, nullptr});
+}
+
+void
+BulkUpsert::addColumn(std::string name, std::vector<int32_t> const& values)
+{
+    mColumns.emplace_back(Column{std::move(name), &values, nullptr});
+}
+
+void
+BulkUpsert::addColumn(std::string name, std::vector<double> const& values)
+{
+    mColumns.emplace_back(Column{std::move(name), &values, nullptr});
+}
+
+size_t
+BulkUpsert::Column::size() const
+{
+    return std::visit([](auto const* values) { return values->size(); },
+                      mValues);
+}
+
+bool
+BulkUpsert::Column::isNull(size_t row) const
+{
+    return mIndicators && (*mIndicators)[row] == soci::i_null;
+}
+
+size_t
+BulkUpsert::numRows() const
+{
+    releaseAssert(mColumns.size() > mKeyColumns.size());
+    size_t rows = mColumns.front().size();
+    for (auto const& col : mColumns)
+    {
+        releaseAssert(col.size() == rows);
+    }
+    return rows;
+}
+
+std::string
+BulkUpsert::columnList() const
+{
+    std::string res;
+    for (auto const& col : mColumns)
+    {
+        if (!res.empty())
+        {
+            res += ", ";
+        }
+        res += col.mName;
+    }
+    return res;
+}
+
+std::string
+BulkUpsert::upsertClause() const
+{
+    if (mKeyColumns.empty())
+    {
+        return "";
+    }
+
+    std::string res = " ON CONFLICT (";
+    for (size_t i = 0; i < mKeyColumns.size(); ++i)
+    {
+        res += (i == 0 ? "" : ", ") + mKeyColumns[i];
+    }
+    res += ") DO UPDATE SET ";
+
+    bool first = true;
+    for (auto const& col : mColumns)
+    {
+        if (std::find(mKeyColumns.begin(), mKeyColumns.end(), col.mName) !=
+            mKeyColumns.end())
+        {
+            continue;
+        }
+        res += (first ? "" : ", ") + col.mName + " = excluded." + col.mName;
+        first = false;
+    }
+    return res;
+}
+
+medida::TimerContext
+BulkUpsert::getTimer() const
+{
+    return mKeyColumns.empty() ? mDB.getInsertTimer(mEntityName)
+                               : mDB.getUpsertTimer(mEntityName);
+}
+
+void
+BulkUpsert::checkRowsWritten(size_t rows) const
+{
+    if (rows != numRows())
+    {
+        throw std::runtime_error("Could not update data in SQL");
+    }
+}
+
+void
+BulkUpsert::execute()
+{
+    class BulkUpsertOperation : public DatabaseTypeSpecificOperation<void>
+    {
+        BulkUpsert& mUpsert;
+
+      public:
+        explicit BulkUpsertOperation(BulkUpsert& upsert) : mUpsert(upsert)
+        {
+        }
+
+        void
+        doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
+        {
+            mUpsert.execute(sq);
+        }
+
+#ifdef USE_POSTGRES
+        void
+        doPostgresSpecificOperation(soci::postgresql_session_backend* pg) override
+        {
+            mUpsert.execute(pg);
+        }
+#endif
+    };
+
+    BulkUpsertOperation op(*this);
+    mDB.doDatabaseTypeSpecificOperation(op);
+}
+
+void
+BulkUpsert::execute(soci::sqlite3_session_backend* sq)
+{
+    ZoneScoped;
+    size_t const rows = numRows();
+    size_t const maxVariables = static_cast<size_t>(
+        sqlite3_limit(sq->conn_, SQLITE_LIMIT_VARIABLE_NUMBER, -1));
+    size_t const rowsPerStatement =
+        std::min(SQLITE_MAX_ROWS_PER_STATEMENT, maxVariables / mColumns.size());
+    releaseAssert(rowsPerStatement > 0);
+
+    std::string rowPlaceholders = "(?";
+    for (size_t i = 1; i < mColumns.size(); ++i)
+    {
+        rowPlaceholders += ", ?";
+    }
+    rowPlaceholders += ")";
+
+    auto timer = getTimer();
+    size_t written = 0;
+    for (size_t begin = 0; begin < rows; begin += rowsPerStatement)
+    {
+        size_t const end = std::min(rows, begin + rowsPerStatement);
+
+        std::string sql = "INSERT INTO " + mTable + " (" + columnList() +
+                          ") VALUES " + rowPlaceholders;
+        for (size_t i = begin + 1; i < end; ++i)
+        {
+            sql += ", " + rowPlaceholders;
+        }
+        sql += upsertClause();
+
+        auto prep = mDB.getPreparedStatement(sql);
+        auto be = prep.statement().get_backend();
+        if (be == nullptr)
+        {
+            throw std::runtime_error("no sql backend");
+        }
+        auto st = dynamic_cast<soci::sqlite3_statement_backend*>(be)->stmt_;
+
+        sqlite3_reset(st);
+        int param = 1;
+        for (size_t i = begin; i < end; ++i)
+        {
+            for (auto const& col : mColumns)
+            {
+                if (col.isNull(i))
+                {
+                    sqlite3_bind_null(st, param);
+                }
+                else
+                {
+                    std::visit(
+                        [&](auto const* values) {
+                            bindSqlite(st, param, (*values)[i]);
+                        },
+                        col.mValues);
+                }
+                ++param;
+            }
+        }
+
+        if (sqlite3_step(st) != SQLITE_DONE)
+        {
+            std::string err = sqlite3_errmsg(sq->conn_);
+            sqlite3_reset(st);
+            throw std::runtime_error(
+                fmt::format("Could not update data in SQL: {}", err));
+        }
+        written += static_cast<size_t>(sqlite3_changes(sq->conn_));
+        // The bound text points into the caller's vectors
+        sqlite3_reset(st);
+        sqlite3_clear_bindings(st);
+    }
+    checkRowsWritten(written);
+}
+
+#ifdef USE_POSTGRES
+bool
+BulkUpsert::usePostgresCopy(size_t rows)
+{
+    return rows >= POSTGRES_COPY_THRESHOLD;
+}
+
+void
+BulkUpsert::execute(soci::postgresql_session_backend* pg)
+{
+    ZoneScoped;
+    size_t const rows = numRows();
+    PGconn* conn = pg->conn_;
+    std::string const columns = columnList();
+    std::string const tmpTable = "tmp_upsert_" + mTable;
+
+    // Plain inserts go straight into the table. Upserts go through a
+    // temporary table that lives as long as the session and has the same
+    // column types as the table, but none of its constraints.
+    bool const insertOnly = mKeyColumns.empty();
+    if (!insertOnly && !usePostgresCopy(rows))
+    {
+        executeRowByRow();
+        return;
+    }
+
+    auto timer = getTimer();
+
+    std::string const copyTable = insertOnly ? mTable : tmpTable;
+    if (!insertOnly)
+    {
+        execPostgres(conn,
+                     "CREATE TEMP TABLE IF NOT EXISTS " + tmpTable +
+                         " AS SELECT " + columns + " FROM " + mTable +
+                         " WITH NO DATA",
+                     PGRES_COMMAND_OK);
+        execPostgres(conn, "TRUNCATE " + tmpTable, PGRES_COMMAND_OK);
+    }
+    execPostgres(conn, "COPY " + copyTable + " (" + columns + ") FROM STDIN",
+                 PGRES_COPY_IN);
+
+    std::string buf;
+    buf.reserve(COPY_BUFFER_SIZE + 4096);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        for (size_t c = 0; c < mColumns.size(); ++c)
+        {
+            auto const& col = mColumns[c];
+            if (c > 0)
+            {
+                buf += '\t';
+            }
+            if (col.isNull(i))
+            {
+                buf += "\\N";
+            }
+            else
+            {
+                std::visit(
+                    [&](auto const* values) {
+                        appendCopyText(buf, (*values)[i]);
+                    },
+                    col.mValues);
+            }
+        }
+        buf += '\n';
+        if (buf.size() >= COPY_BUFFER_SIZE)
+        {
+            putCopyData(conn, buf);
+            buf.clear();
+        }
+    }
+    if (!buf.empty())
+    {
+        putCopyData(conn, buf);
+    }
+    if (PQputCopyEnd(conn, nullptr) != 1)
+    {
+        throw std::runtime_error(
+            fmt::format("Could not end COPY: {}", PQerrorMessage(conn)));
+    }
+
+    bool copied = true;
+    size_t rowsCopied = 0;
+    std::string err;
+    while (PGresult* res = PQgetResult(conn))
+    {
+        if (PQresultStatus(res) != PGRES_COMMAND_OK)
+        {
+            copied = false;
+            err = PQresultErrorMessage(res);
+        }
+        else
+        {
+            char const* tuples = PQcmdTuples(res);
+            rowsCopied = *tuples ? std::stoull(tuples) : 0;
+        }
+        PQclear(res);
+    }
+    if (!copied)
+    {
+        throw std::runtime_error(fmt::format("Could not COPY data: {}", err));
+    }
+    if (insertOnly)
+    {
+        checkRowsWritten(rowsCopied);
+        return;
+    }
+
+    auto prep =
+        mDB.getPreparedStatement("INSERT INTO " + mTable + " (" + columns +
+                                 ") SELECT " + columns + " FROM " + tmpTable +
+                                 upsertClause());
+    soci::statement& st = prep.statement();
+    st.define_and_bind();
+    st.execute(true);
+    checkRowsWritten(static_cast<size_t>(st.get_affected_rows()));
+}
+
+void
+BulkUpsert::executeRowByRow()
+{
+    ZoneScoped;
+    std::string sql = "INSERT INTO " + mTable + " (" + columnList() +
+                      ") VALUES (";
+    for (size_t c = 0; c < mColumns.size(); ++c)
+    {
+        sql += fmt::format("{}:v{}", c == 0 ? "" : ", ", c);
+    }
+    sql += ")" + upsertClause();
+
+    auto timer = getTimer();
+    size_t written = 0;
+    std::vector<soci::indicator> inds(mColumns.size());
+    for (size_t i = 0; i < numRows(); ++i)
+    {
+        auto prep = mDB.getPreparedStatement(sql);
+        soci::statement& st = prep.statement();
+        for (size_t c = 0; c < mColumns.size(); ++c)
+        {
+            auto const& col = mColumns[c];
+            inds[c] = col.isNull(i) ? soci::i_null : soci::i_ok;
+            std::visit(
+                [&](auto const* values) {
+                    st.exchange(soci::use((*values)[i], inds[c]));
+                },
+                col.mValues);
+        }
+        st.define_and_bind();
+        st.execute(true);
+        written += static_cast<size_t>(st.get_affected_rows());
+    }
+    checkRowsWritten(written);
+}
+#endif
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "database/Database.h"
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace caiz
+{
+
+// BulkUpsert writes a batch of rows into one table in as few statements as
+// possible. Rows whose key columns match an existing row replace every other
+// column of that row.
+//
+// On SQLite the rows go out in multi-row INSERT ... VALUES statements, each as
+// large as SQLite's bound-variable limit allows. On Postgres the rows are
+// COPYed into a temporary table and then merged into the table with a single
+// INSERT ... SELECT. COPY has a few round trips of fixed overhead, so batches
+// smaller than POSTGRES_COPY_THRESHOLD (see usePostgresCopy) are instead
+// upserted one row at a time, unless the caller has a single statement with
+// array parameters for them.
+//
+// With no key columns, every row is inserted as a new row and a row that
+// violates a constraint of the table is an error. On Postgres such rows are
+// COPYed straight into the table, which is cheaper than one INSERT per row
+// for any batch.
+//
+// Columns refer to the caller's vectors, which must all have the same length
+// and must outlive the BulkUpsert. execute throws unless every row was written.
+class BulkUpsert
+{
+  public:
+    static constexpr size_t POSTGRES_COPY_THRESHOLD = 512;
+
+    // entityName names the upsert timer, see Database::getUpsertTimer
+    BulkUpsert(Database& db, std::string table, std::string entityName,
+               std::vector<std::string> keyColumns);
+
+    void addColumn(std::string name, std::vector<std::string> const& values,
+                   std::vector<soci::indicator> const* indicators = nullptr);
+    void addColumn(std::string name, std::vector<int64_t> const& values);
+    void addColumn(std::string name, std::vector<int32_t> const& values);
+    void addColumn(std::string name, std::vector<double> const& values);
+
+    // Writes the rows through the main session of the database
+    void execute();
+
+    void execute(soci::sqlite3_session_backend* sq);
+#ifdef USE_POSTGRES
+    static bool usePostgresCopy(size_t rows);
+    void execute(soci::postgresql_session_backend* pg);
+#endif
+
+  private:
+#ifdef USE_POSTGRES
+    void executeRowByRow();
+#endif
+
+    // Upper bound on rows per SQLite statement, so that statements (which are
+    // cached by text) stay a reasonable size
+    static constexpr size_t SQLITE_MAX_ROWS_PER_STATEMENT = 1024;
+
+    struct Column
+    {
+        std::string mName;
+        std::variant<std::vector<std::string> const*,
+                     std::vector<int64_t> const*, std::vector<int32_t> const*,
+                     std::vector<double> const*>
+            mValues;
+        std::vector<soci::indicator> const* mIndicators;
+
+        size_t size() const;
+        bool isNull(size_t row) const;
+    };
+
+    Database& mDB;
+    std::string const mTable;
+    std::string const mEntityName;
+    std::vector<std::string> const mKeyColumns;
+    std::vector<Column> mColumns;
+
+    size_t numRows() const;
+    std::string columnList() const;
+    std::string upsertClause() const;
+    medida::TimerContext getTimer() const;
+    void checkRowsWritten(size_t rows) const;
+};
+}
@@ -94,8 +94,6 @@ class Database : NonMovableOrCopyable
     std::map<std::string, std::shared_ptr<soci::statement>> mStatements;
     medida::Counter& mStatementsSize;
 
-    std::set<std::string> mEntityTypes;
-
     static bool gDriversRegistered;
     static void registerDrivers();
     void applySchemaUpgrade(unsigned long vers);
@@ -121,6 +119,13 @@ class Database : NonMovableOrCopyable
     // when the statement context is destroyed.
     StatementContext getPreparedStatement(std::string const& query);
 
+    // Same as above, but prepares the statement on `session`. Only statements
+    // on the main session are cached; on any other session (e.g. one taken
+    // from the connection pool by a worker thread) the statement is prepared
+    // for this use only.
+    StatementContext getPreparedStatement(std::string const& query,
+                                          soci::session& session);
+
     // Purge all cached prepared statements, closing their handles with the
     // database.
     void clearPreparedStatementCache();
@@ -5,7 +5,9 @@
 #include "util/asio.h"
 #include "crypto/Hex.h"
 #include "crypto/KeyUtils.h"
+#include "database/BulkUpsert.h"
 #include "database/Database.h"
+#include "database/DatabaseTypeSpecificOperation.h"
 #include "ledger/LedgerTxn.h"
 #include "ledger/test/LedgerTestUtils.h"
 #include "lib/catch.hpp"
@@ -67,6 +69,133 @@ transactionTest(Application::pointer app)
 
     session << "SELECT x FROM test", soci::into(b);
     CHECK(a == b);
+
+    session << "DROP TABLE test";
+}
+
+class TestBulkUpsertOperation : public DatabaseTypeSpecificOperation<void>
+{
+    Database& mDB;
+
+  public:
+    std::vector<std::string> mKeys;
+    std::vector<int32_t> mSubKeys;
+    std::vector<int64_t> mAmounts;
+    std::vector<double> mPrices;
+    std::vector<std::string> mNotes;
+    std::vector<soci::indicator> mNoteInds;
+
+    explicit TestBulkUpsertOperation(Database& db) : mDB(db)
+    {
+    }
+
+    void
+    addRow(int i, int64_t amount, bool withNote)
+    {
+        mKeys.emplace_back("key\t" + std::to_string(i / 2));
+        mSubKeys.emplace_back(i % 2);
+        mAmounts.emplace_back(amount);
+        mPrices.emplace_back(amount / 7.0);
+        // Exercise the characters that COPY has to escape
+        mNotes.emplace_back(withNote ? "a\tb\nc\\d\r" + std::to_string(i)
+                                     : "");
+        mNoteInds.emplace_back(withNote ? soci::i_ok : soci::i_null);
+    }
+
+    BulkUpsert
+    bulkUpsert(std::vector<std::string> keyColumns = {"k", "sub"}) const
+    {
+        BulkUpsert upsert(mDB, "test", "test", std::move(keyColumns));
+        upsert.addColumn("k", mKeys);
+        upsert.addColumn("sub", mSubKeys);
+        upsert.addColumn("amount", mAmounts);
+        upsert.addColumn("price", mPrices);
+        upsert.addColumn("note", mNotes, &mNoteInds);
+        return upsert;
+    }
+
+    void
+    doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
+    {
+        bulkUpsert().execute(sq);
+    }
+
+#ifdef USE_POSTGRES
+    void
+    doPostgresSpecificOperation(soci::postgresql_session_backend* pg) override
+    {
+        bulkUpsert().execute(pg);
+    }
+#endif
+};
+
+void
+bulkUpsertTest(Application::pointer app)
+{
+    auto& db = app->getDatabase();
+    auto& session = db.getSession();
+    session << "DROP TABLE IF EXISTS test";
+    session << "CREATE TABLE test (k TEXT NOT NULL, sub INT NOT NULL, "
+               "amount BIGINT NOT NULL, price DOUBLE PRECISION NOT NULL, "
+               "note TEXT, PRIMARY KEY (k, sub))";
+
+    // Enough rows to need several SQLite statements
+    int const numRows = 3000;
+    {
+        soci::transaction tx(session);
+        TestBulkUpsertOperation insert(db);
+        for (int i = 0; i < numRows; ++i)
+        {
+            insert.addRow(i, i, i % 3 == 0);
+        }
+        db.doDatabaseTypeSpecificOperation(insert);
+
+        // Update every other row and add new ones
+        TestBulkUpsertOperation update(db);
+        for (int i = 0; i < numRows + 100; i += 2)
+        {
+            update.addRow(i, INT64_MAX - i, i % 3 != 0);
+        }
+        db.doDatabaseTypeSpecificOperation(update);
+        tx.commit();
+    }
+
+    int count = 0;
+    session << "SELECT COUNT(*) FROM test", soci::into(count);
+    REQUIRE(count == numRows + 50);
+
+    for (int i : {0, 1, 2, 3, 2998, 2999, 3000, 3098})
+    {
+        TestBulkUpsertOperation expected(db);
+        bool updated = i % 2 == 0;
+        expected.addRow(i, updated ? INT64_MAX - i : i,
+                        updated ? i % 3 != 0 : i % 3 == 0);
+
+        int64_t amount = 0;
+        double price = 0;
+        std::string note;
+        soci::indicator noteInd;
+        session << "SELECT amount, price, note FROM test "
+                   "WHERE k = :k AND sub = :sub",
+            soci::into(amount), soci::into(price), soci::into(note, noteInd),
+            soci::use(expected.mKeys[0]), soci::use(expected.mSubKeys[0]);
+        REQUIRE(amount == expected.mAmounts[0]);
+        REQUIRE(price == expected.mPrices[0]);
+        REQUIRE(noteInd == expected.mNoteInds[0]);
+        if (noteInd == soci::i_ok)
+        {
+            REQUIRE(note == expected.mNotes[0]);
+        }
+    }
+
+    // Without key columns rows are only ever inserted
+    TestBulkUpsertOperation extra(db);
+    extra.addRow(2 * numRows, 1, false);
+    extra.bulkUpsert({}).execute();
+    session << "SELECT COUNT(*) FROM test", soci::into(count);
+    REQUIRE(count == numRows + 51);
+    REQUIRE_THROWS_AS(extra.bulkUpsert({}).execute(), std::runtime_error);
+
     session << "DROP TABLE test";
 }
 
@@ -79,6 +208,15 @@ TEST_CASE("database smoketest", "[db]")
     transactionTest(app);
 }
 
+TEST_CASE("bulk upsert", "[db]")
+{
+    Config const& cfg = getTestConfig(0, Config::TESTDB_IN_MEMORY_SQLITE);
+
+    VirtualClock clock;
+    Application::pointer app = createTestApplication(clock, cfg, true, false);
+    bulkUpsertTest(app);
+}
+
 TEST_CASE("database on-disk smoketest", "[db]")
 {
     Config const& cfg = getTestConfig(0, Config::TESTDB_ON_DISK_SQLITE);
@@ -247,6 +385,11 @@ TEST_CASE("postgres smoketest", "[db]")
             tx.commit();
         }
 
+        SECTION("bulk upsert")
+        {
+            bulkUpsertTest(app);
+        }
+
         SECTION("postgres MVCC test")
         {
             app->getDatabase().getSession() << "drop table if exists test";
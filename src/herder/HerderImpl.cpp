@@ -992,7 +992,8 @@ HerderImpl::safelyProcessSCPQueue(bool synchronous)
     else
     {
         mApp.postOnMainThread(processSCPQueueSomeMore,
-                              "processSCPQueueSomeMore");
+                              "processSCPQueueSomeMore",
+                              Scheduler::ActionType::CRITICAL_ACTION);
     }
 }
 
@@ -1212,18 +1213,22 @@ HerderImpl::triggerNextLedger(uint32_t ledgerSeqToTrigger,
         return;
     }
 
-    // our first choice for this round's set is all the tx we have collected
-    // during last few ledger closes
+    // our first choice for this round's set is the best of the tx we have
+    // collected during last few ledger closes. The queues keep their
+    // candidates up to date as transactions come and go, so only the
+    // candidates are validated and surge priced here. Invalid transactions
+    // outside of the candidates are only banned once they make it into one.
     auto const& lcl = mLedgerManager.getLastClosedLedgerHeader();
     TxSetFrame::TxPhases txPhases;
-    txPhases.emplace_back(mTransactionQueue.getTransactions(lcl.header));
+    txPhases.emplace_back(
+        mTransactionQueue.getCandidateTransactions(lcl.header));
 
 #ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
     if (protocolVersionStartsFrom(lcl.header.ledgerVersion,
                                   ProtocolVersion::V_20))
     {
         txPhases.emplace_back(
-            mSorobanTransactionQueue.getTransactions(lcl.header));
+            mSorobanTransactionQueue.getCandidateTransactions(lcl.header));
     }
 #endif
 
@@ -4,6 +4,7 @@
 
 #include "herder/HerderPersistenceImpl.h"
 #include "crypto/Hex.h"
+#include "database/BulkUpsert.h"
 #include "database/Database.h"
 #include "database/DatabaseUtils.h"
 #include "herder/Herder.h"
@@ -62,6 +63,12 @@ HerderPersistenceImpl::saveSCPHistory(uint32_t seq,
             st.execute(true);
         }
     }
+    std::vector<std::string> envNodeIDs;
+    std::vector<int64_t> envLedgerSeqs;
+    std::vector<std::string> envEncoded;
+    envNodeIDs.reserve(envs.size());
+    envLedgerSeqs.reserve(envs.size());
+    envEncoded.reserve(envs.size());
     for (auto const& e : envs)
     {
         auto const& qHash =
@@ -69,34 +76,22 @@ HerderPersistenceImpl::saveSCPHistory(uint32_t seq,
         usedQSets.insert(
             std::make_pair(qHash, mApp.getHerder().getQSet(qHash)));
 
-        std::string nodeIDStrKey = KeyUtils::toStrKey(e.statement.nodeID);
-
-        auto envelopeBytes(xdr::xdr_to_opaque(e));
-
-        std::string envelopeEncoded;
-        envelopeEncoded = decoder::encode_b64(envelopeBytes);
-
-        auto prepEnv =
-            db.getPreparedStatement("INSERT INTO scphistory "
-                                    "(nodeid, ledgerseq, envelope) VALUES "
-                                    "(:n, :l, :e)");
-
-        auto& st = prepEnv.statement();
-        st.exchange(soci::use(nodeIDStrKey));
-        st.exchange(soci::use(seq));
-        st.exchange(soci::use(envelopeEncoded));
-        st.define_and_bind();
-        {
-            ZoneNamedN(insertSCPHistoryZone, "insert scphistory", true);
-            st.execute(true);
-        }
-        if (st.get_affected_rows() != 1)
-        {
-            throw std::runtime_error("Could not update data in SQL");
-        }
+        envNodeIDs.emplace_back(KeyUtils::toStrKey(e.statement.nodeID));
+        envLedgerSeqs.emplace_back(seq);
+        envEncoded.emplace_back(decoder::encode_b64(xdr::xdr_to_opaque(e)));
+    }
+    {
+        ZoneNamedN(insertSCPHistoryZone, "insert scphistory", true);
+        BulkUpsert insert(db, "scphistory", "scphistory", {});
+        insert.addColumn("nodeid", envNodeIDs);
+        insert.addColumn("ledgerseq", envLedgerSeqs);
+        insert.addColumn("envelope", envEncoded);
+        insert.execute();
     }
 
     // save quorum information
+    std::vector<std::string> qNodeIDs;
+    std::vector<std::string> qSetHashes;
     for (auto const& p : qmap)
     {
         auto const& nodeID = p.first;
@@ -108,36 +103,16 @@ HerderPersistenceImpl::saveSCPHistory(uint32_t seq,
         auto qSetH = xdrSha256(*(p.second.mQuorumSet));
         usedQSets.insert(std::make_pair(qSetH, p.second.mQuorumSet));
 
-        std::string nodeIDStrKey = KeyUtils::toStrKey(nodeID);
-        std::string qSetHHex(binToHex(qSetH));
-
-        auto prep = db.getPreparedStatement(
-            "UPDATE quoruminfo SET qsethash = :h WHERE nodeid = :id");
-        auto& st = prep.statement();
-        st.exchange(soci::use(qSetHHex));
-        st.exchange(soci::use(nodeIDStrKey));
-        st.define_and_bind();
-        {
-            ZoneNamedN(updateQsetZone, "update quoruminfo", true);
-            st.execute(true);
-        }
-        if (st.get_affected_rows() != 1)
-        {
-            auto prepI = db.getPreparedStatement(
-                "INSERT INTO quoruminfo (nodeid, qsethash) VALUES (:id, :h)");
-            auto& stI = prepI.statement();
-            stI.exchange(soci::use(nodeIDStrKey));
-            stI.exchange(soci::use(qSetHHex));
-            stI.define_and_bind();
-            {
-                ZoneNamedN(insertQsetZone, "insert quoruminfo", true);
-                stI.execute(true);
-            }
-            if (stI.get_affected_rows() != 1)
-            {
-                throw std::runtime_error("Could not update data in SQL");
-            }
-        }
+        qNodeIDs.emplace_back(KeyUtils::toStrKey(nodeID));
+        qSetHashes.emplace_back(binToHex(qSetH));
+    }
+    if (!qNodeIDs.empty())
+    {
+        ZoneNamedN(upsertQsetZone, "upsert quoruminfo", true);
+        BulkUpsert upsert(db, "quoruminfo", "quoruminfo", {"nodeid"});
+        upsert.addColumn("nodeid", qNodeIDs);
+        upsert.addColumn("qsethash", qSetHashes);
+        upsert.execute();
     }
     // save quorum sets
     for (auto const& p : usedQSets)
@@ -14,6 +14,7 @@
 #include "util/Logging.h"
 #include "util/UnorderedSet.h"
 #include <Tracy.hpp>
+#include <algorithm>
 #include <xdrpp/marshal.h>
 
 using namespace std;
@@ -104,6 +105,7 @@ PendingEnvelopes::putQSet(Hash const& qSetHash, SCPQuorumSet const& qSet)
         res = std::make_shared<SCPQuorumSet>(qSet);
         mKnownQSets[qSetHash] = res;
         mQsetCache.put(qSetHash, res);
+        itemKnown(&SlotEnvelopes::mWaitingForQSet, qSetHash);
     }
     return res;
 }
@@ -187,6 +189,7 @@ PendingEnvelopes::putTxSet(Hash const& hash, uint64 slot,
         res = txset;
         mKnownTxSets[hash] = res;
         mTxSetCache.put(hash, std::make_pair(slot, res));
+        itemKnown(&SlotEnvelopes::mWaitingForTxSet, hash);
     }
     return res;
 }
@@ -324,7 +327,11 @@ PendingEnvelopes::recvSCPEnvelope(SCPEnvelope const& envelope)
             { // we haven't seen this envelope before
                 // insert it into the fetching set
                 fetchIt =
-                    fetching.emplace(envelope, mApp.getClock().now()).first;
+                    fetching
+                        .emplace(envelope,
+                                 FetchingEnvelope{mApp.getClock().now()})
+                        .first;
+                addMissingItems(envs, fetchIt);
                 startFetch(envelope);
                 updateMetrics();
             }
@@ -336,11 +343,17 @@ PendingEnvelopes::recvSCPEnvelope(SCPEnvelope const& envelope)
         }
 
         // we are fetching this envelope
-        // check if we are done fetching it
-        if (isFullyFetched(envelope))
+        // check if we are done fetching it. Known txsets and qsets are only
+        // held weakly, so one may have expired since it was counted as
+        // received: wait for it again in that case.
+        if (fetchIt->second.mMissingItems == 0 && !isFullyFetched(envelope))
+        {
+            addMissingItems(envs, fetchIt);
+        }
+        if (fetchIt->second.mMissingItems == 0)
         {
             std::chrono::nanoseconds durationNano =
-                mApp.getClock().now() - fetchIt->second;
+                mApp.getClock().now() - fetchIt->second.mStartedAt;
             mFetchDuration.Update(durationNano);
             Hash h = Slot::getCompanionQuorumSetHashFromStatement(
                 envelope.statement);
@@ -391,7 +404,12 @@ PendingEnvelopes::discardSCPEnvelope(SCPEnvelope const& envelope)
             return;
         }
 
-        envs.mFetchingEnvelopes.erase(envelope);
+        auto fetchIt = envs.mFetchingEnvelopes.find(envelope);
+        if (fetchIt != envs.mFetchingEnvelopes.end())
+        {
+            removeMissingItems(envs, fetchIt);
+            envs.mFetchingEnvelopes.erase(fetchIt);
+        }
 
         stopFetch(envelope);
     }
@@ -562,6 +580,97 @@ PendingEnvelopes::isFullyFetched(SCPEnvelope const& envelope)
                        });
 }
 
+void
+PendingEnvelopes::addMissingItems(SlotEnvelopes& envs,
+                                  SlotEnvelopes::FetchingIter it)
+{
+    auto const& envelope = it->first;
+    auto& missing = it->second.mMissingItems;
+    // an envelope may refer to the same item more than once, but is only
+    // added once to its waiters
+    auto wait = [&](std::vector<SlotEnvelopes::FetchingIter>& waiters) {
+        if (waiters.empty() || waiters.back() != it)
+        {
+            waiters.emplace_back(it);
+            ++missing;
+        }
+    };
+
+    Hash h = Slot::getCompanionQuorumSetHashFromStatement(envelope.statement);
+    if (!getKnownQSet(h, false))
+    {
+        wait(envs.mWaitingForQSet[h]);
+    }
+    for (auto const& h2 : getTxSetHashes(envelope))
+    {
+        if (!getKnownTxSet(h2, 0, false))
+        {
+            wait(envs.mWaitingForTxSet[h2]);
+        }
+    }
+}
+
+void
+PendingEnvelopes::removeMissingItems(SlotEnvelopes& envs,
+                                     SlotEnvelopes::FetchingIter it)
+{
+    if (it->second.mMissingItems == 0)
+    {
+        return;
+    }
+
+    auto unwait =
+        [&](UnorderedMap<Hash, std::vector<SlotEnvelopes::FetchingIter>>&
+                waiting,
+            Hash const& hash) {
+            auto waitIt = waiting.find(hash);
+            if (waitIt == waiting.end())
+            {
+                return;
+            }
+            auto& waiters = waitIt->second;
+            waiters.erase(std::remove(waiters.begin(), waiters.end(), it),
+                          waiters.end());
+            if (waiters.empty())
+            {
+                waiting.erase(waitIt);
+            }
+        };
+
+    auto const& envelope = it->first;
+    unwait(envs.mWaitingForQSet,
+           Slot::getCompanionQuorumSetHashFromStatement(envelope.statement));
+    for (auto const& h : getTxSetHashes(envelope))
+    {
+        unwait(envs.mWaitingForTxSet, h);
+    }
+    it->second.mMissingItems = 0;
+}
+
+void
+PendingEnvelopes::itemKnown(
+    UnorderedMap<Hash, std::vector<SlotEnvelopes::FetchingIter>>
+        SlotEnvelopes::*waiting,
+    Hash const& hash)
+{
+    ZoneScoped;
+    for (auto& slot : mEnvelopes)
+    {
+        auto& slotWaiting = slot.second.*waiting;
+        auto waitIt = slotWaiting.find(hash);
+        if (waitIt == slotWaiting.end())
+        {
+            continue;
+        }
+        for (auto const& it : waitIt->second)
+        {
+            releaseAssert(it->second.mMissingItems > 0);
+            --it->second.mMissingItems;
+        }
+        slotWaiting.erase(waitIt);
+    }
+}
+
 void
 PendingEnvelopes::startFetch(SCPEnvelope const& envelope)
 {
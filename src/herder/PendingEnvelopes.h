@@ -23,14 +23,29 @@ namespace caiz
 
 class HerderImpl;
 
+struct FetchingEnvelope
+{
+    VirtualClock::time_point mStartedAt;
+    // number of distinct txsets and qsets the envelope still waits for
+    size_t mMissingItems{0};
+};
+
 struct SlotEnvelopes
 {
+    using FetchingIter = std::map<SCPEnvelope, FetchingEnvelope>::iterator;
+
     // envelopes we have discarded
     std::set<SCPEnvelope> mDiscardedEnvelopes;
     // envelopes we have processed already
     std::set<SCPEnvelope> mProcessedEnvelopes;
     // envelopes we are fetching right now
-    std::map<SCPEnvelope, VirtualClock::time_point> mFetchingEnvelopes;
+    std::map<SCPEnvelope, FetchingEnvelope> mFetchingEnvelopes;
+
+    // fetching envelopes waiting for a given txset or qset; an entry is
+    // dropped as soon as the item becomes known, decrementing the
+    // mMissingItems of each of its waiters
+    UnorderedMap<Hash, std::vector<FetchingIter>> mWaitingForTxSet;
+    UnorderedMap<Hash, std::vector<FetchingIter>> mWaitingForQSet;
 
     // list of ready envelopes that haven't been sent to SCP yet
     std::vector<SCPEnvelopeWrapperPtr> mReadyEnvelopes;
@@ -91,6 +106,15 @@ class PendingEnvelopes
     void envelopeReady(SCPEnvelope const& envelope);
     void discardSCPEnvelope(SCPEnvelope const& envelope);
     bool isFullyFetched(SCPEnvelope const& envelope);
+    // records the items envelope is missing as its dependencies, called once
+    // when envelope starts being fetched
+    void addMissingItems(SlotEnvelopes& envs, SlotEnvelopes::FetchingIter it);
+    void removeMissingItems(SlotEnvelopes& envs,
+                            SlotEnvelopes::FetchingIter it);
+    // called when the item with the given hash becomes known
+    void itemKnown(UnorderedMap<Hash, std::vector<SlotEnvelopes::FetchingIter>>
+                       SlotEnvelopes::*waiting,
+                   Hash const& hash);
     void startFetch(SCPEnvelope const& envelope);
     void stopFetch(SCPEnvelope const& envelope);
     void touchFetchCache(SCPEnvelope const& envelope);
@@ -11,17 +11,6 @@
 
 namespace caiz
 {
-namespace
-{
-
-int
-feeRate3WayCompare(TransactionFrameBase const& l, TransactionFrameBase const& r)
-{
-    return caiz::feeRate3WayCompare(l.getFeeBid(), l.getNumOperations(),
-                                       r.getFeeBid(), r.getNumOperations());
-}
-
-} // namespace
 
 int
 feeRate3WayCompare(int64_t lFeeBid, uint32_t lNbOps, int64_t rFeeBid,
@@ -75,9 +64,9 @@ SurgePricingPriorityQueue::TxStackComparator::TxStackComparator(bool isGreater,
 
 bool
 SurgePricingPriorityQueue::TxStackComparator::operator()(
-    TxStackPtr const& txStack1, TxStackPtr const& txStack2) const
+    TxStackEntry const& entry1, TxStackEntry const& entry2) const
 {
-    return txStackLessThan(*txStack1, *txStack2) ^ mIsGreater;
+    return entryLessThan(entry1, entry2) ^ mIsGreater;
 }
 
 bool
@@ -103,34 +92,19 @@ SurgePricingPriorityQueue::TxStackComparator::isGreater() const
 }
 
 bool
-SurgePricingPriorityQueue::TxStackComparator::txStackLessThan(
-    TxStack const& txStack1, TxStack const& txStack2) const
+SurgePricingPriorityQueue::TxStackComparator::entryLessThan(
+    TxStackEntry const& entry1, TxStackEntry const& entry2) const
 {
-    if (txStack1.empty())
-    {
-        return !txStack2.empty();
-    }
-    if (txStack2.empty())
-    {
-        return false;
-    }
-    return txLessThan(txStack1.getTopTx(), txStack2.getTopTx(), true);
-}
-
-bool
-SurgePricingPriorityQueue::TxStackComparator::txLessThan(
-    TransactionFrameBaseConstPtr const& tx1,
-    TransactionFrameBaseConstPtr const& tx2, bool breakTiesWithHash) const
-{
-    auto cmp3 = feeRate3WayCompare(*tx1, *tx2);
+    auto cmp3 = feeRate3WayCompare(entry1.mFeeBid, entry1.mNumOps,
+                                   entry2.mFeeBid, entry2.mNumOps);
 
-    if (cmp3 != 0 || !breakTiesWithHash)
+    if (cmp3 != 0)
     {
         return cmp3 < 0;
     }
     // break tie with pointer arithmetic
-    auto lx = reinterpret_cast<size_t>(tx1.get()) ^ mSeed;
-    auto rx = reinterpret_cast<size_t>(tx2.get()) ^ mSeed;
+    auto lx = entry1.mTxAddress ^ mSeed;
+    auto rx = entry2.mTxAddress ^ mSeed;
     return lx < rx;
 }
 
@@ -140,7 +114,10 @@ SurgePricingPriorityQueue::SurgePricingPriorityQueue(
     : mComparator(isHighestPriority, comparisonSeed)
     , mLaneConfig(settings)
     , mLaneLimits(mLaneConfig->getLaneLimits())
-    , mTxStackSets(mLaneLimits.size(), TxStackSet(mComparator))
+    , mArena(ARENA_CHUNK_SIZE)
+    , mTxStackSets(mLaneLimits.size(),
+                   TxStackSet(mComparator,
+                              ArenaAllocator<TxStackEntry>(&mArena)))
 {
     releaseAssert(!mLaneLimits.empty());
     mLaneCurrentCount = std::vector<Resource>(
@@ -187,15 +164,27 @@ SurgePricingPriorityQueue::visitTopTxs(
               hadTxNotFittingLane);
 }
 
+SurgePricingPriorityQueue::TxStackEntry
+SurgePricingPriorityQueue::makeEntry(TxStackPtr txStack) const
+{
+    auto tx = txStack->getTopTx();
+    auto feeBid = tx->getFeeBid();
+    auto numOps = tx->getNumOperations();
+    auto txAddress = reinterpret_cast<size_t>(tx.get());
+    auto resources = txStack->getResources();
+    return TxStackEntry{std::move(txStack), feeBid, numOps, txAddress,
+                        std::move(resources)};
+}
+
 void
 SurgePricingPriorityQueue::add(TxStackPtr txStack)
 {
     releaseAssert(txStack != nullptr);
     auto lane = mLaneConfig->getLane(*txStack->getTopTx());
-    bool inserted = mTxStackSets[lane].insert(txStack).second;
+    auto [it, inserted] = mTxStackSets[lane].insert(makeEntry(txStack));
     if (inserted)
     {
-        mLaneCurrentCount[lane] += txStack->getResources();
+        mLaneCurrentCount[lane] += it->mResources;
     }
 }
 
@@ -204,7 +193,7 @@ SurgePricingPriorityQueue::erase(TxStackPtr txStack)
 {
     releaseAssert(txStack != nullptr);
     auto lane = mLaneConfig->getLane(*txStack->getTopTx());
-    auto it = mTxStackSets[lane].find(txStack);
+    auto it = mTxStackSets[lane].find(makeEntry(txStack));
     if (it != mTxStackSets[lane].end())
     {
         erase(lane, it);
@@ -222,7 +211,7 @@ void
 SurgePricingPriorityQueue::erase(
     size_t lane, SurgePricingPriorityQueue::TxStackSet::iterator iter)
 {
-    auto res = (*iter)->getResources();
+    auto const& res = iter->mResources;
     releaseAssert(res <= mLaneCurrentCount[lane]);
     mLaneCurrentCount[lane] -= res;
     mTxStackSets[lane].erase(iter);
@@ -558,7 +547,7 @@ SurgePricingPriorityQueue::Iterator::getMutableInnerIter() const
 TxStackPtr
 SurgePricingPriorityQueue::Iterator::operator*() const
 {
-    return *getMutableInnerIter()->second;
+    return getMutableInnerIter()->second->mTxStack;
 }
 
 SurgePricingPriorityQueue::LaneIter
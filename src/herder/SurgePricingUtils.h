@@ -7,6 +7,7 @@
 #include <set>
 
 #include "transactions/TransactionFrameBase.h"
+#include "util/Arena.h"
 
 namespace caiz
 {
@@ -216,13 +217,28 @@ class SurgePricingPriorityQueue
         std::vector<std::pair<TxStackPtr, bool>>& txStacksToEvict) const;
 
   private:
+    // A stack in the queue, along with the ordering key and resources of the
+    // stack as of when it was added. Comparisons only look at the key, so they
+    // don't go through the virtual methods of the stack and its top
+    // transaction, and erasing the stack gives back exactly the resources that
+    // adding it counted.
+    struct TxStackEntry
+    {
+        TxStackPtr mTxStack;
+        int64_t mFeeBid;
+        uint32_t mNumOps;
+        // Address of the top transaction, used to break ties
+        size_t mTxAddress;
+        Resource mResources;
+    };
+
     class TxStackComparator
     {
       public:
         TxStackComparator(bool isGreater, size_t seed);
 
-        bool operator()(TxStackPtr const& txStack1,
-                        TxStackPtr const& txStack2) const;
+        bool operator()(TxStackEntry const& entry1,
+                        TxStackEntry const& entry2) const;
 
         bool compareFeeOnly(TransactionFrameBase const& tx1,
                             TransactionFrameBase const& tx2) const;
@@ -231,18 +247,18 @@ class SurgePricingPriorityQueue
         bool isGreater() const;
 
       private:
-        bool txStackLessThan(TxStack const& txStack1,
-                             TxStack const& txStack2) const;
-
-        bool txLessThan(TransactionFrameBaseConstPtr const& tx1,
-                        TransactionFrameBaseConstPtr const& tx2,
-                        bool breakTiesWithHash) const;
+        bool entryLessThan(TxStackEntry const& entry1,
+                           TxStackEntry const& entry2) const;
 
         bool const mIsGreater;
         size_t mSeed;
     };
 
-    using TxStackSet = std::set<TxStackPtr, TxStackComparator>;
+    // Chunk size of the arena the set nodes are allocated from
+    static constexpr size_t ARENA_CHUNK_SIZE = 64 * 1024;
+
+    using TxStackSet = std::set<TxStackEntry, TxStackComparator,
+                                ArenaAllocator<TxStackEntry>>;
     using LaneIter = std::pair<size_t, TxStackSet::iterator>;
 
     // Iterator for walking the queue from top to bottom, possibly restricted
@@ -288,12 +304,18 @@ class SurgePricingPriorityQueue
 
     Iterator getTop() const;
 
+    TxStackEntry makeEntry(TxStackPtr txStack) const;
+
     TxStackComparator const mComparator;
     std::shared_ptr<SurgePricingLaneConfig> mLaneConfig;
     std::vector<Resource> const& mLaneLimits;
 
     std::vector<Resource> mLaneCurrentCount;
 
+    // Stacks come and go as transactions are added, evicted and popped, so
+    // the set nodes are recycled through an arena rather than the heap.
+    // Declared before the sets, which must release their nodes first.
+    Arena mArena;
     std::vector<TxStackSet> mTxStackSets;
 };
 
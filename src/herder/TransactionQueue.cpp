@@ -52,6 +52,7 @@ TransactionQueue::TransactionQueue(Application& app, uint32 pendingDepth,
                                    bool isSoroban)
     : mApp(app)
     , mPendingDepth(pendingDepth)
+    , mIsSoroban(isSoroban)
     , mBannedTransactions(banDepth)
     , mLedgerVersion(app.getLedgerManager()
                          .getLastClosedLedgerHeader()
@@ -574,6 +575,7 @@ TransactionQueue::tryAdd(TransactionFrameBasePtr tx, bool submittedFromSelf)
         oldTxIter = stateIter->second.mTransactions.end();
     }
 
+    removeAccountHead(stateIter->second);
     if (oldTxIter != stateIter->second.mTransactions.end())
     {
         prepareDropTransaction(stateIter->second, *oldTxIter);
@@ -586,6 +588,7 @@ TransactionQueue::tryAdd(TransactionFrameBasePtr tx, bool submittedFromSelf)
         oldTxIter = --stateIter->second.mTransactions.end();
         mSizeByAge[stateIter->second.mAge]->inc();
     }
+    addAccountHead(stateIter->second);
 
     // Maybe replaced-by-fee, make sure we maintain the invariant
     if (mApp.getConfig().LIMIT_TX_QUEUE_SOURCE_ACCOUNT &&
@@ -625,6 +628,7 @@ TransactionQueue::dropTransactions(AccountStates::iterator stateIter,
     // Note prepareDropTransaction may erase other iterators from
     // mAccountStates, but it will not erase stateIter because it has at least
     // one transaction (otherwise we couldn't reach that line).
+    removeAccountHead(stateIter->second);
     for (auto iter = begin; iter != end; ++iter)
     {
         prepareDropTransaction(stateIter->second, *iter);
@@ -632,6 +636,7 @@ TransactionQueue::dropTransactions(AccountStates::iterator stateIter,
 
     // Actually erase the transactions to be dropped.
     stateIter->second.mTransactions.erase(begin, end);
+    addAccountHead(stateIter->second);
 
     // If the queue for stateIter is now empty, then (1) erase it if it is not
     // the fee-source for some other transaction or (2) reset the age otherwise.
@@ -875,6 +880,7 @@ TransactionQueue::shift()
 
         if (mPendingDepth == it->second.mAge)
         {
+            removeAccountHead(it->second);
             for (auto& toBan : it->second.mTransactions)
             {
                 // This never invalidates it because
@@ -961,6 +967,211 @@ TransactionQueue::getTransactions(LedgerHeader const& lcl) const
     return txs;
 }
 
+TxSetFrame::Transactions
+TransactionQueue::getCandidateTransactions(LedgerHeader const& lcl) const
+{
+    ZoneScoped;
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    auto phase =
+        mIsSoroban ? TxSetFrame::Phase::SOROBAN : TxSetFrame::Phase::CLASSIC;
+#else
+    releaseAssert(!mIsSoroban);
+    auto phase = TxSetFrame::Phase::CLASSIC;
+#endif
+    auto laneConfig = TxSetFrame::makeSurgePricingLaneConfig(
+        phase, mApp,
+        protocolVersionStartsFrom(lcl.ledgerVersion,
+                                  GENERALIZED_TX_SET_PROTOCOL_VERSION));
+    size_t const genericLane = SurgePricingPriorityQueue::GENERIC_LANE;
+    auto laneLeft = laneConfig->getLaneLimits();
+    std::vector<bool> hadTxNotFittingLane(laneLeft.size(), false);
+    auto opsLeft = [&](size_t lane) {
+        return laneLeft[lane].getVal(Resource::Type::OPERATIONS);
+    };
+
+    int64_t const startingSeq = getStartingSequenceNumber(lcl.ledgerSeq + 1);
+
+    // The transactions that follow a picked transaction of the same account
+    // become available one at a time, as a heap with the highest fee rate on
+    // top. mIndex is the position of mTx in the transactions of its account.
+    struct NextTx
+    {
+        TransactionFrameBasePtr mTx;
+        size_t mIndex;
+    };
+    HigherFeeRate higherFeeRate;
+    auto lowerNextTx = [&](NextTx const& lhs, NextTx const& rhs) {
+        return higherFeeRate(rhs.mTx, lhs.mTx);
+    };
+    std::vector<NextTx> nextTxs;
+    std::array<AccountHeads::const_iterator, 2> heads = {
+        mAccountHeads[0].begin(), mAccountHeads[1].begin()};
+
+    // When DEX operations are limited, the DEX heads are exactly the heads in
+    // the limited lane, which can be skipped once that lane is full and some
+    // transaction did not fit it
+    auto headsDone = [&](size_t i) {
+        return heads[i] == mAccountHeads[i].end() ||
+               (i != genericLane && i < laneLeft.size() &&
+                hadTxNotFittingLane[i] && opsLeft(i) == 0);
+    };
+
+    TxSetFrame::Transactions txs;
+    while (true)
+    {
+        // Pick the transaction with the highest fee rate among the heads and
+        // the next transactions of the accounts picked so far, exactly like
+        // surge pricing does with the stacks of transactions of each account
+        NextTx next{nullptr, 0};
+        std::optional<size_t> headsIndex;
+        for (size_t i = 0; i < heads.size(); ++i)
+        {
+            if (!headsDone(i) &&
+                (!next.mTx || higherFeeRate(*heads[i], next.mTx)))
+            {
+                next.mTx = *heads[i];
+                headsIndex = i;
+            }
+        }
+        if (!nextTxs.empty() &&
+            (!next.mTx || higherFeeRate(nextTxs.front().mTx, next.mTx)))
+        {
+            next = nextTxs.front();
+            headsIndex.reset();
+        }
+        if (!next.mTx)
+        {
+            break;
+        }
+        if (headsIndex)
+        {
+            ++heads[*headsIndex];
+        }
+        else
+        {
+            std::pop_heap(nextTxs.begin(), nextTxs.end(), lowerNextTx);
+            nextTxs.pop_back();
+        }
+
+        // getTransactions stops at this sequence number for every account
+        auto const& tx = next.mTx;
+        if (tx->getSeqNum() == startingSeq)
+        {
+            continue;
+        }
+
+        auto res = laneConfig->getTxResources(*tx);
+        auto lane = laneConfig->getLane(*tx);
+        bool fitsLane = !anyGreater(res, laneLeft[lane]);
+        if (!fitsLane || anyGreater(res, laneLeft[genericLane]))
+        {
+            // Surge pricing drops the rest of the transactions of this
+            // account. Only the first transaction that does not fit matters
+            // for the base fees.
+            auto notFittingLane = fitsLane ? genericLane : lane;
+            if (!hadTxNotFittingLane[notFittingLane])
+            {
+                hadTxNotFittingLane[notFittingLane] = true;
+                txs.emplace_back(tx);
+            }
+            if (hadTxNotFittingLane[genericLane] && opsLeft(genericLane) == 0)
+            {
+                break;
+            }
+            continue;
+        }
+
+        laneLeft[genericLane] -= res;
+        if (lane != genericLane)
+        {
+            laneLeft[lane] -= res;
+        }
+        txs.emplace_back(tx);
+
+        auto const& accountTxs =
+            mAccountStates.at(tx->getSourceID()).mTransactions;
+        if (next.mIndex + 1 < accountTxs.size())
+        {
+            nextTxs.push_back(
+                {accountTxs[next.mIndex + 1].mTx, next.mIndex + 1});
+            std::push_heap(nextTxs.begin(), nextTxs.end(), lowerNextTx);
+        }
+    }
+
+    // Once the generic lane is full, surge pricing finds every transaction
+    // left to not fit, and whether one of them does not fit a limited lane
+    // (rather than the generic one) changes the base fee of that lane
+    for (size_t lane = genericLane + 1;
+         lane < laneLeft.size() && lane < heads.size(); ++lane)
+    {
+        if (hadTxNotFittingLane[lane])
+        {
+            continue;
+        }
+        auto notFitting = [&](TransactionFrameBasePtr const& tx) {
+            return tx->getSeqNum() != startingSeq &&
+                   laneConfig->getLane(*tx) == lane &&
+                   anyGreater(laneConfig->getTxResources(*tx), laneLeft[lane]);
+        };
+        auto nextIt = std::find_if(
+            nextTxs.begin(), nextTxs.end(),
+            [&](NextTx const& next) { return notFitting(next.mTx); });
+        if (nextIt != nextTxs.end())
+        {
+            txs.emplace_back(nextIt->mTx);
+            continue;
+        }
+        auto headIt =
+            std::find_if(heads[lane], mAccountHeads[lane].end(), notFitting);
+        if (headIt != mAccountHeads[lane].end())
+        {
+            txs.emplace_back(*headIt);
+        }
+    }
+
+    return txs;
+}
+
+bool
+TransactionQueue::HigherFeeRate::operator()(
+    TransactionFrameBasePtr const& tx1,
+    TransactionFrameBasePtr const& tx2) const
+{
+    auto cmp3 = feeRate3WayCompare(tx1->getFeeBid(), tx1->getNumOperations(),
+                                   tx2->getFeeBid(), tx2->getNumOperations());
+    if (cmp3 != 0)
+    {
+        return cmp3 > 0;
+    }
+    return tx1->getFullHash() < tx2->getFullHash();
+}
+
+static size_t
+accountHeadsIndex(TransactionFrameBase const& tx)
+{
+    return tx.hasDexOperations() ? 1 : 0;
+}
+
+void
+TransactionQueue::removeAccountHead(AccountState const& state)
+{
+    if (!state.mTransactions.empty())
+    {
+        auto const& tx = state.mTransactions.front().mTx;
+        mAccountHeads[accountHeadsIndex(*tx)].erase(tx);
+    }
+}
+
+void
+TransactionQueue::addAccountHead(AccountState const& state)
+{
+    if (!state.mTransactions.empty())
+    {
+        auto const& tx = state.mTransactions.front().mTx;
+        mAccountHeads[accountHeadsIndex(*tx)].emplace(tx);
+    }
+}
+
 TransactionFrameBaseConstPtr
 TransactionQueue::getTx(Hash const& hash) const
 {
@@ -980,6 +1191,10 @@ void
 TransactionQueue::clearAll()
 {
     mAccountStates.clear();
+    for (auto& heads : mAccountHeads)
+    {
+        heads.clear();
+    }
     for (auto& b : mBannedTransactions)
     {
         b.clear();
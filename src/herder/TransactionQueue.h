@@ -16,9 +16,11 @@
 
 #include "util/UnorderedMap.h"
 #include "util/UnorderedSet.h"
+#include <array>
 #include <chrono>
 #include <deque>
 #include <memory>
+#include <set>
 #include <vector>
 
 namespace medida
@@ -56,6 +58,11 @@ class Application;
  *   pendingDepth, all transactions for that source account are banned. It also
  *   unbans any transactions that have been banned for more than banDepth
  *   ledgers.
+ *
+ * The first transaction of every sequence-number-source is also kept in
+ * mAccountHeads, ordered by fee rate, so that the candidate for the next
+ * transaction set can be picked without going through the whole queue (see
+ * getCandidateTransactions).
  */
 class TransactionQueue
 {
@@ -147,6 +154,19 @@ class TransactionQueue
 
     TxSetFrame::Transactions getTransactions(LedgerHeader const& lcl) const;
 
+    // Returns the candidate for the next transaction set: the transactions
+    // that surge pricing would pick out of getTransactions(lcl), along with
+    // the best transaction that each lane had no room for, so that surge
+    // pricing the candidate picks the same transactions and charges the same
+    // base fees (up to ties between equal fee rates). Transactions are assumed
+    // to be valid. This walks mAccountHeads from the highest fee rate down
+    // until the generic lane has no operations left, so it usually costs
+    // O(k log n) for a candidate of k transactions. It may still have to go
+    // through the remaining DEX transactions to find out whether one of them
+    // does not fit the DEX lane.
+    TxSetFrame::Transactions
+    getCandidateTransactions(LedgerHeader const& lcl) const;
+
     struct ReplacedTransaction
     {
         TransactionFrameBasePtr mOld;
@@ -178,6 +198,7 @@ class TransactionQueue
 
     Application& mApp;
     uint32 const mPendingDepth;
+    bool const mIsSoroban;
 
     AccountStates mAccountStates;
     BannedTransactions mBannedTransactions;
@@ -233,6 +254,25 @@ class TransactionQueue
 
     UnorderedMap<Hash, TransactionFrameBasePtr> mKnownTxHashes;
 
+    // Orders transactions from the highest to the lowest fee rate, breaking
+    // ties by hash.
+    struct HigherFeeRate
+    {
+        bool operator()(TransactionFrameBasePtr const& tx1,
+                        TransactionFrameBasePtr const& tx2) const;
+    };
+    using AccountHeads = std::set<TransactionFrameBasePtr, HigherFeeRate>;
+
+    // The first transaction of every account in mAccountStates that has any,
+    // split into those without and with DEX operations. DEX transactions are
+    // the only ones that can be in a limited surge pricing lane.
+    std::array<AccountHeads, 2> mAccountHeads;
+
+    // Must be called before and after changing the transactions of an
+    // account, respectively.
+    void removeAccountHead(AccountState const& state);
+    void addAccountHead(AccountState const& state);
+
     size_t mBroadcastSeed;
 
     friend class TxQueueTracker;
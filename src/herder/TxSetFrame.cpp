@@ -1146,6 +1146,39 @@ TxSetFrame::addTxsFromXdr(Application& app,
                           &TxSetUtils::hashTxSorter);
 }
 
+std::shared_ptr<SurgePricingLaneConfig>
+TxSetFrame::makeSurgePricingLaneConfig(Phase phase, Application& app,
+                                       bool isGeneralized)
+{
+    if (phase == Phase::CLASSIC)
+    {
+        uint32_t maxOps = static_cast<uint32_t>(
+            app.getLedgerManager().getLastMaxTxSetSizeOps());
+        std::optional<uint32_t> dexOpsLimit;
+        if (isGeneralized)
+        {
+            // DEX operations limit implies that DEX transactions should
+            // compete with each other in in a separate fee lane, which is
+            // only possible with generalized tx set.
+            dexOpsLimit = app.getConfig().MAX_DEX_TX_OPERATIONS_IN_TX_SET;
+        }
+        return std::make_shared<DexLimitingLaneConfig>(maxOps, dexOpsLimit);
+    }
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    releaseAssert(phase == Phase::SOROBAN);
+    LedgerTxn ltx(app.getLedgerTxnRoot(), false,
+                  TransactionMode::READ_ONLY_WITHOUT_SQL_TXN);
+    auto limits = app.getLedgerManager().maxLedgerResources(
+        /* isSoroban */ true, ltx);
+    return std::make_shared<SorobanGenericLaneConfig>(limits);
+#else
+    // Prior to protocol 20, there must be a single classic phase, so we
+    // shouldn't ever get here
+    releaseAssert(false);
+    return nullptr;
+#endif
+}
+
 void
 TxSetFrame::applySurgePricing(Application& app)
 {
@@ -1171,22 +1204,10 @@ TxSetFrame::applySurgePricing(Application& app)
         auto& phase = mTxPhases[i];
         auto actTxQueues = TxSetUtils::buildAccountTxQueues(phase);
 
+        auto surgePricingLaneConfig =
+            makeSurgePricingLaneConfig(phaseType, app, isGeneralizedTxSet());
         if (phaseType == TxSetFrame::Phase::CLASSIC)
         {
-            uint32_t maxOps = static_cast<uint32_t>(
-                app.getLedgerManager().getLastMaxTxSetSizeOps());
-            std::optional<uint32_t> dexOpsLimit;
-            if (isGeneralizedTxSet())
-            {
-                // DEX operations limit implies that DEX transactions should
-                // compete with each other in in a separate fee lane, which is
-                // only possible with generalized tx set.
-                dexOpsLimit = app.getConfig().MAX_DEX_TX_OPERATIONS_IN_TX_SET;
-            }
-
-            auto surgePricingLaneConfig =
-                std::make_shared<DexLimitingLaneConfig>(maxOps, dexOpsLimit);
-
             std::vector<bool> hadTxNotFittingLane;
             auto includedTxs =
                 SurgePricingPriorityQueue::getMostTopTxsWithinLimits(
@@ -1224,15 +1245,6 @@ TxSetFrame::applySurgePricing(Application& app)
             releaseAssert(isGeneralizedTxSet());
             releaseAssert(phaseType == TxSetFrame::Phase::SOROBAN);
 
-            LedgerTxn ltx(app.getLedgerTxnRoot(), false,
-                          TransactionMode::READ_ONLY_WITHOUT_SQL_TXN);
-
-            auto limits = app.getLedgerManager().maxLedgerResources(
-                /* isSoroban */ true, ltx);
-
-            auto surgePricingLaneConfig =
-                std::make_shared<SorobanGenericLaneConfig>(limits);
-
             std::vector<bool> hadTxNotFittingLane;
             auto includedTxs =
                 SurgePricingPriorityQueue::getMostTopTxsWithinLimits(
@@ -58,6 +58,13 @@ class TxSetFrame : public NonMovableOrCopyable
                          uint64_t upperBoundCloseTimeOffset,
                          TxPhases& invalidTxsPerPhase);
 
+    // Returns the lane configuration that surge pricing uses to pick the
+    // transactions of `phase` for a tx set built on top of the last closed
+    // ledger.
+    static std::shared_ptr<SurgePricingLaneConfig>
+    makeSurgePricingLaneConfig(Phase phase, Application& app,
+                               bool isGeneralized);
+
     // Creates a legacy (non-generalized) TxSetFrame from the transactions that
     // are trusted to be valid. Validation and filtering are not performed.
     // This should be *only* used for building the legacy TxSetFrames from
@@ -151,6 +151,25 @@ TEST_CASE("PendingEnvelopes recvSCPEnvelope", "[herder]")
                     Herder::ENVELOPE_STATUS_PROCESSED);
         }
 
+        SECTION("quorum set expiring before the tx set comes is fetched again")
+        {
+            REQUIRE(pendingEnvelopes.recvSCPQuorumSet(saneQSetHash, saneQSet));
+            pendingEnvelopes.clearQSetCache();
+
+            // Every item has been received once, but the quorum set is gone
+            REQUIRE(pendingEnvelopes.recvTxSet(p.second->getContentsHash(),
+                                               p.second));
+            REQUIRE(herder.getSCP().getLatestMessage(pk) == nullptr);
+            REQUIRE(pendingEnvelopes.recvSCPEnvelope(saneEnvelope) ==
+                    Herder::ENVELOPE_STATUS_FETCHING);
+
+            // -> processes saneEnvelope
+            REQUIRE(pendingEnvelopes.recvSCPQuorumSet(saneQSetHash, saneQSet));
+            auto m = herder.getSCP().getLatestMessage(pk);
+            REQUIRE(m);
+            REQUIRE(*m == saneEnvelope);
+        }
+
         SECTION("process when all data came (tx set first)")
         {
             REQUIRE(pendingEnvelopes.recvTxSet(p.second->getContentsHash(),
@@ -231,6 +250,29 @@ TEST_CASE("PendingEnvelopes recvSCPEnvelope", "[herder]")
         }
     }
 
+    SECTION("discarded envelope stops waiting for shared txset")
+    {
+        REQUIRE(pendingEnvelopes.recvSCPEnvelope(bigEnvelope) ==
+                Herder::ENVELOPE_STATUS_FETCHING);
+        REQUIRE(pendingEnvelopes.recvSCPEnvelope(saneEnvelope) ==
+                Herder::ENVELOPE_STATUS_FETCHING);
+
+        REQUIRE(!pendingEnvelopes.recvSCPQuorumSet(bigQSetHash, bigQSet));
+        REQUIRE(pendingEnvelopes.recvSCPQuorumSet(saneQSetHash, saneQSet));
+        REQUIRE(herder.getSCP().getLatestMessage(pk) == nullptr);
+
+        // -> processes saneEnvelope only
+        REQUIRE(
+            pendingEnvelopes.recvTxSet(p.second->getContentsHash(), p.second));
+        auto m = herder.getSCP().getLatestMessage(pk);
+        REQUIRE(m);
+        REQUIRE(*m == saneEnvelope);
+        REQUIRE(pendingEnvelopes.recvSCPEnvelope(saneEnvelope) ==
+                Herder::ENVELOPE_STATUS_PROCESSED);
+        REQUIRE(pendingEnvelopes.recvSCPEnvelope(bigEnvelope) ==
+                Herder::ENVELOPE_STATUS_DISCARDED);
+    }
+
     SECTION("different slots asking for same qset txset")
     {
         auto saneEnvelope2 = makeEnvelope(
@@ -2,6 +2,7 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "crypto/SHA.h"
 #include "crypto/SecretKey.h"
 #include "herder/Herder.h"
 #include "herder/HerderImpl.h"
@@ -17,6 +18,7 @@
 #include "test/test.h"
 #include "transactions/SignatureUtils.h"
 #include "transactions/TransactionUtils.h"
+#include "util/ProtocolVersion.h"
 #include "util/Timer.h"
 #include "util/numeric128.h"
 #include "xdr/Caiz-transaction.h"
@@ -2185,6 +2187,108 @@ TEST_CASE("TransactionQueue limiter with DEX separation",
     }
 }
 
+TEST_CASE("TransactionQueue tx set candidate", "[herder][transactionqueue]")
+{
+    auto test = [](uint32_t protocolVersion) {
+        VirtualClock clock;
+        auto cfg = getTestConfig();
+        cfg.LEDGER_PROTOCOL_VERSION = protocolVersion;
+        cfg.TESTING_UPGRADE_LEDGER_PROTOCOL_VERSION = protocolVersion;
+        cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE = 20;
+        cfg.MAX_DEX_TX_OPERATIONS_IN_TX_SET = 6;
+        auto app = createTestApplication(clock, cfg);
+        auto const& lcl = app->getLedgerManager().getLastClosedLedgerHeader();
+        auto root = TestAccount::createRoot(*app);
+
+        Asset native(ASSET_TYPE_NATIVE);
+        Asset usd(ASSET_TYPE_CREDIT_ALPHANUM4);
+        strToAssetCode(usd.alphaNum4().assetCode, "USD");
+        auto makeTx = [&](TestAccount& account, int64_t seqDelta, bool isDex,
+                          uint32_t nbOps, uint32_t opFee) {
+            std::vector<Operation> ops;
+            for (uint32_t i = 0; i < nbOps; ++i)
+            {
+                ops.emplace_back(
+                    isDex ? manageBuyOffer(0, native, usd, Price{2, 5}, 10)
+                          : payment(account.getPublicKey(), 1));
+            }
+            return transactionFromOperations(
+                *app, account, account.getLastSequenceNumber() + seqDelta, ops,
+                nbOps * opFee);
+        };
+
+        // Every transaction has its own fee rate, so that surge pricing does
+        // not have to break ties
+        ClassicTransactionQueue tq(*app, 4, 10, 4);
+        std::vector<TransactionFrameBasePtr> queued;
+        auto const balance =
+            app->getLedgerManager().getLastMinBalance(0) + 10000000;
+        for (uint32_t i = 0; i < 20; ++i)
+        {
+            auto account = root.create(fmt::format("A{}", i), balance);
+            for (int64_t seqDelta = 1; seqDelta <= 2; ++seqDelta)
+            {
+                uint32_t j = 2 * i + static_cast<uint32_t>(seqDelta) - 1;
+                auto tx = makeTx(account, seqDelta, j % 4 == 0, 1 + j % 2,
+                                 100 + (j * 37) % 41);
+                REQUIRE(tq.tryAdd(tx, false) ==
+                        TransactionQueue::AddResult::ADD_STATUS_PENDING);
+                queued.emplace_back(tx);
+            }
+        }
+
+        auto baseFees = [&](TxSetFrame::Transactions const& txs) {
+            auto txSet = TxSetFrame::makeFromTransactions(txs, *app, 0, 0);
+            std::map<Hash, std::optional<int64_t>> res;
+            for (auto const& tx :
+                 txSet->getTxsForPhase(TxSetFrame::Phase::CLASSIC))
+            {
+                res.emplace(tx->getFullHash(),
+                            txSet->getTxBaseFee(tx, lcl.header));
+            }
+            return res;
+        };
+        auto checkCandidate = [&]() {
+            auto txs = tq.getTransactions(lcl.header);
+            auto candidate = tq.getCandidateTransactions(lcl.header);
+            REQUIRE(candidate.size() < txs.size());
+            REQUIRE(baseFees(candidate) == baseFees(txs));
+        };
+
+        checkCandidate();
+        SECTION("ban")
+        {
+            for (size_t i = 0; i < queued.size(); i += 5)
+            {
+                tq.ban({queued[i]});
+                checkCandidate();
+            }
+        }
+        SECTION("replace by fee")
+        {
+            for (size_t i = 0; i < queued.size(); i += 7)
+            {
+                auto fb = feeBump(*app, root, queued[i],
+                                  6000 + 10 * static_cast<int64_t>(i));
+                REQUIRE(tq.tryAdd(fb, false) ==
+                        TransactionQueue::AddResult::ADD_STATUS_PENDING);
+                checkCandidate();
+            }
+        }
+    };
+
+    SECTION("legacy tx set")
+    {
+        test(static_cast<uint32_t>(GENERALIZED_TX_SET_PROTOCOL_VERSION) - 1);
+    }
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    SECTION("generalized tx set")
+    {
+        test(static_cast<uint32_t>(GENERALIZED_TX_SET_PROTOCOL_VERSION));
+    }
+#endif
+}
+
 TEST_CASE("transaction queue starting sequence boundary",
           "[herder][transactionqueue]")
 {
@@ -3037,3 +3141,113 @@ TEST_CASE("arbitrage tx identification benchmark",
     LOG_INFO(DEFAULT_LOG, "executed 100 loop-checks of 600-op tx loop in {}",
              ch::duration_cast<ch::milliseconds>(end - start));
 }
+
+TEST_CASE("TxQueueLimiter benchmark",
+          "[herder][transactionqueue][bench][!hide]")
+{
+    // Fills a limiter to the capacity of the classic transaction queue with
+    // unsigned transactions from distinct accounts (a quarter of them in the
+    // DEX lane), then measures adding transactions with increasing fees
+    // (each of which evicts cheaper ones), and building a nomination tx set
+    // out of the full queue.
+    VirtualClock clock;
+    auto cfg = getTestConfig();
+    cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE = 5000;
+    cfg.MAX_DEX_TX_OPERATIONS_IN_TX_SET = 1000;
+    auto app = createTestApplication(clock, cfg);
+
+    TxQueueLimiter limiter(2, *app, false);
+    auto const maxQueueOps = app->getHerder().getMaxQueueSizeOps();
+
+    Asset xlm = txtest::makeNativeAsset();
+    Asset usd = txtest::makeAsset(txtest::getAccount("issuer"), "USD");
+    uint32_t nextAccount = 0;
+    auto makeTx = [&](uint32_t fee) {
+        TransactionEnvelope env(ENVELOPE_TYPE_TX);
+        PublicKey source;
+        source.ed25519() = sha256(std::to_string(nextAccount));
+        env.v1().tx.sourceAccount = toMuxedAccount(source);
+        env.v1().tx.seqNum = 1;
+        auto nbOps = 1 + nextAccount % 4;
+        for (uint32_t i = 0; i < nbOps; ++i)
+        {
+            env.v1().tx.operations.emplace_back(
+                nextAccount % 4 == 0
+                    ? txtest::manageOffer(0, xlm, usd, Price{1, 1}, 100)
+                    : txtest::payment(source, 100));
+        }
+        env.v1().tx.fee = fee * nbOps;
+        ++nextAccount;
+        return std::static_pointer_cast<TransactionFrameBase>(
+            std::make_shared<TransactionFrame>(Hash(), env));
+    };
+
+    namespace ch = std::chrono;
+    using clock = ch::high_resolution_clock;
+    UnorderedSet<TransactionFrameBasePtr> queued;
+    std::vector<std::pair<TxStackPtr, bool>> txsToEvict;
+    auto tryAdd = [&](TransactionFrameBasePtr const& tx) {
+        txsToEvict.clear();
+        if (!limiter.canAddTx(tx, nullptr, txsToEvict).first)
+        {
+            return false;
+        }
+        limiter.evictTransactions(
+            txsToEvict, *tx, [&](TransactionFrameBasePtr const& evicted) {
+                limiter.removeTransaction(evicted);
+                queued.erase(evicted);
+            });
+        limiter.addTransaction(tx);
+        queued.emplace(tx);
+        return true;
+    };
+
+    auto start = clock::now();
+    size_t queuedOps = 0;
+    while (queuedOps < maxQueueOps)
+    {
+        auto tx = makeTx(100 + nextAccount % 1000);
+        if (!tryAdd(tx))
+        {
+            break;
+        }
+        queuedOps += tx->getNumOperations();
+    }
+    auto filled = clock::now();
+    LOG_INFO(DEFAULT_LOG, "added {} txs ({} of {} ops) without eviction in {}",
+             queued.size(), queuedOps, maxQueueOps,
+             ch::duration_cast<ch::milliseconds>(filled - start));
+
+    size_t const numEvicting = 20000;
+    size_t added = 0;
+    for (size_t i = 0; i < numEvicting; ++i)
+    {
+        if (tryAdd(makeTx(static_cast<uint32_t>(1100 + i))))
+        {
+            ++added;
+        }
+    }
+    auto evicted = clock::now();
+    LOG_INFO(DEFAULT_LOG, "added {} of {} txs with eviction in {}", added,
+             numEvicting,
+             ch::duration_cast<ch::milliseconds>(evicted - filled));
+
+    std::vector<TxStackPtr> stacks;
+    stacks.reserve(queued.size());
+    for (auto const& tx : queued)
+    {
+        stacks.emplace_back(std::make_shared<SingleTxStack>(tx));
+    }
+    auto laneConfig = std::make_shared<DexLimitingLaneConfig>(
+        Resource(cfg.TESTING_UPGRADE_MAX_TX_SET_SIZE),
+        std::make_optional<Resource>(*cfg.MAX_DEX_TX_OPERATIONS_IN_TX_SET));
+    std::vector<bool> hadTxNotFittingLane;
+    auto nominationStart = clock::now();
+    auto selected = SurgePricingPriorityQueue::getMostTopTxsWithinLimits(
+        stacks, laneConfig, hadTxNotFittingLane);
+    auto nominationEnd = clock::now();
+    LOG_INFO(DEFAULT_LOG, "selected {} of {} txs for nomination in {}",
+             selected.size(), stacks.size(),
+             ch::duration_cast<ch::microseconds>(nominationEnd -
+                                                 nominationStart));
+}
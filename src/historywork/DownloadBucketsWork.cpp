@@ -3,8 +3,10 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "historywork/DownloadBucketsWork.h"
+#include "bucket/Bucket.h"
 #include "bucket/BucketManager.h"
 #include "catchup/CatchupManager.h"
+#include "catchup/CatchupProgress.h"
 #include "history/FileTransferInfo.h"
 #include "history/HistoryArchive.h"
 #include "historywork/GetAndUnzipRemoteFileWork.h"
@@ -71,11 +73,48 @@ DownloadBucketsWork::yieldMoreWork()
     }
 
     auto hash = *mNextBucketIter;
+    std::weak_ptr<DownloadBucketsWork> weak(
+        std::static_pointer_cast<DownloadBucketsWork>(shared_from_this()));
+    bool resumable = CatchupProgress::tracksBuckets(mApp, mDownloadDir);
+
+    if (resumable)
+    {
+        // A bucket verified by an earlier run only has its hash verified again
+        if (auto b = CatchupProgress::getRecordedBucket(mApp, hash))
+        {
+            OnFailureCallback failureCb = [weak, hash]() {
+                CLOG_WARNING(History,
+                             "Bucket {} kept by an earlier catchup does not "
+                             "match its hash",
+                             hash);
+                if (auto self = weak.lock())
+                {
+                    self->mVerificationFailed = true;
+                }
+            };
+            auto successCb = [weak, b, hash](Application& app) -> bool {
+                if (auto self = weak.lock())
+                {
+                    self->mBuckets[hash] = b;
+                }
+                return true;
+            };
+            auto w1 = std::make_shared<VerifyBucketWork>(
+                mApp, b->getFilename().string(), hexToBin256(hash), failureCb);
+            auto w2 = std::make_shared<WorkWithCallback>(
+                mApp, "reuse-verified-bucket", successCb);
+            std::vector<std::shared_ptr<BasicWork>> seq{w1, w2};
+            ++mNextBucketIter;
+            return std::make_shared<WorkSequence>(
+                mApp, "verify-reused-bucket-sequence-" + hash, seq);
+        }
+    }
+
     FileTransferInfo ft(mDownloadDir, HISTORY_FILE_TYPE_BUCKET, hash);
     auto w1 = std::make_shared<GetAndUnzipRemoteFileWork>(mApp, ft, mArchive);
 
     auto getFileWeak = std::weak_ptr<GetAndUnzipRemoteFileWork>(w1);
-    OnFailureCallback failureCb = [getFileWeak, hash]() {
+    OnFailureCallback failureCb = [getFileWeak, weak, hash]() {
         auto getFile = getFileWeak.lock();
         if (getFile)
         {
@@ -86,10 +125,12 @@ DownloadBucketsWork::yieldMoreWork()
                           ar->getName());
             }
         }
+        if (auto self = weak.lock())
+        {
+            self->mVerificationFailed = true;
+        }
     };
-    std::weak_ptr<DownloadBucketsWork> weak(
-        std::static_pointer_cast<DownloadBucketsWork>(shared_from_this()));
-    auto successCb = [weak, ft, hash](Application& app) -> bool {
+    auto successCb = [weak, ft, hash, resumable](Application& app) -> bool {
         auto self = weak.lock();
         if (self)
         {
@@ -101,6 +142,10 @@ DownloadBucketsWork::yieldMoreWork()
                 /*mergeKey=*/nullptr,
                 /*index=*/nullptr);
             self->mBuckets[hash] = b;
+            if (resumable)
+            {
+                CatchupProgress::recordBucket(app, hash);
+            }
         }
         return true;
     };
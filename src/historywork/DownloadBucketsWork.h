@@ -22,6 +22,7 @@ class DownloadBucketsWork : public BatchWork
     std::vector<std::string>::const_iterator mNextBucketIter;
     TmpDir const& mDownloadDir;
     std::shared_ptr<HistoryArchive> mArchive;
+    bool mVerificationFailed{false};
 
   public:
     DownloadBucketsWork(Application& app,
@@ -32,6 +33,13 @@ class DownloadBucketsWork : public BatchWork
     ~DownloadBucketsWork() = default;
     std::string getStatus() const override;
 
+    // Returns true if a bucket did not match its hash.
+    bool
+    verificationFailed() const
+    {
+        return mVerificationFailed;
+    }
+
   protected:
     bool hasNext() const override;
     std::shared_ptr<BasicWork> yieldMoreWork() override;
@@ -65,8 +65,17 @@ DownloadVerifyTxResultsWork::yieldMoreWork()
     FileTransferInfo ft(mDownloadDir, HISTORY_FILE_TYPE_RESULTS,
                         mCurrCheckpoint);
     auto w1 = std::make_shared<GetAndUnzipRemoteFileWork>(mApp, ft, mArchive);
+    std::weak_ptr<DownloadVerifyTxResultsWork> weak(
+        std::static_pointer_cast<DownloadVerifyTxResultsWork>(
+            shared_from_this()));
+    OnFailureCallback failureCb = [weak]() {
+        if (auto self = weak.lock())
+        {
+            self->mVerificationFailed = true;
+        }
+    };
     auto w2 = std::make_shared<VerifyTxResultsWork>(mApp, mDownloadDir,
-                                                    mCurrCheckpoint);
+                                                    mCurrCheckpoint, failureCb);
     std::vector<std::shared_ptr<BasicWork>> seq{w1, w2};
     auto w3 = std::make_shared<WorkSequence>(
         mApp,
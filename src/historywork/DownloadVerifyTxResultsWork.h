@@ -23,6 +23,7 @@ class DownloadVerifyTxResultsWork : public BatchWork
     CheckpointRange const mRange;
     uint32_t mCurrCheckpoint;
     std::shared_ptr<HistoryArchive> mArchive;
+    bool mVerificationFailed{false};
 
   public:
     DownloadVerifyTxResultsWork(
@@ -30,6 +31,14 @@ class DownloadVerifyTxResultsWork : public BatchWork
         std::shared_ptr<HistoryArchive> archive = nullptr);
     std::string getStatus() const override;
 
+    // Returns true if the results of a checkpoint did not match its ledger
+    // headers.
+    bool
+    verificationFailed() const
+    {
+        return mVerificationFailed;
+    }
+
   protected:
     bool hasNext() const override;
     std::shared_ptr<BasicWork> yieldMoreWork() override;
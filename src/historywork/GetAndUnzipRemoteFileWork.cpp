@@ -4,6 +4,7 @@
 
 #include "historywork/GetAndUnzipRemoteFileWork.h"
 #include "catchup/CatchupManager.h"
+#include "catchup/CatchupProgress.h"
 #include "history/HistoryArchive.h"
 #include "historywork/GetRemoteFileWork.h"
 #include "historywork/GunzipFileWork.h"
@@ -42,13 +43,35 @@ GetAndUnzipRemoteFileWork::getStatus() const
 void
 GetAndUnzipRemoteFileWork::doReset()
 {
-    std::remove(mFt.localPath_nogz().c_str());
-    std::remove(mFt.localPath_gz().c_str());
-    std::remove(mFt.localPath_gz_tmp().c_str());
+    mReused = false;
+    mReuseChecked = false;
+    mHashing = false;
+    mFileHash.reset();
+    ++mHashGeneration;
     mGetRemoteFileWork.reset();
     mGunzipFileWork.reset();
 }
 
+void
+GetAndUnzipRemoteFileWork::hashFileInBackground()
+{
+    mHashing = true;
+    std::weak_ptr<GetAndUnzipRemoteFileWork> weak(
+        std::static_pointer_cast<GetAndUnzipRemoteFileWork>(
+            shared_from_this()));
+    auto generation = mHashGeneration;
+    CatchupProgress::hashFile(
+        mApp, mFt, [weak, generation](std::string const& fileHash) {
+            auto self = weak.lock();
+            if (self && self->mHashGeneration == generation)
+            {
+                self->mHashing = false;
+                self->mFileHash = fileHash;
+                self->wakeUp();
+            }
+        });
+}
+
 void
 GetAndUnzipRemoteFileWork::onFailureRaise()
 {
@@ -65,7 +88,10 @@ GetAndUnzipRemoteFileWork::onFailureRaise()
 void
 GetAndUnzipRemoteFileWork::onSuccess()
 {
-    mApp.getCatchupManager().fileDownloaded(mFt.getType());
+    if (!mReused)
+    {
+        mApp.getCatchupManager().fileDownloaded(mFt.getType());
+    }
     Work::onSuccess();
 }
 
@@ -73,7 +99,33 @@ BasicWork::State
 GetAndUnzipRemoteFileWork::doWork()
 {
     ZoneScoped;
-    if (mGunzipFileWork)
+    if (mHashing)
+    {
+        return State::WORK_WAITING;
+    }
+    else if (!mReuseChecked)
+    {
+        if (CatchupProgress::tracks(mApp, mFt) &&
+            CatchupProgress::hasRecord(mApp, mFt))
+        {
+            if (!mFileHash)
+            {
+                hashFileInBackground();
+                return State::WORK_WAITING;
+            }
+            mReused = CatchupProgress::matchesRecord(mApp, mFt, *mFileHash);
+            mFileHash.reset();
+        }
+        mReuseChecked = true;
+    }
+
+    if (mReused)
+    {
+        CLOG_DEBUG(History, "Reusing {} downloaded by an earlier catchup",
+                   mFt.localPath_nogz());
+        return State::WORK_SUCCESS;
+    }
+    else if (mGunzipFileWork)
     {
         // Download completed, unzipping started
         releaseAssert(mGetRemoteFileWork);
@@ -85,6 +137,16 @@ GetAndUnzipRemoteFileWork::doWork()
                        mFt.remoteName());
             return State::WORK_FAILURE;
         }
+        if (state == State::WORK_SUCCESS &&
+            CatchupProgress::tracks(mApp, mFt))
+        {
+            if (!mFileHash)
+            {
+                hashFileInBackground();
+                return State::WORK_WAITING;
+            }
+            CatchupProgress::recordFile(mApp, mFt, *mFileHash);
+        }
         return state;
     }
     else if (mGetRemoteFileWork)
@@ -106,6 +168,9 @@ GetAndUnzipRemoteFileWork::doWork()
     else
     {
         CLOG_DEBUG(History, "Downloading and unzipping {}", mFt.remoteName());
+        std::remove(mFt.localPath_nogz().c_str());
+        std::remove(mFt.localPath_gz().c_str());
+        std::remove(mFt.localPath_gz_tmp().c_str());
         mGetRemoteFileWork =
             addWork<GetRemoteFileWork>(mFt.remoteName(), mFt.localPath_gz_tmp(),
                                        mArchive, BasicWork::RETRY_NEVER);
@@ -6,6 +6,7 @@
 
 #include "history/FileTransferInfo.h"
 #include "work/Work.h"
+#include <optional>
 
 namespace caiz
 {
@@ -21,7 +22,21 @@ class GetAndUnzipRemoteFileWork : public Work
     FileTransferInfo mFt;
     std::shared_ptr<HistoryArchive> const mArchive;
 
+    // Set when the file was already downloaded by an interrupted resumable
+    // catchup (see CatchupProgress), in which case nothing is fetched.
+    bool mReused{false};
+    bool mReuseChecked{false};
+
+    // Hash of the unzipped file of a resumable catchup, computed in the
+    // background: first to check whether an earlier download can be reused,
+    // then to record a new one. mHashGeneration tells the hash of the current
+    // attempt from that of an attempt reset while hashing.
+    bool mHashing{false};
+    std::optional<std::string> mFileHash;
+    uint64_t mHashGeneration{0};
+
     bool validateFile();
+    void hashFileInBackground();
 
   public:
     // Passing `nullptr` for the archive argument will cause the work to
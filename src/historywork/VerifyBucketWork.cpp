@@ -125,7 +125,8 @@ VerifyBucketWork::spawnVerifier()
                 },
                 "VerifyBucket: finish");
         },
-        "VerifyBucket: start in background");
+        "VerifyBucket: start in background",
+        WorkerPool::Priority::LATENCY_SENSITIVE);
 }
 
 void
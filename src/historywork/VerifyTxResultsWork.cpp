@@ -17,11 +17,13 @@ namespace caiz
 
 VerifyTxResultsWork::VerifyTxResultsWork(Application& app,
                                          TmpDir const& downloadDir,
-                                         uint32_t checkpoint)
+                                         uint32_t checkpoint,
+                                         OnFailureCallback failureCb)
     : BasicWork(app, "verify-results-" + std::to_string(checkpoint),
                 RETRY_NEVER)
     , mDownloadDir(downloadDir)
     , mCheckpoint(checkpoint)
+    , mOnFailure(failureCb)
 {
 }
 
@@ -36,6 +38,15 @@ VerifyTxResultsWork::onReset()
     mLastSeenLedger = 0;
 }
 
+void
+VerifyTxResultsWork::onFailureRaise()
+{
+    if (mOnFailure)
+    {
+        mOnFailure();
+    }
+}
+
 BasicWork::State
 VerifyTxResultsWork::onRun()
 {
@@ -79,7 +90,8 @@ VerifyTxResultsWork::onRun()
         }
     };
 
-    mApp.postOnBackgroundThread(verify, "VerifyTxResults: start in background");
+    mApp.postOnBackgroundThread(verify, "VerifyTxResults: start in background",
+                                WorkerPool::Priority::LATENCY_SENSITIVE);
     return State::WORK_WAITING;
 }
 
@@ -6,7 +6,7 @@
 
 #include "util/TmpDir.h"
 #include "util/XDRStream.h"
-#include "work/BasicWork.h"
+#include "work/Work.h"
 #include "xdr/Caiz-types.h"
 
 namespace caiz
@@ -25,17 +25,20 @@ class VerifyTxResultsWork : public BasicWork
     bool mDone{false};
     asio::error_code mEc;
     uint32_t mLastSeenLedger;
+    OnFailureCallback mOnFailure;
 
     TransactionHistoryResultEntry getCurrentTxResultSet(uint32_t ledger);
     bool verifyTxResultsOfCheckpoint();
 
   public:
     VerifyTxResultsWork(Application& app, TmpDir const& downloadDir,
-                        uint32_t checkpoint);
+                        uint32_t checkpoint,
+                        OnFailureCallback failureCb = nullptr);
 
   protected:
     BasicWork::State onRun() override;
     void onReset() override;
+    void onFailureRaise() override;
 
     bool
     onAbort() override
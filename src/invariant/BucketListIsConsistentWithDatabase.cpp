@@ -4,9 +4,12 @@
 
 #include "invariant/BucketListIsConsistentWithDatabase.h"
 #include "bucket/Bucket.h"
+#include "bucket/BucketIndex.h"
 #include "bucket/BucketInputIterator.h"
 #include "bucket/BucketManager.h"
+#include "bucket/LedgerCmp.h"
 #include "crypto/Hex.h"
+#include "database/Database.h"
 #include "history/HistoryArchive.h"
 #include "invariant/InvariantManager.h"
 #include "ledger/LedgerManager.h"
@@ -15,11 +18,14 @@
 #include "ledger/LedgerTxnEntry.h"
 #include "main/Application.h"
 #include "main/PersistentState.h"
-#include "medida/timer.h"
 #include "util/XDRCereal.h"
+#include "util/types.h"
+#include <Tracy.hpp>
+#include <algorithm>
 #include <chrono>
 #include <fmt/chrono.h>
 #include <fmt/format.h>
+#include <future>
 #include <map>
 
 namespace caiz
@@ -88,172 +94,512 @@ BucketListIsConsistentWithDatabase::getName() const
     return "BucketListIsConsistentWithDatabase";
 }
 
-struct EntryCounts
+namespace
 {
-    uint64_t mAccounts{0};
-    uint64_t mTrustLines{0};
-    uint64_t mOffers{0};
-    uint64_t mData{0};
-    uint64_t mClaimableBalance{0};
-    uint64_t mLiquidityPool{0};
-    uint64_t mContractData{0};
-    uint64_t mContractCode{0};
-    uint64_t mConfigSettings{0};
-
-    uint64_t
-    totalEntries() const
+// Live entries and dead keys are checked against the database this many at a
+// time, so that memory use does not grow with the size of the bucket
+constexpr size_t CHECK_BATCH_SIZE = 0x4000;
+
+// The entry types that are stored in the database, in the order they are
+// reported in
+std::vector<LedgerEntryType> const&
+databaseEntryTypes()
+{
+    static std::vector<LedgerEntryType> const types{
+        ACCOUNT,          TRUSTLINE,     OFFER, DATA, CLAIMABLE_BALANCE,
+        LIQUIDITY_POOL,
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+        CONTRACT_DATA,    CONTRACT_CODE, CONFIG_SETTING
+#endif
+    };
+    return types;
+}
+
+void
+throwIfNotDatabaseEntryType(LedgerEntryType let)
+{
+    auto const& types = databaseEntryTypes();
+    if (std::find(types.begin(), types.end(), let) == types.end())
     {
-        return mAccounts + mTrustLines + mOffers + mData + mClaimableBalance +
-               mLiquidityPool + mContractData + mConfigSettings;
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("unknown ledger entry type: {:d}"),
+                        static_cast<uint32_t>(let)));
     }
+}
+
+struct EntryBatch
+{
+    std::vector<LedgerEntry> mLive;
+    std::vector<LedgerKey> mDead;
+    // Set if the bucket is malformed, the check fails with it
+    std::string mError;
+    bool mLast{false};
+};
 
-    void
-    countLiveEntry(LedgerEntry const& e)
+// Reads a bucket one batch at a time, checking the order of its entries and
+// their lastModifiedLedgerSeq bounds on the way. Only touches the bucket, so
+// it can run on a worker thread.
+class BucketBatchReader
+{
+    BucketInputIterator mIter;
+    uint32_t const mOldestLedger;
+    uint32_t const mNewestLedger;
+    std::function<bool(LedgerEntryType)> const mEntryTypeFilter;
+    bool mHasPreviousEntry{false};
+    BucketEntry mPreviousEntry;
+
+    std::string
+    checkEntry(BucketEntry const& e)
     {
-        switch (e.data.type())
+        if (mHasPreviousEntry && !BucketEntryIdCmp{}(mPreviousEntry, e))
         {
-        case ACCOUNT:
-            ++mAccounts;
-            break;
-        case TRUSTLINE:
-            ++mTrustLines;
-            break;
-        case OFFER:
-            ++mOffers;
-            break;
-        case DATA:
-            ++mData;
-            break;
-        case CLAIMABLE_BALANCE:
-            ++mClaimableBalance;
-            break;
-        case LIQUIDITY_POOL:
-            ++mLiquidityPool;
-            break;
-#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
-        case CONTRACT_DATA:
-            ++mContractData;
-            break;
-        case CONTRACT_CODE:
-            ++mContractCode;
-            break;
-        case CONFIG_SETTING:
-            ++mConfigSettings;
-            break;
-#endif
-        default:
-            throw std::runtime_error(
-                fmt::format(FMT_STRING("unknown ledger entry type: {:d}"),
-                            static_cast<uint32_t>(e.data.type())));
+            std::string s = "Bucket has out of order entries: ";
+            s += xdr_to_string(mPreviousEntry, "previous");
+            s += xdr_to_string(e, "current");
+            return s;
         }
+        mPreviousEntry = e;
+        mHasPreviousEntry = true;
+
+        if (e.type() == LIVEENTRY || e.type() == INITENTRY)
+        {
+            if (e.liveEntry().lastModifiedLedgerSeq < mOldestLedger)
+            {
+                auto s = fmt::format(
+                    FMT_STRING("lastModifiedLedgerSeq beneath lower"
+                               " bound for this bucket ({:d} < {:d}): "),
+                    e.liveEntry().lastModifiedLedgerSeq, mOldestLedger);
+                s += xdr_to_string(e.liveEntry(), "live");
+                return s;
+            }
+            if (e.liveEntry().lastModifiedLedgerSeq > mNewestLedger)
+            {
+                auto s = fmt::format(
+                    FMT_STRING("lastModifiedLedgerSeq above upper"
+                               " bound for this bucket ({:d} > {:d}): "),
+                    e.liveEntry().lastModifiedLedgerSeq, mNewestLedger);
+                s += xdr_to_string(e.liveEntry(), "live");
+                return s;
+            }
+        }
+        return {};
     }
 
-    std::string
-    checkDbEntryCounts(Application& app, LedgerRange const& range,
-                       std::function<bool(LedgerEntryType)> entryTypeFilter)
+  public:
+    BucketBatchReader(std::shared_ptr<Bucket const> bucket,
+                      uint32_t oldestLedger, uint32_t newestLedger,
+                      std::function<bool(LedgerEntryType)> entryTypeFilter)
+        : mIter(bucket)
+        , mOldestLedger(oldestLedger)
+        , mNewestLedger(newestLedger)
+        , mEntryTypeFilter(entryTypeFilter)
+    {
+    }
+
+    EntryBatch
+    next()
     {
-        std::string msg;
-        auto check = [&](LedgerEntryType let, uint64_t numInBucket) {
-            if (entryTypeFilter(let))
+        ZoneScoped;
+        EntryBatch batch;
+        while (mIter &&
+               batch.mLive.size() + batch.mDead.size() < CHECK_BATCH_SIZE)
+        {
+            auto const& e = *mIter;
+            batch.mError = checkEntry(e);
+            if (!batch.mError.empty())
+            {
+                batch.mLast = true;
+                return batch;
+            }
+
+            if (e.type() == LIVEENTRY || e.type() == INITENTRY)
             {
-                auto& ltxRoot = app.getLedgerTxnRoot();
-                uint64_t numInDb = ltxRoot.countObjects(let, range);
-                if (numInDb != numInBucket)
+                if (mEntryTypeFilter(e.liveEntry().data.type()))
                 {
-                    msg = fmt::format(
-                        FMT_STRING("Incorrect {} count: Bucket = {:d} Database "
-                                   "= {:d}"),
-                        xdr::xdr_traits<LedgerEntryType>::enum_name(let),
-                        numInBucket, numInDb);
-                    return false;
+                    throwIfNotDatabaseEntryType(e.liveEntry().data.type());
+                    batch.mLive.emplace_back(e.liveEntry());
                 }
             }
-            return true;
-        };
-
-        // Uses short-circuiting to make this compact
-        check(ACCOUNT, mAccounts) && check(TRUSTLINE, mTrustLines) &&
-            check(OFFER, mOffers) && check(DATA, mData) &&
-            check(CLAIMABLE_BALANCE, mClaimableBalance) &&
-            check(LIQUIDITY_POOL, mLiquidityPool)
-#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
-            && check(CONTRACT_DATA, mContractData) &&
-            check(CONTRACT_CODE, mContractCode) &&
-            check(CONFIG_SETTING, mConfigSettings)
-#endif
-            ;
-        return msg;
+            else if (e.type() == DEADENTRY)
+            {
+                if (mEntryTypeFilter(e.deadEntry().type()))
+                {
+                    batch.mDead.emplace_back(e.deadEntry());
+                }
+            }
+            ++mIter;
+        }
+        batch.mLast = !mIter;
+        return batch;
     }
 };
 
-void
-BucketListIsConsistentWithDatabase::checkEntireBucketlist()
+// Reads the live state of a whole BucketList one batch at a time, in key
+// order, by merging its buckets. Of all versions of an entry only the one in
+// the newest bucket is kept, and entries whose newest version is a DEADENTRY
+// are skipped. Memory use does not depend on the size of the BucketList. Only
+// touches the buckets, so it can run on a worker thread.
+class BucketListStateReader
 {
-    auto& lm = mApp.getLedgerManager();
-    auto& bm = mApp.getBucketManager();
-    HistoryArchiveState has = lm.getLastClosedLedgerHAS();
-    std::map<LedgerKey, LedgerEntry> bucketLedgerMap =
-        bm.loadCompleteLedgerState(has);
-    EntryCounts counts;
-    medida::Timer timer(std::chrono::microseconds(1));
+    // Newest bucket first
+    std::vector<std::unique_ptr<BucketInputIterator>> mIters;
+    std::function<bool(LedgerEntryType)> const mEntryTypeFilter;
+
+  public:
+    BucketListStateReader(
+        std::vector<std::shared_ptr<Bucket const>> const& buckets,
+        std::function<bool(LedgerEntryType)> entryTypeFilter)
+        : mEntryTypeFilter(entryTypeFilter)
+    {
+        for (auto const& b : buckets)
+        {
+            mIters.emplace_back(std::make_unique<BucketInputIterator>(b));
+        }
+    }
+
+    EntryBatch
+    next()
+    {
+        ZoneScoped;
+        EntryBatch batch;
+        BucketEntryIdCmp cmp;
+        while (batch.mLive.size() < CHECK_BATCH_SIZE)
+        {
+            // On equal keys the newest bucket wins
+            BucketInputIterator* newest = nullptr;
+            for (auto& iter : mIters)
+            {
+                if (*iter && (!newest || cmp(**iter, **newest)))
+                {
+                    newest = iter.get();
+                }
+            }
+            if (!newest)
+            {
+                break;
+            }
+
+            BucketEntry e = **newest;
+            for (auto& iter : mIters)
+            {
+                if (*iter && !cmp(e, **iter))
+                {
+                    ++*iter;
+                }
+            }
+
+            if (e.type() == LIVEENTRY || e.type() == INITENTRY)
+            {
+                if (mEntryTypeFilter(e.liveEntry().data.type()))
+                {
+                    throwIfNotDatabaseEntryType(e.liveEntry().data.type());
+                    batch.mLive.emplace_back(e.liveEntry());
+                }
+            }
+        }
+        batch.mLast = std::none_of(mIters.begin(), mIters.end(),
+                                   [](auto const& iter) { return bool(*iter); });
+        return batch;
+    }
+};
+
+template <typename Reader>
+std::future<EntryBatch>
+readBatchInBackground(Application& app, std::shared_ptr<Reader> reader)
+{
+    auto promise = std::make_shared<std::promise<EntryBatch>>();
+    auto res = promise->get_future();
+    // The main thread waits for the batch, and reader is kept alive by the
+    // task in case the check returns before the batch is read
+    app.postOnBackgroundThread(
+        [reader, promise]() {
+            try
+            {
+                promise->set_value(reader->next());
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+        },
+        "BucketListIsConsistentWithDatabase: read bucket",
+        WorkerPool::Priority::LATENCY_SENSITIVE);
+    return res;
+}
+
+struct EntriesOfType
+{
+    std::vector<LedgerEntry> mLive;
+    std::vector<LedgerKey> mDead;
+};
+
+// Checks live entries and dead keys of a single entry type against the
+// database with one batched load through session, which may be a session from
+// the connection pool used on a worker thread. Returns the first failure, if
+// any.
+std::string
+checkEntriesOfType(AbstractLedgerTxnParent const& root, soci::session& session,
+                   EntriesOfType const& entries)
+{
+    ZoneScoped;
+    UnorderedSet<LedgerKey> keys;
+    keys.reserve(entries.mLive.size() + entries.mDead.size());
+    for (auto const& entry : entries.mLive)
+    {
+        keys.emplace(LedgerEntryKey(entry));
+    }
+    keys.insert(entries.mDead.begin(), entries.mDead.end());
 
+    // The database should contain the same expired entries as the bucket even
+    // if they are not accessible, so this reads it directly
+    auto fromDb = root.loadObjects(keys, session);
+    for (auto const& entry : entries.mLive)
+    {
+        auto const& dbEntry = fromDb.at(LedgerEntryKey(entry));
+        if (!dbEntry)
+        {
+            std::string s{
+                "Inconsistent state between objects (not found in database): "};
+            s += xdr_to_string(entry, "live");
+            return s;
+        }
+        if (!(*dbEntry == entry))
+        {
+            std::string s{"Inconsistent state between objects: "};
+            s += xdr_to_string(*dbEntry, "db");
+            s += xdr_to_string(entry, "live");
+            return s;
+        }
+    }
+    for (auto const& key : entries.mDead)
+    {
+        auto const& dbEntry = fromDb.at(key);
+        if (dbEntry)
+        {
+            std::string s = "Entry with type DEADENTRY found in database ";
+            s += xdr_to_string(*dbEntry, "db");
+            return s;
+        }
+    }
+    return {};
+}
+}
+
+std::string
+BucketListIsConsistentWithDatabase::checkBatch(
+    std::vector<LedgerEntry> const& live, std::vector<LedgerKey> const& dead)
+{
+    ZoneScoped;
+    // Batched loads do not support in-memory LedgerTxn, so check entry by
+    // entry
+    if (mApp.getConfig().isInMemoryMode())
     {
         LedgerTxn ltx(mApp.getLedgerTxnRoot());
-        for (auto const& pair : bucketLedgerMap)
+        for (auto const& entry : live)
         {
-            // Don't check entry types in BucketListDB when enabled
-            if (mApp.getConfig().isUsingBucketListDB() &&
-                !BucketIndex::typeNotSupported(pair.first.type()))
+            auto s = checkAgainstDatabase(ltx, entry);
+            if (!s.empty())
             {
-                continue;
+                return s;
+            }
+        }
+        for (auto const& key : dead)
+        {
+            auto s = checkAgainstDatabase(ltx, key);
+            if (!s.empty())
+            {
+                return s;
             }
+        }
+        return {};
+    }
 
-            counts.countLiveEntry(pair.second);
-            std::string s;
-            timer.Time([&]() { s = checkAgainstDatabase(ltx, pair.second); });
+    std::map<LedgerEntryType, EntriesOfType> byType;
+    for (auto const& entry : live)
+    {
+        byType[entry.data.type()].mLive.emplace_back(entry);
+    }
+    for (auto const& key : dead)
+    {
+        byType[key.type()].mDead.emplace_back(key);
+    }
+
+    auto& db = mApp.getDatabase();
+    auto const& root = mApp.getLedgerTxnRoot();
+    if (!db.canUsePool() || byType.size() < 2)
+    {
+        for (auto const& kv : byType)
+        {
+            auto s = checkEntriesOfType(root, db.getSession(), kv.second);
             if (!s.empty())
             {
-                throw std::runtime_error(s);
+                return s;
+            }
+        }
+        return {};
+    }
+
+    // Each entry type is checked on the worker pool with its own session.
+    // The tasks only reference app-owned state besides their own entries.
+    auto& pool = db.getPool();
+    std::vector<std::future<std::string>> results;
+    for (auto& kv : byType)
+    {
+        auto entries = std::make_shared<EntriesOfType>(std::move(kv.second));
+        auto task = std::make_shared<std::packaged_task<std::string()>>(
+            [&root, &pool, entries]() {
+                soci::session session(pool);
+                return checkEntriesOfType(root, session, *entries);
+            });
+        results.emplace_back(task->get_future());
+        mApp.postOnBackgroundThread(
+            [task]() { (*task)(); },
+            "BucketListIsConsistentWithDatabase: check entries",
+            WorkerPool::Priority::LATENCY_SENSITIVE);
+    }
+
+    // Failures are reported in entry type order, whichever check ends first
+    std::string res;
+    std::exception_ptr error;
+    for (auto& result : results)
+    {
+        try
+        {
+            auto s = result.get();
+            if (res.empty())
+            {
+                res = std::move(s);
             }
-            auto i = counts.totalEntries();
-            if ((i & 0x7ffff) == 0)
+        }
+        catch (...)
+        {
+            if (!error)
             {
-                using namespace std::chrono;
-                nanoseconds ns = timer.duration_unit() *
-                                 static_cast<nanoseconds::rep>(timer.mean());
-                microseconds us = duration_cast<microseconds>(ns);
-                CLOG_INFO(Ledger,
-                          "Checked bucket-vs-DB consistency for "
-                          "{} entries (mean {}/entry)",
-                          i, us);
+                error = std::current_exception();
             }
         }
     }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+    return res;
+}
 
+std::string
+BucketListIsConsistentWithDatabase::checkCounts(
+    std::map<LedgerEntryType, uint64_t> const& counts,
+    LedgerRange const& ledgers,
+    std::function<bool(LedgerEntryType)> const& entryTypeFilter)
+{
+    ZoneScoped;
     // Count functionality does not support in-memory LedgerTxn
-    if (!mApp.getConfig().isInMemoryMode())
+    if (mApp.getConfig().isInMemoryMode())
+    {
+        return {};
+    }
+
+    auto& ltxRoot = mApp.getLedgerTxnRoot();
+    for (auto let : databaseEntryTypes())
     {
-        auto range = LedgerRange::inclusive(LedgerManager::GENESIS_LEDGER_SEQ,
-                                            has.currentLedger);
+        if (!entryTypeFilter(let))
+        {
+            continue;
+        }
+        auto iter = counts.find(let);
+        uint64_t numInBucket = iter == counts.end() ? 0 : iter->second;
+        uint64_t numInDb = ltxRoot.countObjects(let, ledgers);
+        if (numInDb != numInBucket)
+        {
+            return fmt::format(
+                FMT_STRING("Incorrect {} count: Bucket = {:d} Database = {:d}"),
+                xdr::xdr_traits<LedgerEntryType>::enum_name(let), numInBucket,
+                numInDb);
+        }
+    }
+    return {};
+}
+
+void
+BucketListIsConsistentWithDatabase::checkEntireBucketlist()
+{
+    auto& lm = mApp.getLedgerManager();
+    auto& bm = mApp.getBucketManager();
+    HistoryArchiveState has = lm.getLastClosedLedgerHAS();
 
-        // If BucketListDB enabled, only types not supported by BucketListDB
-        // should be in SQL DB
-        std::function<bool(LedgerEntryType)> filter;
-        if (mApp.getConfig().isUsingBucketListDB())
+    std::vector<std::shared_ptr<Bucket const>> buckets;
+    for (auto const& hsb : has.currentBuckets)
+    {
+        for (auto const& hash : {hexToBin256(hsb.curr), hexToBin256(hsb.snap)})
         {
-            filter = BucketIndex::typeNotSupported;
+            if (isZero(hash))
+            {
+                continue;
+            }
+            auto b = bm.getBucketByHash(hash);
+            if (!b)
+            {
+                throw std::runtime_error(std::string("missing bucket: ") +
+                                         binToHex(hash));
+            }
+            buckets.emplace_back(b);
         }
-        else
+    }
+
+    // If BucketListDB enabled, only types not supported by BucketListDB
+    // should be in SQL DB
+    std::function<bool(LedgerEntryType)> filter;
+    if (mApp.getConfig().isUsingBucketListDB())
+    {
+        filter = BucketIndex::typeNotSupported;
+    }
+    else
+    {
+        filter = [](LedgerEntryType) { return true; };
+    }
+
+    // The BucketList state is merged from the buckets on a worker thread one
+    // batch at a time while the previous batch is looked up in the database
+    auto start = std::chrono::steady_clock::now();
+    auto reader = std::make_shared<BucketListStateReader>(buckets, filter);
+    std::map<LedgerEntryType, uint64_t> counts;
+    uint64_t checked = 0;
+    auto next = readBatchInBackground(mApp, reader);
+    while (true)
+    {
+        auto batch = next.get();
+        if (!batch.mLast)
         {
-            filter = [](LedgerEntryType) { return true; };
+            next = readBatchInBackground(mApp, reader);
         }
 
-        auto s = counts.checkDbEntryCounts(mApp, range, filter);
+        for (auto const& entry : batch.mLive)
+        {
+            ++counts[entry.data.type()];
+        }
+        auto s = checkBatch(batch.mLive, {});
         if (!s.empty())
         {
             throw std::runtime_error(s);
         }
+        checked += batch.mLive.size();
+        if (batch.mLast)
+        {
+            break;
+        }
+    }
+
+    auto range = LedgerRange::inclusive(LedgerManager::GENESIS_LEDGER_SEQ,
+                                        has.currentLedger);
+    auto s = checkCounts(counts, range, filter);
+    if (!s.empty())
+    {
+        throw std::runtime_error(s);
     }
+    CLOG_INFO(Ledger, "Checked bucket-vs-DB consistency for {} entries in {}",
+              checked,
+              std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start));
 
     if (mApp.getConfig().isUsingBucketListDB() &&
         mApp.getPersistentState().getState(PersistentState::kDBBackend) !=
@@ -269,71 +615,41 @@ BucketListIsConsistentWithDatabase::checkOnBucketApply(
     std::shared_ptr<Bucket const> bucket, uint32_t oldestLedger,
     uint32_t newestLedger, std::function<bool(LedgerEntryType)> entryTypeFilter)
 {
-    EntryCounts counts;
-    {
-        LedgerTxn ltx(mApp.getLedgerTxnRoot());
+    auto reader = std::make_shared<BucketBatchReader>(
+        bucket, oldestLedger, newestLedger, entryTypeFilter);
+    std::map<LedgerEntryType, uint64_t> counts;
 
-        bool hasPreviousEntry = false;
-        BucketEntry previousEntry;
-        for (BucketInputIterator iter(bucket); iter; ++iter)
+    // The next batch is read from the bucket on a worker thread while the
+    // current one is looked up in the database
+    auto next = readBatchInBackground(mApp, reader);
+    while (true)
+    {
+        auto batch = next.get();
+        if (!batch.mError.empty())
         {
-            auto const& e = *iter;
-            if (hasPreviousEntry && !BucketEntryIdCmp{}(previousEntry, e))
-            {
-                std::string s = "Bucket has out of order entries: ";
-                s += xdr_to_string(previousEntry, "previous");
-                s += xdr_to_string(e, "current");
-                return s;
-            }
-            previousEntry = e;
-            hasPreviousEntry = true;
-
-            if (e.type() == LIVEENTRY || e.type() == INITENTRY)
-            {
-                if (e.liveEntry().lastModifiedLedgerSeq < oldestLedger)
-                {
-                    auto s = fmt::format(
-                        FMT_STRING("lastModifiedLedgerSeq beneath lower"
-                                   " bound for this bucket ({:d} < {:d}): "),
-                        e.liveEntry().lastModifiedLedgerSeq, oldestLedger);
-                    s += xdr_to_string(e.liveEntry(), "live");
-                    return s;
-                }
-                if (e.liveEntry().lastModifiedLedgerSeq > newestLedger)
-                {
-                    auto s = fmt::format(
-                        FMT_STRING("lastModifiedLedgerSeq above upper"
-                                   " bound for this bucket ({:d} > {:d}): "),
-                        e.liveEntry().lastModifiedLedgerSeq, newestLedger);
-                    s += xdr_to_string(e.liveEntry(), "live");
-                    return s;
-                }
+            return batch.mError;
+        }
+        if (!batch.mLast)
+        {
+            next = readBatchInBackground(mApp, reader);
+        }
 
-                if (entryTypeFilter(e.liveEntry().data.type()))
-                {
-                    counts.countLiveEntry(e.liveEntry());
-                    auto s = checkAgainstDatabase(ltx, e.liveEntry());
-                    if (!s.empty())
-                    {
-                        return s;
-                    }
-                }
-            }
-            else if (e.type() == DEADENTRY)
-            {
-                if (entryTypeFilter(e.deadEntry().type()))
-                {
-                    auto s = checkAgainstDatabase(ltx, e.deadEntry());
-                    if (!s.empty())
-                    {
-                        return s;
-                    }
-                }
-            }
+        for (auto const& entry : batch.mLive)
+        {
+            ++counts[entry.data.type()];
+        }
+        auto s = checkBatch(batch.mLive, batch.mDead);
+        if (!s.empty())
+        {
+            return s;
+        }
+        if (batch.mLast)
+        {
+            break;
         }
     }
 
     auto range = LedgerRange::inclusive(oldestLedger, newestLedger);
-    return counts.checkDbEntryCounts(mApp, range, entryTypeFilter);
+    return checkCounts(counts, range, entryTypeFilter);
 }
 }
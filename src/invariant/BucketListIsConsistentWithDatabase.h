@@ -5,11 +5,15 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "invariant/Invariant.h"
+#include "xdr/Caiz-ledger-entries.h"
+#include <map>
+#include <vector>
 
 namespace caiz
 {
 
 class Application;
+struct LedgerRange;
 
 // This Invariant is used to validate that the BucketList and Database are
 // in a consistent state after a bucket apply, such as during catchup-minimal.
@@ -24,6 +28,14 @@ class Application;
 // database, while the third condition shows that the database does not
 // contain any entry in the appropriate ledger range other than those in
 // the bucket.
+//
+// Entries are checked in batches: the live entries and DEADENTRYs of a batch
+// are loaded from the database with one query per entry type, each on a
+// worker thread with its own session from the connection pool when there is
+// one, and the next batch is read from the bucket on a worker thread
+// meanwhile. Memory use is bounded by the batch size rather than by the size
+// of the bucket. The offline check of the entire BucketList merges its
+// buckets on the fly, so it does not load the complete ledger state either.
 class BucketListIsConsistentWithDatabase : public Invariant
 {
   public:
@@ -44,5 +56,18 @@ class BucketListIsConsistentWithDatabase : public Invariant
 
   private:
     Application& mApp;
+
+    // Checks that each live entry is in the database and that no dead key is.
+    // Returns the first failure, if any.
+    std::string checkBatch(std::vector<LedgerEntry> const& live,
+                           std::vector<LedgerKey> const& dead);
+
+    // Compares the number of live entries of each entry type accepted by
+    // entryTypeFilter with the number of entries of that type in the database
+    // last modified within ledgers. Returns the first failure, if any.
+    std::string
+    checkCounts(std::map<LedgerEntryType, uint64_t> const& counts,
+                LedgerRange const& ledgers,
+                std::function<bool(LedgerEntryType)> const& entryTypeFilter);
 };
 }
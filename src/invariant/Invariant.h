@@ -57,6 +57,16 @@ class Invariant
         return std::string{};
     }
 
+    // Whether checkOnOperationApply depends only on its arguments. Invariants
+    // that keep state across operations must return false: they are always
+    // checked synchronously, in apply order, even when the other invariants
+    // are checked on background threads.
+    virtual bool
+    isOperationCheckStateless() const
+    {
+        return true;
+    }
+
 #ifdef BUILD_TESTS
     virtual void
     snapshotForFuzzer()
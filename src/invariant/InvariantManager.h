@@ -40,9 +40,21 @@ class InvariantManager
         std::shared_ptr<Bucket const> bucket, uint32_t ledger, uint32_t level,
         bool isCurr, std::function<bool(LedgerEntryType)> entryTypeFilter) = 0;
 
+    // txContentsHash and opIndex locate the operation within its ledger and
+    // are only used to report failures.
     virtual void checkOnOperationApply(Operation const& operation,
                                        OperationResult const& opres,
-                                       LedgerTxnDelta const& ltxDelta) = 0;
+                                       LedgerTxnDelta const& ltxDelta,
+                                       Hash const& txContentsHash,
+                                       size_t opIndex) = 0;
+
+    // When operations are checked asynchronously (see
+    // EXPERIMENTAL_ASYNC_INVARIANT_CHECK_THREADS), blocks until every
+    // operation handed to checkOnOperationApply so far has been checked and
+    // reports the failures found, throwing InvariantDoesNotHold for a strict
+    // invariant unless halting is disabled. Called at ledger boundaries. Does
+    // nothing when operations are checked synchronously.
+    virtual void finishOperationChecks() = 0;
 
     virtual void registerInvariant(std::shared_ptr<Invariant> invariant) = 0;
 
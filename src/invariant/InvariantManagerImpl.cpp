@@ -11,7 +11,9 @@
 #include "invariant/InvariantManagerImpl.h"
 #include "ledger/LedgerTxn.h"
 #include "main/Application.h"
+#include "main/Config.h"
 #include "main/ErrorMessages.h"
+#include "util/GlobalChecks.h"
 #include "util/Logging.h"
 #include "util/ProtocolVersion.h"
 #include "util/XDRCereal.h"
@@ -19,7 +21,11 @@
 
 #include "medida/counter.h"
 #include "medida/metrics_registry.h"
+#include "medida/timer.h"
 
+#include <Tracy.hpp>
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <numeric>
 #include <regex>
@@ -27,16 +33,89 @@
 namespace caiz
 {
 
+struct InvariantManagerImpl::OperationSnapshot
+{
+    uint64_t mSeq;
+    Operation mOperation;
+    OperationResult mResult;
+    LedgerTxnDelta mDelta;
+    Hash mTxContentsHash;
+    size_t mOpIndex;
+};
+
+namespace
+{
+std::shared_ptr<InternalLedgerEntry const>
+copyEntry(std::shared_ptr<InternalLedgerEntry const> const& entry)
+{
+    return entry ? std::make_shared<InternalLedgerEntry const>(*entry)
+                 : nullptr;
+}
+
+LedgerTxnDelta
+deepCopyDelta(LedgerTxnDelta const& ltxDelta)
+{
+    LedgerTxnDelta res;
+    res.header = ltxDelta.header;
+    res.entry.reserve(ltxDelta.entry.size());
+    for (auto const& kv : ltxDelta.entry)
+    {
+        res.entry.emplace(kv.first,
+                          LedgerTxnDelta::EntryDelta{
+                              copyEntry(kv.second.current),
+                              copyEntry(kv.second.previous)});
+    }
+    return res;
+}
+}
+
 std::unique_ptr<InvariantManager>
 InvariantManager::create(Application& app)
 {
-    return std::make_unique<InvariantManagerImpl>(app.getMetrics());
+    return std::make_unique<InvariantManagerImpl>(app.getMetrics(),
+                                                  app.getConfig());
 }
 
-InvariantManagerImpl::InvariantManagerImpl(medida::MetricsRegistry& registry)
+InvariantManagerImpl::InvariantManagerImpl(medida::MetricsRegistry& registry,
+                                           Config const& cfg)
     : mInvariantFailureCount(
           registry.NewCounter({"ledger", "invariant", "failure"}))
+    , mAsyncCheckWaitTime(
+          registry.NewTimer({"ledger", "invariant", "async-wait"}))
+    , mHaltOnAsyncFailure(cfg.EXPERIMENTAL_ASYNC_INVARIANT_HALT_ON_FAILURE)
 {
+    for (uint32_t i = 0; i < cfg.EXPERIMENTAL_ASYNC_INVARIANT_CHECK_THREADS;
+         ++i)
+    {
+        mAsyncCheckThreads.emplace_back([this]() { runOperationChecks(); });
+    }
+}
+
+InvariantManagerImpl::~InvariantManagerImpl()
+{
+    if (!checksOperationsAsync())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mAsyncMutex);
+        mStopping = true;
+    }
+    mAsyncCV.notify_all();
+    for (auto& thread : mAsyncCheckThreads)
+    {
+        thread.join();
+    }
+
+    std::sort(mAsyncFailures.begin(), mAsyncFailures.end(),
+              [](AsyncFailure const& a, AsyncFailure const& b) {
+                  return a.mSeq < b.mSeq;
+              });
+    for (auto const& failure : mAsyncFailures)
+    {
+        CLOG_ERROR(Invariant, "{}", failure.mMessage);
+    }
 }
 
 Json::Value
@@ -98,10 +177,33 @@ InvariantManagerImpl::checkOnBucketApply(
     }
 }
 
+std::string
+InvariantManagerImpl::checkOperation(Invariant& invariant,
+                                     Operation const& operation,
+                                     OperationResult const& opres,
+                                     LedgerTxnDelta const& ltxDelta,
+                                     Hash const& txContentsHash, size_t opIndex)
+{
+    auto result = invariant.checkOnOperationApply(operation, opres, ltxDelta);
+    if (result.empty())
+    {
+        return result;
+    }
+
+    return fmt::format(
+        FMT_STRING(R"(Invariant "{}" does not hold on operation {} of )"
+                   R"(transaction {} in ledger {}: {}{}{})"),
+        invariant.getName(), opIndex, binToHex(txContentsHash),
+        ltxDelta.header.current.ledgerSeq, result, "\n",
+        xdr_to_string(operation, "Operation"));
+}
+
 void
 InvariantManagerImpl::checkOnOperationApply(Operation const& operation,
                                             OperationResult const& opres,
-                                            LedgerTxnDelta const& ltxDelta)
+                                            LedgerTxnDelta const& ltxDelta,
+                                            Hash const& txContentsHash,
+                                            size_t opIndex)
 {
     if (protocolVersionIsBefore(ltxDelta.header.current.ledgerVersion,
                                 ProtocolVersion::V_8))
@@ -109,21 +211,161 @@ InvariantManagerImpl::checkOnOperationApply(Operation const& operation,
         return;
     }
 
+    bool deferred = false;
     for (auto invariant : mEnabled)
     {
-        auto result =
-            invariant->checkOnOperationApply(operation, opres, ltxDelta);
-        if (result.empty())
+        if (checksOperationsAsync() && invariant->isOperationCheckStateless())
         {
+            deferred = true;
             continue;
         }
 
-        auto message = fmt::format(
-            FMT_STRING(R"(Invariant "{}" does not hold on operation: {}{}{})"),
-            invariant->getName(), result, "\n",
-            xdr_to_string(operation, "Operation"));
-        onInvariantFailure(invariant, message,
-                           ltxDelta.header.current.ledgerSeq);
+        auto message = checkOperation(*invariant, operation, opres, ltxDelta,
+                                      txContentsHash, opIndex);
+        if (!message.empty())
+        {
+            onInvariantFailure(invariant, message,
+                               ltxDelta.header.current.ledgerSeq);
+        }
+    }
+
+    if (deferred)
+    {
+        enqueueOperationCheck(operation, opres, ltxDelta, txContentsHash,
+                              opIndex);
+    }
+}
+
+void
+InvariantManagerImpl::enqueueOperationCheck(Operation const& operation,
+                                            OperationResult const& opres,
+                                            LedgerTxnDelta const& ltxDelta,
+                                            Hash const& txContentsHash,
+                                            size_t opIndex)
+{
+    ZoneScoped;
+    releaseAssert(threadIsMain());
+
+    auto snapshot = std::make_unique<OperationSnapshot const>(
+        OperationSnapshot{mNextSeq++, operation, opres,
+                          deepCopyDelta(ltxDelta), txContentsHash, opIndex});
+
+    std::unique_lock<std::mutex> lock(mAsyncMutex);
+    mAsyncCV.wait(lock, [&] {
+        return mPendingChecks.size() < MAX_PENDING_OPERATION_CHECKS;
+    });
+    mPendingChecks.emplace_back(std::move(snapshot));
+    ++mUnfinishedChecks;
+    lock.unlock();
+    mAsyncCV.notify_all();
+}
+
+void
+InvariantManagerImpl::runOperationChecks()
+{
+    std::unique_lock<std::mutex> lock(mAsyncMutex);
+    while (true)
+    {
+        mAsyncCV.wait(lock,
+                      [&] { return !mPendingChecks.empty() || mStopping; });
+        if (mPendingChecks.empty())
+        {
+            // Stopping and fully drained
+            return;
+        }
+
+        auto snapshot = std::move(mPendingChecks.front());
+        mPendingChecks.pop_front();
+        lock.unlock();
+        // Wakes up the main thread if it is waiting for space in the queue
+        mAsyncCV.notify_all();
+
+        std::vector<AsyncFailure> failures;
+        // mEnabled only changes while no check is in flight, see
+        // enableInvariant
+        for (auto const& invariant : mEnabled)
+        {
+            if (!invariant->isOperationCheckStateless())
+            {
+                continue;
+            }
+
+            std::string message;
+            try
+            {
+                message = checkOperation(
+                    *invariant, snapshot->mOperation, snapshot->mResult,
+                    snapshot->mDelta, snapshot->mTxContentsHash,
+                    snapshot->mOpIndex);
+            }
+            catch (std::exception const& e)
+            {
+                message = fmt::format(
+                    FMT_STRING(R"(Invariant "{}" threw on operation {} of )"
+                               R"(transaction {} in ledger {}: {})"),
+                    invariant->getName(), snapshot->mOpIndex,
+                    binToHex(snapshot->mTxContentsHash),
+                    snapshot->mDelta.header.current.ledgerSeq, e.what());
+            }
+            if (!message.empty())
+            {
+                failures.emplace_back(
+                    AsyncFailure{snapshot->mSeq, invariant, std::move(message),
+                                 snapshot->mDelta.header.current.ledgerSeq});
+            }
+        }
+
+        lock.lock();
+        std::move(failures.begin(), failures.end(),
+                  std::back_inserter(mAsyncFailures));
+        --mUnfinishedChecks;
+        mAsyncCV.notify_all();
+    }
+}
+
+std::vector<InvariantManagerImpl::AsyncFailure>
+InvariantManagerImpl::waitForOperationChecks()
+{
+    std::unique_lock<std::mutex> lock(mAsyncMutex);
+    mAsyncCV.wait(lock, [&] { return mUnfinishedChecks == 0; });
+    std::vector<AsyncFailure> failures;
+    failures.swap(mAsyncFailures);
+    return failures;
+}
+
+void
+InvariantManagerImpl::finishOperationChecks()
+{
+    ZoneScoped;
+    releaseAssert(threadIsMain());
+    if (!checksOperationsAsync())
+    {
+        return;
+    }
+
+    std::vector<AsyncFailure> failures;
+    {
+        auto waitTime = mAsyncCheckWaitTime.TimeScope();
+        failures = waitForOperationChecks();
+    }
+    std::sort(failures.begin(), failures.end(),
+              [](AsyncFailure const& a, AsyncFailure const& b) {
+                  return a.mSeq < b.mSeq;
+              });
+
+    for (auto const& failure : failures)
+    {
+        if (mHaltOnAsyncFailure)
+        {
+            onInvariantFailure(failure.mInvariant, failure.mMessage,
+                               failure.mLedger);
+        }
+        else
+        {
+            recordInvariantFailure(failure.mInvariant, failure.mMessage,
+                                   failure.mLedger);
+            CLOG_ERROR(Invariant, "{}", failure.mMessage);
+        }
     }
 }
 
@@ -163,6 +405,13 @@ InvariantManagerImpl::enableInvariant(std::string const& invPattern)
                         invPattern, e.what()));
     }
 
+    if (checksOperationsAsync())
+    {
+        // Worker threads read mEnabled without holding the lock
+        std::unique_lock<std::mutex> lock(mAsyncMutex);
+        mAsyncCV.wait(lock, [&] { return mUnfinishedChecks == 0; });
+    }
+
     bool enabledSome = false;
     for (auto const& inv : mInvariants)
     {
@@ -207,13 +456,21 @@ InvariantManagerImpl::enableInvariant(std::string const& invPattern)
     }
 }
 
+void
+InvariantManagerImpl::recordInvariantFailure(
+    std::shared_ptr<Invariant> invariant, std::string const& message,
+    uint32_t ledger)
+{
+    mInvariantFailureCount.inc();
+    mFailureInformation[invariant->getName()] = {ledger, message};
+}
+
 void
 InvariantManagerImpl::onInvariantFailure(std::shared_ptr<Invariant> invariant,
                                          std::string const& message,
                                          uint32_t ledger)
 {
-    mInvariantFailureCount.inc();
-    mFailureInformation[invariant->getName()] = {ledger, message};
+    recordInvariantFailure(invariant, message, ledger);
     handleInvariantFailure(invariant, message);
 }
 
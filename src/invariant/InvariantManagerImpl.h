@@ -5,23 +5,63 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "invariant/InvariantManager.h"
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace medida
 {
 class MetricsRegistry;
 class Counter;
+class Timer;
 }
 
 namespace caiz
 {
 
+class Config;
+
 class InvariantManagerImpl : public InvariantManager
 {
     std::map<std::string, std::shared_ptr<Invariant>> mInvariants;
     std::vector<std::shared_ptr<Invariant>> mEnabled;
     medida::Counter& mInvariantFailureCount;
+    medida::Timer& mAsyncCheckWaitTime;
+
+    // Asynchronous operation checks. Each applied operation is copied into an
+    // OperationSnapshot that owns deep copies of the entries in its delta,
+    // because the LedgerTxn entries the delta points to keep changing after
+    // the operation is applied. Worker threads check snapshots in any order;
+    // failures are put back into apply order (by mSeq) when they are reported
+    // on the main thread by finishOperationChecks.
+    struct OperationSnapshot;
+
+    struct AsyncFailure
+    {
+        uint64_t mSeq;
+        std::shared_ptr<Invariant> mInvariant;
+        std::string mMessage;
+        uint32_t mLedger;
+    };
+
+    // Bounds the memory held by snapshots; applying blocks while the workers
+    // are this far behind.
+    static constexpr size_t MAX_PENDING_OPERATION_CHECKS = 4096;
+
+    bool const mHaltOnAsyncFailure;
+    uint64_t mNextSeq{0};
+
+    std::mutex mAsyncMutex;
+    std::condition_variable mAsyncCV;
+    std::deque<std::unique_ptr<OperationSnapshot const>> mPendingChecks;
+    // Snapshots queued or being checked
+    size_t mUnfinishedChecks{0};
+    std::vector<AsyncFailure> mAsyncFailures;
+    bool mStopping{false};
+    std::vector<std::thread> mAsyncCheckThreads;
 
     struct InvariantFailureInformation
     {
@@ -31,7 +71,10 @@ class InvariantManagerImpl : public InvariantManager
     std::map<std::string, InvariantFailureInformation> mFailureInformation;
 
   public:
-    InvariantManagerImpl(medida::MetricsRegistry& registry);
+    InvariantManagerImpl(medida::MetricsRegistry& registry, Config const& cfg);
+
+    // Finishes the pending operation checks, logging their failures
+    ~InvariantManagerImpl();
 
     virtual Json::Value getJsonInfo() override;
 
@@ -39,7 +82,11 @@ class InvariantManagerImpl : public InvariantManager
 
     virtual void checkOnOperationApply(Operation const& operation,
                                        OperationResult const& opres,
-                                       LedgerTxnDelta const& ltxDelta) override;
+                                       LedgerTxnDelta const& ltxDelta,
+                                       Hash const& txContentsHash,
+                                       size_t opIndex) override;
+
+    virtual void finishOperationChecks() override;
 
     virtual void checkOnBucketApply(
         std::shared_ptr<Bucket const> bucket, uint32_t ledger, uint32_t level,
@@ -57,6 +104,25 @@ class InvariantManagerImpl : public InvariantManager
 #endif // BUILD_TESTS
 
   private:
+    bool
+    checksOperationsAsync() const
+    {
+        return !mAsyncCheckThreads.empty();
+    }
+
+    std::string checkOperation(Invariant& invariant, Operation const& operation,
+                               OperationResult const& opres,
+                               LedgerTxnDelta const& ltxDelta,
+                               Hash const& txContentsHash, size_t opIndex);
+    void enqueueOperationCheck(Operation const& operation,
+                               OperationResult const& opres,
+                               LedgerTxnDelta const& ltxDelta,
+                               Hash const& txContentsHash, size_t opIndex);
+    void runOperationChecks();
+    std::vector<AsyncFailure> waitForOperationChecks();
+
+    void recordInvariantFailure(std::shared_ptr<Invariant> invariant,
+                                std::string const& message, uint32_t ledger);
     void onInvariantFailure(std::shared_ptr<Invariant> invariant,
                             std::string const& message, uint32_t ledger);
 
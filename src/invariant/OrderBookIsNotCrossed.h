@@ -55,6 +55,12 @@ class OrderBookIsNotCrossed : public Invariant
                           OperationResult const& result,
                           LedgerTxnDelta const& ltxDelta) override;
 
+    bool
+    isOperationCheckStateless() const override
+    {
+        return false;
+    }
+
     OrderBook const&
     getOrderBook() const
     {
@@ -5,6 +5,7 @@
 #include "util/asio.h"
 
 #include "bucket/Bucket.h"
+#include "crypto/Hex.h"
 #include "database/Database.h"
 #include "herder/TxSetFrame.h"
 #include "invariant/Invariant.h"
@@ -202,7 +203,7 @@ TEST_CASE("onOperationApply fail succeed", "[invariant]")
 
         LedgerTxn ltx(app->getLedgerTxnRoot());
         REQUIRE_THROWS_AS(app->getInvariantManager().checkOnOperationApply(
-                              {}, res, ltx.getDelta()),
+                              {}, res, ltx.getDelta(), Hash{}, 0),
                           InvariantDoesNotHold);
     }
     SECTION("Succeed")
@@ -213,6 +214,75 @@ TEST_CASE("onOperationApply fail succeed", "[invariant]")
 
         LedgerTxn ltx(app->getLedgerTxnRoot());
         REQUIRE_NOTHROW(app->getInvariantManager().checkOnOperationApply(
-            {}, res, ltx.getDelta()));
+            {}, res, ltx.getDelta(), Hash{}, 0));
+    }
+}
+
+TEST_CASE("onOperationApply async", "[invariant]")
+{
+    VirtualClock clock;
+    Config cfg = getTestConfig();
+    cfg.EXPERIMENTAL_ASYNC_INVARIANT_CHECK_THREADS = 2;
+
+    OperationResult res;
+    Hash txHash;
+    txHash[0] = 0xab;
+
+    auto checkOperations = [&](Application& app, size_t numOps) {
+        LedgerTxn ltx(app.getLedgerTxnRoot());
+        auto delta = ltx.getDelta();
+        for (size_t i = 0; i < numOps; ++i)
+        {
+            // Failures are only reported at the ledger boundary
+            REQUIRE_NOTHROW(app.getInvariantManager().checkOnOperationApply(
+                {}, res, delta, txHash, i));
+        }
+    };
+
+    SECTION("Fail")
+    {
+        Application::pointer app = createTestApplication(clock, cfg);
+        app->getInvariantManager().registerInvariant<TestInvariant>(0, true);
+        app->getInvariantManager().enableInvariant(
+            TestInvariant::toString(0, true));
+
+        checkOperations(*app, 100);
+        try
+        {
+            app->getInvariantManager().finishOperationChecks();
+            FAIL("expected InvariantDoesNotHold");
+        }
+        catch (InvariantDoesNotHold const& e)
+        {
+            // Reported in apply order, with the operation's coordinates
+            std::string msg = e.what();
+            REQUIRE(msg.find("on operation 0 of transaction " +
+                             binToHex(txHash)) != std::string::npos);
+        }
+        REQUIRE_NOTHROW(app->getInvariantManager().finishOperationChecks());
+    }
+    SECTION("Fail without halting")
+    {
+        cfg.EXPERIMENTAL_ASYNC_INVARIANT_HALT_ON_FAILURE = false;
+        Application::pointer app = createTestApplication(clock, cfg);
+        app->getInvariantManager().registerInvariant<TestInvariant>(0, true);
+        app->getInvariantManager().enableInvariant(
+            TestInvariant::toString(0, true));
+
+        checkOperations(*app, 100);
+        REQUIRE_NOTHROW(app->getInvariantManager().finishOperationChecks());
+        auto info = app->getInvariantManager().getJsonInfo();
+        REQUIRE(info["count"].asInt64() == 100);
+    }
+    SECTION("Succeed")
+    {
+        Application::pointer app = createTestApplication(clock, cfg);
+        app->getInvariantManager().registerInvariant<TestInvariant>(0, false);
+        app->getInvariantManager().enableInvariant(
+            TestInvariant::toString(0, false));
+
+        checkOperations(*app, 100);
+        REQUIRE_NOTHROW(app->getInvariantManager().finishOperationChecks());
+        REQUIRE(app->getInvariantManager().getJsonInfo().empty());
     }
 }
@@ -0,0 +1,172 @@
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/AsyncMetaStreamWriter.h"
+#include "ledger/MetaDebugSegmentIndex.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include "util/XDRStream.h"
+#include <Tracy.hpp>
+#include <medida/timer.h>
+
+namespace caiz
+{
+
+AsyncMetaStreamWriter::AsyncMetaStreamWriter(medida::Timer& writeTimer)
+    : mWriteTimer(writeTimer), mThread([this]() { run(); })
+{
+}
+
+AsyncMetaStreamWriter::~AsyncMetaStreamWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCV.notify_all();
+    mThread.join();
+
+    if (mError)
+    {
+        try
+        {
+            std::rethrow_exception(mError);
+        }
+        catch (std::exception const& e)
+        {
+            CLOG_ERROR(Ledger, "Error writing LedgerCloseMeta: {}", e.what());
+        }
+    }
+}
+
+void
+AsyncMetaStreamWriter::enqueue(std::unique_ptr<LedgerCloseMetaFrame const> meta,
+                               XDROutputFileStream* metaStream,
+                               XDROutputFileStream* metaDebugStream,
+                               MetaDebugSegmentIndex* metaDebugIndex)
+{
+    ZoneScoped;
+    releaseAssert(threadIsMain());
+    releaseAssert(meta);
+    releaseAssert(metaStream || metaDebugStream);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCV.wait(lock, [&] {
+        return mPending.size() < MAX_PENDING_METAS || mError;
+    });
+    if (mError)
+    {
+        std::rethrow_exception(mError);
+    }
+    mPending.emplace_back(PendingMeta{std::move(meta), metaStream,
+                                      metaDebugStream, metaDebugIndex});
+    ++mEnqueued;
+    lock.unlock();
+    mCV.notify_all();
+}
+
+void
+AsyncMetaStreamWriter::waitForStreamWrites()
+{
+    ZoneScoped;
+    releaseAssert(threadIsMain());
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCV.wait(lock, [&] { return mStreamWritten == mEnqueued || mError; });
+    if (mError)
+    {
+        std::rethrow_exception(mError);
+    }
+}
+
+void
+AsyncMetaStreamWriter::waitForWrites()
+{
+    ZoneScoped;
+    releaseAssert(threadIsMain());
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCV.wait(lock, [&] { return mPending.empty() || mError; });
+    if (mError)
+    {
+        std::rethrow_exception(mError);
+    }
+}
+
+void
+AsyncMetaStreamWriter::writeStream(PendingMeta const& pending)
+{
+    ZoneScoped;
+    if (pending.mMetaStream)
+    {
+        pending.mMetaStream->writeOne(pending.mMeta->getXDR());
+        pending.mMetaStream->flush();
+    }
+}
+
+void
+AsyncMetaStreamWriter::writeDebugStream(PendingMeta const& pending)
+{
+    ZoneScoped;
+    if (pending.mMetaDebugStream)
+    {
+        auto const& lcm = pending.mMeta->getXDR();
+        size_t bytesWritten = 0;
+        pending.mMetaDebugStream->writeOne(lcm, nullptr, &bytesWritten);
+        if (pending.mMetaDebugIndex)
+        {
+            pending.mMetaDebugIndex->addRecord(lcm, bytesWritten);
+        }
+    }
+}
+
+void
+AsyncMetaStreamWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true)
+    {
+        mCV.wait(lock, [&] { return !mPending.empty() || mStopping; });
+        if (mPending.empty())
+        {
+            // Stopping and fully drained
+            return;
+        }
+
+        // Keep the meta in the queue while writing it so that the buffer
+        // bound also covers the meta in flight.
+        auto& pending = mPending.front();
+        lock.unlock();
+
+        std::exception_ptr error;
+        try
+        {
+            auto streamWrite = mWriteTimer.TimeScope();
+            writeStream(pending);
+            lock.lock();
+            ++mStreamWritten;
+            lock.unlock();
+            mCV.notify_all();
+            writeDebugStream(pending);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        mPending.pop_front();
+        if (error)
+        {
+            // Stop writing after the first failure: later metas would leave
+            // a gap in the stream.
+            mError = error;
+            mPending.clear();
+            mCV.notify_all();
+            return;
+        }
+        mCV.notify_all();
+    }
+}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/LedgerCloseMetaFrame.h"
+#include "util/NonCopyable.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace medida
+{
+class Timer;
+}
+
+namespace caiz
+{
+
+class MetaDebugSegmentIndex;
+class XDROutputFileStream;
+
+// AsyncMetaStreamWriter moves serializing and writing LedgerCloseMeta off the
+// ledger close path. Metas are handed over to a dedicated writer thread
+// through a small bounded buffer and written in the order they were enqueued,
+// so downstream consumers still see every ledger's meta exactly once and in
+// sequence.
+//
+// Each meta is first written and flushed to the meta stream, then written to
+// the debug stream and index. waitForStreamWrites() is the durability
+// barrier: once it returns, every enqueued meta is flushed to the meta
+// stream. Ledger close calls it before committing the ledger, so a crash can
+// never leave a committed ledger without its meta. The debug stream carries
+// no such guarantee and may still be written while the ledger commits.
+//
+// The writer does not own the output streams or the debug segment index. The
+// owner must call waitForWrites() before closing, rotating or otherwise
+// touching a stream or index that has been passed to enqueue(). Both waits
+// rethrow any error raised on the writer thread.
+class AsyncMetaStreamWriter : public NonMovableOrCopyable
+{
+    struct PendingMeta
+    {
+        std::unique_ptr<LedgerCloseMetaFrame const> mMeta;
+        XDROutputFileStream* mMetaStream;
+        XDROutputFileStream* mMetaDebugStream;
+        MetaDebugSegmentIndex* mMetaDebugIndex;
+    };
+
+    // Bounds the memory held by queued metas. Ledger close waits for each
+    // meta's stream write before committing, so usually only one is pending.
+    static constexpr size_t MAX_PENDING_METAS = 2;
+
+    medida::Timer& mWriteTimer;
+
+    std::mutex mMutex;
+    std::condition_variable mCV;
+    std::deque<PendingMeta> mPending;
+    // number of metas enqueued, and of those flushed to their meta stream
+    uint64_t mEnqueued{0};
+    uint64_t mStreamWritten{0};
+    bool mStopping{false};
+    std::exception_ptr mError;
+
+    std::thread mThread;
+
+    void run();
+    void writeStream(PendingMeta const& pending);
+    void writeDebugStream(PendingMeta const& pending);
+
+  public:
+    explicit AsyncMetaStreamWriter(medida::Timer& writeTimer);
+
+    // Drains all pending metas and joins the writer thread.
+    ~AsyncMetaStreamWriter();
+
+    // Queues meta to be written to metaStream and metaDebugStream (either of
+    // which may be null), recording it in metaDebugIndex if one is given.
+    // Blocks while the buffer is full.
+    void enqueue(std::unique_ptr<LedgerCloseMetaFrame const> meta,
+                 XDROutputFileStream* metaStream,
+                 XDROutputFileStream* metaDebugStream,
+                 MetaDebugSegmentIndex* metaDebugIndex);
+
+    // Blocks until every enqueued meta has been written and flushed to its
+    // meta stream, without waiting for debug stream writes.
+    void waitForStreamWrites();
+
+    // Blocks until every enqueued meta has been completely written.
+    void waitForWrites();
+};
+}
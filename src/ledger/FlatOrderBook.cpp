@@ -0,0 +1,247 @@
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/FlatOrderBook.h"
+#include <algorithm>
+#include <cmath>
+
+namespace caiz
+{
+
+namespace
+{
+// Returns the index of the first of offers, which are sorted from the worst to
+// the best offer, that is not worse than desc
+template <typename Offer>
+size_t
+lowerBound(std::vector<Offer> const& offers, OfferDescriptor const& desc)
+{
+    auto worse = [](Offer const& lhs, OfferDescriptor const& rhs) {
+        return isBetterOffer(rhs, lhs.desc);
+    };
+    auto iter = std::lower_bound(offers.begin(), offers.end(), desc, worse);
+    return iter - offers.begin();
+}
+}
+
+size_t
+FlatOrderBook::maxPending() const
+{
+    auto sqrtSize =
+        static_cast<size_t>(std::sqrt(static_cast<double>(mOffers.size())));
+    return std::max(MIN_MAX_PENDING, sqrtSize);
+}
+
+void
+FlatOrderBook::merge()
+{
+    // Compacting first does not change the contents of the order book, so it
+    // does not matter if resize throws afterwards
+    compact();
+    size_t i = mOffers.size();
+    mOffers.resize(mOffers.size() + mPending.size());
+
+    // Merge from the back, where the best offers are, so that the offers of
+    // mOffers are moved at most once
+    size_t j = mPending.size();
+    size_t next = mOffers.size();
+    while (j > 0)
+    {
+        if (i > 0 && isBetterOffer(mOffers[i - 1].desc, mPending[j - 1].desc))
+        {
+            mOffers[--next] = mOffers[--i];
+        }
+        else
+        {
+            mOffers[--next] = mPending[--j];
+        }
+    }
+    mPending.clear();
+}
+
+void
+FlatOrderBook::compact()
+{
+    if (mNumErased == 0)
+    {
+        return;
+    }
+    mOffers.erase(std::remove_if(mOffers.begin(), mOffers.end(),
+                                 [](Offer const& offer) {
+                                     return offer.key == ERASED;
+                                 }),
+                  mOffers.end());
+    mNumErased = 0;
+}
+
+size_t
+FlatOrderBook::addKey(LedgerKey const& key)
+{
+    if (!mFreeKeys.empty())
+    {
+        LedgerKey copy(key);
+        auto index = mFreeKeys.back();
+        mKeys[index] = std::move(copy);
+        mFreeKeys.pop_back();
+        return index;
+    }
+
+    // Reserve room for every key to be freed, so that removeKey never
+    // allocates
+    mFreeKeys.reserve(mKeys.size() + 1);
+    mKeys.emplace_back(key);
+    return mKeys.size() - 1;
+}
+
+void
+FlatOrderBook::removeKey(size_t index)
+{
+    mFreeKeys.push_back(index);
+}
+
+void
+FlatOrderBook::insert(OfferDescriptor const& desc, LedgerKey const& key)
+{
+    auto index = lowerBound(mOffers, desc);
+    if (index < mOffers.size() && mOffers[index].desc == desc)
+    {
+        if (mOffers[index].key == ERASED)
+        {
+            // The offer is inserted again after being erased, which is what
+            // happens when it is modified, so it takes its old place back
+            mOffers[index].key = addKey(key);
+            --mNumErased;
+        }
+        return;
+    }
+    auto pendingIndex = lowerBound(mPending, desc);
+    if (pendingIndex < mPending.size() && mPending[pendingIndex].desc == desc)
+    {
+        return;
+    }
+
+    if (index == mOffers.size())
+    {
+        // An offer better than all others in the array goes to its back
+        auto keyIndex = addKey(key);
+        try
+        {
+            mOffers.emplace_back(Offer{desc, keyIndex});
+        }
+        catch (...)
+        {
+            removeKey(keyIndex);
+            throw;
+        }
+        return;
+    }
+
+    if (mPending.size() >= maxPending())
+    {
+        merge();
+        pendingIndex = 0;
+    }
+    auto keyIndex = addKey(key);
+    try
+    {
+        mPending.emplace(mPending.begin() + pendingIndex,
+                         Offer{desc, keyIndex});
+    }
+    catch (...)
+    {
+        removeKey(keyIndex);
+        throw;
+    }
+}
+
+void
+FlatOrderBook::erase(OfferDescriptor const& desc)
+{
+    auto pendingIndex = lowerBound(mPending, desc);
+    if (pendingIndex < mPending.size() && mPending[pendingIndex].desc == desc)
+    {
+        removeKey(mPending[pendingIndex].key);
+        mPending.erase(mPending.begin() + pendingIndex);
+        return;
+    }
+
+    auto index = lowerBound(mOffers, desc);
+    if (index == mOffers.size() || !(mOffers[index].desc == desc) ||
+        mOffers[index].key == ERASED)
+    {
+        return;
+    }
+    removeKey(mOffers[index].key);
+    mOffers[index].key = ERASED;
+    ++mNumErased;
+
+    // Marked offers at the back are removed right away, so the best offer of
+    // the array is always the last one
+    while (!mOffers.empty() && mOffers.back().key == ERASED)
+    {
+        mOffers.pop_back();
+        --mNumErased;
+    }
+    if (mNumErased >= maxPending())
+    {
+        compact();
+    }
+}
+
+LedgerKey const*
+FlatOrderBook::best() const
+{
+    if (mPending.empty())
+    {
+        return mOffers.empty() ? nullptr : &mKeys[mOffers.back().key];
+    }
+    if (mOffers.empty() ||
+        isBetterOffer(mPending.back().desc, mOffers.back().desc))
+    {
+        return &mKeys[mPending.back().key];
+    }
+    return &mKeys[mOffers.back().key];
+}
+
+LedgerKey const*
+FlatOrderBook::bestWorseThan(OfferDescriptor const& worseThan) const
+{
+    // Offers worse than worseThan are exactly those before its lower bound
+    Offer const* res = nullptr;
+    auto index = lowerBound(mOffers, worseThan);
+    while (index > 0 && mOffers[index - 1].key == ERASED)
+    {
+        --index;
+    }
+    if (index > 0)
+    {
+        res = &mOffers[index - 1];
+    }
+
+    auto pendingIndex = lowerBound(mPending, worseThan);
+    if (pendingIndex > 0 &&
+        (!res || isBetterOffer(mPending[pendingIndex - 1].desc, res->desc)))
+    {
+        res = &mPending[pendingIndex - 1];
+    }
+    return res ? &mKeys[res->key] : nullptr;
+}
+
+void
+FlatOrderBook::forEachOffer(
+    std::function<void(OfferDescriptor const&, LedgerKey const&)> f) const
+{
+    for (auto const& offer : mOffers)
+    {
+        if (offer.key != ERASED)
+        {
+            f(offer.desc, mKeys[offer.key]);
+        }
+    }
+    for (auto const& offer : mPending)
+    {
+        f(offer.desc, mKeys[offer.key]);
+    }
+}
+}
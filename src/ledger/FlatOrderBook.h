@@ -0,0 +1,98 @@
+#pragma once
+
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/LedgerTxn.h"
+#include <functional>
+#include <vector>
+
+namespace caiz
+{
+
+// FlatOrderBook contains the offers of one asset pair, keyed by their
+// OfferDescriptor and ordered by isBetterOffer. It is what LedgerTxn keeps for
+// each asset pair of its in-memory order book.
+//
+// Offers are kept in a flat array sorted from the worst to the best offer, so
+// that the best offer (which is the one usually consumed) is removed from the
+// back. The array only holds descriptors and the index of the key in mKeys,
+// where keys never move, so searches only touch contiguous memory and moving
+// offers around is cheap.
+//
+// An insert in the middle of the array would still move half of it, so offers
+// are inserted into a small sorted buffer instead, which is merged into the
+// array once it is full. Likewise, an offer erased from the middle of the array
+// is only marked as erased, and marked offers are compacted away once there are
+// as many of them as the buffer can hold. The buffer holds about sqrt(n)
+// offers, so inserts and erases cost O(log n + sqrt(n)) amortized, while best()
+// is O(1) and bestWorseThan() is O(log n + sqrt(n)), whatever the order of
+// inserts, erases and reads.
+class FlatOrderBook
+{
+    struct Offer
+    {
+        OfferDescriptor desc;
+        // Index of the key in mKeys, or ERASED
+        size_t key;
+    };
+    static constexpr size_t ERASED = static_cast<size_t>(-1);
+
+    // Sorted from the worst to the best offer. The back is never marked as
+    // erased.
+    std::vector<Offer> mOffers;
+    size_t mNumErased{0};
+
+    // Offers inserted since the last merge, also sorted from the worst to the
+    // best. An offer is never both in here and in mOffers.
+    std::vector<Offer> mPending;
+
+    // Keys of the offers, and the indices of the unused ones
+    std::vector<LedgerKey> mKeys;
+    std::vector<size_t> mFreeKeys;
+
+    // The most offers that can be pending, or marked as erased, before they
+    // are merged or compacted
+    size_t maxPending() const;
+
+    // merge has the strong exception safety guarantee
+    void merge();
+
+    // compact does not throw
+    void compact();
+
+    // addKey has the strong exception safety guarantee
+    size_t addKey(LedgerKey const& key);
+
+    // removeKey does not throw
+    void removeKey(size_t index);
+
+  public:
+    static constexpr size_t MIN_MAX_PENDING = 64;
+
+    bool
+    empty() const
+    {
+        return mOffers.size() == mNumErased && mPending.empty();
+    }
+
+    // insert has the strong exception safety guarantee. Inserting an offer
+    // that is already in the order book does nothing.
+    void insert(OfferDescriptor const& desc, LedgerKey const& key);
+
+    // erase does not throw
+    void erase(OfferDescriptor const& desc);
+
+    // Returns the key of the best offer, or nullptr if empty.
+    LedgerKey const* best() const;
+
+    // Returns the key of the best offer that is worse than worseThan, or
+    // nullptr if there is none.
+    LedgerKey const* bestWorseThan(OfferDescriptor const& worseThan) const;
+
+    // Calls f on every offer, in no particular order.
+    void forEachOffer(
+        std::function<void(OfferDescriptor const&, LedgerKey const&)> f) const;
+};
+}
@@ -34,10 +34,14 @@ namespace caiz
 
 FlushAndRotateMetaDebugWork::FlushAndRotateMetaDebugWork(
     Application& app, std::filesystem::path const& metaDebugPath,
-    std::unique_ptr<XDROutputFileStream> metaDebugFile, uint32_t ledgersToKeep)
+    std::unique_ptr<XDROutputFileStream> metaDebugFile,
+    std::unique_ptr<MetaDebugSegmentIndex> metaDebugIndex,
+    uint32_t ledgersToKeep)
     : Work(app, "flush and rotate meta-debug", BasicWork::RETRY_NEVER)
     , mMetaDebugPath(metaDebugPath)
     , mMetaDebugFile(std::move(metaDebugFile))
+    , mMetaDebugIndex(std::move(metaDebugIndex))
+    , mIndexed(static_cast<bool>(mMetaDebugIndex))
     , mLedgersToKeep(ledgersToKeep)
 {
 }
@@ -106,9 +110,11 @@ FlushAndRotateMetaDebugWork::doWork()
         // its body to be copy-constructable. So we double-indirect through
         // something copy-constructble: a shared_ptr<unique_ptr<...>>.
         using OwnedStream = std::unique_ptr<XDROutputFileStream>;
+        using OwnedIndex = std::unique_ptr<MetaDebugSegmentIndex>;
         auto file = std::make_shared<OwnedStream>(std::move(mMetaDebugFile));
+        auto index = std::make_shared<OwnedIndex>(std::move(mMetaDebugIndex));
         mApp.postOnBackgroundThread(
-            [weak, file]() {
+            [weak, file, index]() {
                 auto self = weak.lock();
                 if (!self || self->isAborting())
                 {
@@ -133,6 +139,24 @@ FlushAndRotateMetaDebugWork::doWork()
                                  e.what());
                 }
 
+                // Indexed segments get their index written next to them.
+                if (*index)
+                {
+                    auto indexPath = MetaDebugSegmentIndex::getIndexPath(
+                        self->mMetaDebugPath);
+                    try
+                    {
+                        (*index)->save(indexPath);
+                    }
+                    catch (std::exception& e)
+                    {
+                        CLOG_WARNING(Ledger,
+                                     "Failed to write debug metadata index "
+                                     "{}: {}",
+                                     indexPath.string(), e.what());
+                    }
+                }
+
                 // Then post back to main thread.
                 self->mApp.postOnMainThread(
                     [weak]() {
@@ -148,28 +172,33 @@ FlushAndRotateMetaDebugWork::doWork()
         return BasicWork::State::WORK_WAITING;
     }
 
-    // Step 2: wait for the creation and completion of mGzipFileWork.
-    if (!mGzipFileWork)
+    // Step 2: wait for the creation and completion of mGzipFileWork. Indexed
+    // segments are left uncompressed so that readers can seek to the offsets
+    // recorded in the index.
+    if (!mIndexed && !mGzipFileWork)
     {
         CLOG_DEBUG(Ledger, "compressing meta-debug file {}",
                    mMetaDebugPath.string());
         mGzipFileWork = addWork<GzipFileWork>(mMetaDebugPath.string());
         return BasicWork::State::WORK_RUNNING;
     }
-    if (!mGzipFileWork->isDone())
-    {
-        return mGzipFileWork->getState();
-    }
-    if (mGzipFileWork->getState() == State::WORK_SUCCESS)
-    {
-        CLOG_DEBUG(Ledger, "compressed meta-debug file {}",
-                   mMetaDebugPath.string());
-    }
-    else
+    if (mGzipFileWork)
     {
-        CLOG_ERROR(Ledger, "failed to compress meta-debug file {}",
-                   mMetaDebugPath.string());
-        return State::WORK_FAILURE;
+        if (!mGzipFileWork->isDone())
+        {
+            return mGzipFileWork->getState();
+        }
+        if (mGzipFileWork->getState() == State::WORK_SUCCESS)
+        {
+            CLOG_DEBUG(Ledger, "compressed meta-debug file {}",
+                       mMetaDebugPath.string());
+        }
+        else
+        {
+            CLOG_ERROR(Ledger, "failed to compress meta-debug file {}",
+                       mMetaDebugPath.string());
+            return State::WORK_FAILURE;
+        }
     }
 
     // Step 3: synchronously rotate the meta files in the directory, whether
@@ -195,6 +224,7 @@ FlushAndRotateMetaDebugWork::doWork()
             CLOG_DEBUG(Ledger, "trimming old meta-debug file {}", f.string());
             std::error_code ec;
             std::filesystem::remove(f, ec);
+            std::filesystem::remove(MetaDebugSegmentIndex::getIndexPath(f), ec);
             // Ignore errors: there's nothing we can do to "try harder" and
             // failing the work is not helpful. We'll just try again.
         }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "historywork/GzipFileWork.h"
+#include "ledger/MetaDebugSegmentIndex.h"
 #include "util/XDRStream.h"
 #include <filesystem>
 
@@ -15,6 +16,8 @@ class FlushAndRotateMetaDebugWork : public Work
 {
     std::filesystem::path mMetaDebugPath;
     std::unique_ptr<XDROutputFileStream> mMetaDebugFile;
+    std::unique_ptr<MetaDebugSegmentIndex> mMetaDebugIndex;
+    bool const mIndexed;
     std::shared_ptr<GzipFileWork> mGzipFileWork;
     uint32_t mLedgersToKeep;
 
@@ -22,6 +25,7 @@ class FlushAndRotateMetaDebugWork : public Work
     FlushAndRotateMetaDebugWork(
         Application& app, std::filesystem::path const& metaDebugPath,
         std::unique_ptr<XDROutputFileStream> metaDebugFile,
+        std::unique_ptr<MetaDebugSegmentIndex> metaDebugIndex,
         uint32_t ledgersToKeep);
     ~FlushAndRotateMetaDebugWork() = default;
 
@@ -109,6 +109,18 @@ InMemoryLedgerTxnRoot::countObjects(LedgerEntryType let,
     return 0;
 }
 
+UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
+InMemoryLedgerTxnRoot::loadObjects(UnorderedSet<LedgerKey> const& keys,
+                                   soci::session& session) const
+{
+    UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>> res;
+    for (auto const& key : keys)
+    {
+        res.emplace(key, nullptr);
+    }
+    return res;
+}
+
 void
 InMemoryLedgerTxnRoot::deleteObjectsModifiedOnOrAfterLedger(
     uint32_t ledger) const
@@ -68,6 +68,9 @@ class InMemoryLedgerTxnRoot : public AbstractLedgerTxnParent
     uint64_t countObjects(LedgerEntryType let) const override;
     uint64_t countObjects(LedgerEntryType let,
                           LedgerRange const& ledgers) const override;
+    UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
+    loadObjects(UnorderedSet<LedgerKey> const& keys,
+                soci::session& session) const override;
 
     void deleteObjectsModifiedOnOrAfterLedger(uint32_t ledger) const override;
 
@@ -17,6 +17,7 @@
 #include "herder/TxSetFrame.h"
 #include "herder/Upgrades.h"
 #include "history/HistoryManager.h"
+#include "invariant/InvariantManager.h"
 #include "ledger/FlushAndRotateMetaDebugWork.h"
 #include "ledger/LedgerHeaderUtils.h"
 #include "ledger/LedgerRange.h"
@@ -28,6 +29,7 @@
 #include "main/ErrorMessages.h"
 #include "overlay/OverlayManager.h"
 #include "transactions/OperationFrame.h"
+#include "transactions/ParallelSorobanApply.h"
 #include "transactions/TransactionFrameBase.h"
 #include "transactions/TransactionMetaFrame.h"
 #include "transactions/TransactionSQL.h"
@@ -141,6 +143,8 @@ LedgerManagerImpl::LedgerManagerImpl(Application& app)
           app.getMetrics().NewCounter({"ledger", "age", "current-seconds"}))
     , mMetaStreamWriteTime(
           app.getMetrics().NewTimer({"ledger", "metastream", "write"}))
+    , mMetaStreamWaitTime(
+          app.getMetrics().NewTimer({"ledger", "metastream", "wait"}))
     , mLastClose(mApp.getClock().now())
     , mCatchupDuration(
           app.getMetrics().NewTimer({"ledger", "catchup", "duration"}))
@@ -148,6 +152,11 @@ LedgerManagerImpl::LedgerManagerImpl(Application& app)
 
 {
     setupLedgerCloseMetaStream();
+    if (app.getConfig().EXPERIMENTAL_ASYNC_META_STREAM)
+    {
+        mMetaStreamWriter =
+            std::make_unique<AsyncMetaStreamWriter>(mMetaStreamWriteTime);
+    }
 }
 
 void
@@ -643,6 +652,16 @@ LedgerManagerImpl::emitNextMeta()
 {
     releaseAssert(mNextMetaToEmit);
     releaseAssert(mMetaStream || mMetaDebugStream);
+    if (mMetaStreamWriter)
+    {
+        // Serialization and writes happen on the writer thread. The meta
+        // stream write is waited for before the ledger commits, see
+        // waitForMetaStreamDurable.
+        mMetaStreamWriter->enqueue(std::move(mNextMetaToEmit),
+                                   mMetaStream.get(), mMetaDebugStream.get(),
+                                   mMetaDebugIndex.get());
+        return;
+    }
     auto timer = LogSlowExecution("MetaStream write",
                                   LogSlowExecution::Mode::AUTOMATIC_RAII,
                                   "took", std::chrono::milliseconds(100));
@@ -654,11 +673,44 @@ LedgerManagerImpl::emitNextMeta()
     }
     if (mMetaDebugStream)
     {
-        mMetaDebugStream->writeOne(mNextMetaToEmit->getXDR());
+        size_t bytesWritten = 0;
+        mMetaDebugStream->writeOne(mNextMetaToEmit->getXDR(), nullptr,
+                                   &bytesWritten);
+        if (mMetaDebugIndex)
+        {
+            mMetaDebugIndex->addRecord(mNextMetaToEmit->getXDR(),
+                                       bytesWritten);
+        }
     }
     mNextMetaToEmit.reset();
 }
 
+void
+LedgerManagerImpl::waitForMetaStreamDurable()
+{
+    if (mMetaStreamWriter)
+    {
+        auto timer = LogSlowExecution("MetaStream wait",
+                                      LogSlowExecution::Mode::AUTOMATIC_RAII,
+                                      "took", std::chrono::milliseconds(100));
+        auto streamWait = mMetaStreamWaitTime.TimeScope();
+        mMetaStreamWriter->waitForStreamWrites();
+    }
+}
+
+void
+LedgerManagerImpl::waitForMetaStreamWrites()
+{
+    if (mMetaStreamWriter)
+    {
+        auto timer = LogSlowExecution("MetaStream wait",
+                                      LogSlowExecution::Mode::AUTOMATIC_RAII,
+                                      "took", std::chrono::milliseconds(100));
+        auto streamWait = mMetaStreamWaitTime.TimeScope();
+        mMetaStreamWriter->waitForWrites();
+    }
+}
+
 /*
     This is the main method that closes the current ledger based on
 the close context that was computed by SCP or by the historical module
@@ -674,6 +726,15 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
                                      LogSlowExecution::Mode::MANUAL, "",
                                      std::chrono::milliseconds::max()};
 
+    // Operations of the previous ledgers may still be being checked in the
+    // background. Report their invariant failures before applying anything
+    // on top of them.
+    mApp.getInvariantManager().finishOperationChecks();
+
+    // Declared before ltx so that the arena is only reset after every
+    // LedgerTxn of this close has been destroyed
+    Arena::Scope arenaScope(mLedgerTxnArena);
+
     LedgerTxn ltx(mApp.getLedgerTxnRoot());
     auto header = ltx.loadHeader();
     ++header.current().ledgerSeq;
@@ -730,6 +791,10 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
     auto const& sv = ledgerData.getValue();
     header.current().scpValue = sv;
 
+    // Debug stream writes of the previous ledger's meta may still be running;
+    // they must finish before we rotate the streams they are written to.
+    waitForMetaStreamWrites();
+
     maybeResetLedgerCloseMetaDebugStream(header.current().ledgerSeq);
 
     // In addition to the _canonical_ LedgerResultSet hashed into the
@@ -761,15 +826,28 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
     std::vector<TransactionFrameBasePtr> const txs =
         txSet->getTxsInApplyOrder();
 
+    // The txhistory and txfeehistory rows of this ledger are collected while
+    // the transactions are applied and written in bulk once they all are.
+    // They go through the same session, and so the same SQL transaction, as
+    // the rest of the ledger.
+    std::unique_ptr<TransactionHistoryBatch> historyBatch;
+    if (mApp.getConfig().MODE_STORES_HISTORY_MISC)
+    {
+        historyBatch = std::make_unique<TransactionHistoryBatch>(
+            header.current().ledgerSeq, txs.size());
+    }
+
     // first, prefetch source accounts for txset, then charge fees
     prefetchTxSourceIds(txs);
-    processFeesSeqNums(txs, ltx, *txSet, ledgerCloseMeta);
+    processFeesSeqNums(txs, ltx, *txSet, ledgerCloseMeta, historyBatch);
 
     TransactionResultSet txResultSet;
     txResultSet.results.reserve(txs.size());
-    applyTransactions(*txSet, txs, ltx, txResultSet, ledgerCloseMeta);
-    if (mApp.getConfig().MODE_STORES_HISTORY_MISC)
+    applyTransactions(*txSet, txs, ltx, txResultSet, ledgerCloseMeta,
+                      historyBatch);
+    if (historyBatch)
     {
+        historyBatch->flush(mApp.getDatabase());
         storeTxSet(mApp.getDatabase(), ltx.loadHeader().current().ledgerSeq,
                    *txSet);
     }
@@ -818,7 +896,7 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
                 uem.changes = changes;
             }
             // Note: Index from 1 rather than 0 to match the behavior of
-            // storeTransaction and storeTransactionFee.
+            // the txhistory and txfeehistory tables.
             if (mApp.getConfig().MODE_STORES_HISTORY_MISC)
             {
                 Upgrades::storeUpgradeHistory(getDatabase(), ledgerSeq,
@@ -892,6 +970,10 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
     hm.maybeQueueHistoryCheckpoint();
 
     // step 2
+    // Any meta emitted for this ledger (or, with delayed meta, the previous
+    // one) must be in the meta stream before the ledger is committed: a crash
+    // right after the commit would otherwise lose it for good.
+    waitForMetaStreamDurable();
     ltx.commit();
 
     // step 3
@@ -1056,11 +1138,14 @@ LedgerManagerImpl::maybeResetLedgerCloseMetaDebugStream(uint32_t ledgerSeq)
             }
 
             // If we are resetting and already have a stream, hand it off to the
-            // flush-and-rotate work to finish up with.
+            // flush-and-rotate work to finish up with. Any pending async write
+            // must land in the stream before it changes hands.
+            waitForMetaStreamWrites();
             mFlushAndRotateMetaDebugWork =
                 mApp.getWorkScheduler()
                     .scheduleWork<FlushAndRotateMetaDebugWork>(
                         mMetaDebugPath, std::move(mMetaDebugStream),
+                        std::move(mMetaDebugIndex),
                         mApp.getConfig().METADATA_DEBUG_LEDGERS);
             mMetaDebugPath.clear();
         }
@@ -1086,6 +1171,10 @@ LedgerManagerImpl::maybeResetLedgerCloseMetaDebugStream(uint32_t ledgerSeq)
 
                 // If we get to this line, the stream is open.
                 mMetaDebugStream = std::move(tmpStream);
+                if (mApp.getConfig().METADATA_DEBUG_INDEXED_SEGMENTS)
+                {
+                    mMetaDebugIndex = std::make_unique<MetaDebugSegmentIndex>();
+                }
             }
             else
             {
@@ -1164,7 +1253,8 @@ void
 LedgerManagerImpl::processFeesSeqNums(
     std::vector<TransactionFrameBasePtr> const& txs,
     AbstractLedgerTxn& ltxOuter, TxSetFrame const& txSet,
-    std::unique_ptr<LedgerCloseMetaFrame> const& ledgerCloseMeta)
+    std::unique_ptr<LedgerCloseMetaFrame> const& ledgerCloseMeta,
+    std::unique_ptr<TransactionHistoryBatch> const& historyBatch)
 {
     ZoneScoped;
     CLOG_DEBUG(Ledger, "processing fees and sequence numbers");
@@ -1173,7 +1263,6 @@ LedgerManagerImpl::processFeesSeqNums(
     {
         LedgerTxn ltx(ltxOuter);
         auto header = ltx.loadHeader().current();
-        auto ledgerSeq = header.ledgerSeq;
         std::map<AccountID, SequenceNumber> accToMaxSeq;
 
         bool mergeSeen = false;
@@ -1200,13 +1289,6 @@ LedgerManagerImpl::processFeesSeqNums(
                 }
             }
 
-            LedgerEntryChanges changes = ltxTx.getChanges();
-            if (ledgerCloseMeta)
-            {
-                ledgerCloseMeta->pushTxProcessingEntry();
-                ledgerCloseMeta->setLastTxProcessingFeeProcessingChanges(
-                    changes);
-            }
             // Note to future: when we eliminate the txhistory and txfeehistory
             // tables, the following step can be removed.
             //
@@ -1214,10 +1296,19 @@ LedgerManagerImpl::processFeesSeqNums(
             // txs counting from 1, not 0. We preserve this for the time being
             // in case anyone depends on it.
             ++index;
-            if (mApp.getConfig().MODE_STORES_HISTORY_MISC)
+            if (historyBatch || ledgerCloseMeta)
             {
-                storeTransactionFee(mApp.getDatabase(), ledgerSeq, tx, changes,
-                                    index);
+                LedgerEntryChanges changes = ltxTx.getChanges();
+                if (ledgerCloseMeta)
+                {
+                    ledgerCloseMeta->pushTxProcessingEntry();
+                    ledgerCloseMeta->setLastTxProcessingFeeProcessingChanges(
+                        changes);
+                }
+                if (historyBatch)
+                {
+                    historyBatch->storeTransactionFee(tx, changes, index);
+                }
             }
             ltxTx.commit();
         }
@@ -1297,7 +1388,8 @@ void
 LedgerManagerImpl::applyTransactions(
     TxSetFrame const& txSet, std::vector<TransactionFrameBasePtr> const& txs,
     AbstractLedgerTxn& ltx, TransactionResultSet& txResultSet,
-    std::unique_ptr<LedgerCloseMetaFrame> const& ledgerCloseMeta)
+    std::unique_ptr<LedgerCloseMetaFrame> const& ledgerCloseMeta,
+    std::unique_ptr<TransactionHistoryBatch> const& historyBatch)
 {
     ZoneNamedN(txsZone, "applyTransactions", true);
     int index = 0;
@@ -1321,11 +1413,24 @@ LedgerManagerImpl::applyTransactions(
     Hash sorobanBasePrngSeed = txSet.getContentsHash();
     uint64_t txNum{0};
 
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    if (mApp.getConfig().EXPERIMENTAL_PARALLEL_SOROBAN_APPLY_THREADS > 0)
+    {
+        speculativelyExecuteHostFunctions(
+            mApp, ltx, txs, sorobanBasePrngSeed,
+            mApp.getConfig().EXPERIMENTAL_PARALLEL_SOROBAN_APPLY_THREADS);
+    }
+#endif
+
     for (auto tx : txs)
     {
         ZoneNamedN(txZone, "applyTransaction", true);
         auto txTime = mTransactionApply.TimeScope();
-        TransactionMetaFrame tm(ltx.loadHeader().current().ledgerVersion);
+        // Meta is only read by the meta stream and the txhistory table, so
+        // skip building it if neither is in use
+        TransactionMetaFrame tm(ltx.loadHeader().current().ledgerVersion,
+                                ledgerCloseMeta ||
+                                    mApp.getConfig().MODE_STORES_HISTORY_MISC);
         CLOG_DEBUG(Tx, " tx#{} = {} ops={} txseq={} (@ {})", index,
                    hexAbbrev(tx->getContentsHash()), tx->getNumOperations(),
                    tx->getSeqNum(),
@@ -1335,10 +1440,7 @@ LedgerManagerImpl::applyTransactions(
         // If tx can use the seed, we need to compute a sub-seed for it.
         if (tx->isSoroban())
         {
-            SHA256 subSeedSha;
-            subSeedSha.add(sorobanBasePrngSeed);
-            subSeedSha.add(xdr::xdr_to_opaque(txNum));
-            subSeed = subSeedSha.finish();
+            subSeed = getSorobanSubSeed(sorobanBasePrngSeed, txNum);
         }
         ++txNum;
 
@@ -1370,11 +1472,9 @@ LedgerManagerImpl::applyTransactions(
         // txs counting from 1, not 0. We preserve this for the time being
         // in case anyone depends on it.
         ++index;
-        if (mApp.getConfig().MODE_STORES_HISTORY_MISC)
+        if (historyBatch)
         {
-            auto ledgerSeq = ltx.loadHeader().current().ledgerSeq;
-            storeTransaction(mApp.getDatabase(), ledgerSeq, tx, tm.getXDR(),
-                             txResultSet);
+            historyBatch->storeTransaction(tx, tm.getXDR(), txResultSet);
         }
     }
 
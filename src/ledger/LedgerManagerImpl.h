@@ -6,11 +6,14 @@
 #include "util/asio.h"
 
 #include "history/HistoryManager.h"
+#include "ledger/AsyncMetaStreamWriter.h"
 #include "ledger/LedgerCloseMetaFrame.h"
 #include "ledger/LedgerManager.h"
+#include "ledger/MetaDebugSegmentIndex.h"
 #include "ledger/NetworkConfig.h"
 #include "main/PersistentState.h"
 #include "transactions/TransactionFrame.h"
+#include "util/Arena.h"
 #include "util/XDRStream.h"
 #include "xdr/Caiz-ledger.h"
 #include <filesystem>
@@ -36,6 +39,7 @@ class AbstractLedgerTxn;
 class Application;
 class Database;
 class LedgerTxnHeader;
+class TransactionHistoryBatch;
 class BasicWork;
 
 class LedgerManagerImpl : public LedgerManager
@@ -44,6 +48,7 @@ class LedgerManagerImpl : public LedgerManager
     Application& mApp;
     std::unique_ptr<XDROutputFileStream> mMetaStream;
     std::unique_ptr<XDROutputFileStream> mMetaDebugStream;
+    std::unique_ptr<MetaDebugSegmentIndex> mMetaDebugIndex;
     std::weak_ptr<BasicWork> mFlushAndRotateMetaDebugWork;
     std::filesystem::path mMetaDebugPath;
 
@@ -59,6 +64,7 @@ class LedgerManagerImpl : public LedgerManager
     medida::Buckets& mLedgerAgeClosed;
     medida::Counter& mLedgerAge;
     medida::Timer& mMetaStreamWriteTime;
+    medida::Timer& mMetaStreamWaitTime;
     VirtualClock::time_point mLastClose;
     bool mRebuildInMemoryState{false};
 
@@ -67,16 +73,26 @@ class LedgerManagerImpl : public LedgerManager
 
     std::unique_ptr<LedgerCloseMetaFrame> mNextMetaToEmit;
 
+    // Backs the entry maps of every LedgerTxn opened during closeLedger, and
+    // is reset once the ledger is closed.
+    Arena mLedgerTxnArena;
+
+    // Set when EXPERIMENTAL_ASYNC_META_STREAM is enabled. Declared after the
+    // meta streams so that it is destroyed (and drained) before they are.
+    std::unique_ptr<AsyncMetaStreamWriter> mMetaStreamWriter;
+
     void processFeesSeqNums(
         std::vector<TransactionFrameBasePtr> const& txs,
         AbstractLedgerTxn& ltxOuter, TxSetFrame const& txSet,
-        std::unique_ptr<LedgerCloseMetaFrame> const& ledgerCloseMeta);
+        std::unique_ptr<LedgerCloseMetaFrame> const& ledgerCloseMeta,
+        std::unique_ptr<TransactionHistoryBatch> const& historyBatch);
 
     void applyTransactions(
         TxSetFrame const& txSet,
         std::vector<TransactionFrameBasePtr> const& txs, AbstractLedgerTxn& ltx,
         TransactionResultSet& txResultSet,
-        std::unique_ptr<LedgerCloseMetaFrame> const& ledgerCloseMeta);
+        std::unique_ptr<LedgerCloseMetaFrame> const& ledgerCloseMeta,
+        std::unique_ptr<TransactionHistoryBatch> const& historyBatch);
 
     void ledgerClosed(AbstractLedgerTxn& ltx);
 
@@ -90,6 +106,8 @@ class LedgerManagerImpl : public LedgerManager
     void setState(State s);
 
     void emitNextMeta();
+    void waitForMetaStreamDurable();
+    void waitForMetaStreamWrites();
 
   protected:
     virtual void transferLedgerEntriesToBucketList(AbstractLedgerTxn& ltx,
@@ -22,6 +22,7 @@
 #include "xdr/Caiz-ledger-entries.h"
 #include "xdrpp/marshal.h"
 #include <Tracy.hpp>
+#include <atomic>
 #include <soci.h>
 
 namespace caiz
@@ -39,6 +40,14 @@ LedgerEntryPtr::Live(std::shared_ptr<InternalLedgerEntry> const& lePtr)
     return {lePtr, EntryPtrState::LIVE};
 }
 
+LedgerEntryPtr
+LedgerEntryPtr::Shared(std::shared_ptr<InternalLedgerEntry const> const& lePtr)
+{
+    // The entry is never modified through a shared LedgerEntryPtr, see unshare
+    return {std::const_pointer_cast<InternalLedgerEntry>(lePtr),
+            EntryPtrState::LIVE, true};
+}
+
 LedgerEntryPtr
 LedgerEntryPtr::Delete()
 {
@@ -46,8 +55,9 @@ LedgerEntryPtr::Delete()
 }
 
 LedgerEntryPtr::LedgerEntryPtr(
-    std::shared_ptr<InternalLedgerEntry> const& lePtr, EntryPtrState state)
-    : mEntryPtr(lePtr), mState(state)
+    std::shared_ptr<InternalLedgerEntry> const& lePtr, EntryPtrState state,
+    bool shared)
+    : mEntryPtr(lePtr), mState(state), mShared(shared)
 {
     if (lePtr)
     {
@@ -140,10 +150,40 @@ LedgerEntryPtr::mergeFrom(LedgerEntryPtr const& entryPtr)
         throw std::runtime_error("unknown EntryPtrState");
     }
 
+    // An entry that is still shared with a parent stays shared if the child
+    // did not replace it
+    if (mEntryPtr != entryPtr.mEntryPtr)
+    {
+        mShared = entryPtr.mShared;
+    }
+
     // std::shared_ptr<...>::operator= does not throw
     mEntryPtr = entryPtr.get();
 }
 
+#ifdef BUILD_TESTS
+static std::atomic<uint64_t> gNumUnshared{0};
+
+uint64_t
+LedgerEntryPtr::getNumUnsharedForTesting()
+{
+    return gNumUnshared;
+}
+#endif // BUILD_TESTS
+
+void
+LedgerEntryPtr::unshare()
+{
+    if (mShared)
+    {
+        mEntryPtr = std::make_shared<InternalLedgerEntry>(*mEntryPtr);
+        mShared = false;
+#ifdef BUILD_TESTS
+        ++gNumUnshared;
+#endif // BUILD_TESTS
+    }
+}
+
 EntryPtrState
 LedgerEntryPtr::getState() const
 {
@@ -168,6 +208,12 @@ LedgerEntryPtr::isDeleted() const
     return mState == EntryPtrState::DELETED;
 }
 
+bool
+LedgerEntryPtr::isShared() const
+{
+    return mShared;
+}
+
 template <typename KeySetT>
 UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
 populateLoadedEntries(KeySetT const& keys,
@@ -348,6 +394,8 @@ LedgerTxn::Impl::Impl(LedgerTxn& self, AbstractLedgerTxnParent& parent,
     : mParent(parent)
     , mChild(nullptr)
     , mHeader(std::make_unique<LedgerHeader>(mParent.getHeader()))
+    , mEntry(EntryMap::allocator_type(Arena::current()))
+    , mActive(ActiveMap::allocator_type(Arena::current()))
     , mShouldUpdateLastModified(shouldUpdateLastModified)
     , mIsSealed(false)
     , mConsistency(LedgerTxnConsistency::EXACT)
@@ -1018,14 +1066,47 @@ LedgerTxn::Impl::getBestOffer(Asset const& buying, Asset const& selling)
 
     AssetPair const assets{buying, selling};
 
+    auto iter = mBestOfferFrontier.find(assets);
+    if (iter != mBestOfferFrontier.end())
+    {
+        if (!iter->second.mOffers.empty())
+        {
+            return iter->second.mOffers.front();
+        }
+        if (iter->second.mComplete)
+        {
+            return nullptr;
+        }
+    }
+
+    auto best = computeBestOffer(buying, selling);
+
+    // The frontier for assets is empty here (if it exists at all), so best
+    // starts it.
+    auto& frontier = mBestOfferFrontier[assets];
+    if (best)
+    {
+        appendToBestOfferFrontier(frontier, assets, best);
+    }
+    else
+    {
+        frontier.mComplete = true;
+    }
+    return best;
+}
+
+std::shared_ptr<LedgerEntry const>
+LedgerTxn::Impl::computeBestOffer(Asset const& buying, Asset const& selling)
+{
+    AssetPair const assets{buying, selling};
+
     std::shared_ptr<LedgerEntry const> selfBest;
     auto ob = findOrderBook(buying, selling);
     if (ob)
     {
-        auto& offers = *ob;
-        if (!offers.empty())
+        if (auto key = ob->best())
         {
-            auto entryIter = mEntry.find(offers.begin()->second);
+            auto entryIter = mEntry.find(*key);
             if (entryIter == mEntry.end() || entryIter->second.isDeleted())
             {
                 throw std::runtime_error("invalid order book state");
@@ -1128,15 +1209,64 @@ LedgerTxn::Impl::getBestOffer(Asset const& buying, Asset const& selling,
 
     AssetPair const assets{buying, selling};
 
+    // The frontier is a prefix of the order book, so the first cached offer
+    // that is worse than worseThan is the answer if there is one. Otherwise
+    // the answer can only extend the frontier if worseThan is the last cached
+    // offer; anything else would leave a gap.
+    bool extendFrontier = false;
+    auto iter = mBestOfferFrontier.find(assets);
+    if (iter != mBestOfferFrontier.end())
+    {
+        auto const& offers = iter->second.mOffers;
+        auto next = std::partition_point(
+            offers.begin(), offers.end(),
+            [&](std::shared_ptr<LedgerEntry const> const& le) {
+                return !isBetterOffer(worseThan, *le);
+            });
+        if (next != offers.end())
+        {
+            return *next;
+        }
+        if (iter->second.mComplete)
+        {
+            return nullptr;
+        }
+        if (!offers.empty())
+        {
+            auto const& oe = offers.back()->data.offer();
+            extendFrontier = oe.offerID == worseThan.offerID &&
+                             oe.price == worseThan.price;
+        }
+    }
+
+    auto best = computeBestOffer(buying, selling, worseThan);
+
+    if (extendFrontier)
+    {
+        auto& frontier = mBestOfferFrontier.at(assets);
+        if (best)
+        {
+            appendToBestOfferFrontier(frontier, assets, best);
+        }
+        else
+        {
+            frontier.mComplete = true;
+        }
+    }
+    return best;
+}
+
+std::shared_ptr<LedgerEntry const>
+LedgerTxn::Impl::computeBestOffer(Asset const& buying, Asset const& selling,
+                                  OfferDescriptor const& worseThan)
+{
     std::shared_ptr<LedgerEntry const> selfBest;
     auto ob = findOrderBook(buying, selling);
     if (ob)
     {
-        auto const& offers = *ob;
-        auto iter = offers.upper_bound(worseThan);
-        if (iter != offers.end())
+        if (auto key = ob->bestWorseThan(worseThan))
         {
-            auto entryIter = mEntry.find(iter->second);
+            auto entryIter = mEntry.find(*key);
             if (entryIter == mEntry.end() || entryIter->second.isDeleted())
             {
                 throw std::runtime_error("invalid order book state");
@@ -1509,7 +1639,7 @@ std::shared_ptr<InternalLedgerEntry const>
 LedgerTxn::getNewestVersion(InternalLedgerKey const& key,
                             bool loadExpiredEntry) const
 {
-    return getImpl()->getNewestVersion(key, loadExpiredEntry);
+    return getImpl()->exportNewestVersion(key, loadExpiredEntry);
 }
 
 std::shared_ptr<InternalLedgerEntry const>
@@ -1524,6 +1654,46 @@ LedgerTxn::Impl::getNewestVersion(InternalLedgerKey const& key,
     return mParent.getNewestVersion(key, loadExpiredEntry);
 }
 
+std::shared_ptr<InternalLedgerEntry const>
+LedgerTxn::Impl::exportNewestVersion(InternalLedgerKey const& key,
+                                     bool loadExpiredEntry)
+{
+    // Callers other than a child may keep the result while this LedgerTxn
+    // modifies the entry in place, and expect to observe those modifications
+    // (the account cache of TransactionFrame before protocol 8 relies on
+    // this), so they must not be handed an entry that is still shared with
+    // the parent. A child never keeps what it is handed past its own lifetime,
+    // during which this LedgerTxn cannot be modified.
+    if (!mChild)
+    {
+        auto iter = mEntry.find(key);
+        if (iter != mEntry.end())
+        {
+            iter->second.unshare();
+            return iter->second.get();
+        }
+    }
+    return getNewestVersion(key, loadExpiredEntry);
+}
+
+InternalLedgerEntry&
+LedgerTxn::unshareEntry(InternalLedgerKey const& key)
+{
+    return getImpl()->unshareEntry(key);
+}
+
+InternalLedgerEntry&
+LedgerTxn::Impl::unshareEntry(InternalLedgerKey const& key)
+{
+    auto iter = mEntry.find(key);
+    if (iter == mEntry.end() || iter->second.isDeleted())
+    {
+        throw std::runtime_error("unsharing an entry that is not recorded");
+    }
+    iter->second.unshare();
+    return *iter->second;
+}
+
 std::pair<std::shared_ptr<InternalLedgerEntry const>,
           LedgerTxn::Impl::EntryMap::iterator>
 LedgerTxn::Impl::getNewestVersionEntryMap(InternalLedgerKey const& key)
@@ -1673,12 +1843,13 @@ LedgerTxn::Impl::load(LedgerTxn& self, InternalLedgerKey const& key)
     }
     else
     {
-        currentEntryPtr = LedgerEntryPtr::Live(
-            std::make_shared<InternalLedgerEntry>(*newest.first));
+        // Share the parent's entry until it is first modified
+        currentEntryPtr = LedgerEntryPtr::Shared(newest.first);
     }
 
     releaseAssert(currentEntryPtr.has_value());
-    auto impl = LedgerTxnEntry::makeSharedImpl(self, *currentEntryPtr->get());
+    auto impl = LedgerTxnEntry::makeSharedImpl(
+        self, *currentEntryPtr->get(), currentEntryPtr->isShared());
 
     // Set the key to active before constructing the LedgerTxnEntry, as this
     // can throw and the LedgerTxnEntry destructor requires that mActive
@@ -1728,6 +1899,7 @@ LedgerTxn::Impl::loadAllOffers(LedgerTxn& self)
         // std::less<LedgerKey>, so this should not throw when swapped)
         mEntry.swap(previousEntries);
         mMultiOrderBook.swap(previousMultiOrderBook);
+        clearBestOfferFrontier();
         throw;
     }
 }
@@ -1874,6 +2046,7 @@ LedgerTxn::Impl::loadOffersByAccountAndAsset(LedgerTxn& self,
         // std::less<LedgerKey>, so this should not throw when swapped)
         mEntry.swap(previousEntries);
         mMultiOrderBook.swap(previousMultiOrderBook);
+        clearBestOfferFrontier();
         throw;
     }
 }
@@ -1941,7 +2114,7 @@ LedgerTxn::Impl::loadWithoutRecord(LedgerTxn& self,
         return {};
     }
 
-    auto impl = ConstLedgerTxnEntry::makeSharedImpl(self, *newest);
+    auto impl = ConstLedgerTxnEntry::makeSharedImpl(self, newest);
 
     // Set the key to active before constructing the ConstLedgerTxnEntry, as
     // this can throw and the LedgerTxnEntry destructor requires that mActive
@@ -1977,6 +2150,7 @@ LedgerTxn::Impl::rollback() noexcept
 
     mEntry.clear();
     mMultiOrderBook.clear();
+    clearBestOfferFrontier();
     mActive.clear();
     mActiveHeader.reset();
     mIsSealed = true;
@@ -2032,6 +2206,13 @@ LedgerTxn::countObjects(LedgerEntryType let, LedgerRange const& ledgers) const
     throw std::runtime_error("called countObjects on non-root LedgerTxn");
 }
 
+UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
+LedgerTxn::loadObjects(UnorderedSet<LedgerKey> const& keys,
+                       soci::session& session) const
+{
+    throw std::runtime_error("called loadObjects on non-root LedgerTxn");
+}
+
 void
 LedgerTxn::deleteObjectsModifiedOnOrAfterLedger(uint32_t ledger) const
 {
@@ -2140,8 +2321,11 @@ LedgerTxn::Impl::maybeUpdateLastModified() noexcept
         if (!kv.second.isDeleted())
         {
             if (mShouldUpdateLastModified &&
-                entry->type() == InternalLedgerEntryType::LEDGER_ENTRY)
+                entry->type() == InternalLedgerEntryType::LEDGER_ENTRY &&
+                entry->ledgerEntry().lastModifiedLedgerSeq !=
+                    mHeader->ledgerSeq)
             {
+                entry.unshare();
                 entry->ledgerEntry().lastModifiedLedgerSeq = mHeader->ledgerSeq;
             }
         }
@@ -2159,6 +2343,7 @@ LedgerTxn::Impl::maybeUpdateLastModifiedThenInvokeThenSeal(
         f(mEntry);
 
         mMultiOrderBook.clear();
+        clearBestOfferFrontier();
         mActive.clear();
         mActiveHeader.reset();
         mIsSealed = true;
@@ -2173,45 +2358,25 @@ void
 LedgerTxn::Impl::removeFromOrderBookIfExists(LedgerEntry const& le)
 {
     auto const& oe = le.data.offer();
-    auto mobIterBuying = mMultiOrderBook.find(oe.buying);
-    if (mobIterBuying != mMultiOrderBook.end())
+    auto mobIter = mMultiOrderBook.find({oe.buying, oe.selling});
+    if (mobIter != mMultiOrderBook.end())
     {
-        auto& mobBuying = mobIterBuying->second;
-        auto mobIterSelling = mobBuying.find(oe.selling);
-        if (mobIterSelling != mobBuying.end())
+        auto& ob = mobIter->second;
+        ob.erase({oe.price, oe.offerID});
+        if (ob.empty())
         {
-            auto& mobSelling = mobIterSelling->second;
-            auto obIter = mobSelling.find({oe.price, oe.offerID});
-            if (obIter != mobSelling.end())
-            {
-                mobSelling.erase(obIter);
-
-                if (mobSelling.empty())
-                {
-                    mobBuying.erase(mobIterSelling);
-                    if (mobBuying.empty())
-                    {
-                        mMultiOrderBook.erase(mobIterBuying);
-                    }
-                }
-            }
+            mMultiOrderBook.erase(mobIter);
         }
     }
 }
 
-LedgerTxn::Impl::OrderBook*
+FlatOrderBook*
 LedgerTxn::Impl::findOrderBook(Asset const& buying, Asset const& selling)
 {
-    auto mobIterBuying = mMultiOrderBook.find(buying);
-    if (mobIterBuying != mMultiOrderBook.end())
+    auto mobIter = mMultiOrderBook.find({buying, selling});
+    if (mobIter != mMultiOrderBook.end())
     {
-        auto& mobBuying = mobIterBuying->second;
-        auto mobIterSelling = mobBuying.find(selling);
-        if (mobIterSelling != mobBuying.end())
-        {
-            auto& mobSelling = mobIterSelling->second;
-            return &mobSelling;
-        }
+        return &mobIter->second;
     }
     return nullptr;
 }
@@ -2306,6 +2471,7 @@ LedgerTxn::Impl::updateEntry(InternalLedgerKey const& key,
         auto const& le = (*keyHint)->second->ledgerEntry();
         removeFromOrderBookIfExists(le);
     }
+    updateBestOfferFrontier(key.ledgerKey(), lePtr, effectiveActive);
 
     // We only insert the new offer into the order book if it exists and is not
     // active. Otherwise, we just record the update in mEntry and return.
@@ -2313,12 +2479,102 @@ LedgerTxn::Impl::updateEntry(InternalLedgerKey const& key,
     {
         auto const& oe = lePtr->ledgerEntry().data.offer();
 
-        auto& ob = mMultiOrderBook[oe.buying][oe.selling];
-        ob.emplace(OfferDescriptor{oe.price, oe.offerID}, key.ledgerKey());
+        auto& ob = mMultiOrderBook[{oe.buying, oe.selling}];
+        ob.insert(OfferDescriptor{oe.price, oe.offerID}, key.ledgerKey());
     }
     recordEntry();
 }
 
+void
+LedgerTxn::Impl::updateBestOfferFrontier(LedgerKey const& key,
+                                         LedgerEntryPtr const& lePtr,
+                                         bool effectiveActive) noexcept
+{
+    if (mBestOfferFrontier.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        // Whatever happened to the offer, its previous state no longer belongs
+        // in the frontier. Removing an offer from a prefix of the order book
+        // leaves a prefix of the order book.
+        auto indexIter = mBestOfferFrontierIndex.find(key);
+        if (indexIter != mBestOfferFrontierIndex.end())
+        {
+            auto& offers = mBestOfferFrontier.at(indexIter->second).mOffers;
+            auto offerID = key.offer().offerID;
+            offers.erase(std::find_if(
+                offers.begin(), offers.end(),
+                [&](std::shared_ptr<LedgerEntry const> const& le) {
+                    return le->data.offer().offerID == offerID;
+                }));
+            mBestOfferFrontierIndex.erase(indexIter);
+        }
+
+        // A live offer that is not active joins the order book. It only
+        // belongs in the frontier if it is better than the last cached offer,
+        // or if the frontier already holds the whole order book.
+        if (lePtr.isDeleted() || effectiveActive)
+        {
+            return;
+        }
+        auto const& le = lePtr->ledgerEntry();
+        auto const& oe = le.data.offer();
+        AssetPair const assets{oe.buying, oe.selling};
+        auto iter = mBestOfferFrontier.find(assets);
+        if (iter == mBestOfferFrontier.end())
+        {
+            return;
+        }
+        auto& frontier = iter->second;
+        if (frontier.mComplete ||
+            (!frontier.mOffers.empty() &&
+             isBetterOffer(le, *frontier.mOffers.back())))
+        {
+            auto pos = std::partition_point(
+                frontier.mOffers.begin(), frontier.mOffers.end(),
+                [&](std::shared_ptr<LedgerEntry const> const& cached) {
+                    return isBetterOffer(*cached, le);
+                });
+            frontier.mOffers.emplace(pos,
+                                     std::make_shared<LedgerEntry const>(le));
+            mBestOfferFrontierIndex.emplace(key, assets);
+        }
+    }
+    catch (...)
+    {
+        clearBestOfferFrontier();
+    }
+}
+
+void
+LedgerTxn::Impl::appendToBestOfferFrontier(
+    BestOfferFrontier& frontier, AssetPair const& assets,
+    std::shared_ptr<LedgerEntry const> const& offer)
+{
+    // The offer is added before it is indexed, and removed again if indexing
+    // fails, so the index never refers to an offer missing from the frontier
+    frontier.mOffers.emplace_back(offer);
+    try
+    {
+        mBestOfferFrontierIndex.emplace(LedgerEntryKey(*offer), assets);
+    }
+    catch (...)
+    {
+        frontier.mOffers.pop_back();
+        throw;
+    }
+}
+
+void
+LedgerTxn::Impl::clearBestOfferFrontier() noexcept
+{
+    mBestOfferFrontier.clear();
+    mBestOfferFrontierIndex.clear();
+}
+
 static bool
 isWorseThan(std::shared_ptr<OfferDescriptor const> const& lhs,
             std::shared_ptr<OfferDescriptor const> const& rhs)
@@ -2427,13 +2683,13 @@ LedgerTxn::Impl::getOrderBook() const
                  std::map<OfferDescriptor, LedgerKey, IsBetterOfferComparator>,
                  AssetPairHash>
         res;
-    for (auto& b : mMultiOrderBook)
+    for (auto const& [assets, ob] : mMultiOrderBook)
     {
-        for (auto& s : b.second)
-        {
-            AssetPair p{b.first, s.first};
-            res[p].insert(s.second.begin(), s.second.end());
-        }
+        auto& offers = res[assets];
+        ob.forEachOffer(
+            [&](OfferDescriptor const& desc, LedgerKey const& key) {
+                offers.emplace(desc, key);
+            });
     }
     return res;
 }
@@ -2946,6 +3202,67 @@ LedgerTxnRoot::Impl::countObjects(LedgerEntryType let,
     return count;
 }
 
+UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
+LedgerTxnRoot::loadObjects(UnorderedSet<LedgerKey> const& keys,
+                           soci::session& session) const
+{
+    return mImpl->loadObjects(keys, session);
+}
+
+UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
+LedgerTxnRoot::Impl::loadObjects(UnorderedSet<LedgerKey> const& keys,
+                                 soci::session& session) const
+{
+    ZoneScoped;
+    std::map<LedgerEntryType, UnorderedSet<LedgerKey>> keysByType;
+    for (auto const& key : keys)
+    {
+        keysByType[key.type()].emplace(key);
+    }
+
+    UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>> res;
+    for (auto const& [let, keysOfType] : keysByType)
+    {
+        UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>> loaded;
+        switch (let)
+        {
+        case ACCOUNT:
+            loaded = bulkLoadAccounts(keysOfType, session);
+            break;
+        case TRUSTLINE:
+            loaded = bulkLoadTrustLines(keysOfType, session);
+            break;
+        case OFFER:
+            loaded = bulkLoadOffers(keysOfType, session);
+            break;
+        case DATA:
+            loaded = bulkLoadData(keysOfType, session);
+            break;
+        case CLAIMABLE_BALANCE:
+            loaded = bulkLoadClaimableBalance(keysOfType, session);
+            break;
+        case LIQUIDITY_POOL:
+            loaded = bulkLoadLiquidityPool(keysOfType, session);
+            break;
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+        case CONTRACT_DATA:
+            loaded = bulkLoadContractData(keysOfType, session);
+            break;
+        case CONTRACT_CODE:
+            loaded = bulkLoadContractCode(keysOfType, session);
+            break;
+        case CONFIG_SETTING:
+            loaded = bulkLoadConfigSettings(keysOfType, session);
+            break;
+#endif
+        default:
+            throw std::runtime_error("Unknown key type");
+        }
+        res.insert(loaded.begin(), loaded.end());
+    }
+    return res;
+}
+
 void
 LedgerTxnRoot::deleteObjectsModifiedOnOrAfterLedger(uint32_t ledger) const
 {
@@ -3067,6 +3384,7 @@ LedgerTxnRoot::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
     }
     else
     {
+        auto& session = mApp.getDatabase().getSession();
         UnorderedSet<LedgerKey> accounts;
         UnorderedSet<LedgerKey> offers;
         UnorderedSet<LedgerKey> trustlines;
@@ -3087,7 +3405,7 @@ LedgerTxnRoot::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
                 insertIfNotLoaded(accounts, key);
                 if (accounts.size() == mBulkLoadBatchSize)
                 {
-                    cacheResult(bulkLoadAccounts(accounts));
+                    cacheResult(bulkLoadAccounts(accounts, session));
                     accounts.clear();
                 }
                 break;
@@ -3095,7 +3413,7 @@ LedgerTxnRoot::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
                 insertIfNotLoaded(offers, key);
                 if (offers.size() == mBulkLoadBatchSize)
                 {
-                    cacheResult(bulkLoadOffers(offers));
+                    cacheResult(bulkLoadOffers(offers, session));
                     offers.clear();
                 }
                 break;
@@ -3103,7 +3421,7 @@ LedgerTxnRoot::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
                 insertIfNotLoaded(trustlines, key);
                 if (trustlines.size() == mBulkLoadBatchSize)
                 {
-                    cacheResult(bulkLoadTrustLines(trustlines));
+                    cacheResult(bulkLoadTrustLines(trustlines, session));
                     trustlines.clear();
                 }
                 break;
@@ -3111,7 +3429,7 @@ LedgerTxnRoot::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
                 insertIfNotLoaded(data, key);
                 if (data.size() == mBulkLoadBatchSize)
                 {
-                    cacheResult(bulkLoadData(data));
+                    cacheResult(bulkLoadData(data, session));
                     data.clear();
                 }
                 break;
@@ -3119,7 +3437,8 @@ LedgerTxnRoot::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
                 insertIfNotLoaded(claimablebalance, key);
                 if (claimablebalance.size() == mBulkLoadBatchSize)
                 {
-                    cacheResult(bulkLoadClaimableBalance(claimablebalance));
+                    cacheResult(
+                        bulkLoadClaimableBalance(claimablebalance, session));
                     claimablebalance.clear();
                 }
                 break;
@@ -3127,7 +3446,7 @@ LedgerTxnRoot::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
                 insertIfNotLoaded(liquiditypool, key);
                 if (liquiditypool.size() == mBulkLoadBatchSize)
                 {
-                    cacheResult(bulkLoadLiquidityPool(liquiditypool));
+                    cacheResult(bulkLoadLiquidityPool(liquiditypool, session));
                     liquiditypool.clear();
                 }
                 break;
@@ -3136,7 +3455,7 @@ LedgerTxnRoot::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
                 insertIfNotLoaded(contractdata, key);
                 if (contractdata.size() == mBulkLoadBatchSize)
                 {
-                    cacheResult(bulkLoadContractData(contractdata));
+                    cacheResult(bulkLoadContractData(contractdata, session));
                     contractdata.clear();
                 }
                 break;
@@ -3144,7 +3463,7 @@ LedgerTxnRoot::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
                 insertIfNotLoaded(contractCode, key);
                 if (contractCode.size() == mBulkLoadBatchSize)
                 {
-                    cacheResult(bulkLoadContractCode(contractCode));
+                    cacheResult(bulkLoadContractCode(contractCode, session));
                     contractCode.clear();
                 }
                 break;
@@ -3152,7 +3471,8 @@ LedgerTxnRoot::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
                 insertIfNotLoaded(configSettings, key);
                 if (configSettings.size() == mBulkLoadBatchSize)
                 {
-                    cacheResult(bulkLoadConfigSettings(configSettings));
+                    cacheResult(
+                        bulkLoadConfigSettings(configSettings, session));
                     configSettings.clear();
                 }
                 break;
@@ -3161,16 +3481,16 @@ LedgerTxnRoot::Impl::prefetch(UnorderedSet<LedgerKey> const& keys)
         }
 
         //  Prefetch whatever is remaining
-        cacheResult(bulkLoadAccounts(accounts));
-        cacheResult(bulkLoadOffers(offers));
-        cacheResult(bulkLoadTrustLines(trustlines));
-        cacheResult(bulkLoadData(data));
-        cacheResult(bulkLoadClaimableBalance(claimablebalance));
-        cacheResult(bulkLoadLiquidityPool(liquiditypool));
+        cacheResult(bulkLoadAccounts(accounts, session));
+        cacheResult(bulkLoadOffers(offers, session));
+        cacheResult(bulkLoadTrustLines(trustlines, session));
+        cacheResult(bulkLoadData(data, session));
+        cacheResult(bulkLoadClaimableBalance(claimablebalance, session));
+        cacheResult(bulkLoadLiquidityPool(liquiditypool, session));
 #ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
-        cacheResult(bulkLoadConfigSettings(configSettings));
-        cacheResult(bulkLoadContractData(contractdata));
-        cacheResult(bulkLoadContractCode(contractCode));
+        cacheResult(bulkLoadConfigSettings(configSettings, session));
+        cacheResult(bulkLoadContractData(contractdata, session));
+        cacheResult(bulkLoadContractCode(contractCode, session));
 #endif
     }
 
@@ -3333,19 +3653,20 @@ LedgerTxnRoot::getBestOffer(Asset const& buying, Asset const& selling,
 #endif
 }
 
-static std::deque<LedgerEntry>::const_iterator
-findIncludedOffer(std::deque<LedgerEntry>::const_iterator iter,
-                  std::deque<LedgerEntry>::const_iterator const& end,
+// Returns the index of the best offer in offers[start:] that is worse than
+// *worseThan (or of the best offer if !worseThan), or offers.size() if there
+// is none.
+static size_t
+findIncludedOffer(std::vector<OfferDescriptor> const& offers, size_t start,
                   OfferDescriptor const* worseThan)
 {
     if (worseThan)
     {
-        iter = std::upper_bound(
-            iter, end, *worseThan,
-            static_cast<bool (*)(OfferDescriptor const&, LedgerEntry const&)>(
-                isBetterOffer));
+        return std::upper_bound(offers.begin() + start, offers.end(),
+                                *worseThan, IsBetterOfferComparator()) -
+               offers.begin();
     }
-    return iter;
+    return start;
 }
 
 std::deque<LedgerEntry>::const_iterator
@@ -3391,6 +3712,11 @@ LedgerTxnRoot::Impl::loadNextBestOffersIntoCache(BestOffersEntryPtr cached,
 
     cached->allLoaded =
         static_cast<size_t>(std::distance(iter, offers.cend())) < BATCH_SIZE;
+    for (auto newIter = iter; newIter != offers.cend(); ++newIter)
+    {
+        auto const& oe = newIter->data.offer();
+        cached->descriptors.emplace_back(OfferDescriptor{oe.price, oe.offerID});
+    }
     return iter;
 }
 
@@ -3458,12 +3784,15 @@ LedgerTxnRoot::Impl::getBestOffer(Asset const& buying, Asset const& selling,
     // Batch-load best offers until an offer worse than *worseThan is found
     // (or until any offer is found if !worseThan)
     size_t initialBestOffersSize = offers.size();
-    auto iter = findIncludedOffer(offers.cbegin(), offers.cend(), worseThan);
-    while (iter == offers.cend() && !cached->allLoaded)
+    auto index = findIncludedOffer(cached->descriptors, 0, worseThan);
+    while (index == offers.size() && !cached->allLoaded)
     {
-        iter = loadNextBestOffersIntoCache(cached, buying, selling);
-        iter = findIncludedOffer(iter, offers.cend(), worseThan);
+        auto newIter = loadNextBestOffersIntoCache(cached, buying, selling);
+        index = findIncludedOffer(
+            cached->descriptors,
+            static_cast<size_t>(newIter - offers.cbegin()), worseThan);
     }
+    auto iter = offers.cbegin() + index;
 
     bool newOffersLoaded = offers.size() != initialBestOffersSize;
     // Populate entry cache with upcoming best offers and prefetch associated
@@ -3866,7 +4195,7 @@ LedgerTxnRoot::Impl::getFromBestOffers(Asset const& buying,
         }
 
         auto emptyPtr =
-            std::make_shared<BestOffersEntry>(BestOffersEntry{{}, false});
+            std::make_shared<BestOffersEntry>(BestOffersEntry{{}, false, {}});
         mBestOffers.emplace(offersKey, emptyPtr);
         return emptyPtr;
     }
@@ -173,6 +173,11 @@
 //    accesses to a parent's entries when a child is open.
 //
 
+namespace soci
+{
+class session;
+}
+
 namespace caiz
 {
 
@@ -183,6 +188,11 @@ namespace caiz
   1. INIT - InternalLedgerEntry was created at this level
   2. LIVE - InternalLedgerEntry was modified at this level
   3. DELETED - InternalLedgerEntry was deleted at this level
+
+  A LIVE LedgerEntryPtr can also be shared: it then points at the
+  InternalLedgerEntry of a parent, which a load at this level has not yet
+  modified. The parent cannot change while this level is open, so the entry
+  is only copied (by unshare) when it is first modified at this level.
 */
 enum class EntryPtrState
 {
@@ -198,12 +208,15 @@ class LedgerEntryPtr
     Init(std::shared_ptr<InternalLedgerEntry> const& lePtr);
     static LedgerEntryPtr
     Live(std::shared_ptr<InternalLedgerEntry> const& lePtr);
+    static LedgerEntryPtr
+    Shared(std::shared_ptr<InternalLedgerEntry const> const& lePtr);
     static LedgerEntryPtr Delete();
 
     // These methods have the strong exception safety guarantee
     InternalLedgerEntry& operator*() const;
     InternalLedgerEntry* operator->() const;
     void mergeFrom(LedgerEntryPtr const& entryPtr);
+    void unshare();
 
     // These methods do not throw
     std::shared_ptr<InternalLedgerEntry> get() const;
@@ -211,13 +224,21 @@ class LedgerEntryPtr
     bool isInit() const;
     bool isLive() const;
     bool isDeleted() const;
+    bool isShared() const;
+
+#ifdef BUILD_TESTS
+    // Returns how many entries unshare has copied so far, so that tests can
+    // measure how many copies sharing saves.
+    static uint64_t getNumUnsharedForTesting();
+#endif // BUILD_TESTS
 
   private:
     LedgerEntryPtr(std::shared_ptr<InternalLedgerEntry> const& lePtr,
-                   EntryPtrState state);
+                   EntryPtrState state, bool shared = false);
 
     std::shared_ptr<InternalLedgerEntry> mEntryPtr;
     EntryPtrState mState;
+    bool mShared;
 };
 
 // A heuristic number that is used to batch together groups of
@@ -447,6 +468,16 @@ class AbstractLedgerTxnParent
     virtual uint64_t countObjects(LedgerEntryType let,
                                   LedgerRange const& ledgers) const = 0;
 
+    // Return the ledger objects with keys `keys` as stored in the database,
+    // bypassing all caches and BucketListDB, with a batched query per entry
+    // type. Keys that are not in the database map to nullptr. The objects are
+    // read through `session`, which may be a session from the database
+    // connection pool used on a worker thread. Will throw when called on
+    // anything other than a (real or stub) root LedgerTxn.
+    virtual UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
+    loadObjects(UnorderedSet<LedgerKey> const& keys,
+                soci::session& session) const = 0;
+
     // Delete all ledger entries modified on-or-after `ledger`. Will throw
     // when called on anything other than a (real or stub) root LedgerTxn.
     virtual void
@@ -527,6 +558,11 @@ class AbstractLedgerTxn : public AbstractLedgerTxnParent
     friend class ConstLedgerTxnEntry::Impl;
     virtual void deactivate(InternalLedgerKey const& key) = 0;
 
+    // unshareEntry is used by a LedgerTxnEntry that was loaded without copying
+    // the entry from the parent, before it is first modified. Returns the
+    // private copy of the entry that the LedgerTxnEntry must use from then on.
+    virtual InternalLedgerEntry& unshareEntry(InternalLedgerKey const& key) = 0;
+
     // deactivateHeader is used to deactivate the LedgerTxnHeader.
     friend class LedgerTxnHeader::Impl;
     virtual void deactivateHeader() = 0;
@@ -688,6 +724,8 @@ class LedgerTxn : public AbstractLedgerTxn
 
     void deactivate(InternalLedgerKey const& key) override;
 
+    InternalLedgerEntry& unshareEntry(InternalLedgerKey const& key) override;
+
     void deactivateHeader() override;
 
     std::unique_ptr<Impl> const& getImpl() const;
@@ -793,6 +831,9 @@ class LedgerTxn : public AbstractLedgerTxn
     uint64_t countObjects(LedgerEntryType let) const override;
     uint64_t countObjects(LedgerEntryType let,
                           LedgerRange const& ledgers) const override;
+    UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
+    loadObjects(UnorderedSet<LedgerKey> const& keys,
+                soci::session& session) const override;
     void deleteObjectsModifiedOnOrAfterLedger(uint32_t ledger) const override;
     void dropAccounts(bool rebuild) override;
     void dropData(bool rebuild) override;
@@ -854,6 +895,9 @@ class LedgerTxnRoot : public AbstractLedgerTxnParent
     uint64_t countObjects(LedgerEntryType let) const override;
     uint64_t countObjects(LedgerEntryType let,
                           LedgerRange const& ledgers) const override;
+    UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
+    loadObjects(UnorderedSet<LedgerKey> const& keys,
+                soci::session& session) const override;
 
     void deleteObjectsModifiedOnOrAfterLedger(uint32_t ledger) const override;
 
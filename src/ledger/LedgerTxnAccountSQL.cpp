@@ -5,6 +5,7 @@
 #include "crypto/KeyUtils.h"
 #include "crypto/SecretKey.h"
 #include "crypto/SignerKey.h"
+#include "database/BulkUpsert.h"
 #include "database/Database.h"
 #include "database/DatabaseTypeSpecificOperation.h"
 #include "ledger/LedgerTxnImpl.h"
@@ -228,63 +229,41 @@ class BulkUpsertAccountsOperation : public DatabaseTypeSpecificOperation<void>
         }
     }
 
-    void
-    doSociGenericOperation()
+    BulkUpsert
+    bulkUpsert() const
     {
-        std::string sql =
-            "INSERT INTO accounts ( "
-            "accountid, balance, seqnum, numsubentries, inflationdest,"
-            "homedomain, thresholds, signers, flags, lastmodified, "
-            "extension, ledgerext "
-            ") VALUES ( "
-            ":id, :v1, :v2, :v3, :v4, :v5, :v6, :v7, :v8, :v9, :v10, :v11 "
-            ") ON CONFLICT (accountid) DO UPDATE SET "
-            "balance = excluded.balance, "
-            "seqnum = excluded.seqnum, "
-            "numsubentries = excluded.numsubentries, "
-            "inflationdest = excluded.inflationdest, "
-            "homedomain = excluded.homedomain, "
-            "thresholds = excluded.thresholds, "
-            "signers = excluded.signers, "
-            "flags = excluded.flags, "
-            "lastmodified = excluded.lastmodified, "
-            "extension = excluded.extension, "
-            "ledgerext = excluded.ledgerext";
-        auto prep = mDB.getPreparedStatement(sql);
-        soci::statement& st = prep.statement();
-        st.exchange(soci::use(mAccountIDs));
-        st.exchange(soci::use(mBalances));
-        st.exchange(soci::use(mSeqNums));
-        st.exchange(soci::use(mSubEntryNums));
-        st.exchange(soci::use(mInflationDests, mInflationDestInds));
-        st.exchange(soci::use(mHomeDomains));
-        st.exchange(soci::use(mThresholds));
-        st.exchange(soci::use(mSigners, mSignerInds));
-        st.exchange(soci::use(mFlags));
-        st.exchange(soci::use(mLastModifieds));
-        st.exchange(soci::use(mExtensions, mExtensionInds));
-        st.exchange(soci::use(mLedgerExtensions));
-        st.define_and_bind();
-        {
-            auto timer = mDB.getUpsertTimer("account");
-            st.execute(true);
-        }
-        if (static_cast<size_t>(st.get_affected_rows()) != mAccountIDs.size())
-        {
-            throw std::runtime_error("Could not update data in SQL");
-        }
+        BulkUpsert upsert(mDB, "accounts", "account", {"accountid"});
+        upsert.addColumn("accountid", mAccountIDs);
+        upsert.addColumn("balance", mBalances);
+        upsert.addColumn("seqnum", mSeqNums);
+        upsert.addColumn("numsubentries", mSubEntryNums);
+        upsert.addColumn("inflationdest", mInflationDests, &mInflationDestInds);
+        upsert.addColumn("homedomain", mHomeDomains);
+        upsert.addColumn("thresholds", mThresholds);
+        upsert.addColumn("signers", mSigners, &mSignerInds);
+        upsert.addColumn("flags", mFlags);
+        upsert.addColumn("lastmodified", mLastModifieds);
+        upsert.addColumn("extension", mExtensions, &mExtensionInds);
+        upsert.addColumn("ledgerext", mLedgerExtensions);
+        return upsert;
     }
 
     void
     doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
     {
-        doSociGenericOperation();
+        bulkUpsert().execute(sq);
     }
 
 #ifdef USE_POSTGRES
     void
     doPostgresSpecificOperation(soci::postgresql_session_backend* pg) override
     {
+        if (BulkUpsert::usePostgresCopy(mAccountIDs.size()))
+        {
+            bulkUpsert().execute(pg);
+            return;
+        }
+
         std::string strAccountIDs, strBalances, strSeqNums, strSubEntryNums,
             strInflationDests, strFlags, strHomeDomains, strThresholds,
             strSigners, strLastModifieds, strExtensions, strLedgerExtensions;
@@ -504,6 +483,7 @@ class BulkLoadAccountsOperation
     : public DatabaseTypeSpecificOperation<std::vector<LedgerEntry>>
 {
     Database& mDb;
+    soci::session& mSession;
     std::vector<std::string> mAccountIDs;
 
     std::vector<LedgerEntry>
@@ -591,8 +571,9 @@ class BulkLoadAccountsOperation
     }
 
   public:
-    BulkLoadAccountsOperation(Database& db, UnorderedSet<LedgerKey> const& keys)
-        : mDb(db)
+    BulkLoadAccountsOperation(Database& db, soci::session& session,
+                              UnorderedSet<LedgerKey> const& keys)
+        : mDb(db), mSession(session)
     {
         mAccountIDs.reserve(keys.size());
         for (auto const& k : keys)
@@ -619,7 +600,7 @@ class BulkLoadAccountsOperation
             " FROM accounts "
             "WHERE accountid IN carray(?, ?, 'char*')";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto be = prep.statement().get_backend();
         if (be == nullptr)
         {
@@ -650,7 +631,7 @@ class BulkLoadAccountsOperation
             " FROM accounts "
             "WHERE accountid IN (SELECT * FROM r)";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto& st = prep.statement();
         st.exchange(soci::use(strAccountIDs));
         return executeAndFetch(st);
@@ -659,15 +640,16 @@ class BulkLoadAccountsOperation
 };
 
 UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
-LedgerTxnRoot::Impl::bulkLoadAccounts(UnorderedSet<LedgerKey> const& keys) const
+LedgerTxnRoot::Impl::bulkLoadAccounts(
+    UnorderedSet<LedgerKey> const& keys, soci::session& session) const
 {
     ZoneScoped;
     ZoneValue(static_cast<int64_t>(keys.size()));
     if (!keys.empty())
     {
-        BulkLoadAccountsOperation op(mApp.getDatabase(), keys);
+        BulkLoadAccountsOperation op(mApp.getDatabase(), session, keys);
         return populateLoadedEntries(
-            keys, mApp.getDatabase().doDatabaseTypeSpecificOperation(op));
+            keys, doDatabaseTypeSpecificOperation(session, op));
     }
     else
     {
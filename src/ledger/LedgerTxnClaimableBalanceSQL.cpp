@@ -2,6 +2,7 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "database/BulkUpsert.h"
 #include "ledger/LedgerTxnImpl.h"
 #include "main/Application.h"
 #include "util/GlobalChecks.h"
@@ -42,6 +43,7 @@ class BulkLoadClaimableBalanceOperation
     : public DatabaseTypeSpecificOperation<std::vector<LedgerEntry>>
 {
     Database& mDb;
+    soci::session& mSession;
     std::vector<std::string> mBalanceIDs;
 
     std::vector<LedgerEntry>
@@ -72,9 +74,9 @@ class BulkLoadClaimableBalanceOperation
     }
 
   public:
-    BulkLoadClaimableBalanceOperation(Database& db,
+    BulkLoadClaimableBalanceOperation(Database& db, soci::session& session,
                                       UnorderedSet<LedgerKey> const& keys)
-        : mDb(db)
+        : mDb(db), mSession(session)
     {
         mBalanceIDs.reserve(keys.size());
         for (auto const& k : keys)
@@ -100,7 +102,7 @@ class BulkLoadClaimableBalanceOperation
                           "FROM claimablebalance "
                           "WHERE balanceid IN r";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto be = prep.statement().get_backend();
         if (be == nullptr)
         {
@@ -128,7 +130,7 @@ class BulkLoadClaimableBalanceOperation
                           "FROM claimablebalance "
                           "WHERE balanceid IN (SELECT * from r)";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto& st = prep.statement();
         st.exchange(soci::use(strBalanceIDs));
         return executeAndFetch(st);
@@ -138,13 +140,13 @@ class BulkLoadClaimableBalanceOperation
 
 UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
 LedgerTxnRoot::Impl::bulkLoadClaimableBalance(
-    UnorderedSet<LedgerKey> const& keys) const
+    UnorderedSet<LedgerKey> const& keys, soci::session& session) const
 {
     if (!keys.empty())
     {
-        BulkLoadClaimableBalanceOperation op(mApp.getDatabase(), keys);
+        BulkLoadClaimableBalanceOperation op(mApp.getDatabase(), session, keys);
         return populateLoadedEntries(
-            keys, mApp.getDatabase().doDatabaseTypeSpecificOperation(op));
+            keys, doDatabaseTypeSpecificOperation(session, op));
     }
     else
     {
@@ -267,44 +269,33 @@ class BulkUpsertClaimableBalanceOperation
         }
     }
 
-    void
-    doSociGenericOperation()
+    BulkUpsert
+    bulkUpsert() const
     {
-        std::string sql = "INSERT INTO claimablebalance "
-                          "(balanceid, ledgerentry, lastmodified) "
-                          "VALUES "
-                          "( :id, :v1, :v2 ) "
-                          "ON CONFLICT (balanceid) DO UPDATE SET "
-                          "balanceid = excluded.balanceid, ledgerentry = "
-                          "excluded.ledgerentry, lastmodified = "
-                          "excluded.lastmodified";
-
-        auto prep = mDb.getPreparedStatement(sql);
-        soci::statement& st = prep.statement();
-        st.exchange(soci::use(mBalanceIDs));
-        st.exchange(soci::use(mClaimableBalanceEntrys));
-        st.exchange(soci::use(mLastModifieds));
-        st.define_and_bind();
-        {
-            auto timer = mDb.getUpsertTimer("claimablebalance");
-            st.execute(true);
-        }
-        if (static_cast<size_t>(st.get_affected_rows()) != mBalanceIDs.size())
-        {
-            throw std::runtime_error("Could not update data in SQL");
-        }
+        BulkUpsert upsert(mDb, "claimablebalance", "claimablebalance",
+                          {"balanceid"});
+        upsert.addColumn("balanceid", mBalanceIDs);
+        upsert.addColumn("ledgerentry", mClaimableBalanceEntrys);
+        upsert.addColumn("lastmodified", mLastModifieds);
+        return upsert;
     }
 
     void
     doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
     {
-        doSociGenericOperation();
+        bulkUpsert().execute(sq);
     }
 
 #ifdef USE_POSTGRES
     void
     doPostgresSpecificOperation(soci::postgresql_session_backend* pg) override
     {
+        if (BulkUpsert::usePostgresCopy(mBalanceIDs.size()))
+        {
+            bulkUpsert().execute(pg);
+            return;
+        }
+
         std::string strBalanceIDs, strClaimableBalanceEntry, strLastModifieds;
 
         PGconn* conn = pg->conn_;
@@ -3,6 +3,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+#include "database/BulkUpsert.h"
 #include "ledger/LedgerTxnImpl.h"
 #include "ledger/NonSociRelatedException.h"
 #include "main/Application.h"
@@ -55,6 +56,7 @@ class bulkLoadConfigSettingsOperation
     : public DatabaseTypeSpecificOperation<std::vector<LedgerEntry>>
 {
     Database& mDb;
+    soci::session& mSession;
     std::vector<int32_t> mConfigSettingIDs;
 
     std::vector<LedgerEntry>
@@ -84,9 +86,9 @@ class bulkLoadConfigSettingsOperation
     }
 
   public:
-    bulkLoadConfigSettingsOperation(Database& db,
+    bulkLoadConfigSettingsOperation(Database& db, soci::session& session,
                                     UnorderedSet<LedgerKey> const& keys)
-        : mDb(db)
+        : mDb(db), mSession(session)
     {
         mConfigSettingIDs.reserve(keys.size());
         for (auto const& k : keys)
@@ -104,7 +106,7 @@ class bulkLoadConfigSettingsOperation
                           "FROM configsettings "
                           "WHERE configsettingid IN r";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto be = prep.statement().get_backend();
         if (be == nullptr)
         {
@@ -133,7 +135,7 @@ class bulkLoadConfigSettingsOperation
                           "FROM configsettings "
                           "WHERE configsettingid IN (SELECT * from r)";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto& st = prep.statement();
         st.exchange(soci::use(strConfigSettingIDs));
         return executeAndFetch(st);
@@ -143,13 +145,13 @@ class bulkLoadConfigSettingsOperation
 
 UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
 LedgerTxnRoot::Impl::bulkLoadConfigSettings(
-    UnorderedSet<LedgerKey> const& keys) const
+    UnorderedSet<LedgerKey> const& keys, soci::session& session) const
 {
     if (!keys.empty())
     {
-        bulkLoadConfigSettingsOperation op(mApp.getDatabase(), keys);
+        bulkLoadConfigSettingsOperation op(mApp.getDatabase(), session, keys);
         return populateLoadedEntries(
-            keys, mApp.getDatabase().doDatabaseTypeSpecificOperation(op));
+            keys, doDatabaseTypeSpecificOperation(session, op));
     }
     else
     {
@@ -189,44 +191,33 @@ class bulkUpsertConfigSettingsOperation
         }
     }
 
-    void
-    doSociGenericOperation()
+    BulkUpsert
+    bulkUpsert() const
     {
-        std::string sql = "INSERT INTO configsettings "
-                          "(configsettingid, ledgerentry, lastmodified) "
-                          "VALUES "
-                          "( :id, :v1, :v2 ) "
-                          "ON CONFLICT (configsettingid) DO UPDATE SET "
-                          "ledgerentry = excluded.ledgerentry, "
-                          "lastmodified = excluded.lastmodified";
-
-        auto prep = mDb.getPreparedStatement(sql);
-        soci::statement& st = prep.statement();
-        st.exchange(soci::use(mConfigSettingIDs));
-        st.exchange(soci::use(mConfigSettingEntries));
-        st.exchange(soci::use(mLastModifieds));
-        st.define_and_bind();
-        {
-            auto timer = mDb.getUpsertTimer("configsetting");
-            st.execute(true);
-        }
-        if (static_cast<size_t>(st.get_affected_rows()) !=
-            mConfigSettingIDs.size())
-        {
-            throw std::runtime_error("Could not update data in SQL");
-        }
+        BulkUpsert upsert(mDb, "configsettings", "configsetting",
+                          {"configsettingid"});
+        upsert.addColumn("configsettingid", mConfigSettingIDs);
+        upsert.addColumn("ledgerentry", mConfigSettingEntries);
+        upsert.addColumn("lastmodified", mLastModifieds);
+        return upsert;
     }
 
     void
     doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
     {
-        doSociGenericOperation();
+        bulkUpsert().execute(sq);
     }
 
 #ifdef USE_POSTGRES
     void
     doPostgresSpecificOperation(soci::postgresql_session_backend* pg) override
     {
+        if (BulkUpsert::usePostgresCopy(mConfigSettingIDs.size()))
+        {
+            bulkUpsert().execute(pg);
+            return;
+        }
+
         std::string strConfigSettingIDs, strConfigSettingEntries,
             strLastModifieds;
 
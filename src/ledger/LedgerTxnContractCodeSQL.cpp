@@ -3,6 +3,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+#include "database/BulkUpsert.h"
 #include "ledger/LedgerTxnImpl.h"
 #include "ledger/NonSociRelatedException.h"
 #include "main/Application.h"
@@ -63,6 +64,7 @@ class BulkLoadContractCodeOperation
     : public DatabaseTypeSpecificOperation<std::vector<LedgerEntry>>
 {
     Database& mDb;
+    soci::session& mSession;
     std::vector<std::string> mHashes;
 
     std::vector<LedgerEntry>
@@ -92,9 +94,9 @@ class BulkLoadContractCodeOperation
     }
 
   public:
-    BulkLoadContractCodeOperation(Database& db,
+    BulkLoadContractCodeOperation(Database& db, soci::session& session,
                                   UnorderedSet<LedgerKey> const& keys)
-        : mDb(db)
+        : mDb(db), mSession(session)
     {
         mHashes.reserve(keys.size());
         for (auto const& k : keys)
@@ -122,7 +124,7 @@ class BulkLoadContractCodeOperation
                           "FROM contractcode "
                           "WHERE hash IN carray(?, ?, 'char*')";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto be = prep.statement().get_backend();
         if (be == nullptr)
         {
@@ -150,7 +152,7 @@ class BulkLoadContractCodeOperation
                           "FROM contractcode "
                           "WHERE (hash) IN (SELECT * from r)";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto& st = prep.statement();
         st.exchange(soci::use(strHashes));
         return executeAndFetch(st);
@@ -160,13 +162,13 @@ class BulkLoadContractCodeOperation
 
 UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
 LedgerTxnRoot::Impl::bulkLoadContractCode(
-    UnorderedSet<LedgerKey> const& keys) const
+    UnorderedSet<LedgerKey> const& keys, soci::session& session) const
 {
     if (!keys.empty())
     {
-        BulkLoadContractCodeOperation op(mApp.getDatabase(), keys);
+        BulkLoadContractCodeOperation op(mApp.getDatabase(), session, keys);
         return populateLoadedEntries(
-            keys, mApp.getDatabase().doDatabaseTypeSpecificOperation(op));
+            keys, doDatabaseTypeSpecificOperation(session, op));
     }
     else
     {
@@ -293,43 +295,32 @@ class BulkUpsertContractCodeOperation
         }
     }
 
-    void
-    doSociGenericOperation()
+    BulkUpsert
+    bulkUpsert() const
     {
-        std::string sql = "INSERT INTO contractCode "
-                          "(hash, ledgerentry, lastmodified) "
-                          "VALUES "
-                          "( :hash, :v1, :v2 ) "
-                          "ON CONFLICT (hash) DO UPDATE SET "
-                          "ledgerentry = excluded.ledgerentry, "
-                          "lastmodified = excluded.lastmodified";
-
-        auto prep = mDb.getPreparedStatement(sql);
-        soci::statement& st = prep.statement();
-        st.exchange(soci::use(mHashes));
-        st.exchange(soci::use(mContractCodeEntries));
-        st.exchange(soci::use(mLastModifieds));
-        st.define_and_bind();
-        {
-            auto timer = mDb.getUpsertTimer("contractcode");
-            st.execute(true);
-        }
-        if (static_cast<size_t>(st.get_affected_rows()) != mHashes.size())
-        {
-            throw std::runtime_error("Could not update data in SQL");
-        }
+        BulkUpsert upsert(mDb, "contractCode", "contractcode", {"hash"});
+        upsert.addColumn("hash", mHashes);
+        upsert.addColumn("ledgerentry", mContractCodeEntries);
+        upsert.addColumn("lastmodified", mLastModifieds);
+        return upsert;
     }
 
     void
     doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
     {
-        doSociGenericOperation();
+        bulkUpsert().execute(sq);
     }
 
 #ifdef USE_POSTGRES
     void
     doPostgresSpecificOperation(soci::postgresql_session_backend* pg) override
     {
+        if (BulkUpsert::usePostgresCopy(mHashes.size()))
+        {
+            bulkUpsert().execute(pg);
+            return;
+        }
+
         std::string strHashes, strContractCodeEntries, strLastModifieds;
 
         PGconn* conn = pg->conn_;
@@ -3,6 +3,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+#include "database/BulkUpsert.h"
 #include "ledger/LedgerTxnImpl.h"
 #include "ledger/NonSociRelatedException.h"
 #include "main/Application.h"
@@ -69,6 +70,7 @@ class BulkLoadContractDataOperation
     : public DatabaseTypeSpecificOperation<std::vector<LedgerEntry>>
 {
     Database& mDb;
+    soci::session& mSession;
     std::vector<std::string> mContractIDs;
     std::vector<std::string> mKeys;
     std::vector<int32_t> mTypes;
@@ -100,9 +102,9 @@ class BulkLoadContractDataOperation
     }
 
   public:
-    BulkLoadContractDataOperation(Database& db,
+    BulkLoadContractDataOperation(Database& db, soci::session& session,
                                   UnorderedSet<LedgerKey> const& keys)
-        : mDb(db)
+        : mDb(db), mSession(session)
     {
         mContractIDs.reserve(keys.size());
         mKeys.reserve(keys.size());
@@ -156,7 +158,7 @@ class BulkLoadContractDataOperation
                           "FROM contractdata "
                           "WHERE (contractid, key, type) IN (SELECT * FROM r)";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto be = prep.statement().get_backend();
         if (be == nullptr)
         {
@@ -191,7 +193,7 @@ class BulkLoadContractDataOperation
                           "FROM contractdata "
                           "WHERE (contractid, key, type) IN (SELECT * from r)";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto& st = prep.statement();
         st.exchange(soci::use(strContractIDs));
         st.exchange(soci::use(strKeys));
@@ -203,13 +205,13 @@ class BulkLoadContractDataOperation
 
 UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
 LedgerTxnRoot::Impl::bulkLoadContractData(
-    UnorderedSet<LedgerKey> const& keys) const
+    UnorderedSet<LedgerKey> const& keys, soci::session& session) const
 {
     if (!keys.empty())
     {
-        BulkLoadContractDataOperation op(mApp.getDatabase(), keys);
+        BulkLoadContractDataOperation op(mApp.getDatabase(), session, keys);
         return populateLoadedEntries(
-            keys, mApp.getDatabase().doDatabaseTypeSpecificOperation(op));
+            keys, doDatabaseTypeSpecificOperation(session, op));
     }
     else
     {
@@ -358,46 +360,36 @@ class BulkUpsertContractDataOperation
         }
     }
 
-    void
-    doSociGenericOperation()
+    BulkUpsert
+    bulkUpsert() const
     {
         // TODO: Update query for EXPIRATION_EXTENSION entries
-        std::string sql = "INSERT INTO contractData "
-                          "(contractid, key, type, ledgerentry, lastmodified) "
-                          "VALUES "
-                          "( :id, :key, :type, :v1, :v2 ) "
-                          "ON CONFLICT (contractid, key, type) DO UPDATE SET "
-                          "ledgerentry = excluded.ledgerentry, "
-                          "lastmodified = excluded.lastmodified";
-
-        auto prep = mDb.getPreparedStatement(sql);
-        soci::statement& st = prep.statement();
-        st.exchange(soci::use(mContractIDs));
-        st.exchange(soci::use(mKeys));
-        st.exchange(soci::use(mTypes));
-        st.exchange(soci::use(mContractDataEntries));
-        st.exchange(soci::use(mLastModifieds));
-        st.define_and_bind();
-        {
-            auto timer = mDb.getUpsertTimer("contractdata");
-            st.execute(true);
-        }
-        if (static_cast<size_t>(st.get_affected_rows()) != mContractIDs.size())
-        {
-            throw std::runtime_error("Could not update data in SQL");
-        }
+        BulkUpsert upsert(mDb, "contractData", "contractdata",
+                          {"contractid", "key", "type"});
+        upsert.addColumn("contractid", mContractIDs);
+        upsert.addColumn("key", mKeys);
+        upsert.addColumn("type", mTypes);
+        upsert.addColumn("ledgerentry", mContractDataEntries);
+        upsert.addColumn("lastmodified", mLastModifieds);
+        return upsert;
     }
 
     void
     doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
     {
-        doSociGenericOperation();
+        bulkUpsert().execute(sq);
     }
 
 #ifdef USE_POSTGRES
     void
     doPostgresSpecificOperation(soci::postgresql_session_backend* pg) override
     {
+        if (BulkUpsert::usePostgresCopy(mContractIDs.size()))
+        {
+            bulkUpsert().execute(pg);
+            return;
+        }
+
         std::string strContractIDs, strKeys, strTypes, strContractDataEntries,
             strLastModifieds;
 
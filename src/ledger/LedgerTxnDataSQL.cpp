@@ -4,6 +4,7 @@
 
 #include "crypto/KeyUtils.h"
 #include "crypto/SecretKey.h"
+#include "database/BulkUpsert.h"
 #include "database/Database.h"
 #include "database/DatabaseTypeSpecificOperation.h"
 #include "ledger/LedgerTxnImpl.h"
@@ -120,48 +121,35 @@ class BulkUpsertDataOperation : public DatabaseTypeSpecificOperation<void>
         }
     }
 
-    void
-    doSociGenericOperation()
+    BulkUpsert
+    bulkUpsert() const
     {
-        std::string sql =
-            "INSERT INTO accountdata ( "
-            "accountid, dataname, datavalue, lastmodified, extension, "
-            "ledgerext "
-            ") VALUES ( "
-            ":id, :v1, :v2, :v3, :v4, :v5 "
-            ") ON CONFLICT (accountid, dataname) DO UPDATE SET "
-            "datavalue = excluded.datavalue, "
-            "lastmodified = excluded.lastmodified, "
-            "extension = excluded.extension, "
-            "ledgerext = excluded.ledgerext";
-        auto prep = mDB.getPreparedStatement(sql);
-        soci::statement& st = prep.statement();
-        st.exchange(soci::use(mAccountIDs));
-        st.exchange(soci::use(mDataNames));
-        st.exchange(soci::use(mDataValues));
-        st.exchange(soci::use(mLastModifieds));
-        st.exchange(soci::use(mExtensions));
-        st.exchange(soci::use(mLedgerExtensions));
-        st.define_and_bind();
-        {
-            auto timer = mDB.getUpsertTimer("data");
-            st.execute(true);
-        }
-        if (static_cast<size_t>(st.get_affected_rows()) != mAccountIDs.size())
-        {
-            throw std::runtime_error("Could not update data in SQL");
-        }
+        BulkUpsert upsert(mDB, "accountdata", "data",
+                          {"accountid", "dataname"});
+        upsert.addColumn("accountid", mAccountIDs);
+        upsert.addColumn("dataname", mDataNames);
+        upsert.addColumn("datavalue", mDataValues);
+        upsert.addColumn("lastmodified", mLastModifieds);
+        upsert.addColumn("extension", mExtensions);
+        upsert.addColumn("ledgerext", mLedgerExtensions);
+        return upsert;
     }
 
     void
     doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
     {
-        doSociGenericOperation();
+        bulkUpsert().execute(sq);
     }
 #ifdef USE_POSTGRES
     void
     doPostgresSpecificOperation(soci::postgresql_session_backend* pg) override
     {
+        if (BulkUpsert::usePostgresCopy(mAccountIDs.size()))
+        {
+            bulkUpsert().execute(pg);
+            return;
+        }
+
         std::string strAccountIDs, strDataNames, strDataValues,
             strLastModifieds, strExtensions, strLedgerExtensions;
 
@@ -355,6 +343,7 @@ class BulkLoadDataOperation
     : public DatabaseTypeSpecificOperation<std::vector<LedgerEntry>>
 {
     Database& mDb;
+    soci::session& mSession;
     std::vector<std::string> mAccountIDs;
     std::vector<std::string> mDataNames;
 
@@ -403,8 +392,9 @@ class BulkLoadDataOperation
     }
 
   public:
-    BulkLoadDataOperation(Database& db, UnorderedSet<LedgerKey> const& keys)
-        : mDb(db)
+    BulkLoadDataOperation(Database& db, soci::session& session,
+                          UnorderedSet<LedgerKey> const& keys)
+        : mDb(db), mSession(session)
     {
         mAccountIDs.reserve(keys.size());
         mDataNames.reserve(keys.size());
@@ -443,7 +433,7 @@ class BulkLoadDataOperation
                           "ledgerext "
                           "FROM accountdata WHERE (accountid, dataname) IN r";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto be = prep.statement().get_backend();
         if (be == nullptr)
         {
@@ -478,7 +468,7 @@ class BulkLoadDataOperation
             "ledgerext "
             "FROM accountdata WHERE (accountid, dataname) IN (SELECT * FROM r)";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto& st = prep.statement();
         st.exchange(soci::use(strAccountIDs));
         st.exchange(soci::use(strDataNames));
@@ -488,15 +478,16 @@ class BulkLoadDataOperation
 };
 
 UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
-LedgerTxnRoot::Impl::bulkLoadData(UnorderedSet<LedgerKey> const& keys) const
+LedgerTxnRoot::Impl::bulkLoadData(
+    UnorderedSet<LedgerKey> const& keys, soci::session& session) const
 {
     ZoneScoped;
     ZoneValue(static_cast<int64_t>(keys.size()));
     if (!keys.empty())
     {
-        BulkLoadDataOperation op(mApp.getDatabase(), keys);
+        BulkLoadDataOperation op(mApp.getDatabase(), session, keys);
         return populateLoadedEntries(
-            keys, mApp.getDatabase().doDatabaseTypeSpecificOperation(op));
+            keys, doDatabaseTypeSpecificOperation(session, op));
     }
     else
     {
@@ -16,10 +16,12 @@ namespace caiz
 class LedgerTxnEntry::Impl : public EntryImplBase
 {
     AbstractLedgerTxn& mLedgerTxn;
-    InternalLedgerEntry& mCurrent;
+    InternalLedgerEntry* mCurrent;
+    bool mShared;
 
   public:
-    explicit Impl(AbstractLedgerTxn& ltx, InternalLedgerEntry& current);
+    explicit Impl(AbstractLedgerTxn& ltx, InternalLedgerEntry& current,
+                  bool shared);
 
     ~Impl() override;
 
@@ -44,9 +46,9 @@ class LedgerTxnEntry::Impl : public EntryImplBase
 
 std::shared_ptr<LedgerTxnEntry::Impl>
 LedgerTxnEntry::makeSharedImpl(AbstractLedgerTxn& ltx,
-                               InternalLedgerEntry& current)
+                               InternalLedgerEntry& current, bool shared)
 {
-    return std::make_shared<Impl>(ltx, current);
+    return std::make_shared<Impl>(ltx, current, shared);
 }
 
 std::shared_ptr<EntryImplBase>
@@ -65,8 +67,9 @@ LedgerTxnEntry::LedgerTxnEntry(std::shared_ptr<Impl> const& impl)
 {
 }
 
-LedgerTxnEntry::Impl::Impl(AbstractLedgerTxn& ltx, InternalLedgerEntry& current)
-    : mLedgerTxn(ltx), mCurrent(current)
+LedgerTxnEntry::Impl::Impl(AbstractLedgerTxn& ltx, InternalLedgerEntry& current,
+                           bool shared)
+    : mLedgerTxn(ltx), mCurrent(&current), mShared(shared)
 {
 }
 
@@ -136,16 +139,22 @@ LedgerTxnEntry::current() const
     return getImpl()->current();
 }
 
+LedgerEntry const&
+LedgerTxnEntry::currentConst() const
+{
+    return current();
+}
+
 LedgerEntry&
 LedgerTxnEntry::Impl::current()
 {
-    return mCurrent.ledgerEntry();
+    return currentGeneralized().ledgerEntry();
 }
 
 LedgerEntry const&
 LedgerTxnEntry::Impl::current() const
 {
-    return mCurrent.ledgerEntry();
+    return mCurrent->ledgerEntry();
 }
 
 InternalLedgerEntry&
@@ -163,13 +172,20 @@ LedgerTxnEntry::currentGeneralized() const
 InternalLedgerEntry&
 LedgerTxnEntry::Impl::currentGeneralized()
 {
-    return mCurrent;
+    // The caller may modify the entry, so it can no longer be shared with the
+    // parent
+    if (mShared)
+    {
+        mCurrent = &mLedgerTxn.unshareEntry(mCurrent->toKey());
+        mShared = false;
+    }
+    return *mCurrent;
 }
 
 InternalLedgerEntry const&
 LedgerTxnEntry::Impl::currentGeneralized() const
 {
-    return mCurrent;
+    return *mCurrent;
 }
 
 void
@@ -181,7 +197,7 @@ LedgerTxnEntry::deactivate()
 void
 LedgerTxnEntry::Impl::deactivate()
 {
-    auto key = mCurrent.toKey();
+    auto key = mCurrent->toKey();
     mLedgerTxn.deactivate(key);
 }
 
@@ -194,7 +210,7 @@ LedgerTxnEntry::erase()
 void
 LedgerTxnEntry::Impl::erase()
 {
-    auto key = mCurrent.toKey();
+    auto key = mCurrent->toKey();
     mLedgerTxn.erase(key);
 }
 
@@ -230,10 +246,13 @@ LedgerTxnEntry::swap(LedgerTxnEntry& other)
 class ConstLedgerTxnEntry::Impl : public EntryImplBase
 {
     AbstractLedgerTxn& mLedgerTxn;
-    InternalLedgerEntry const mCurrent;
+    // Nothing can modify the entry while it is active, so it does not need to
+    // be copied
+    std::shared_ptr<InternalLedgerEntry const> const mCurrent;
 
   public:
-    explicit Impl(AbstractLedgerTxn& ltx, InternalLedgerEntry const& current);
+    explicit Impl(AbstractLedgerTxn& ltx,
+                  std::shared_ptr<InternalLedgerEntry const> const& current);
 
     ~Impl() override;
 
@@ -253,8 +272,9 @@ class ConstLedgerTxnEntry::Impl : public EntryImplBase
 };
 
 std::shared_ptr<ConstLedgerTxnEntry::Impl>
-ConstLedgerTxnEntry::makeSharedImpl(AbstractLedgerTxn& ltx,
-                                    InternalLedgerEntry const& current)
+ConstLedgerTxnEntry::makeSharedImpl(
+    AbstractLedgerTxn& ltx,
+    std::shared_ptr<InternalLedgerEntry const> const& current)
 {
     return std::make_shared<Impl>(ltx, current);
 }
@@ -275,8 +295,9 @@ ConstLedgerTxnEntry::ConstLedgerTxnEntry(std::shared_ptr<Impl> const& impl)
 {
 }
 
-ConstLedgerTxnEntry::Impl::Impl(AbstractLedgerTxn& ltx,
-                                InternalLedgerEntry const& current)
+ConstLedgerTxnEntry::Impl::Impl(
+    AbstractLedgerTxn& ltx,
+    std::shared_ptr<InternalLedgerEntry const> const& current)
     : mLedgerTxn(ltx), mCurrent(current)
 {
 }
@@ -344,7 +365,7 @@ ConstLedgerTxnEntry::current() const
 LedgerEntry const&
 ConstLedgerTxnEntry::Impl::current() const
 {
-    return mCurrent.ledgerEntry();
+    return mCurrent->ledgerEntry();
 }
 
 InternalLedgerEntry const&
@@ -356,7 +377,7 @@ ConstLedgerTxnEntry::currentGeneralized() const
 InternalLedgerEntry const&
 ConstLedgerTxnEntry::Impl::currentGeneralized() const
 {
-    return mCurrent;
+    return *mCurrent;
 }
 
 std::shared_ptr<ConstLedgerTxnEntry::Impl>
@@ -390,7 +411,7 @@ ConstLedgerTxnEntry::deactivate()
 void
 ConstLedgerTxnEntry::Impl::deactivate()
 {
-    auto key = mCurrent.toKey();
+    auto key = mCurrent->toKey();
     mLedgerTxn.deactivate(key);
 }
 
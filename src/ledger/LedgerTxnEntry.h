@@ -54,6 +54,12 @@ class LedgerTxnEntry
     LedgerEntry& current();
     LedgerEntry const& current() const;
 
+    // Same as current() const, for callers holding a non-const
+    // LedgerTxnEntry that only read the entry. The non-const accessors make
+    // a private copy of an entry shared with the parent, this does not. The
+    // reference is only valid until the entry is next modified.
+    LedgerEntry const& currentConst() const;
+
     InternalLedgerEntry& currentGeneralized();
     InternalLedgerEntry const& currentGeneralized() const;
 
@@ -63,8 +69,12 @@ class LedgerTxnEntry
 
     void swap(LedgerTxnEntry& other);
 
+    // If shared is true, current belongs to a parent of ltx and is only
+    // read until the entry is first modified, at which point ltx provides a
+    // private copy.
     static std::shared_ptr<Impl> makeSharedImpl(AbstractLedgerTxn& ltx,
-                                                InternalLedgerEntry& current);
+                                                InternalLedgerEntry& current,
+                                                bool shared = false);
 };
 
 class ConstLedgerTxnEntry
@@ -106,7 +116,8 @@ class ConstLedgerTxnEntry
     void swap(ConstLedgerTxnEntry& other);
 
     static std::shared_ptr<Impl>
-    makeSharedImpl(AbstractLedgerTxn& ltx, InternalLedgerEntry const& current);
+    makeSharedImpl(AbstractLedgerTxn& ltx,
+                   std::shared_ptr<InternalLedgerEntry const> const& current);
 };
 
 std::shared_ptr<EntryImplBase>
@@ -5,6 +5,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "database/Database.h"
+#include "ledger/FlatOrderBook.h"
 #include "ledger/LedgerTxn.h"
 #include "util/RandomEvictionCache.h"
 #include <list>
@@ -201,21 +202,27 @@ class LedgerTxn::Impl
 {
     class EntryIteratorImpl;
 
-    typedef UnorderedMap<InternalLedgerKey, LedgerEntryPtr> EntryMap;
+    // mEntry and mActive are allocated from the Arena that was current when
+    // this LedgerTxn was created (if any). During ledger close that is the
+    // per-close arena of the LedgerManager, so that the nodes churned by the
+    // nested LedgerTxn of every operation are recycled rather than going
+    // through the global heap.
+    typedef ArenaUnorderedMap<InternalLedgerKey, LedgerEntryPtr> EntryMap;
+    typedef ArenaUnorderedMap<InternalLedgerKey, std::shared_ptr<EntryImplBase>>
+        ActiveMap;
 
     AbstractLedgerTxnParent& mParent;
     AbstractLedgerTxn* mChild;
     std::unique_ptr<LedgerHeader> mHeader;
     std::shared_ptr<LedgerTxnHeader::Impl> mActiveHeader;
     EntryMap mEntry;
-    UnorderedMap<InternalLedgerKey, std::shared_ptr<EntryImplBase>> mActive;
+    ActiveMap mActive;
     bool const mShouldUpdateLastModified;
     bool mIsSealed;
     LedgerTxnConsistency mConsistency;
 
-    typedef std::map<OfferDescriptor, LedgerKey, IsBetterOfferComparator>
-        OrderBook;
-    typedef UnorderedMap<Asset, UnorderedMap<Asset, OrderBook>> MultiOrderBook;
+    typedef UnorderedMap<AssetPair, FlatOrderBook, AssetPairHash>
+        MultiOrderBook;
     // mMultiOrderbook is an in-memory representation of the order book that
     // contains an entry if and only if it is live, and recorded in this
     // LedgerTxn, and not active. It is grouped by asset pair, and for each
@@ -237,6 +244,27 @@ class LedgerTxn::Impl
     //     re-synchronizes an entry in mMultiOrderbook with mEntry/mActive.
     MultiOrderBook mMultiOrderBook;
 
+    // The BestOfferFrontier caches, for each asset pair P, a prefix of the
+    // offers with asset pair P that exist as of this LedgerTxn, ordered from
+    // best to worst; mComplete is set once the prefix holds every such offer.
+    // Every operation that crosses P asks its parents for the same offers
+    // again, and each of those requests otherwise merges the order book of
+    // every LedgerTxn down to LedgerTxnRoot.
+    //
+    // The frontier is kept exact by updateEntry: an offer that changes leaves
+    // the frontier it appears in (found through mBestOfferFrontierIndex), and
+    // its new state is inserted if it sorts before the last cached offer. The
+    // parent cannot change while this LedgerTxn is open, so nothing else can
+    // invalidate the frontier.
+    struct BestOfferFrontier
+    {
+        std::vector<std::shared_ptr<LedgerEntry const>> mOffers;
+        bool mComplete{false};
+    };
+    UnorderedMap<AssetPair, BestOfferFrontier, AssetPairHash>
+        mBestOfferFrontier;
+    UnorderedMap<LedgerKey, AssetPair> mBestOfferFrontierIndex;
+
     // The WorstBestOfferMap is a cache which retains, for each asset pair, the
     // worst value (including possibly nullptr) returned from calling
     // loadBestOffer on this LedgerTxn. Each time we call loadBestOffer, we call
@@ -418,7 +446,7 @@ class LedgerTxn::Impl
 
     // findOrderBook has the strong exception safety guarantee
     // returns: the orderbook that the offer le would be in (if found)
-    OrderBook* findOrderBook(Asset const& buying, Asset const& selling);
+    FlatOrderBook* findOrderBook(Asset const& buying, Asset const& selling);
 
     // removeFromOrderBookIfExists has the strong exception safety guarantee
     void removeFromOrderBookIfExists(LedgerEntry const& le);
@@ -431,6 +459,25 @@ class LedgerTxn::Impl
                      EntryMap::iterator const* keyHint, LedgerEntryPtr lePtr,
                      bool effectiveActive) noexcept;
 
+    // updateBestOfferFrontier drops the whole frontier if it cannot be
+    // updated, so it never throws
+    void updateBestOfferFrontier(LedgerKey const& key,
+                                 LedgerEntryPtr const& lePtr,
+                                 bool effectiveActive) noexcept;
+    void clearBestOfferFrontier() noexcept;
+    // appendToBestOfferFrontier has the strong exception safety guarantee
+    void appendToBestOfferFrontier(
+        BestOfferFrontier& frontier, AssetPair const& assets,
+        std::shared_ptr<LedgerEntry const> const& offer);
+
+    // computeBestOffer has the same exception safety guarantee as
+    // getBestOffer, and does not consult the frontier
+    std::shared_ptr<LedgerEntry const> computeBestOffer(Asset const& buying,
+                                                        Asset const& selling);
+    std::shared_ptr<LedgerEntry const>
+    computeBestOffer(Asset const& buying, Asset const& selling,
+                     OfferDescriptor const& worseThan);
+
     // updateWorstBestOffer has the strong exception safety guarantee
     void updateWorstBestOffer(AssetPair const& assets,
                               std::shared_ptr<OfferDescriptor const> offerDesc);
@@ -475,6 +522,9 @@ class LedgerTxn::Impl
     // deactivate has the strong exception safety guarantee
     void deactivate(InternalLedgerKey const& key);
 
+    // unshareEntry has the strong exception safety guarantee
+    InternalLedgerEntry& unshareEntry(InternalLedgerKey const& key);
+
     // deactivateHeader has the strong exception safety guarantee
     void deactivateHeader();
 
@@ -567,6 +617,12 @@ class LedgerTxn::Impl
     std::shared_ptr<InternalLedgerEntry const>
     getNewestVersion(InternalLedgerKey const& key, bool loadExpiredEntry) const;
 
+    // exportNewestVersion is getNewestVersion for callers outside of this
+    // LedgerTxn: it first unshares the entry if it is recorded here. It has
+    // the same exception safety guarantee as getNewestVersion.
+    std::shared_ptr<InternalLedgerEntry const>
+    exportNewestVersion(InternalLedgerKey const& key, bool loadExpiredEntry);
+
     // load has the basic exception safety guarantee. If it throws an exception,
     // then
     // - the prepared statement cache may be, but is not guaranteed to be,
@@ -740,6 +796,9 @@ class LedgerTxnRoot::Impl
     {
         std::deque<LedgerEntry> bestOffers;
         bool allLoaded;
+        // Descriptors of bestOffers, in the same order, so that searching for
+        // an offer doesn't have to go through the entries.
+        std::vector<OfferDescriptor> descriptors;
     };
     typedef std::shared_ptr<BestOffersEntry> BestOffersEntryPtr;
 
@@ -858,24 +917,33 @@ class LedgerTxnRoot::Impl
                                          Asset const& selling) const;
 
     UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
-    bulkLoadAccounts(UnorderedSet<LedgerKey> const& keys) const;
+    bulkLoadAccounts(UnorderedSet<LedgerKey> const& keys,
+                     soci::session& session) const;
     UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
-    bulkLoadTrustLines(UnorderedSet<LedgerKey> const& keys) const;
+    bulkLoadTrustLines(UnorderedSet<LedgerKey> const& keys,
+                       soci::session& session) const;
     UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
-    bulkLoadOffers(UnorderedSet<LedgerKey> const& keys) const;
+    bulkLoadOffers(UnorderedSet<LedgerKey> const& keys,
+                   soci::session& session) const;
     UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
-    bulkLoadData(UnorderedSet<LedgerKey> const& keys) const;
+    bulkLoadData(UnorderedSet<LedgerKey> const& keys,
+                 soci::session& session) const;
     UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
-    bulkLoadClaimableBalance(UnorderedSet<LedgerKey> const& keys) const;
+    bulkLoadClaimableBalance(UnorderedSet<LedgerKey> const& keys,
+                             soci::session& session) const;
     UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
-    bulkLoadLiquidityPool(UnorderedSet<LedgerKey> const& keys) const;
+    bulkLoadLiquidityPool(UnorderedSet<LedgerKey> const& keys,
+                          soci::session& session) const;
 #ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
     UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
-    bulkLoadContractData(UnorderedSet<LedgerKey> const& keys) const;
+    bulkLoadContractData(UnorderedSet<LedgerKey> const& keys,
+                         soci::session& session) const;
     UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
-    bulkLoadContractCode(UnorderedSet<LedgerKey> const& keys) const;
+    bulkLoadContractCode(UnorderedSet<LedgerKey> const& keys,
+                         soci::session& session) const;
     UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
-    bulkLoadConfigSettings(UnorderedSet<LedgerKey> const& keys) const;
+    bulkLoadConfigSettings(UnorderedSet<LedgerKey> const& keys,
+                           soci::session& session) const;
 #endif
 
     std::deque<LedgerEntry>::const_iterator
@@ -908,6 +976,12 @@ class LedgerTxnRoot::Impl
     uint64_t countObjects(LedgerEntryType let,
                           LedgerRange const& ledgers) const;
 
+    // loadObjects has the strong exception safety guarantee. It only reads
+    // through session, so it may be called from a worker thread.
+    UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
+    loadObjects(UnorderedSet<LedgerKey> const& keys,
+                soci::session& session) const;
+
     // deleteObjectsModifiedOnOrAfterLedger has no exception safety guarantees.
     void deleteObjectsModifiedOnOrAfterLedger(uint32_t ledger) const;
 
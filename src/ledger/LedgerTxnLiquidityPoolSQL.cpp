@@ -2,6 +2,7 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "database/BulkUpsert.h"
 #include "ledger/LedgerTxnImpl.h"
 #include "ledger/NonSociRelatedException.h"
 #include "main/Application.h"
@@ -63,6 +64,7 @@ class BulkLoadLiquidityPoolOperation
     : public DatabaseTypeSpecificOperation<std::vector<LedgerEntry>>
 {
     Database& mDb;
+    soci::session& mSession;
     std::vector<std::string> mPoolAssets;
 
     std::vector<LedgerEntry>
@@ -92,9 +94,9 @@ class BulkLoadLiquidityPoolOperation
     }
 
   public:
-    BulkLoadLiquidityPoolOperation(Database& db,
+    BulkLoadLiquidityPoolOperation(Database& db, soci::session& session,
                                    UnorderedSet<LedgerKey> const& keys)
-        : mDb(db)
+        : mDb(db), mSession(session)
     {
         mPoolAssets.reserve(keys.size());
         for (auto const& k : keys)
@@ -120,7 +122,7 @@ class BulkLoadLiquidityPoolOperation
                           "FROM liquiditypool "
                           "WHERE poolasset IN r";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto be = prep.statement().get_backend();
         if (be == nullptr)
         {
@@ -148,7 +150,7 @@ class BulkLoadLiquidityPoolOperation
                           "FROM liquiditypool "
                           "WHERE poolasset IN (SELECT * from r)";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto& st = prep.statement();
         st.exchange(soci::use(strPoolAssets));
         return executeAndFetch(st);
@@ -158,13 +160,13 @@ class BulkLoadLiquidityPoolOperation
 
 UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
 LedgerTxnRoot::Impl::bulkLoadLiquidityPool(
-    UnorderedSet<LedgerKey> const& keys) const
+    UnorderedSet<LedgerKey> const& keys, soci::session& session) const
 {
     if (!keys.empty())
     {
-        BulkLoadLiquidityPoolOperation op(mApp.getDatabase(), keys);
+        BulkLoadLiquidityPoolOperation op(mApp.getDatabase(), session, keys);
         return populateLoadedEntries(
-            keys, mApp.getDatabase().doDatabaseTypeSpecificOperation(op));
+            keys, doDatabaseTypeSpecificOperation(session, op));
     }
     else
     {
@@ -292,48 +294,34 @@ class BulkUpsertLiquidityPoolOperation
         }
     }
 
-    void
-    doSociGenericOperation()
+    BulkUpsert
+    bulkUpsert() const
     {
-        std::string sql =
-            "INSERT INTO liquiditypool "
-            "(poolasset, asseta, assetb, ledgerentry, lastmodified) "
-            "VALUES "
-            "( :id, :v1, :v2, :v3, :v4 ) "
-            "ON CONFLICT (poolasset) DO UPDATE SET "
-            "asseta = excluded.asseta, "
-            "assetb = excluded.assetb, "
-            "ledgerentry = excluded.ledgerentry, "
-            "lastmodified = excluded.lastmodified";
-
-        auto prep = mDb.getPreparedStatement(sql);
-        soci::statement& st = prep.statement();
-        st.exchange(soci::use(mPoolAssets));
-        st.exchange(soci::use(mAssetAs));
-        st.exchange(soci::use(mAssetBs));
-        st.exchange(soci::use(mLiquidityPoolEntries));
-        st.exchange(soci::use(mLastModifieds));
-        st.define_and_bind();
-        {
-            auto timer = mDb.getUpsertTimer("liquiditypool");
-            st.execute(true);
-        }
-        if (static_cast<size_t>(st.get_affected_rows()) != mPoolAssets.size())
-        {
-            throw std::runtime_error("Could not update data in SQL");
-        }
+        BulkUpsert upsert(mDb, "liquiditypool", "liquiditypool", {"poolasset"});
+        upsert.addColumn("poolasset", mPoolAssets);
+        upsert.addColumn("asseta", mAssetAs);
+        upsert.addColumn("assetb", mAssetBs);
+        upsert.addColumn("ledgerentry", mLiquidityPoolEntries);
+        upsert.addColumn("lastmodified", mLastModifieds);
+        return upsert;
     }
 
     void
     doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
     {
-        doSociGenericOperation();
+        bulkUpsert().execute(sq);
     }
 
 #ifdef USE_POSTGRES
     void
     doPostgresSpecificOperation(soci::postgresql_session_backend* pg) override
     {
+        if (BulkUpsert::usePostgresCopy(mPoolAssets.size()))
+        {
+            bulkUpsert().execute(pg);
+            return;
+        }
+
         std::string strPoolAssets, strAssetAs, strAssetBs,
             strLiquidityPoolEntry, strLastModifieds;
 
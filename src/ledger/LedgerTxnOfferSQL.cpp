@@ -4,6 +4,7 @@
 
 #include "crypto/KeyUtils.h"
 #include "crypto/SecretKey.h"
+#include "database/BulkUpsert.h"
 #include "database/Database.h"
 #include "database/DatabaseTypeSpecificOperation.h"
 #include "ledger/LedgerTxnImpl.h"
@@ -418,63 +419,41 @@ class BulkUpsertOffersOperation : public DatabaseTypeSpecificOperation<void>
         }
     }
 
-    void
-    doSociGenericOperation()
+    BulkUpsert
+    bulkUpsert() const
     {
-        std::string sql =
-            "INSERT INTO offers ( "
-            "sellerid, offerid, sellingasset, buyingasset, "
-            "amount, pricen, priced, price, flags, lastmodified, extension, "
-            "ledgerext "
-            ") VALUES ( "
-            ":v1, :v2, :v3, :v4, :v5, :v6, :v7, :v8, :v9, :v10, :v11, :v12 "
-            ") ON CONFLICT (offerid) DO UPDATE SET "
-            "sellerid = excluded.sellerid, "
-            "sellingasset = excluded.sellingasset, "
-            "buyingasset = excluded.buyingasset, "
-            "amount = excluded.amount, "
-            "pricen = excluded.pricen, "
-            "priced = excluded.priced, "
-            "price = excluded.price, "
-            "flags = excluded.flags, "
-            "lastmodified = excluded.lastmodified, "
-            "extension = excluded.extension, "
-            "ledgerext = excluded.ledgerext";
-        auto prep = mDB.getPreparedStatement(sql);
-        soci::statement& st = prep.statement();
-        st.exchange(soci::use(mSellerIDs));
-        st.exchange(soci::use(mOfferIDs));
-        st.exchange(soci::use(mSellingAssets));
-        st.exchange(soci::use(mBuyingAssets));
-        st.exchange(soci::use(mAmounts));
-        st.exchange(soci::use(mPriceNs));
-        st.exchange(soci::use(mPriceDs));
-        st.exchange(soci::use(mPrices));
-        st.exchange(soci::use(mFlags));
-        st.exchange(soci::use(mLastModifieds));
-        st.exchange(soci::use(mExtensions));
-        st.exchange(soci::use(mLedgerExtensions));
-        st.define_and_bind();
-        {
-            auto timer = mDB.getUpsertTimer("offer");
-            st.execute(true);
-        }
-        if (static_cast<size_t>(st.get_affected_rows()) != mOfferIDs.size())
-        {
-            throw std::runtime_error("Could not update data in SQL");
-        }
+        BulkUpsert upsert(mDB, "offers", "offer", {"offerid"});
+        upsert.addColumn("sellerid", mSellerIDs);
+        upsert.addColumn("offerid", mOfferIDs);
+        upsert.addColumn("sellingasset", mSellingAssets);
+        upsert.addColumn("buyingasset", mBuyingAssets);
+        upsert.addColumn("amount", mAmounts);
+        upsert.addColumn("pricen", mPriceNs);
+        upsert.addColumn("priced", mPriceDs);
+        upsert.addColumn("price", mPrices);
+        upsert.addColumn("flags", mFlags);
+        upsert.addColumn("lastmodified", mLastModifieds);
+        upsert.addColumn("extension", mExtensions);
+        upsert.addColumn("ledgerext", mLedgerExtensions);
+        return upsert;
     }
 
     void
     doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
     {
-        doSociGenericOperation();
+        bulkUpsert().execute(sq);
     }
 
 #ifdef USE_POSTGRES
     void
     doPostgresSpecificOperation(soci::postgresql_session_backend* pg) override
     {
+        if (BulkUpsert::usePostgresCopy(mOfferIDs.size()))
+        {
+            bulkUpsert().execute(pg);
+            return;
+        }
+
 
         std::string strSellerIDs, strOfferIDs, strSellingAssets,
             strBuyingAssets, strAmounts, strPriceNs, strPriceDs, strPrices,
@@ -704,6 +683,7 @@ class BulkLoadOffersOperation
     : public DatabaseTypeSpecificOperation<std::vector<LedgerEntry>>
 {
     Database& mDb;
+    soci::session& mSession;
     std::vector<int64_t> mOfferIDs;
     UnorderedSet<LedgerKey> mKeys;
 
@@ -766,8 +746,9 @@ class BulkLoadOffersOperation
     }
 
   public:
-    BulkLoadOffersOperation(Database& db, UnorderedSet<LedgerKey> const& keys)
-        : mDb(db)
+    BulkLoadOffersOperation(Database& db, soci::session& session,
+                            UnorderedSet<LedgerKey> const& keys)
+        : mDb(db), mSession(session)
     {
         mOfferIDs.reserve(keys.size());
         for (auto const& k : keys)
@@ -789,7 +770,7 @@ class BulkLoadOffersOperation
             "ledgerext "
             "FROM offers WHERE offerid IN carray(?, ?, 'int64')";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto be = prep.statement().get_backend();
         if (be == nullptr)
         {
@@ -818,7 +799,7 @@ class BulkLoadOffersOperation
             "amount, pricen, priced, flags, lastmodified, extension, "
             "ledgerext "
             "FROM offers WHERE offerid IN (SELECT * FROM r)";
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto& st = prep.statement();
         st.exchange(soci::use(strOfferIDs));
         return executeAndFetch(st);
@@ -827,15 +808,16 @@ class BulkLoadOffersOperation
 };
 
 UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
-LedgerTxnRoot::Impl::bulkLoadOffers(UnorderedSet<LedgerKey> const& keys) const
+LedgerTxnRoot::Impl::bulkLoadOffers(
+    UnorderedSet<LedgerKey> const& keys, soci::session& session) const
 {
     ZoneScoped;
     ZoneValue(static_cast<int64_t>(keys.size()));
     if (!keys.empty())
     {
-        BulkLoadOffersOperation op(mApp.getDatabase(), keys);
+        BulkLoadOffersOperation op(mApp.getDatabase(), session, keys);
         return populateLoadedEntries(
-            keys, mApp.getDatabase().doDatabaseTypeSpecificOperation(op));
+            keys, doDatabaseTypeSpecificOperation(session, op));
     }
     else
     {
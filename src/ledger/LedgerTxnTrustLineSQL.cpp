@@ -4,6 +4,7 @@
 
 #include "crypto/KeyUtils.h"
 #include "crypto/SecretKey.h"
+#include "database/BulkUpsert.h"
 #include "database/Database.h"
 #include "database/DatabaseTypeSpecificOperation.h"
 #include "ledger/LedgerTxnImpl.h"
@@ -159,43 +160,34 @@ class BulkUpsertTrustLinesOperation : public DatabaseTypeSpecificOperation<void>
         }
     }
 
-    void
-    doSociGenericOperation()
+    BulkUpsert
+    bulkUpsert() const
     {
-        std::string sql = "INSERT INTO trustlines ( "
-                          "accountid, asset, ledgerentry, lastmodified)"
-                          "VALUES ( "
-                          ":id, :v1, :v2, :v3 "
-                          ") ON CONFLICT (accountid, asset) DO UPDATE SET "
-                          "ledgerentry = excluded.ledgerentry, "
-                          "lastmodified = excluded.lastmodified";
-        auto prep = mDB.getPreparedStatement(sql);
-        soci::statement& st = prep.statement();
-        st.exchange(soci::use(mAccountIDs));
-        st.exchange(soci::use(mAssets));
-        st.exchange(soci::use(mTrustLineEntries));
-        st.exchange(soci::use(mLastModifieds));
-        st.define_and_bind();
-        {
-            auto timer = mDB.getUpsertTimer("trustline");
-            st.execute(true);
-        }
-        if (static_cast<size_t>(st.get_affected_rows()) != mAccountIDs.size())
-        {
-            throw std::runtime_error("Could not update data in SQL");
-        }
+        BulkUpsert upsert(mDB, "trustlines", "trustline",
+                          {"accountid", "asset"});
+        upsert.addColumn("accountid", mAccountIDs);
+        upsert.addColumn("asset", mAssets);
+        upsert.addColumn("ledgerentry", mTrustLineEntries);
+        upsert.addColumn("lastmodified", mLastModifieds);
+        return upsert;
     }
 
     void
     doSqliteSpecificOperation(soci::sqlite3_session_backend* sq) override
     {
-        doSociGenericOperation();
+        bulkUpsert().execute(sq);
     }
 
 #ifdef USE_POSTGRES
     void
     doPostgresSpecificOperation(soci::postgresql_session_backend* pg) override
     {
+        if (BulkUpsert::usePostgresCopy(mAccountIDs.size()))
+        {
+            bulkUpsert().execute(pg);
+            return;
+        }
+
         PGconn* conn = pg->conn_;
 
         std::string strAccountIDs, strAssets, strTrustLineEntries,
@@ -374,6 +366,7 @@ class BulkLoadTrustLinesOperation
     : public DatabaseTypeSpecificOperation<std::vector<LedgerEntry>>
 {
     Database& mDb;
+    soci::session& mSession;
     std::vector<std::string> mAccountIDs;
     std::vector<std::string> mAssets;
 
@@ -408,9 +401,9 @@ class BulkLoadTrustLinesOperation
     }
 
   public:
-    BulkLoadTrustLinesOperation(Database& db,
+    BulkLoadTrustLinesOperation(Database& db, soci::session& session,
                                 UnorderedSet<LedgerKey> const& keys)
-        : mDb(db)
+        : mDb(db), mSession(session)
     {
         mAccountIDs.reserve(keys.size());
         mAssets.reserve(keys.size());
@@ -456,7 +449,7 @@ class BulkLoadTrustLinesOperation
                           ") SELECT accountid, asset, ledgerentry "
                           "FROM trustlines WHERE (accountid, asset) IN r";
 
-        auto prep = mDb.getPreparedStatement(sql);
+        auto prep = mDb.getPreparedStatement(sql, mSession);
         auto be = prep.statement().get_backend();
         if (be == nullptr)
         {
@@ -491,7 +484,8 @@ class BulkLoadTrustLinesOperation
             "ledgerentry "
             " FROM trustlines "
             "WHERE (accountid, asset) IN (SELECT * "
-            "FROM r)");
+            "FROM r)",
+            mSession);
         auto& st = prep.statement();
         st.exchange(soci::use(strAccountIDs));
         st.exchange(soci::use(strAssets));
@@ -502,15 +496,15 @@ class BulkLoadTrustLinesOperation
 
 UnorderedMap<LedgerKey, std::shared_ptr<LedgerEntry const>>
 LedgerTxnRoot::Impl::bulkLoadTrustLines(
-    UnorderedSet<LedgerKey> const& keys) const
+    UnorderedSet<LedgerKey> const& keys, soci::session& session) const
 {
     ZoneScoped;
     ZoneValue(static_cast<int64_t>(keys.size()));
     if (!keys.empty())
     {
-        BulkLoadTrustLinesOperation op(mApp.getDatabase(), keys);
+        BulkLoadTrustLinesOperation op(mApp.getDatabase(), session, keys);
         return populateLoadedEntries(
-            keys, mApp.getDatabase().doDatabaseTypeSpecificOperation(op));
+            keys, doDatabaseTypeSpecificOperation(session, op));
     }
     else
     {
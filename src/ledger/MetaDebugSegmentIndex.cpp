@@ -0,0 +1,140 @@
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/MetaDebugSegmentIndex.h"
+#include "util/Fs.h"
+#include "util/GlobalChecks.h"
+#include <Tracy.hpp>
+#include <algorithm>
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/array.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
+#include <fmt/format.h>
+#include <fstream>
+
+namespace caiz
+{
+
+namespace
+{
+template <typename Entries, typename Key>
+std::optional<std::streamoff>
+lookupSorted(Entries const& entries, Key const& key)
+{
+    auto it = std::lower_bound(
+        entries.begin(), entries.end(), key,
+        [](auto const& entry, Key const& k) { return entry.first < k; });
+    if (it == entries.end() || !(it->first == key))
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+}
+
+void
+MetaDebugSegmentIndex::addRecord(LedgerCloseMeta const& lcm,
+                                 size_t bytesWritten)
+{
+    ZoneScoped;
+    LedgerHeaderHistoryEntry const* header = nullptr;
+    xdr::xvector<TransactionResultMeta> const* txProcessing = nullptr;
+    switch (lcm.v())
+    {
+    case 0:
+        header = &lcm.v0().ledgerHeader;
+        txProcessing = &lcm.v0().txProcessing;
+        break;
+    case 1:
+        header = &lcm.v1().ledgerHeader;
+        txProcessing = &lcm.v1().txProcessing;
+        break;
+    default:
+        releaseAssert(false);
+    }
+
+    auto seq = header->header.ledgerSeq;
+    releaseAssert(mLedgerOffsets.empty() || mLedgerOffsets.back().first < seq);
+    mLedgerOffsets.emplace_back(seq, mEndOffset);
+
+    auto const sortedUpTo = mTxOffsets.size();
+    for (auto const& trm : *txProcessing)
+    {
+        mTxOffsets.emplace_back(trm.result.transactionHash, mEndOffset);
+    }
+    std::sort(mTxOffsets.begin() + sortedUpTo, mTxOffsets.end());
+    std::inplace_merge(mTxOffsets.begin(), mTxOffsets.begin() + sortedUpTo,
+                       mTxOffsets.end());
+
+    mEndOffset += bytesWritten;
+}
+
+std::optional<std::streamoff>
+MetaDebugSegmentIndex::lookupLedger(uint32_t ledgerSeq) const
+{
+    return lookupSorted(mLedgerOffsets, ledgerSeq);
+}
+
+std::optional<std::streamoff>
+MetaDebugSegmentIndex::lookupTransaction(Hash const& txHash) const
+{
+    std::array<uint8_t, 32> const& key = txHash;
+    return lookupSorted(mTxOffsets, key);
+}
+
+size_t
+MetaDebugSegmentIndex::size() const
+{
+    return mLedgerOffsets.size();
+}
+
+void
+MetaDebugSegmentIndex::save(std::filesystem::path const& indexPath) const
+{
+    ZoneScoped;
+    std::ofstream out;
+    out.exceptions(std::ios::failbit | std::ios::badbit);
+    out.open(indexPath, std::ios_base::binary | std::ios_base::trunc);
+    cereal::BinaryOutputArchive ar(out);
+    ar(META_DEBUG_INDEX_VERSION, *this);
+}
+
+std::optional<MetaDebugSegmentIndex>
+MetaDebugSegmentIndex::load(std::filesystem::path const& indexPath)
+{
+    ZoneScoped;
+    if (!fs::exists(indexPath.string()))
+    {
+        return std::nullopt;
+    }
+
+    std::ifstream in(indexPath, std::ios::binary);
+    if (!in)
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Error opening file {}"), indexPath));
+    }
+
+    uint32_t version;
+    cereal::BinaryInputArchive ar(in);
+    ar(version);
+    if (version != META_DEBUG_INDEX_VERSION)
+    {
+        return std::nullopt;
+    }
+
+    MetaDebugSegmentIndex index;
+    ar(index);
+    return index;
+}
+
+std::filesystem::path
+MetaDebugSegmentIndex::getIndexPath(std::filesystem::path const& segmentPath)
+{
+    auto p = segmentPath;
+    p += ".index";
+    return p;
+}
+}
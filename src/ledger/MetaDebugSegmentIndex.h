@@ -0,0 +1,71 @@
+#pragma once
+
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "xdr/Caiz-ledger.h"
+#include <array>
+#include <filesystem>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace caiz
+{
+
+// MetaDebugSegmentIndex maps ledger sequence numbers and transaction hashes to
+// the file offset of the LedgerCloseMeta record containing them in a
+// meta-debug segment. It is built incrementally while the segment is written
+// and saved next to the segment (see getIndexPath) when the segment is
+// rotated, so that tools like dump-xdr can seek straight to the record they
+// are looking for instead of decoding the whole segment.
+class MetaDebugSegmentIndex
+{
+  public:
+    inline static const uint32_t META_DEBUG_INDEX_VERSION = 1;
+
+    // Records the LedgerCloseMeta that was just written to the segment,
+    // occupying bytesWritten bytes starting at the end of the previously
+    // recorded record.
+    void addRecord(LedgerCloseMeta const& lcm, size_t bytesWritten);
+
+    // Returns the offset of the record for the given ledger, or std::nullopt
+    // if the segment does not contain it.
+    std::optional<std::streamoff> lookupLedger(uint32_t ledgerSeq) const;
+
+    // Returns the offset of the record for the ledger that applied the given
+    // transaction, or std::nullopt if the segment does not contain it.
+    std::optional<std::streamoff> lookupTransaction(Hash const& txHash) const;
+
+    // Number of records (ledgers) indexed.
+    size_t size() const;
+
+    void save(std::filesystem::path const& indexPath) const;
+
+    // Loads the index at indexPath. Returns std::nullopt if the file does
+    // not exist or was written by a different index version.
+    static std::optional<MetaDebugSegmentIndex>
+    load(std::filesystem::path const& indexPath);
+
+    // Returns the path of the index file for the given segment.
+    static std::filesystem::path
+    getIndexPath(std::filesystem::path const& segmentPath);
+
+    template <class Archive>
+    void
+    serialize(Archive& ar)
+    {
+        ar(mLedgerOffsets, mTxOffsets, mEndOffset);
+    }
+
+  private:
+    // Both vectors are kept sorted by key. Ledgers are appended in increasing
+    // order; transaction hashes are sorted when a record is added. Hashes are
+    // stored as plain std::arrays so that cereal's binary archive can
+    // serialize them directly.
+    std::vector<std::pair<uint32_t, std::streamoff>> mLedgerOffsets;
+    std::vector<std::pair<std::array<uint8_t, 32>, std::streamoff>> mTxOffsets;
+    std::streamoff mEndOffset{0};
+};
+}
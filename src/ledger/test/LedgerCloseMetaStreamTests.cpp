@@ -4,15 +4,19 @@
 
 #include "crypto/Hex.h"
 #include "crypto/Random.h"
+#include "crypto/SHA.h"
 #include "crypto/SecretKey.h"
 #include "history/HistoryArchiveManager.h"
 #include "history/test/HistoryTestsUtils.h"
 #include "ledger/FlushAndRotateMetaDebugWork.h"
 #include "ledger/LedgerTxn.h"
+#include "ledger/MetaDebugSegmentIndex.h"
 #include "ledger/test/LedgerTestUtils.h"
 #include "lib/catch.hpp"
+#include "lib/json/json.h"
 #include "main/Application.h"
 #include "main/ApplicationUtils.h"
+#include "main/dumpxdr.h"
 #include "simulation/Simulation.h"
 #include "test/TestUtils.h"
 #include "test/TxTests.h"
@@ -27,6 +31,7 @@
 #include <fmt/format.h>
 #include <fstream>
 #include <iterator>
+#include <sstream>
 
 using namespace caiz;
 
@@ -274,6 +279,7 @@ TEST_CASE("LedgerCloseMetaStream file descriptor - REPLAY_IN_MEMORY",
 #endif
 
     bool const delayMeta = GENERATE(true, false);
+    bool const asyncMeta = GENERATE(true, false);
 
     // Step 3: pass it to an application and have it catch up to the generated
     // history, streaming ledgerCloseMeta to the file descriptor.
@@ -285,6 +291,7 @@ TEST_CASE("LedgerCloseMetaStream file descriptor - REPLAY_IN_MEMORY",
         cfg.RUN_STANDALONE = true;
         cfg.setInMemoryMode();
         cfg.EXPERIMENTAL_PRECAUTION_DELAY_META = delayMeta;
+        cfg.EXPERIMENTAL_ASYNC_META_STREAM = asyncMeta;
         VirtualClock clock;
         auto app = createTestApplication(clock, cfg, /*newdb=*/false);
 
@@ -434,6 +441,162 @@ TEST_CASE("METADATA_DEBUG_LEDGERS works", "[metadebug]")
     REQUIRE(gotToExpectedSize);
 }
 
+TEST_CASE("METADATA_DEBUG_INDEXED_SEGMENTS works", "[metadebug]")
+{
+    VirtualClock clock;
+    Config cfg = getTestConfig();
+    cfg.MANUAL_CLOSE = false;
+    cfg.METADATA_DEBUG_LEDGERS = 768;
+    cfg.METADATA_DEBUG_INDEXED_SEGMENTS = true;
+    auto app = createTestApplication(clock, cfg);
+    app->start();
+    auto bucketDir = app->getBucketManager().getBucketDir();
+    auto& lm = app->getLedgerManager();
+    while (lm.getLastClosedLedgerNum() < cfg.METADATA_DEBUG_LEDGERS)
+    {
+        clock.crank(false);
+    }
+    while (!app->getWorkScheduler().allChildrenDone())
+    {
+        clock.crank(false);
+    }
+
+    auto dir = FlushAndRotateMetaDebugWork::getMetaDebugDirPath(bucketDir);
+    auto files = FlushAndRotateMetaDebugWork::listMetaDebugFiles(bucketDir);
+    REQUIRE(!files.empty());
+    size_t indexedSegments = 0;
+    for (auto const& file : files)
+    {
+        // Indexed segments are never gzipped.
+        REQUIRE(file.extension() == ".xdr");
+        auto segment = dir / file;
+        auto index = MetaDebugSegmentIndex::load(
+            MetaDebugSegmentIndex::getIndexPath(segment));
+        if (!index)
+        {
+            // The segment currently being written has no index yet.
+            continue;
+        }
+        ++indexedSegments;
+
+        // Every record in the segment must be found at its indexed offset.
+        std::vector<std::pair<uint32_t, std::vector<Hash>>> records;
+        XDRInputFileStream in;
+        in.open(segment.string());
+        LedgerCloseMeta lcm;
+        while (in.readOne(lcm))
+        {
+            auto const& header =
+                lcm.v() == 0 ? lcm.v0().ledgerHeader : lcm.v1().ledgerHeader;
+            auto const& txProcessing =
+                lcm.v() == 0 ? lcm.v0().txProcessing : lcm.v1().txProcessing;
+            std::vector<Hash> hashes;
+            for (auto const& trm : txProcessing)
+            {
+                hashes.emplace_back(trm.result.transactionHash);
+            }
+            records.emplace_back(header.header.ledgerSeq, hashes);
+        }
+        REQUIRE(index->size() == records.size());
+
+        for (auto const& [seq, hashes] : records)
+        {
+            auto offset = index->lookupLedger(seq);
+            REQUIRE(offset);
+            XDRInputFileStream seekIn;
+            seekIn.open(segment.string());
+            seekIn.seek(*offset);
+            REQUIRE(seekIn.readOne(lcm));
+            auto const& header =
+                lcm.v() == 0 ? lcm.v0().ledgerHeader : lcm.v1().ledgerHeader;
+            REQUIRE(header.header.ledgerSeq == seq);
+            for (auto const& h : hashes)
+            {
+                REQUIRE(index->lookupTransaction(h) == offset);
+            }
+        }
+        REQUIRE(!index->lookupLedger(records.back().first + 1));
+        REQUIRE(!index->lookupTransaction(sha256("not a transaction")));
+    }
+    REQUIRE(indexedSegments > 0);
+}
+
+TEST_CASE("dump-xdr finds meta in indexed and unindexed segments",
+          "[metadebug]")
+{
+    VirtualClock clock;
+    Config cfg = getTestConfig();
+    cfg.MANUAL_CLOSE = false;
+    cfg.METADATA_DEBUG_LEDGERS = 768;
+    cfg.METADATA_DEBUG_INDEXED_SEGMENTS = true;
+    auto app = createTestApplication(clock, cfg);
+    app->start();
+    auto bucketDir = app->getBucketManager().getBucketDir();
+    auto& lm = app->getLedgerManager();
+    while (lm.getLastClosedLedgerNum() < cfg.METADATA_DEBUG_LEDGERS)
+    {
+        clock.crank(false);
+    }
+    while (!app->getWorkScheduler().allChildrenDone())
+    {
+        clock.crank(false);
+    }
+
+    // Number of records dump-xdr prints for the given filters
+    auto countDumped = [](std::string const& segment,
+                          std::optional<uint32_t> ledgerSeq,
+                          std::optional<Hash> txHash) {
+        std::ostringstream out;
+        dumpXdrStreams({segment}, out, true, std::nullopt, ledgerSeq, txHash,
+                       1);
+        if (out.str().empty())
+        {
+            return Json::ArrayIndex(0);
+        }
+        Json::Value records;
+        REQUIRE(Json::Reader().parse(out.str(), records));
+        REQUIRE(records.isArray());
+        return records.size();
+    };
+    auto checkDump = [&](std::string const& segment, uint32_t seq) {
+        REQUIRE(countDumped(segment, seq, std::nullopt) == 1);
+        REQUIRE(countDumped(segment, seq + 100000, std::nullopt) == 0);
+        REQUIRE(countDumped(segment, std::nullopt,
+                            sha256("not a transaction")) == 0);
+        // A transaction that isn't in the ledger is no match, not an error
+        REQUIRE(countDumped(segment, seq, sha256("not a transaction")) == 0);
+    };
+
+    auto dir = FlushAndRotateMetaDebugWork::getMetaDebugDirPath(bucketDir);
+    auto files = FlushAndRotateMetaDebugWork::listMetaDebugFiles(bucketDir);
+    size_t indexedSegments = 0;
+    for (auto const& file : files)
+    {
+        auto segment = (dir / file).string();
+        auto indexPath = MetaDebugSegmentIndex::getIndexPath(segment);
+        if (!MetaDebugSegmentIndex::load(indexPath))
+        {
+            // The segment currently being written has no index yet.
+            continue;
+        }
+        ++indexedSegments;
+
+        XDRInputFileStream in;
+        in.open(segment);
+        LedgerCloseMeta lcm;
+        REQUIRE(in.readOne(lcm));
+        auto const& header =
+            lcm.v() == 0 ? lcm.v0().ledgerHeader : lcm.v1().ledgerHeader;
+        auto seq = header.header.ledgerSeq;
+
+        checkDump(segment, seq);
+        // Without its index the segment is scanned, with the same results
+        std::filesystem::remove(indexPath);
+        checkDump(segment, seq);
+    }
+    REQUIRE(indexedSegments > 0);
+}
+
 TEST_CASE_VERSIONS("meta stream contains reasonable meta", "[ledgerclosemeta]")
 {
     Config cfg = getTestConfig();
@@ -2,6 +2,7 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "ledger/FlatOrderBook.h"
 #include "ledger/LedgerTxn.h"
 #include "ledger/LedgerTxnEntry.h"
 #include "ledger/LedgerTxnHeader.h"
@@ -18,6 +19,7 @@
 #include "util/Math.h"
 #include "util/XDROperators.h"
 #include <algorithm>
+#include <chrono>
 #include <fmt/format.h>
 #include <functional>
 #include <map>
@@ -1582,6 +1584,114 @@ TEST_CASE_VERSIONS("LedgerTxn load", "[ledgertxn]")
 #endif
 }
 
+TEST_CASE("LedgerTxn shares loaded entries until modified", "[ledgertxn]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(clock, getTestConfig());
+
+    LedgerEntry le;
+    le.data.type(ACCOUNT);
+    le.data.account() = LedgerTestUtils::generateValidAccountEntry();
+    le.lastModifiedLedgerSeq = 1;
+    LedgerKey key = LedgerEntryKey(le);
+    LedgerEntry modified = le;
+    ++modified.data.account().seqNum;
+
+    LedgerTxn ltx1(app->getLedgerTxnRoot());
+    REQUIRE(ltx1.create(le));
+    auto parentVersion = ltx1.getNewestVersion(key, false);
+
+    SECTION("load")
+    {
+        {
+            LedgerTxn ltx2(ltx1);
+            auto ltxe = ltx2.load(key);
+            LedgerTxnEntry const& constLtxe = ltxe;
+            REQUIRE(&constLtxe.current() == &parentVersion->ledgerEntry());
+
+            ltxe.current() = modified;
+            REQUIRE(&constLtxe.current() != &parentVersion->ledgerEntry());
+            REQUIRE(parentVersion->ledgerEntry() == le);
+            REQUIRE(ltx2.getNewestVersion(key, false)->ledgerEntry() ==
+                    modified);
+        }
+        REQUIRE(ltx1.getNewestVersion(key, false)->ledgerEntry() == le);
+    }
+
+    SECTION("newest version observes later modifications")
+    {
+        LedgerTxn ltx2(ltx1);
+        auto ltxe = ltx2.load(key);
+        auto newest = ltx2.getNewestVersion(key, false);
+        REQUIRE(newest != parentVersion);
+
+        ltxe.current() = modified;
+        REQUIRE(newest->ledgerEntry() == modified);
+        REQUIRE(parentVersion->ledgerEntry() == le);
+    }
+
+    SECTION("loadWithoutRecord")
+    {
+        LedgerTxn ltx2(ltx1);
+        auto ltxe = ltx2.loadWithoutRecord(key, false);
+        REQUIRE(&ltxe.current() == &parentVersion->ledgerEntry());
+    }
+
+    SECTION("commit")
+    {
+        {
+            LedgerTxn ltx2(ltx1);
+            ltx2.load(key).current() = modified;
+            ltx2.commit();
+        }
+        REQUIRE(parentVersion->ledgerEntry() == le);
+        auto newest = ltx1.getNewestVersion(key, false);
+        REQUIRE(newest->ledgerEntry().data == modified.data);
+    }
+}
+
+TEST_CASE("LedgerTxn copies shared entries only when modified", "[ledgertxn]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(clock, getTestConfig());
+
+    size_t const numEntries = 100;
+    size_t const modifyEvery = 10;
+    std::vector<LedgerEntry> entries;
+    LedgerTxn ltx1(app->getLedgerTxnRoot());
+    for (size_t i = 0; i < numEntries; ++i)
+    {
+        LedgerEntry le;
+        le.data.type(ACCOUNT);
+        le.data.account() = LedgerTestUtils::generateValidAccountEntry();
+        le.lastModifiedLedgerSeq = 1;
+        entries.emplace_back(le);
+        REQUIRE(ltx1.create(le));
+    }
+
+    // Reads every entry and modifies one in modifyEvery of them, returning
+    // how many entries were copied
+    auto countCopies = [&](bool readConst) {
+        auto before = LedgerEntryPtr::getNumUnsharedForTesting();
+        LedgerTxn ltx2(ltx1);
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            auto ltxe = ltx2.load(LedgerEntryKey(entries[i]));
+            auto const& acc = readConst ? ltxe.currentConst().data.account()
+                                        : ltxe.current().data.account();
+            REQUIRE(acc == entries[i].data.account());
+            if (i % modifyEvery == 0)
+            {
+                ++ltxe.current().data.account().seqNum;
+            }
+        }
+        return LedgerEntryPtr::getNumUnsharedForTesting() - before;
+    };
+
+    REQUIRE(countCopies(false) == numEntries);
+    REQUIRE(countCopies(true) == numEntries / modifyEvery);
+}
+
 TEST_CASE("LedgerTxn loadWithoutRecord", "[ledgertxn]")
 {
     VirtualClock clock;
@@ -2446,6 +2556,85 @@ testOffersByAccountAndAsset(
     }
 }
 
+TEST_CASE("LedgerTxn best offer frontier", "[ledgertxn]")
+{
+    VirtualClock clock;
+    auto app = createTestApplication(clock, getTestConfig());
+
+    auto a1 = LedgerTestUtils::generateValidAccountEntry().accountID;
+    Asset buying = LedgerTestUtils::generateValidOfferEntry().buying;
+    Asset selling = LedgerTestUtils::generateValidOfferEntry().selling;
+    REQUIRE(!(buying == selling));
+
+    // Walks the order book from the top the way offer crossing does, and
+    // returns the offerIDs seen (at most limit of them)
+    auto walk = [&](AbstractLedgerTxn& ltx,
+                    size_t limit = std::numeric_limits<size_t>::max()) {
+        std::vector<int64_t> offerIDs;
+        auto le = ltx.getBestOffer(buying, selling);
+        while (le && offerIDs.size() < limit)
+        {
+            auto const& oe = le->data.offer();
+            offerIDs.emplace_back(oe.offerID);
+            le = ltx.getBestOffer(buying, selling, {oe.price, oe.offerID});
+        }
+        return offerIDs;
+    };
+
+    {
+        LedgerTxn ltx(app->getLedgerTxnRoot());
+        applyLedgerTxnUpdates(
+            ltx, {{{a1, 1}, {buying, selling, Price{1, 1}, 1}},
+                  {{a1, 2}, {buying, selling, Price{2, 1}, 1}},
+                  {{a1, 3}, {buying, selling, Price{3, 1}, 1}},
+                  {{a1, 4}, {buying, selling, Price{4, 1}, 1}},
+                  {{a1, 5}, {buying, selling, Price{5, 1}, 1}}});
+        ltx.commit();
+    }
+
+    LedgerTxn ltx1(app->getLedgerTxnRoot());
+
+    auto crossInChild = [&](bool walkFirst) {
+        if (walkFirst)
+        {
+            REQUIRE(walk(ltx1, 2) == std::vector<int64_t>{1, 2});
+        }
+        {
+            // Erase the best offer, move a cached offer to the top and add an
+            // offer in the middle of the book
+            LedgerTxn ltx2(ltx1);
+            applyLedgerTxnUpdates(
+                ltx2, {{{a1, 1}, {buying, selling, Price{1, 1}, 0}},
+                       {{a1, 4}, {buying, selling, Price{3, 2}, 1}},
+                       {{a1, 6}, {buying, selling, Price{5, 2}, 1}}});
+            REQUIRE(walk(ltx2) == std::vector<int64_t>{4, 2, 6, 3, 5});
+            ltx2.commit();
+        }
+        REQUIRE(walk(ltx1) == std::vector<int64_t>{4, 2, 6, 3, 5});
+
+        {
+            // Move an offer to another asset pair and add one at the bottom
+            // of the book, now that ltx1 has cached all of it
+            LedgerTxn ltx2(ltx1);
+            applyLedgerTxnUpdates(
+                ltx2, {{{a1, 2}, {selling, buying, Price{2, 1}, 1}},
+                       {{a1, 7}, {buying, selling, Price{10, 1}, 1}}});
+            ltx2.commit();
+        }
+        REQUIRE(walk(ltx1) == std::vector<int64_t>{4, 6, 3, 5, 7});
+        REQUIRE(walk(ltx1, 1) == std::vector<int64_t>{4});
+    };
+
+    SECTION("cold frontier")
+    {
+        crossInChild(false);
+    }
+    SECTION("partially cached frontier")
+    {
+        crossInChild(true);
+    }
+}
+
 TEST_CASE("LedgerTxn loadOffersByAccountAndAsset", "[ledgertxn]")
 {
     auto a1 = LedgerTestUtils::generateValidAccountEntry().accountID;
@@ -3762,6 +3951,217 @@ TEST_CASE("LedgerTxn in memory order book", "[ledgertxn]")
 #endif
 }
 
+typedef std::vector<std::pair<OfferDescriptor, LedgerKey>> OfferList;
+
+static OfferList
+generateOfferDescriptors(size_t numOffers)
+{
+    OfferList offers;
+    offers.reserve(numOffers);
+    caiz::uniform_int_distribution<int32_t> priceDist(1, 10000);
+    for (size_t i = 0; i < numOffers; ++i)
+    {
+        auto oe = LedgerTestUtils::generateValidOfferEntry();
+        oe.offerID = i + 1;
+        oe.price.n = priceDist(gRandomEngine);
+        oe.price.d = priceDist(gRandomEngine);
+        offers.emplace_back(OfferDescriptor{oe.price, oe.offerID},
+                            offerKey(oe.sellerID, oe.offerID));
+    }
+    return offers;
+}
+
+TEST_CASE("FlatOrderBook", "[ledgertxn]")
+{
+    typedef std::map<OfferDescriptor, LedgerKey, IsBetterOfferComparator>
+        SortedOffers;
+
+    auto check = [](FlatOrderBook const& ob, SortedOffers const& expected,
+                    OfferDescriptor const& worseThan) {
+        REQUIRE(ob.empty() == expected.empty());
+        auto best = ob.best();
+        REQUIRE(bool(best) == !expected.empty());
+        if (best)
+        {
+            REQUIRE(*best == expected.begin()->second);
+        }
+
+        auto iter = expected.upper_bound(worseThan);
+        auto bestWorse = ob.bestWorseThan(worseThan);
+        REQUIRE(bool(bestWorse) == (iter != expected.end()));
+        if (bestWorse)
+        {
+            REQUIRE(*bestWorse == iter->second);
+        }
+    };
+
+    // Enough offers for the order book to merge and compact many times
+    size_t const numOffers = 20 * FlatOrderBook::MIN_MAX_PENDING;
+    auto offers = generateOfferDescriptors(numOffers);
+    caiz::uniform_int_distribution<size_t> offerDist(0, numOffers - 1);
+
+    auto runTest = [&](size_t insertWeight, size_t eraseWeight,
+                       size_t eraseBestWeight) {
+        FlatOrderBook ob;
+        SortedOffers expected;
+        caiz::uniform_int_distribution<size_t> opDist(
+            0, insertWeight + eraseWeight + eraseBestWeight - 1);
+        for (size_t i = 0; i < 10 * numOffers; ++i)
+        {
+            auto const& offer = offers[offerDist(gRandomEngine)];
+            auto op = opDist(gRandomEngine);
+            if (op < insertWeight)
+            {
+                ob.insert(offer.first, offer.second);
+                expected.emplace(offer.first, offer.second);
+            }
+            else if (op < insertWeight + eraseWeight)
+            {
+                ob.erase(offer.first);
+                expected.erase(offer.first);
+            }
+            else if (!expected.empty())
+            {
+                auto bestDesc = expected.begin()->first;
+                ob.erase(bestDesc);
+                expected.erase(bestDesc);
+            }
+            check(ob, expected, offers[offerDist(gRandomEngine)].first);
+        }
+
+        SortedOffers actual;
+        ob.forEachOffer([&](OfferDescriptor const& desc, LedgerKey const& key) {
+            REQUIRE(actual.emplace(desc, key).second);
+        });
+        REQUIRE(actual == expected);
+    };
+
+    SECTION("mostly inserts")
+    {
+        runTest(4, 1, 1);
+    }
+    SECTION("balanced")
+    {
+        runTest(2, 1, 1);
+    }
+    SECTION("mostly erases")
+    {
+        runTest(1, 2, 1);
+    }
+    SECTION("insert and cross best offer")
+    {
+        runTest(1, 0, 1);
+    }
+}
+
+TEST_CASE("FlatOrderBook benchmark", "[!hide][orderbookbench]")
+{
+    // Compares FlatOrderBook with the std::map the order books used to be.
+    // Each round crosses the best offer and walks the next few offers, like
+    // a path payment does, then inserts and erases offers anywhere in the
+    // order book, like offer updates from other transactions do.
+    size_t const numRounds = 200000;
+    size_t const walkLength = 8;
+
+    // The offer IDs of generateOfferDescriptors are one more than their index
+    auto descriptorOf = [](OfferList const& offers, LedgerKey const& key) {
+        return offers[key.offer().offerID - 1].first;
+    };
+
+    auto runFlat = [&](OfferList const& offers, size_t bookSize) {
+        FlatOrderBook ob;
+        for (size_t i = 0; i < bookSize; ++i)
+        {
+            ob.insert(offers[i].first, offers[i].second);
+        }
+
+        size_t found = 0;
+        size_t next = bookSize;
+        for (size_t round = 0; round < numRounds && !ob.empty(); ++round)
+        {
+            auto best = descriptorOf(offers, *ob.best());
+            auto worseThan = best;
+            for (size_t i = 0; i < walkLength; ++i)
+            {
+                auto key = ob.bestWorseThan(worseThan);
+                if (!key)
+                {
+                    break;
+                }
+                ++found;
+                worseThan = descriptorOf(offers, *key);
+            }
+            ob.erase(best);
+
+            auto const& inserted = offers[next++ % offers.size()];
+            ob.insert(inserted.first, inserted.second);
+            auto const& replaced = offers[(next + bookSize) % offers.size()];
+            ob.erase(replaced.first);
+            ob.insert(replaced.first, replaced.second);
+        }
+        return found;
+    };
+
+    auto runMap = [&](OfferList const& offers, size_t bookSize) {
+        std::map<OfferDescriptor, LedgerKey, IsBetterOfferComparator> ob;
+        for (size_t i = 0; i < bookSize; ++i)
+        {
+            ob.emplace(offers[i].first, offers[i].second);
+        }
+
+        size_t found = 0;
+        size_t next = bookSize;
+        for (size_t round = 0; round < numRounds && !ob.empty(); ++round)
+        {
+            auto best = ob.begin()->first;
+            auto worseThan = best;
+            for (size_t i = 0; i < walkLength; ++i)
+            {
+                auto iter = ob.upper_bound(worseThan);
+                if (iter == ob.end())
+                {
+                    break;
+                }
+                ++found;
+                worseThan = iter->first;
+            }
+            ob.erase(best);
+
+            auto const& inserted = offers[next++ % offers.size()];
+            ob.emplace(inserted.first, inserted.second);
+            auto const& replaced = offers[(next + bookSize) % offers.size()];
+            ob.erase(replaced.first);
+            ob.emplace(replaced.first, replaced.second);
+        }
+        return found;
+    };
+
+    auto toMilliseconds = [](auto duration) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration)
+            .count();
+    };
+
+    for (size_t bookSize : {100, 1000, 10000, 100000})
+    {
+        // Twice as many offers as the order book holds, so that inserts
+        // land anywhere in it
+        auto offers = generateOfferDescriptors(2 * bookSize);
+
+        auto start = std::chrono::steady_clock::now();
+        auto flatFound = runFlat(offers, bookSize);
+        auto flatTime = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        auto mapFound = runMap(offers, bookSize);
+        auto mapTime = std::chrono::steady_clock::now() - start;
+
+        REQUIRE(flatFound == mapFound);
+        CLOG_INFO(Ledger, "{} offers: FlatOrderBook {} ms, std::map {} ms",
+                  bookSize, toMilliseconds(flatTime),
+                  toMilliseconds(mapTime));
+    }
+}
+
 TEST_CASE_VERSIONS("LedgerTxn bulk-load offers", "[ledgertxn]")
 {
     auto runTest = [&](Config::TestDbMode mode) {
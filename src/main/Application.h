@@ -5,6 +5,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "main/Config.h"
+#include "util/WorkerPool.h"
 #include "xdr/Caiz-ledger-entries.h"
 #include "xdr/Caiz-types.h"
 #include <lib/json/json.h>
@@ -222,16 +223,21 @@ class Application
     virtual BanManager& getBanManager() = 0;
     virtual StatusManager& getStatusManager() = 0;
 
-    // Get the worker IO service, served by background threads. Work posted to
+    // Get the worker IO service, served by a background thread. Work posted to
     // this io_context will execute in parallel with the calling thread, so use
-    // with caution.
+    // with caution. Prefer postOnBackgroundThread for anything but asio
+    // objects that need an io_context.
     virtual asio::io_context& getWorkerIOContext() = 0;
 
     virtual void postOnMainThread(
         std::function<void()>&& f, std::string&& name,
         Scheduler::ActionType type = Scheduler::ActionType::NORMAL_ACTION) = 0;
-    virtual void postOnBackgroundThread(std::function<void()>&& f,
-                                        std::string jobName) = 0;
+    // Runs f on one of the WORKER_THREADS background threads. Tasks that
+    // something is waiting on should use LATENCY_SENSITIVE, so they never
+    // queue up behind long BULK tasks.
+    virtual void postOnBackgroundThread(
+        std::function<void()>&& f, std::string jobName,
+        WorkerPool::Priority priority = WorkerPool::Priority::BULK) = 0;
 
     // Perform actions necessary to transition from BOOTING_STATE to other
     // states. In particular: either reload or reinitialize the database, and
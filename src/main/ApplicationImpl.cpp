@@ -80,7 +80,7 @@ namespace caiz
 ApplicationImpl::ApplicationImpl(VirtualClock& clock, Config const& cfg)
     : mVirtualClock(clock)
     , mConfig(cfg)
-    , mWorkerIOContext(mConfig.WORKER_THREADS)
+    , mWorkerIOContext(1)
     , mWork(std::make_unique<asio::io_context::work>(mWorkerIOContext))
     , mWorkerThreads()
     , mStopSignals(clock.getIOContext(), SIGINT)
@@ -92,6 +92,12 @@ ApplicationImpl::ApplicationImpl(VirtualClock& clock, Config const& cfg)
           std::make_unique<medida::MetricsRegistry>(cfg.HISTOGRAM_WINDOW_SIZE))
     , mPostOnMainThreadDelay(
           mMetrics->NewTimer({"app", "post-on-main-thread", "delay"}))
+    , mPostOnMainThreadNormalDelay(
+          mMetrics->NewTimer({"app", "post-on-main-thread", "normal-delay"}))
+    , mPostOnMainThreadDroppableDelay(mMetrics->NewTimer(
+          {"app", "post-on-main-thread", "droppable-delay"}))
+    , mPostOnMainThreadCriticalDelay(mMetrics->NewTimer(
+          {"app", "post-on-main-thread", "critical-delay"}))
     , mPostOnBackgroundThreadDelay(
           mMetrics->NewTimer({"app", "post-on-background-thread", "delay"}))
     , mStartedOn(clock.system_now())
@@ -134,14 +140,16 @@ ApplicationImpl::ApplicationImpl(VirtualClock& clock, Config const& cfg)
 
     auto t = mConfig.WORKER_THREADS;
     LOG_DEBUG(DEFAULT_LOG, "Application constructing (worker threads: {})", t);
-    while (t--)
-    {
-        auto thread = std::thread{[this]() {
-            runCurrentThreadWithLowPriority();
-            mWorkerIOContext.run();
-        }};
-        mWorkerThreads.emplace_back(std::move(thread));
-    }
+    mWorkerPool = std::make_unique<WorkerPool>(
+        t, *mMetrics, mConfig.EXPERIMENTAL_WORKER_THREAD_CPUS);
+
+    // The worker IO context only serves asio objects like resolvers and signal
+    // sets, background tasks go to mWorkerPool
+    auto thread = std::thread{[this]() {
+        runCurrentThreadWithLowPriority();
+        mWorkerIOContext.run();
+    }};
+    mWorkerThreads.emplace_back(std::move(thread));
 }
 
 static void
@@ -890,7 +898,14 @@ ApplicationImpl::joinAllThreads()
     {
         w.join();
     }
-    LOG_DEBUG(DEFAULT_LOG, "Joined all {} threads", mWorkerThreads.size());
+    mWorkerThreads.clear();
+    if (mWorkerPool)
+    {
+        LOG_DEBUG(DEFAULT_LOG, "Joining {} worker pool threads",
+                  mWorkerPool->numThreads());
+        mWorkerPool->shutdown();
+    }
+    LOG_DEBUG(DEFAULT_LOG, "Joined all threads");
 }
 
 std::string
@@ -1356,9 +1371,23 @@ ApplicationImpl::postOnMainThread(std::function<void()>&& f, std::string&& name,
 {
     LogSlowExecution isSlow{name, LogSlowExecution::Mode::MANUAL,
                             "executed after"};
+    medida::Timer* typeDelay = &mPostOnMainThreadNormalDelay;
+    switch (type)
+    {
+    case Scheduler::ActionType::NORMAL_ACTION:
+        break;
+    case Scheduler::ActionType::DROPPABLE_ACTION:
+        typeDelay = &mPostOnMainThreadDroppableDelay;
+        break;
+    case Scheduler::ActionType::CRITICAL_ACTION:
+        typeDelay = &mPostOnMainThreadCriticalDelay;
+        break;
+    }
     mVirtualClock.postAction(
-        [this, f = std::move(f), isSlow]() {
-            mPostOnMainThreadDelay.Update(isSlow.checkElapsedTime());
+        [this, f = std::move(f), isSlow, typeDelay]() {
+            auto delay = isSlow.checkElapsedTime();
+            mPostOnMainThreadDelay.Update(delay);
+            typeDelay->Update(delay);
             auto sleepFor =
                 this->getConfig().ARTIFICIALLY_SLEEP_MAIN_THREAD_FOR_TESTING;
             if (sleepFor > std::chrono::microseconds::zero())
@@ -1372,14 +1401,17 @@ ApplicationImpl::postOnMainThread(std::function<void()>&& f, std::string&& name,
 
 void
 ApplicationImpl::postOnBackgroundThread(std::function<void()>&& f,
-                                        std::string jobName)
+                                        std::string jobName,
+                                        WorkerPool::Priority priority)
 {
     LogSlowExecution isSlow{std::move(jobName), LogSlowExecution::Mode::MANUAL,
                             "executed after"};
-    asio::post(getWorkerIOContext(), [this, f = std::move(f), isSlow]() {
-        mPostOnBackgroundThreadDelay.Update(isSlow.checkElapsedTime());
-        f();
-    });
+    mWorkerPool->post(
+        [this, f = std::move(f), isSlow]() {
+            mPostOnBackgroundThreadDelay.Update(isSlow.checkElapsedTime());
+            f();
+        },
+        priority);
 }
 
 void
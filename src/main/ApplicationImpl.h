@@ -80,8 +80,9 @@ class ApplicationImpl : public Application
     virtual asio::io_context& getWorkerIOContext() override;
     virtual void postOnMainThread(std::function<void()>&& f, std::string&& name,
                                   Scheduler::ActionType type) override;
-    virtual void postOnBackgroundThread(std::function<void()>&& f,
-                                        std::string jobName) override;
+    virtual void postOnBackgroundThread(
+        std::function<void()>&& f, std::string jobName,
+        WorkerPool::Priority priority = WorkerPool::Priority::BULK) override;
 
     virtual void start() override;
 
@@ -147,6 +148,7 @@ class ApplicationImpl : public Application
 
     asio::io_context mWorkerIOContext;
     std::unique_ptr<asio::io_context::work> mWork;
+    std::unique_ptr<WorkerPool> mWorkerPool;
 
     std::unique_ptr<BucketManager> mBucketManager;
     std::unique_ptr<Database> mDatabase;
@@ -196,6 +198,10 @@ class ApplicationImpl : public Application
 
     std::unique_ptr<medida::MetricsRegistry> mMetrics;
     medida::Timer& mPostOnMainThreadDelay;
+    // mPostOnMainThreadDelay broken out by Scheduler::ActionType
+    medida::Timer& mPostOnMainThreadNormalDelay;
+    medida::Timer& mPostOnMainThreadDroppableDelay;
+    medida::Timer& mPostOnMainThreadCriticalDelay;
     medida::Timer& mPostOnBackgroundThreadDelay;
     VirtualClock::system_time_point mStartedOn;
 
@@ -112,6 +112,7 @@ CommandHandler::CommandHandler(Application& app) : mApp(app)
     addRoute("info", &CommandHandler::info);
     addRoute("ll", &CommandHandler::ll);
     addRoute("logrotate", &CommandHandler::logRotate);
+    addRoute("mainthreadprofile", &CommandHandler::mainThreadProfile);
     addRoute("manualclose", &CommandHandler::manualClose);
     addRoute("metrics", &CommandHandler::metrics);
     addRoute("tx", &CommandHandler::tx);
@@ -406,6 +407,23 @@ CommandHandler::logRotate(std::string const& params, std::string& retStr)
     Logging::rotate();
 }
 
+void
+CommandHandler::mainThreadProfile(std::string const& params,
+                                  std::string& retStr)
+{
+    ZoneScoped;
+    std::map<std::string, std::string> retMap;
+    http::server::server::parseParams(params, retMap);
+    size_t lim = parseOptionalParamOrDefault<size_t>(retMap, "limit", 20);
+
+    auto& profiler = mApp.getClock().getEventLoopProfiler();
+    retStr = profiler.getJsonInfo(lim).toStyledString();
+    if (retMap["reset"] == "true")
+    {
+        profiler.reset();
+    }
+}
+
 void
 CommandHandler::connect(std::string const& params, std::string& retStr)
 {
@@ -40,6 +40,7 @@
 #include <iostream>
 #include <lib/clara.hpp>
 #include <optional>
+#include <thread>
 
 namespace caiz
 {
@@ -1000,14 +1001,47 @@ runConvertId(CommandLineArgs const& args)
 int
 runDumpXDR(CommandLineArgs const& args)
 {
-    std::string xdr;
+    std::vector<std::string> files;
     bool compact = false;
+    std::optional<std::string> filterQuery;
+    std::optional<uint32_t> ledgerSeq;
+    std::string txHash;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+
+    auto ledgerSeqParser =
+        clara::Opt{[&](uint64_t seq) {
+                       if (seq > UINT32_MAX)
+                       {
+                           return clara::ParserResult::runtimeError(
+                               "ledger sequence number is out of range");
+                       }
+                       ledgerSeq = static_cast<uint32_t>(seq);
+                       return clara::ParserResult::ok(
+                           clara::ParseResultType::Matched);
+                   },
+                   "LEDGER"}["--ledger"](
+            "only dump the meta of this ledger (meta files only)");
+    auto txHashParser = clara::Opt{txHash, "HASH"}["--tx-hash"](
+        "only dump the ledger meta containing this transaction (meta files "
+        "only)");
+    auto threadsParser = clara::Opt{threads, "THREADS"}["--threads"](
+        "number of files to scan in parallel");
 
-    return runWithHelp(args, {compactParser(compact), fileNameParser(xdr)},
-                       [&] {
-                           dumpXdrStream(xdr, compact);
-                           return 0;
-                       });
+    return runWithHelp(
+        args,
+        {compactParser(compact), filterQueryParser(filterQuery),
+         ledgerSeqParser, txHashParser, threadsParser,
+         requiredArgParser(files, "FILE-NAME")},
+        [&] {
+            std::optional<Hash> hash;
+            if (!txHash.empty())
+            {
+                hash = hexToBin256(txHash);
+            }
+            dumpXdrStreams(files, std::cout, compact, filterQuery, ledgerSeq,
+                           hash, threads);
+            return 0;
+        });
 }
 
 int
@@ -1833,7 +1867,8 @@ handleCommandLine(int argc, char* const* argv)
           diagBucketStats},
          {"dump-ledger", "dumps the current ledger state as JSON for debugging",
           runDumpLedger},
-         {"dump-xdr", "dump an XDR file, for debugging", runDumpXDR},
+         {"dump-xdr", "dump XDR files or directories, for debugging",
+          runDumpXDR},
          {"encode-asset", "Print an encoded asset in base 64 for debugging",
           runEncodeAsset},
          {"force-scp", "deprecated, use --wait-for-consensus option instead",
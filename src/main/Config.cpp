@@ -137,11 +137,16 @@ Config::Config() : NODE_SEED(SecretKey::random())
     MANUAL_CLOSE = false;
     CATCHUP_COMPLETE = false;
     CATCHUP_RECENT = 0;
+    EXPERIMENTAL_RESUMABLE_CATCHUP = false;
     EXPERIMENTAL_PRECAUTION_DELAY_META = false;
+    EXPERIMENTAL_ASYNC_META_STREAM = false;
     EXPERIMENTAL_BUCKETLIST_DB = false;
     EXPERIMENTAL_BUCKETLIST_DB_INDEX_PAGE_SIZE_EXPONENT = 14; // 2^14 == 16 kb
     EXPERIMENTAL_BUCKETLIST_DB_INDEX_CUTOFF = 20;             // 20 mb
     EXPERIMENTAL_BUCKETLIST_DB_PERSIST_INDEX = true;
+    EXPERIMENTAL_PARALLEL_SOROBAN_APPLY_THREADS = 0;
+    EXPERIMENTAL_ASYNC_INVARIANT_CHECK_THREADS = 0;
+    EXPERIMENTAL_ASYNC_INVARIANT_HALT_ON_FAILURE = true;
     // automatic maintenance settings:
     // short and prime with 1 hour which will cause automatic maintenance to
     // rarely conflict with any other scheduled tasks on a machine (that tend to
@@ -187,6 +192,7 @@ Config::Config() : NODE_SEED(SecretKey::random())
                            CLOSETIME_DRIFT_LIMIT);
     METADATA_OUTPUT_STREAM = "";
     METADATA_DEBUG_LEDGERS = 0;
+    METADATA_DEBUG_INDEXED_SEGMENTS = false;
 
     LOG_FILE_PATH = "caiz-core-{datetime:%Y-%m-%d_%H-%M-%S}.log";
     BUCKET_DIR_PATH = "buckets";
@@ -261,6 +267,8 @@ Config::Config() : NODE_SEED(SecretKey::random())
     // for it.
     //
     // Worst case = 10 concurrent merges + 1 quorum intersection calculation.
+    // Such BULK tasks never occupy the last worker thread, which is kept for
+    // LATENCY_SENSITIVE tasks like verification.
     WORKER_THREADS = 11;
     MAX_CONCURRENT_SUBPROCESSES = 16;
     NODE_IS_VALIDATOR = false;
@@ -1044,6 +1052,10 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
             {
                 EXPERIMENTAL_PRECAUTION_DELAY_META = readBool(item);
             }
+            else if (item.first == "EXPERIMENTAL_ASYNC_META_STREAM")
+            {
+                EXPERIMENTAL_ASYNC_META_STREAM = readBool(item);
+            }
             else if (item.first == "EXPERIMENTAL_BUCKETLIST_DB")
             {
                 EXPERIMENTAL_BUCKETLIST_DB = readBool(item);
@@ -1062,10 +1074,31 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
             {
                 EXPERIMENTAL_BUCKETLIST_DB_PERSIST_INDEX = readBool(item);
             }
+            else if (item.first ==
+                     "EXPERIMENTAL_PARALLEL_SOROBAN_APPLY_THREADS")
+            {
+                EXPERIMENTAL_PARALLEL_SOROBAN_APPLY_THREADS =
+                    readInt<uint32_t>(item);
+            }
+            else if (item.first ==
+                     "EXPERIMENTAL_ASYNC_INVARIANT_CHECK_THREADS")
+            {
+                EXPERIMENTAL_ASYNC_INVARIANT_CHECK_THREADS =
+                    readInt<uint32_t>(item);
+            }
+            else if (item.first ==
+                     "EXPERIMENTAL_ASYNC_INVARIANT_HALT_ON_FAILURE")
+            {
+                EXPERIMENTAL_ASYNC_INVARIANT_HALT_ON_FAILURE = readBool(item);
+            }
             else if (item.first == "METADATA_DEBUG_LEDGERS")
             {
                 METADATA_DEBUG_LEDGERS = readInt<uint32_t>(item);
             }
+            else if (item.first == "METADATA_DEBUG_INDEXED_SEGMENTS")
+            {
+                METADATA_DEBUG_INDEXED_SEGMENTS = readBool(item);
+            }
             else if (item.first == "KNOWN_CURSORS")
             {
                 KNOWN_CURSORS = readArray<std::string>(item);
@@ -1090,6 +1123,10 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
             {
                 CATCHUP_RECENT = readInt<uint32_t>(item, 0, UINT32_MAX - 1);
             }
+            else if (item.first == "EXPERIMENTAL_RESUMABLE_CATCHUP")
+            {
+                EXPERIMENTAL_RESUMABLE_CATCHUP = readBool(item);
+            }
             else if (item.first == "ARTIFICIALLY_GENERATE_LOAD_FOR_TESTING")
             {
                 ARTIFICIALLY_GENERATE_LOAD_FOR_TESTING = readBool(item);
@@ -1299,6 +1336,10 @@ Config::processConfig(std::shared_ptr<cpptoml::table> t)
             {
                 WORKER_THREADS = readInt<int>(item, 1, 1000);
             }
+            else if (item.first == "EXPERIMENTAL_WORKER_THREAD_CPUS")
+            {
+                EXPERIMENTAL_WORKER_THREAD_CPUS = readIntArray<uint32_t>(item);
+            }
             else if (item.first == "MAX_CONCURRENT_SUBPROCESSES")
             {
                 MAX_CONCURRENT_SUBPROCESSES = readInt<size_t>(item, 1);
@@ -151,6 +151,11 @@ class Config : public std::enable_shared_from_this<Config>
     // If you want, say, a week of history, set this to 120000.
     uint32_t CATCHUP_RECENT;
 
+    // Whether catchup keeps the checkpoint files it downloaded across
+    // restarts, so that an interrupted catchup does not download them again
+    // (see CatchupProgress). Default is false.
+    bool EXPERIMENTAL_RESUMABLE_CATCHUP;
+
     // Interval between automatic maintenance executions
     std::chrono::seconds AUTOMATIC_MAINTENANCE_PERIOD;
 
@@ -278,6 +283,12 @@ class Config : public std::enable_shared_from_this<Config>
     // configuration) to delay emitting metadata by one ledger.
     bool EXPERIMENTAL_PRECAUTION_DELAY_META;
 
+    // A config parameter that, when set to true, writes LedgerCloseMeta to
+    // METADATA_OUTPUT_STREAM and the METADATA_DEBUG_LEDGERS segments on a
+    // dedicated thread. Meta is still written in ledger order, and a ledger is
+    // only committed once its meta is in METADATA_OUTPUT_STREAM.
+    bool EXPERIMENTAL_ASYNC_META_STREAM;
+
     // A config parameter that when set uses the BucketList as the primary
     // key-value store for LedgerEntry lookups
     bool EXPERIMENTAL_BUCKETLIST_DB;
@@ -303,6 +314,25 @@ class Config : public std::enable_shared_from_this<Config>
     // persisted.
     bool EXPERIMENTAL_BUCKETLIST_DB_PERSIST_INDEX;
 
+    // Number of threads (the main thread and worker pool threads) used to
+    // execute the host functions of a ledger's Soroban transactions ahead of
+    // apply, grouped by conflicting footprints.
+    // Apply only reuses results whose inputs match the ledger state at apply
+    // time, so ledger results are unaffected. 0 (the default) disables it.
+    uint32_t EXPERIMENTAL_PARALLEL_SOROBAN_APPLY_THREADS;
+
+    // Number of background threads that check the enabled invariants against
+    // snapshots of each applied operation, instead of checking them on the
+    // apply path. Failures are reported at the next ledger boundary, with the
+    // ledger, transaction and operation they occurred in. 0 (the default)
+    // checks every operation synchronously as it is applied.
+    uint32_t EXPERIMENTAL_ASYNC_INVARIANT_CHECK_THREADS;
+
+    // When operations are checked asynchronously, whether a strict invariant
+    // failure stops the node at the next ledger boundary (the default) or is
+    // only logged and counted.
+    bool EXPERIMENTAL_ASYNC_INVARIANT_HALT_ON_FAILURE;
+
     // A config parameter that stores historical data, such as transactions,
     // fees, and scp history in the database
     bool MODE_STORES_HISTORY_MISC;
@@ -389,6 +419,12 @@ class Config : public std::enable_shared_from_this<Config>
     // at a premium.
     uint32_t METADATA_DEBUG_LEDGERS;
 
+    // When set to true, meta-debug segments are written with an index file
+    // mapping ledger sequence numbers and transaction hashes to record
+    // offsets, and are left uncompressed so readers can seek directly to a
+    // record.
+    bool METADATA_DEBUG_INDEXED_SEGMENTS;
+
     // Set of cursors added at each startup with value '1'.
     std::vector<std::string> KNOWN_CURSORS;
 
@@ -494,6 +530,10 @@ class Config : public std::enable_shared_from_this<Config>
     // thread-management config
     int WORKER_THREADS;
 
+    // CPUs to pin the worker threads to, worker thread i to the i-th CPU
+    // modulo the list size. Empty (the default) leaves placement to the OS.
+    std::vector<uint32_t> EXPERIMENTAL_WORKER_THREAD_CPUS;
+
     // process-management config
     size_t MAX_CONCURRENT_SUBPROCESSES;
 
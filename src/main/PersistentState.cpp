@@ -22,7 +22,7 @@ std::string PersistentState::mapping[kLastEntry] = {
     "lastclosedledger", "historyarchivestate", "lastscpdata",
     "databaseschema",   "networkpassphrase",   "ledgerupgrades",
     "rebuildledger",    "lastscpdataxdr",      "txset",
-    "dbbackend"};
+    "dbbackend",        "catchupfile"};
 
 std::string PersistentState::kSQLCreateStatement =
     "CREATE TABLE IF NOT EXISTS storestate ("
@@ -91,12 +91,74 @@ PersistentState::getStoreStateNameForTxSet(Hash const& txSetHash)
     return res;
 }
 
+std::string
+PersistentState::getStoreStateNameForCatchupFile(std::string const& type,
+                                                 std::string const& hexDigits)
+{
+    return mapping[kCatchupFile] + type + hexDigits;
+}
+
 bool
 PersistentState::hasTxSet(Hash const& txSetHash)
 {
     return entryExists(getStoreStateNameForTxSet(txSetHash));
 }
 
+std::string
+PersistentState::getCatchupFileHash(std::string const& type,
+                                    std::string const& hexDigits)
+{
+    ZoneScoped;
+    return getFromDb(getStoreStateNameForCatchupFile(type, hexDigits));
+}
+
+void
+PersistentState::setCatchupFileHash(std::string const& type,
+                                    std::string const& hexDigits,
+                                    std::string const& fileHash)
+{
+    ZoneScoped;
+    updateDb(getStoreStateNameForCatchupFile(type, hexDigits), fileHash);
+}
+
+std::vector<std::string>
+PersistentState::getCatchupFiles(std::string const& type)
+{
+    ZoneScoped;
+    std::vector<std::string> result;
+    std::string val;
+
+    auto prefix = getStoreStateNameForCatchupFile(type, "");
+    std::string pattern = prefix + "%";
+    auto prep = mApp.getDatabase().getPreparedStatement(
+        "SELECT statename FROM storestate WHERE statename LIKE :n;");
+    auto& st = prep.statement();
+    st.exchange(soci::into(val));
+    st.exchange(soci::use(pattern));
+    st.define_and_bind();
+    st.execute(true);
+
+    while (st.got_data())
+    {
+        result.emplace_back(val.substr(prefix.size()));
+        st.fetch();
+    }
+    return result;
+}
+
+void
+PersistentState::clearCatchupFileHashes()
+{
+    ZoneScoped;
+    std::string pattern = mapping[kCatchupFile] + "%";
+    auto prep = mApp.getDatabase().getPreparedStatement(
+        "DELETE FROM storestate WHERE statename LIKE :n;");
+    auto& st = prep.statement();
+    st.exchange(soci::use(pattern));
+    st.define_and_bind();
+    st.execute(true);
+}
+
 std::string
 PersistentState::getState(PersistentState::Entry entry)
 {
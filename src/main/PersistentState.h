@@ -29,6 +29,7 @@ class PersistentState
         kLastSCPDataXDR,
         kTxSet,
         kDBBackend,
+        kCatchupFile,
         kLastEntry,
     };
 
@@ -59,6 +60,18 @@ class PersistentState
     bool hasTxSet(Hash const& txSetHash);
     void deleteTxSets(std::unordered_set<Hash> hashesToDelete);
 
+    // Hex SHA-256 of the checkpoint files downloaded by a resumable catchup
+    // (see CatchupProgress), keyed by history file type and checkpoint hex
+    // digits. An empty string means the file is not recorded.
+    std::string getCatchupFileHash(std::string const& type,
+                                   std::string const& hexDigits);
+    void setCatchupFileHash(std::string const& type,
+                            std::string const& hexDigits,
+                            std::string const& fileHash);
+    // Returns the hex digits of every recorded file of the given type.
+    std::vector<std::string> getCatchupFiles(std::string const& type);
+    void clearCatchupFileHashes();
+
   private:
     static std::string kSQLCreateStatement;
     static std::string mapping[kLastEntry];
@@ -67,6 +80,8 @@ class PersistentState
 
     std::string getStoreStateName(Entry n, uint32 subscript = 0);
     std::string getStoreStateNameForTxSet(Hash const& txSetHash);
+    std::string getStoreStateNameForCatchupFile(std::string const& type,
+                                                std::string const& hexDigits);
 
     void setSCPStateForSlot(uint64 slot, std::string const& value);
     void updateDb(std::string const& entry, std::string const& value);
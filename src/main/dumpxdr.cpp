@@ -2,6 +2,7 @@
 #include "crypto/Hex.h"
 #include "crypto/SecretKey.h"
 #include "crypto/StrKey.h"
+#include "ledger/MetaDebugSegmentIndex.h"
 #include "main/Config.h"
 #include "transactions/SignatureUtils.h"
 #include "transactions/TransactionBridge.h"
@@ -9,16 +10,24 @@
 #include "util/Decoder.h"
 #include "util/Fs.h"
 #include "util/GlobalChecks.h"
+#include "util/Logging.h"
 #include "util/MetaUtils.h"
 #include "util/XDRCereal.h"
 #include "util/XDROperators.h"
 #include "util/XDRStream.h"
 #include "util/types.h"
+#include "util/xdrquery/XDRQuery.h"
+#include <atomic>
 #include <cereal/archives/json.hpp>
 #include <cereal/cereal.hpp>
+#include <condition_variable>
+#include <filesystem>
 #include <fmt/format.h>
 #include <iostream>
+#include <mutex>
 #include <regex>
+#include <streambuf>
+#include <thread>
 #include <xdrpp/printer.h>
 
 #if !defined(USE_TERMIOS) && !defined(_WIN32)
@@ -48,53 +57,148 @@ namespace caiz
 
 template <typename T>
 void
-dumpstream(XDRInputFileStream& in, bool compact)
+dumpstream(XDRInputFileStream& in, std::ostream& out, bool compact,
+           xdrquery::XDRMatcher* matcher)
 {
     T tmp;
     cereal::JSONOutputArchive archive(
-        std::cout, compact ? cereal::JSONOutputArchive::Options::NoIndent()
-                           : cereal::JSONOutputArchive::Options::Default());
+        out, compact ? cereal::JSONOutputArchive::Options::NoIndent()
+                     : cereal::JSONOutputArchive::Options::Default());
     archive.makeArray();
     while (in && in.readOne(tmp))
     {
-        archive(tmp);
+        if (!matcher || matcher->matchXDR(tmp))
+        {
+            archive(tmp);
+        }
     }
 }
 
-void
-dumpXdrStream(std::string const& filename, bool compact)
+static bool
+metaMatches(LedgerCloseMeta const& lcm, std::optional<uint32_t> ledgerSeq,
+            std::optional<Hash> const& txHash)
+{
+    auto const& header =
+        lcm.v() == 0 ? lcm.v0().ledgerHeader : lcm.v1().ledgerHeader;
+    if (ledgerSeq && header.header.ledgerSeq != *ledgerSeq)
+    {
+        return false;
+    }
+    if (txHash)
+    {
+        auto const& txProcessing =
+            lcm.v() == 0 ? lcm.v0().txProcessing : lcm.v1().txProcessing;
+        return std::any_of(txProcessing.begin(), txProcessing.end(),
+                           [&](TransactionResultMeta const& trm) {
+                               return trm.result.transactionHash == *txHash;
+                           });
+    }
+    return true;
+}
+
+static void
+dumpMatchingMeta(XDRInputFileStream& in, std::string const& filename,
+                 std::ostream& out, bool compact,
+                 xdrquery::XDRMatcher* matcher,
+                 std::optional<uint32_t> ledgerSeq,
+                 std::optional<Hash> const& txHash)
+{
+    LedgerCloseMeta lcm;
+    cereal::JSONOutputArchive archive(
+        out, compact ? cereal::JSONOutputArchive::Options::NoIndent()
+                     : cereal::JSONOutputArchive::Options::Default());
+    archive.makeArray();
+
+    auto index = MetaDebugSegmentIndex::load(
+        MetaDebugSegmentIndex::getIndexPath(filename));
+    if (index)
+    {
+        // A ledger appears at most once per segment, and all of a
+        // transaction's meta lives in the record of the ledger applying it,
+        // so at most one record can match. It is looked up by ledger if one
+        // is given, so it must be that ledger, but it may still not contain
+        // the transaction.
+        auto offset = ledgerSeq ? index->lookupLedger(*ledgerSeq)
+                                : index->lookupTransaction(*txHash);
+        if (offset)
+        {
+            in.seek(*offset);
+            if (!in.readOne(lcm) ||
+                !metaMatches(lcm, ledgerSeq,
+                             ledgerSeq ? std::nullopt : txHash))
+            {
+                throw std::runtime_error(
+                    "meta-debug index does not match segment");
+            }
+            if (metaMatches(lcm, ledgerSeq, txHash) &&
+                (!matcher || matcher->matchXDR(lcm)))
+            {
+                archive(lcm);
+            }
+        }
+        return;
+    }
+
+    while (in && in.readOne(lcm))
+    {
+        if (metaMatches(lcm, ledgerSeq, txHash) &&
+            (!matcher || matcher->matchXDR(lcm)))
+        {
+            archive(lcm);
+        }
+    }
+}
+
+static std::regex const XDR_FILE_REGEX{
+    ".*(ledger|bucket|transactions|results|meta|scp)-.+\\.xdr"};
+
+static void
+dumpXdrFile(std::string const& filename, std::ostream& out, bool compact,
+            xdrquery::XDRMatcher* matcher, std::optional<uint32_t> ledgerSeq,
+            std::optional<Hash> const& txHash)
 {
-    std::regex rx(".*(ledger|bucket|transactions|results|meta|scp)-.+\\.xdr");
     std::smatch sm;
-    if (std::regex_match(filename, sm, rx))
+    if (std::regex_match(filename, sm, XDR_FILE_REGEX))
     {
+        if ((ledgerSeq || txHash) && sm[1] != "meta")
+        {
+            throw std::runtime_error(
+                "ledger and transaction filters require a meta file");
+        }
+
         XDRInputFileStream in;
         in.open(filename);
 
-        if (sm[1] == "ledger")
+        if (ledgerSeq || txHash)
         {
-            dumpstream<LedgerHeaderHistoryEntry>(in, compact);
+            dumpMatchingMeta(in, filename, out, compact, matcher, ledgerSeq,
+                             txHash);
+        }
+        else if (sm[1] == "ledger")
+        {
+            dumpstream<LedgerHeaderHistoryEntry>(in, out, compact, matcher);
         }
         else if (sm[1] == "bucket")
         {
-            dumpstream<BucketEntry>(in, compact);
+            dumpstream<BucketEntry>(in, out, compact, matcher);
         }
         else if (sm[1] == "transactions")
         {
-            dumpstream<TransactionHistoryEntry>(in, compact);
+            dumpstream<TransactionHistoryEntry>(in, out, compact, matcher);
         }
         else if (sm[1] == "results")
         {
-            dumpstream<TransactionHistoryResultEntry>(in, compact);
+            dumpstream<TransactionHistoryResultEntry>(in, out, compact,
+                                                      matcher);
         }
         else if (sm[1] == "meta")
         {
-            dumpstream<LedgerCloseMeta>(in, compact);
+            dumpstream<LedgerCloseMeta>(in, out, compact, matcher);
         }
         else
         {
             releaseAssert(sm[1] == "scp");
-            dumpstream<SCPHistoryEntry>(in, compact);
+            dumpstream<SCPHistoryEntry>(in, out, compact, matcher);
         }
     }
     else
@@ -103,6 +207,260 @@ dumpXdrStream(std::string const& filename, bool compact)
     }
 }
 
+// Expands directories in `paths` into the XDR files they directly contain,
+// in name order, skipping files other than meta files if `metaOnly`.
+// Explicitly named files are kept as they are, so that an unrecognized name
+// is still reported as an error.
+static std::vector<std::string>
+expandXdrPaths(std::vector<std::string> const& paths, bool metaOnly)
+{
+    std::vector<std::string> files;
+    for (auto const& path : paths)
+    {
+        if (!std::filesystem::is_directory(path))
+        {
+            files.emplace_back(path);
+            continue;
+        }
+        std::vector<std::string> dirFiles;
+        for (auto const& entry : std::filesystem::directory_iterator(path))
+        {
+            auto name = entry.path().string();
+            std::smatch sm;
+            if (!entry.is_regular_file() ||
+                !std::regex_match(name, sm, XDR_FILE_REGEX))
+            {
+                continue;
+            }
+            if (metaOnly && sm[1] != "meta")
+            {
+                LOG_WARNING(DEFAULT_LOG,
+                            "Skipping {}: ledger and transaction filters "
+                            "only apply to meta files",
+                            name);
+                continue;
+            }
+            dirFiles.emplace_back(name);
+        }
+        std::sort(dirFiles.begin(), dirFiles.end());
+        files.insert(files.end(), dirFiles.begin(), dirFiles.end());
+    }
+    return files;
+}
+
+namespace
+{
+// Output of files scanned in parallel is printed in input order. A file's
+// output is buffered in chunks of this size, and a file that is not the one
+// currently being printed waits for its turn with at most one chunk
+// buffered, so memory use does not depend on the size of the files.
+constexpr size_t OUTPUT_CHUNK_SIZE = 1 << 16;
+
+class OrderedOutput
+{
+    std::ostream& mOut;
+    std::mutex mMutex;
+    std::condition_variable mTurn;
+    size_t mCurrentFile{0};
+    bool mAborted{false};
+    std::exception_ptr mError;
+
+    // Returns false if another file failed, so `file` will not be printed
+    bool
+    waitForTurn(std::unique_lock<std::mutex>& lock, size_t file)
+    {
+        mTurn.wait(lock, [&]() { return mCurrentFile == file || mAborted; });
+        return !mAborted;
+    }
+
+  public:
+    explicit OrderedOutput(std::ostream& out) : mOut(out)
+    {
+    }
+
+    bool
+    write(size_t file, std::string const& data)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (!waitForTurn(lock, file))
+        {
+            return false;
+        }
+        mOut << data;
+        return true;
+    }
+
+    // Marks `file` as completely written, or as failed with `error`, in
+    // which case nothing after it is printed
+    void
+    finish(size_t file, std::exception_ptr error)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (!waitForTurn(lock, file))
+        {
+            return;
+        }
+        if (error)
+        {
+            mError = error;
+            mAborted = true;
+        }
+        else
+        {
+            ++mCurrentFile;
+        }
+        mTurn.notify_all();
+    }
+
+    bool
+    aborted()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mAborted;
+    }
+
+    std::exception_ptr
+    error()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mError;
+    }
+};
+
+// Buffers the output of one file and hands it to OrderedOutput a chunk at a
+// time. Once another file failed, writes fail and the stream goes bad.
+class FileOutputBuf : public std::streambuf
+{
+    OrderedOutput& mOut;
+    size_t const mFile;
+    std::string mBuffer;
+
+  protected:
+    int_type
+    overflow(int_type c) override
+    {
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            mBuffer.push_back(traits_type::to_char_type(c));
+            if (!flushIfFull())
+            {
+                return traits_type::eof();
+            }
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize
+    xsputn(char const* s, std::streamsize n) override
+    {
+        mBuffer.append(s, static_cast<size_t>(n));
+        return flushIfFull() ? n : 0;
+    }
+
+    bool
+    flushIfFull()
+    {
+        return mBuffer.size() < OUTPUT_CHUNK_SIZE || flushChunk();
+    }
+
+  public:
+    FileOutputBuf(OrderedOutput& out, size_t file) : mOut(out), mFile(file)
+    {
+        mBuffer.reserve(OUTPUT_CHUNK_SIZE);
+    }
+
+    bool
+    flushChunk()
+    {
+        bool written = mBuffer.empty() || mOut.write(mFile, mBuffer);
+        mBuffer.clear();
+        return written;
+    }
+};
+}
+
+void
+dumpXdrStreams(std::vector<std::string> const& paths, std::ostream& out,
+               bool compact,
+               std::optional<std::string> const& filterQuery,
+               std::optional<uint32_t> ledgerSeq, std::optional<Hash> txHash,
+               size_t threads)
+{
+    if (filterQuery)
+    {
+        // Report syntax errors before any file is opened.
+        auto statement = xdrquery::parseXDRQuery(*filterQuery);
+        if (!std::holds_alternative<std::shared_ptr<xdrquery::BoolEvalNode>>(
+                statement))
+        {
+            throw xdrquery::XDRQueryError(
+                "The query doesn't evaluate to bool.");
+        }
+    }
+
+    auto files = expandXdrPaths(paths, ledgerSeq || txHash);
+    if (files.size() == 1)
+    {
+        std::optional<xdrquery::XDRMatcher> matcher;
+        if (filterQuery)
+        {
+            matcher.emplace(*filterQuery);
+        }
+        dumpXdrFile(files.front(), out, compact,
+                    matcher ? &*matcher : nullptr, ledgerSeq, txHash);
+        return;
+    }
+
+    // Files are scanned by a fixed set of workers, each owning a matcher
+    // (evaluation nodes cache field values, so a compiled query can't be
+    // shared between threads). Workers take files in input order, so the
+    // file being printed is always being scanned, and at most `threads`
+    // files are in flight.
+    OrderedOutput output(out);
+    std::atomic<size_t> nextFile{0};
+    auto worker = [&]() {
+        std::optional<xdrquery::XDRMatcher> matcher;
+        if (filterQuery)
+        {
+            matcher.emplace(*filterQuery);
+        }
+        for (size_t i = nextFile++; i < files.size() && !output.aborted();
+             i = nextFile++)
+        {
+            std::exception_ptr error;
+            try
+            {
+                FileOutputBuf buf(output, i);
+                std::ostream fileOut(&buf);
+                dumpXdrFile(files[i], fileOut, compact,
+                            matcher ? &*matcher : nullptr, ledgerSeq, txHash);
+                fileOut << std::endl;
+                buf.flushChunk();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            output.finish(i, error);
+        }
+    };
+
+    threads = std::max<size_t>(1, std::min(threads, files.size()));
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threads; ++i)
+    {
+        workers.emplace_back(worker);
+    }
+    for (auto& w : workers)
+    {
+        w.join();
+    }
+    if (auto error = output.error())
+    {
+        std::rethrow_exception(error);
+    }
+}
+
 #define throw_perror(msg) \
     do \
     { \
@@ -5,10 +5,26 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "overlay/CaizXDR.h"
+#include <optional>
+#include <ostream>
+#include <vector>
 
 namespace caiz
 {
-void dumpXdrStream(std::string const& filename, bool json);
+// Dumps the records of the given XDR files to `out` as JSON, one array per
+// file, in the order the files are given. Directories are expanded into the
+// XDR files they contain. Files are scanned by up to `threads` threads in
+// parallel.
+//
+// If filterQuery is set, only records matching it (see xdrquery::XDRMatcher)
+// are dumped. For meta files, ledgerSeq and txHash further restrict the
+// output to the LedgerCloseMeta for that ledger or containing that
+// transaction; if a file has a MetaDebugSegmentIndex next to it, the record
+// is read directly from its indexed offset.
+void dumpXdrStreams(std::vector<std::string> const& paths, std::ostream& out,
+                    bool compact, std::optional<std::string> const& filterQuery,
+                    std::optional<uint32_t> ledgerSeq,
+                    std::optional<Hash> txHash, size_t threads);
 void printXdr(std::string const& filename, std::string const& filetype,
               bool base64, bool compact, bool rawMode);
 void signtxn(std::string const& filename, std::string netId, bool base64);
@@ -831,6 +831,7 @@ Peer::recvMessage(CaizMessage const& caizMsg)
     case SCP_QUORUMSET:
     case SCP_MESSAGE:
         cat = "SCP";
+        type = Scheduler::ActionType::CRITICAL_ACTION;
         break;
 
     default:
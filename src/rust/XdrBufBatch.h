@@ -0,0 +1,72 @@
+#pragma once
+
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+// Helpers for CxxBufBatch and RustBufBatch, which pass many XDR objects
+// across the rust bridge in a single contiguous buffer.
+
+#include "rust/RustVecXdrMarshal.h"
+#include <optional>
+
+namespace caiz
+{
+
+inline CxxBufBatch
+makeCxxBufBatch()
+{
+    return CxxBufBatch{std::make_unique<std::vector<uint8_t>>(), {}};
+}
+
+// Serializes `t` at the end of `batch` and returns its size in bytes.
+template <typename T>
+size_t
+appendToCxxBufBatch(CxxBufBatch& batch, T const& t)
+{
+    auto& data = *batch.data;
+    auto start = data.size();
+    auto size = xdr::xdr_size(t);
+    data.resize(start + size);
+    xdr::xdr_put p(data.data() + start, data.data() + data.size());
+    xdr::xdr_argpack_archive(p, t);
+    batch.sizes.push_back(static_cast<uint32_t>(size));
+    return size;
+}
+
+// Decodes the objects of a RustBufBatch one after the other, in place.
+class RustBufBatchReader
+{
+    RustBufBatch const& mBatch;
+    size_t mIndex{0};
+    size_t mOffset{0};
+
+  public:
+    explicit RustBufBatchReader(RustBufBatch const& batch) : mBatch(batch)
+    {
+    }
+
+    // Decodes the next object into `t` and returns its size in bytes, or
+    // returns std::nullopt once all objects have been read.
+    template <typename T>
+    std::optional<size_t>
+    next(T& t)
+    {
+        if (mIndex == mBatch.sizes.size())
+        {
+            return std::nullopt;
+        }
+        size_t size = mBatch.sizes[mIndex++];
+        if (mOffset + size > mBatch.data.size())
+        {
+            throw std::runtime_error("malformed XDR batch");
+        }
+        auto begin = mBatch.data.data() + mOffset;
+        xdr::xdr_get g(begin, begin + size);
+        xdr::xdr_argpack_archive(g, t);
+        g.done();
+        mOffset += size;
+        return size;
+    }
+};
+}
@@ -5,12 +5,12 @@
 use crate::{
     log::partition::TX,
     rust_bridge::{
-        Bump, CxxBuf, CxxFeeConfiguration, CxxLedgerInfo, CxxTransactionResources, FeePair,
-        InvokeHostFunctionOutput, RustBuf, XDRFileHash,
+        Bump, CxxBuf, CxxBufBatch, CxxFeeConfiguration, CxxLedgerInfo, CxxTransactionResources,
+        FeePair, InvokeHostFunctionOutput, RustBuf, RustBufBatch, XDRFileHash,
     },
 };
 use log::debug;
-use std::{fmt::Display, io::Cursor, panic, rc::Rc};
+use std::{cell::RefCell, collections::HashMap, fmt::Display, io::Cursor, panic, rc::Rc};
 
 // This module (contract) is bound to _two separate locations_ in the module
 // tree: crate::lo::contract and crate::hi::contract, each of which has a (lo or
@@ -28,7 +28,7 @@ use super::soroban_env_host::{
     xdr::{
         self, AccountId, ContractCodeEntryBody, ContractCostParams, ContractDataEntryBody,
         ContractEvent, ContractEventType, ContractEntryBodyType, DiagnosticEvent, HostFunction,
-        LedgerEntry, LedgerEntryData, LedgerKey, LedgerKeyAccount, LedgerKeyContractCode,
+        LedgerEntry, LedgerEntryData, LedgerEntryExt, LedgerEntryType, LedgerKey, LedgerKeyAccount, LedgerKeyContractCode,
         LedgerKeyContractData, LedgerKeyTrustLine, ReadXdr, ScErrorCode, ScErrorType,
         SorobanAuthorizationEntry, SorobanResources, WriteXdr, XDR_FILES_SHA256,
     },
@@ -138,6 +138,40 @@ fn xdr_from_cxx_buf<T: ReadXdr>(buf: &CxxBuf) -> Result<T, HostError> {
     xdr_from_slice(buf.data.as_slice())
 }
 
+/// Splits a [`CxxBufBatch`] into the slices of its XDR objects, without
+/// copying them.
+fn cxx_buf_batch_slices(batch: &CxxBufBatch) -> Result<Vec<&[u8]>, CoreHostError> {
+    let mut rest = batch.data.as_slice();
+    let mut slices = Vec::with_capacity(batch.sizes.len());
+    for size in batch.sizes.iter() {
+        let size = *size as usize;
+        if size > rest.len() {
+            return Err(CoreHostError::General("malformed XDR batch"));
+        }
+        let (slice, tail) = rest.split_at(size);
+        slices.push(slice);
+        rest = tail;
+    }
+    if !rest.is_empty() {
+        return Err(CoreHostError::General("malformed XDR batch"));
+    }
+    Ok(slices)
+}
+
+/// Serializes `t` at the end of `batch`.
+fn xdr_append_to_rust_buf_batch<T: WriteXdr>(
+    batch: &mut RustBufBatch,
+    t: &T,
+) -> Result<(), HostError> {
+    let start = batch.data.len();
+    let mut cursor = Cursor::new(&mut batch.data);
+    cursor.set_position(start as u64);
+    t.write_xdr(&mut cursor)
+        .map_err(|_| (ScErrorType::Value, ScErrorCode::InvalidInput))?;
+    batch.sizes.push((batch.data.len() - start) as u32);
+    Ok(())
+}
+
 /// Returns a vec of [`XDRFileHash`] structs each representing one .x file
 /// that served as input to xdrgen, which created the XDR definitions used in
 /// the Rust crates visible here. This allows the C++ side of the bridge
@@ -235,18 +269,166 @@ fn ledger_entry_to_ledger_key(le: &LedgerEntry) -> Result<LedgerKey, CoreHostErr
     }
 }
 
-/// Deserializes a sequence of [`xdr::LedgerEntry`] structures from a vector of
-/// [`CxxBuf`] buffers, inserts them into an [`OrdMap`] with entries
+/// Maximum number of contract code entries kept by [`ContractCodeCache`].
+const CONTRACT_CODE_CACHE_CAPACITY: usize = 64;
+
+/// Code hash and body type of a contract code entry. Both body types share a
+/// hash, so they are cached separately.
+type ContractCodeKey = ([u8; 32], i32);
+
+struct CachedContractCode {
+    buf: Vec<u8>,
+    body_end: usize,
+    entry: Rc<LedgerEntry>,
+    last_used: u64,
+}
+
+/// Decoded contract code ledger entries, keyed by code hash and body type,
+/// shared between invocations so that popular contracts don't have their Wasm
+/// decoded again on every call. A cached entry is only used if the XDR passed
+/// in has the same code as the one it was decoded from; the fields around it
+/// (lastModifiedLedgerSeq, expirationLedgerSeq and the entry ext) change on
+/// every expiration bump, so they are decoded from the new XDR instead. This
+/// happens outside of the host, so it doesn't affect metering.
+#[derive(Default)]
+struct ContractCodeCache {
+    entries: HashMap<ContractCodeKey, CachedContractCode>,
+    clock: u64,
+    hits: u32,
+    misses: u32,
+}
+
+thread_local! {
+    static CONTRACT_CODE_CACHE: RefCell<ContractCodeCache> =
+        RefCell::new(ContractCodeCache::default());
+}
+
+fn peek_u32(buf: &[u8], offset: usize) -> Option<u32> {
+    Some(u32::from_be_bytes(
+        buf.get(offset..offset.checked_add(4)?)?.try_into().ok()?,
+    ))
+}
+
+/// Returns the cache key of an XDR [`xdr::LedgerEntry`] if it is a contract
+/// code entry, and the offset its body ends at, without decoding it. The
+/// layout is lastModifiedLedgerSeq, the entry type, then the
+/// [`xdr::ContractCodeEntry`] ext, hash, body type, code (for DATA_ENTRY) and
+/// expirationLedgerSeq, then the entry ext.
+fn peek_contract_code(buf: &[u8]) -> Option<(ContractCodeKey, usize)> {
+    if peek_u32(buf, 4)? as i32 != LedgerEntryType::ContractCode as i32 {
+        return None;
+    }
+    let hash: [u8; 32] = buf.get(12..44)?.try_into().ok()?;
+    let body_type = peek_u32(buf, 44)? as i32;
+    let body_end = if body_type == ContractEntryBodyType::DataEntry as i32 {
+        let len = peek_u32(buf, 48)? as usize;
+        // opaque<> is padded to a multiple of 4 bytes
+        52usize.checked_add(len)?.checked_add((4 - len % 4) % 4)?
+    } else {
+        48
+    };
+    if buf.len() < body_end {
+        return None;
+    }
+    Some(((hash, body_type), body_end))
+}
+
+/// Returns a copy of `entry` with the fields outside of its code taken from
+/// `buf`, the XDR of an entry with the same code.
+fn refresh_contract_code(
+    entry: &LedgerEntry,
+    buf: &[u8],
+    body_end: usize,
+) -> Result<LedgerEntry, HostError> {
+    let invalid = || HostError::from((ScErrorType::Value, ScErrorCode::InvalidInput));
+    let mut res = entry.clone();
+    res.last_modified_ledger_seq = peek_u32(buf, 0).ok_or_else(invalid)?;
+    match &mut res.data {
+        LedgerEntryData::ContractCode(code) => {
+            code.expiration_ledger_seq = peek_u32(buf, body_end).ok_or_else(invalid)?;
+        }
+        _ => return Err(invalid()),
+    }
+    res.ext = xdr_from_slice::<LedgerEntryExt>(&buf[body_end + 4..])?;
+    Ok(res)
+}
+
+impl ContractCodeCache {
+    fn get_or_decode(
+        &mut self,
+        key: ContractCodeKey,
+        body_end: usize,
+        buf: &[u8],
+    ) -> Result<Rc<LedgerEntry>, HostError> {
+        self.clock += 1;
+        if let Some(cached) = self.entries.get_mut(&key) {
+            // The entry type at 4..8 is the same since the key was peeked
+            // from it, the rest up to body_end is the ext, hash and code.
+            if cached.body_end == body_end && cached.buf[8..body_end] == buf[8..body_end] {
+                if cached.buf.as_slice() != buf {
+                    cached.entry = Rc::new(refresh_contract_code(&cached.entry, buf, body_end)?);
+                    cached.buf = buf.to_vec();
+                }
+                cached.last_used = self.clock;
+                self.hits += 1;
+                return Ok(Rc::clone(&cached.entry));
+            }
+        }
+        let entry = Rc::new(xdr_from_slice::<LedgerEntry>(buf)?);
+        self.misses += 1;
+        if !self.entries.contains_key(&key) && self.entries.len() >= CONTRACT_CODE_CACHE_CAPACITY {
+            let lru = self
+                .entries
+                .iter()
+                .min_by_key(|(_, cached)| cached.last_used)
+                .map(|(k, _)| *k);
+            if let Some(lru) = lru {
+                self.entries.remove(&lru);
+            }
+        }
+        self.entries.insert(
+            key,
+            CachedContractCode {
+                buf: buf.to_vec(),
+                body_end,
+                entry: Rc::clone(&entry),
+                last_used: self.clock,
+            },
+        );
+        Ok(entry)
+    }
+
+    /// Returns and resets the hit and miss counts.
+    fn take_stats(&mut self) -> (u32, u32) {
+        let stats = (self.hits, self.misses);
+        self.hits = 0;
+        self.misses = 0;
+        stats
+    }
+}
+
+fn decode_ledger_entry(slice: &[u8]) -> Result<Rc<LedgerEntry>, HostError> {
+    match peek_contract_code(slice) {
+        Some((key, body_end)) => {
+            CONTRACT_CODE_CACHE.with(|cache| cache.borrow_mut().get_or_decode(key, body_end, slice))
+        }
+        None => Ok(Rc::new(xdr_from_slice::<LedgerEntry>(slice)?)),
+    }
+}
+
+/// Deserializes a sequence of [`xdr::LedgerEntry`] structures from a
+/// [`CxxBufBatch`], inserts them into an [`OrdMap`] with entries
 /// additionally keyed by the provided contract ID, checks that the entries
 /// match the provided [`storage::Footprint`], and returns the constructed map.
+/// Contract code entries go through the [`ContractCodeCache`].
 fn build_storage_map_from_xdr_ledger_entries(
     budget: &Budget,
     footprint: &storage::Footprint,
-    ledger_entries: &Vec<CxxBuf>,
+    ledger_entries: &CxxBufBatch,
 ) -> Result<StorageMap, CoreHostError> {
     let mut map = StorageMap::new();
-    for buf in ledger_entries {
-        let le = Rc::new(xdr_from_cxx_buf::<LedgerEntry>(buf)?);
+    for buf in cxx_buf_batch_slices(ledger_entries)? {
+        let le = decode_ledger_entry(buf)?;
         let key = Rc::new(ledger_entry_to_ledger_key(&le)?);
         if !footprint.0.contains_key::<LedgerKey>(&key, budget)? {
             return Err(CoreHostError::General(
@@ -274,19 +456,22 @@ fn build_auth_entries_from_xdr(
 }
 
 /// Iterates over the storage map and serializes the read-write ledger entries
-/// back to XDR.
+/// back to XDR, into a single [`RustBufBatch`].
 fn build_xdr_ledger_entries_from_storage_map(
     footprint: &storage::Footprint,
     storage_map: &StorageMap,
     budget: &Budget,
-) -> Result<Vec<RustBuf>, CoreHostError> {
-    let mut res = Vec::new();
+) -> Result<RustBufBatch, CoreHostError> {
+    let mut res = RustBufBatch {
+        data: Vec::new(),
+        sizes: Vec::new(),
+    };
     for (lk, ole) in storage_map {
         match footprint.0.get::<LedgerKey>(lk, budget)? {
             Some(AccessType::ReadOnly) => (),
             Some(AccessType::ReadWrite) => {
                 if let Some(le) = ole {
-                    res.push(xdr_to_rust_buf(&**le)?)
+                    xdr_append_to_rust_buf_batch(&mut res, &**le)?
                 }
             }
             None => return Err(CoreHostError::General("ledger entry not in footprint")),
@@ -357,7 +542,7 @@ pub(crate) fn invoke_host_function(
     source_account_buf: &CxxBuf,
     auth_entries: &Vec<CxxBuf>,
     ledger_info: CxxLedgerInfo,
-    ledger_entries: &Vec<CxxBuf>,
+    ledger_entries: &CxxBufBatch,
     base_prng_seed: &CxxBuf,
 ) -> Result<InvokeHostFunctionOutput, Box<dyn Error>> {
     let res = panic::catch_unwind(panic::AssertUnwindSafe(|| {
@@ -373,7 +558,11 @@ pub(crate) fn invoke_host_function(
         )
     }));
     match res {
-        Err(_) => Err(CoreHostError::General("contract host panicked").into()),
+        Err(_) => {
+            // The panic may have skipped taking the code cache stats
+            CONTRACT_CODE_CACHE.with(|cache| cache.borrow_mut().take_stats());
+            Err(CoreHostError::General("contract host panicked").into())
+        }
         Ok(r) => r,
     }
 }
@@ -385,7 +574,7 @@ fn invoke_host_function_or_maybe_panic(
     source_account_buf: &CxxBuf,
     auth_entries: &Vec<CxxBuf>,
     ledger_info: CxxLedgerInfo,
-    ledger_entries: &Vec<CxxBuf>,
+    ledger_entries: &CxxBufBatch,
     base_prng_seed: &CxxBuf,
 ) -> Result<InvokeHostFunctionOutput, Box<dyn Error>> {
     let hf = xdr_from_cxx_buf::<HostFunction>(&hf_buf)?;
@@ -399,7 +588,12 @@ fn invoke_host_function_or_maybe_panic(
         xdr_from_cxx_buf::<ContractCostParams>(&ledger_info.mem_cost_params)?,
     );
     let footprint = build_storage_footprint_from_xdr(&budget, &resources.footprint)?;
-    let map = build_storage_map_from_xdr_ledger_entries(&budget, &footprint, ledger_entries)?;
+    let map = build_storage_map_from_xdr_ledger_entries(&budget, &footprint, ledger_entries);
+    // Taken before checking for errors, so that the counts of a failed call
+    // don't end up in the next one's
+    let (code_cache_hits, code_cache_misses) =
+        CONTRACT_CODE_CACHE.with(|cache| cache.borrow_mut().take_stats());
+    let map = map?;
     let storage = Storage::with_enforcing_footprint_and_map(footprint, map);
     let auth_entries = build_auth_entries_from_xdr(auth_entries)?;
     let host = Host::with_storage_and_budget(storage, budget);
@@ -430,10 +624,15 @@ fn invoke_host_function_or_maybe_panic(
                 result_value: RustBuf { data: vec![] },
                 contract_events: vec![],
                 diagnostic_events: extract_diagnostic_events(&events)?,
-                modified_ledger_entries: vec![],
+                modified_ledger_entries: RustBufBatch {
+                    data: vec![],
+                    sizes: vec![],
+                },
                 cpu_insns: budget.get_cpu_insns_consumed(),
                 mem_bytes: budget.get_mem_bytes_consumed(),
                 expiration_bumps: vec![],
+                code_cache_hits,
+                code_cache_misses,
             });
         }
     };
@@ -453,6 +652,8 @@ fn invoke_host_function_or_maybe_panic(
         cpu_insns: budget.get_cpu_insns_consumed(),
         mem_bytes: budget.get_mem_bytes_consumed(),
         expiration_bumps,
+        code_cache_hits,
+        code_cache_misses,
     })
 }
 
@@ -29,6 +29,20 @@ mod rust_bridge {
         data: Vec<u8>,
     }
 
+    // A sequence of XDR objects serialized back to back in a single buffer,
+    // along with the size of each of them. This passes many objects across
+    // the bridge with one allocation rather than one per object (as a
+    // Vec<CxxBuf> or Vec<RustBuf> would).
+    struct CxxBufBatch {
+        data: UniquePtr<CxxVector<u8>>,
+        sizes: Vec<u32>,
+    }
+
+    struct RustBufBatch {
+        data: Vec<u8>,
+        sizes: Vec<u32>,
+    }
+
     // We return these from get_xdr_hashes below.
     struct XDRFileHash {
         file: String,
@@ -47,10 +61,14 @@ mod rust_bridge {
         result_value: RustBuf,
         contract_events: Vec<RustBuf>,
         diagnostic_events: Vec<RustBuf>,
-        modified_ledger_entries: Vec<RustBuf>,
+        modified_ledger_entries: RustBufBatch,
         expiration_bumps: Vec<Bump>,
         cpu_insns: u64,
         mem_bytes: u64,
+        // Contract code entries found in / missing from the host's cache of
+        // decoded code entries.
+        code_cache_hits: u32,
+        code_cache_misses: u32,
     }
 
     // LogLevel declares to cxx.rs a shared type that both Rust and C+++ will
@@ -141,7 +159,7 @@ mod rust_bridge {
             source_account: &CxxBuf,
             auth_entries: &Vec<CxxBuf>,
             ledger_info: CxxLedgerInfo,
-            ledger_entries: &Vec<CxxBuf>,
+            ledger_entries: &CxxBufBatch,
             base_prng_seed: &CxxBuf,
         ) -> Result<InvokeHostFunctionOutput>;
         fn init_logging(maxLevel: LogLevel) -> Result<()>;
@@ -230,6 +248,7 @@ pub(crate) fn get_test_wasm_complex() -> Result<RustBuf, Box<dyn std::error::Err
 }
 
 use rust_bridge::CxxBuf;
+use rust_bridge::CxxBufBatch;
 use rust_bridge::CxxFeeConfiguration;
 use rust_bridge::CxxLedgerInfo;
 use rust_bridge::CxxTransactionResources;
@@ -539,7 +558,7 @@ pub(crate) fn invoke_host_function(
     source_account_buf: &CxxBuf,
     auth_entries: &Vec<CxxBuf>,
     ledger_info: CxxLedgerInfo,
-    ledger_entries: &Vec<CxxBuf>,
+    ledger_entries: &CxxBufBatch,
     base_prng_seed: &CxxBuf,
 ) -> Result<InvokeHostFunctionOutput, Box<dyn std::error::Error>> {
     if ledger_info.protocol_version > config_max_protocol {
@@ -1370,12 +1370,11 @@ statementBallotCounter(SCPStatement const& st)
 
 static bool
 hasVBlockingSubsetStrictlyAheadOf(
-    std::shared_ptr<LocalNode> localNode,
-    std::map<NodeID, SCPEnvelopeWrapperPtr> const& map, uint32_t n)
+    Slot& slot, std::map<NodeID, SCPEnvelopeWrapperPtr> const& map, uint32_t n)
 {
-    return LocalNode::isVBlocking(
-        localNode->getQuorumSet(), map,
-        [&](SCPStatement const& st) { return statementBallotCounter(st) > n; });
+    return slot.isVBlocking(map, [&](SCPStatement const& st) {
+        return statementBallotCounter(st) > n;
+    });
 }
 
 // Step 9 from the paper (Feb 2016):
@@ -1405,10 +1404,9 @@ BallotProtocol::attemptBump()
         // First check to see if this condition applies at all. If there
         // is no v-blocking set ahead of the local node, there's nothing
         // to do, return early.
-        auto localNode = getLocalNode();
         uint32 localCounter =
             mCurrentBallot ? mCurrentBallot->getBallot().counter : 0;
-        if (!hasVBlockingSubsetStrictlyAheadOf(localNode, mLatestEnvelopes,
+        if (!hasVBlockingSubsetStrictlyAheadOf(mSlot, mLatestEnvelopes,
                                                localCounter))
         {
             return false;
@@ -1429,8 +1427,7 @@ BallotProtocol::attemptBump()
         // order, starting from the smallest.
         for (uint32_t n : allCounters)
         {
-            if (!hasVBlockingSubsetStrictlyAheadOf(localNode, mLatestEnvelopes,
-                                                   n))
+            if (!hasVBlockingSubsetStrictlyAheadOf(mSlot, mLatestEnvelopes, n))
             {
                 // Move to n.
                 return abandonBallot(n);
@@ -2195,10 +2192,8 @@ BallotProtocol::checkHeardFromQuorum()
     if (mCurrentBallot)
     {
         ZoneScoped;
-        if (LocalNode::isQuorum(
-                getLocalNode()->getQuorumSet(), mLatestEnvelopes,
-                std::bind(&Slot::getQuorumSetFromStatement, &mSlot, _1),
-                [&](SCPStatement const& st) {
+        if (mSlot.isQuorum(
+                mLatestEnvelopes, [&](SCPStatement const& st) {
                     bool res;
                     if (st.pledges.type() == SCP_ST_PREPARE)
                     {
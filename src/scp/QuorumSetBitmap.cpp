@@ -0,0 +1,121 @@
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "scp/QuorumSetBitmap.h"
+
+namespace caiz
+{
+
+size_t
+NodeBitIndex::getBit(NodeID const& nodeID)
+{
+    return mBits.emplace(nodeID, mBits.size()).first->second;
+}
+
+QuorumSetBitmap::QuorumSetBitmap(SCPQuorumSet const& qSet, NodeBitIndex& index)
+    : mThreshold(qSet.threshold)
+    , mSize(qSet.validators.size() + qSet.innerSets.size())
+{
+    for (auto const& v : qSet.validators)
+    {
+        auto bit = index.getBit(v);
+        if (mValidators.get(bit))
+        {
+            mRepeatedValidators.emplace_back(bit);
+        }
+        else
+        {
+            mValidators.set(bit);
+        }
+    }
+    mInnerSets.reserve(qSet.innerSets.size());
+    for (auto const& inner : qSet.innerSets)
+    {
+        mInnerSets.emplace_back(inner, index);
+    }
+}
+
+size_t
+QuorumSetBitmap::countValidators(BitSet const& nodes) const
+{
+    size_t res = nodes.intersectionCount(mValidators);
+    for (auto bit : mRepeatedValidators)
+    {
+        if (nodes.get(bit))
+        {
+            ++res;
+        }
+    }
+    return res;
+}
+
+bool
+QuorumSetBitmap::isQuorumSlice(BitSet const& nodes) const
+{
+    // LocalNode::isQuorumSliceInternal never reaches a threshold of 0
+    if (mThreshold == 0)
+    {
+        return false;
+    }
+
+    size_t hits = countValidators(nodes);
+    if (hits >= mThreshold)
+    {
+        return true;
+    }
+
+    size_t innerThreshold = mThreshold - hits;
+    if (innerThreshold > mInnerSets.size())
+    {
+        return false;
+    }
+    // once this many inner sets failed, the threshold can't be reached
+    size_t innerFailLimit = mInnerSets.size() - innerThreshold + 1;
+    for (auto const& inner : mInnerSets)
+    {
+        if (inner.isQuorumSlice(nodes))
+        {
+            if (--innerThreshold == 0)
+            {
+                return true;
+            }
+        }
+        else if (--innerFailLimit == 0)
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool
+QuorumSetBitmap::isVBlocking(BitSet const& nodes) const
+{
+    // There is no v-blocking set for {\empty}
+    if (mThreshold == 0)
+    {
+        return false;
+    }
+
+    // like LocalNode::isVBlockingInternal, needs at least one blocked item
+    // even for thresholds above mSize
+    size_t leftTillBlock =
+        mSize + 1 > mThreshold ? mSize + 1 - mThreshold : 1;
+
+    size_t hits = countValidators(nodes);
+    if (hits >= leftTillBlock)
+    {
+        return true;
+    }
+    leftTillBlock -= hits;
+    for (auto const& inner : mInnerSets)
+    {
+        if (inner.isVBlocking(nodes) && --leftTillBlock == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/BitSet.h"
+#include "xdr/Caiz-SCP.h"
+#include <map>
+#include <vector>
+
+namespace caiz
+{
+
+// Assigns a bit number to every node it is asked about, in order of first
+// use. Sets of nodes are then BitSets over these numbers.
+class NodeBitIndex
+{
+    std::map<NodeID, size_t> mBits;
+
+  public:
+    size_t getBit(NodeID const& nodeID);
+
+    size_t
+    size() const
+    {
+        return mBits.size();
+    }
+};
+
+// A SCPQuorumSet compiled against a NodeBitIndex, so that slice and v-blocking
+// checks against a set of nodes are popcounts of bitwise ANDs instead of
+// searches for each validator in a vector of NodeIDs.
+struct QuorumSetBitmap
+{
+    uint32 mThreshold{0};
+    // number of validators and inner sets, counting repeated validators
+    size_t mSize{0};
+    BitSet mValidators;
+    // bit numbers of validators listed more than once, once per extra
+    // occurrence
+    std::vector<size_t> mRepeatedValidators;
+    std::vector<QuorumSetBitmap> mInnerSets;
+
+    QuorumSetBitmap() = default;
+    QuorumSetBitmap(SCPQuorumSet const& qSet, NodeBitIndex& index);
+
+    // same results as LocalNode::isQuorumSlice and LocalNode::isVBlocking
+    // with the nodes whose bits are set in nodes
+    bool isQuorumSlice(BitSet const& nodes) const;
+    bool isVBlocking(BitSet const& nodes) const;
+
+  private:
+    size_t countValidators(BitSet const& nodes) const;
+};
+}
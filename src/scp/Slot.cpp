@@ -13,6 +13,7 @@
 #include "util/Logging.h"
 #include "util/XDROperators.h"
 #include "xdrpp/marshal.h"
+#include <Tracy.hpp>
 #include <ctime>
 #include <functional>
 
@@ -393,13 +394,125 @@ Slot::getJsonQuorumInfo(NodeID const& id, bool summary, bool fullKeys)
     return ret;
 }
 
+QuorumSetBitmap const&
+Slot::getLocalQuorumSetBitmap()
+{
+    auto localNode = getLocalNode();
+    auto const& hash = localNode->getQuorumSetHash();
+    auto it = mQuorumSetBitmaps.find(hash);
+    if (it == mQuorumSetBitmaps.end())
+    {
+        it = mQuorumSetBitmaps
+                 .emplace(hash, QuorumSetBitmap(localNode->getQuorumSet(),
+                                                mNodeBits))
+                 .first;
+    }
+    return it->second;
+}
+
+QuorumSetBitmap const*
+Slot::getQuorumSetBitmapFromStatement(SCPStatement const& st)
+{
+    if (st.pledges.type() == SCP_ST_EXTERNALIZE)
+    {
+        auto bit = mNodeBits.getBit(st.nodeID);
+        auto it = mSingletonQuorumSetBitmaps.find(bit);
+        if (it == mSingletonQuorumSetBitmaps.end())
+        {
+            it = mSingletonQuorumSetBitmaps
+                     .emplace(bit,
+                              QuorumSetBitmap(
+                                  *LocalNode::getSingletonQSet(st.nodeID),
+                                  mNodeBits))
+                     .first;
+        }
+        return &it->second;
+    }
+
+    auto hash = getCompanionQuorumSetHashFromStatement(st);
+    auto it = mQuorumSetBitmaps.find(hash);
+    if (it == mQuorumSetBitmaps.end())
+    {
+        auto qSet = getSCPDriver().getQSet(hash);
+        if (!qSet)
+        {
+            return nullptr;
+        }
+        it = mQuorumSetBitmaps.emplace(hash, QuorumSetBitmap(*qSet, mNodeBits))
+                 .first;
+    }
+    return &it->second;
+}
+
+bool
+Slot::isVBlocking(std::map<NodeID, SCPEnvelopeWrapperPtr> const& map,
+                  StatementPredicate const& filter)
+{
+    ZoneScoped;
+    auto const& qSet = getLocalQuorumSetBitmap();
+    BitSet nodes(mNodeBits.size());
+    for (auto const& it : map)
+    {
+        if (filter(it.second->getStatement()))
+        {
+            nodes.set(mNodeBits.getBit(it.first));
+        }
+    }
+    return qSet.isVBlocking(nodes);
+}
+
+bool
+Slot::isQuorum(std::map<NodeID, SCPEnvelopeWrapperPtr> const& map,
+               StatementPredicate const& filter)
+{
+    ZoneScoped;
+    auto const& qSet = getLocalQuorumSetBitmap();
+
+    std::vector<std::pair<size_t, QuorumSetBitmap const*>> members;
+    BitSet nodes(mNodeBits.size());
+    for (auto const& it : map)
+    {
+        auto const& st = it.second->getStatement();
+        if (filter(st))
+        {
+            auto bit = mNodeBits.getBit(it.first);
+            members.emplace_back(bit, getQuorumSetBitmapFromStatement(st));
+            nodes.set(bit);
+        }
+    }
+
+    // drop nodes that don't have a slice within the remaining nodes, until
+    // all remaining ones do
+    bool changed;
+    do
+    {
+        changed = false;
+        auto it = members.begin();
+        while (it != members.end())
+        {
+            if (it->second && it->second->isQuorumSlice(nodes))
+            {
+                ++it;
+            }
+            else
+            {
+                nodes.unset(it->first);
+                it = members.erase(it);
+                changed = true;
+            }
+        }
+    } while (changed);
+
+    return qSet.isQuorumSlice(nodes);
+}
+
 bool
 Slot::federatedAccept(StatementPredicate voted, StatementPredicate accepted,
                       std::map<NodeID, SCPEnvelopeWrapperPtr> const& envs)
 {
     // Checks if the nodes that claimed to accept the statement form a
     // v-blocking set
-    if (LocalNode::isVBlocking(getLocalNode()->getQuorumSet(), envs, accepted))
+    if (isVBlocking(envs, accepted))
     {
         return true;
     }
@@ -412,10 +525,7 @@ Slot::federatedAccept(StatementPredicate voted, StatementPredicate accepted,
         return res;
     };
 
-    if (LocalNode::isQuorum(
-            getLocalNode()->getQuorumSet(), envs,
-            std::bind(&Slot::getQuorumSetFromStatement, this, _1),
-            ratifyFilter))
+    if (isQuorum(envs, ratifyFilter))
     {
         return true;
     }
@@ -427,9 +537,7 @@ bool
 Slot::federatedRatify(StatementPredicate voted,
                       std::map<NodeID, SCPEnvelopeWrapperPtr> const& envs)
 {
-    return LocalNode::isQuorum(
-        getLocalNode()->getQuorumSet(), envs,
-        std::bind(&Slot::getQuorumSetFromStatement, this, _1), voted);
+    return isQuorum(envs, voted);
 }
 
 std::shared_ptr<LocalNode>
@@ -7,8 +7,10 @@
 #include "BallotProtocol.h"
 #include "LocalNode.h"
 #include "NominationProtocol.h"
+#include "QuorumSetBitmap.h"
 #include "lib/json/json-forwards.h"
 #include "scp/SCP.h"
+#include "util/UnorderedMap.h"
 #include <functional>
 #include <memory>
 #include <set>
@@ -48,6 +50,18 @@ class Slot : public std::enable_shared_from_this<Slot>
     // true if we heard from a v-blocking set
     bool mGotVBlocking;
 
+    // quorum sets compiled for isVBlocking and isQuorum, keyed by hash so
+    // that a new local quorum set gets compiled on first use
+    NodeBitIndex mNodeBits;
+    UnorderedMap<Hash, QuorumSetBitmap> mQuorumSetBitmaps;
+    // singleton quorum sets used for EXTERNALIZE statements, by node bit
+    UnorderedMap<size_t, QuorumSetBitmap> mSingletonQuorumSetBitmaps;
+
+    QuorumSetBitmap const& getLocalQuorumSetBitmap();
+    // nullptr if the quorum set is not known
+    QuorumSetBitmap const*
+    getQuorumSetBitmapFromStatement(SCPStatement const& st);
+
   public:
     Slot(uint64 slotIndex, SCP& SCP);
 
@@ -183,6 +197,13 @@ class Slot : public std::enable_shared_from_this<Slot>
 
     // ** federated agreement helper functions
 
+    // same as LocalNode::isVBlocking and LocalNode::isQuorum for the local
+    // quorum set, using the quorum sets compiled for this slot
+    bool isVBlocking(std::map<NodeID, SCPEnvelopeWrapperPtr> const& map,
+                     StatementPredicate const& filter);
+    bool isQuorum(std::map<NodeID, SCPEnvelopeWrapperPtr> const& map,
+                  StatementPredicate const& filter);
+
     // returns true if the statement defined by voted and accepted
     // should be accepted
     bool federatedAccept(StatementPredicate voted, StatementPredicate accepted,
@@ -7,6 +7,7 @@
 #include "crypto/SHA.h"
 #include "lib/catch.hpp"
 #include "scp/LocalNode.h"
+#include "scp/QuorumSetBitmap.h"
 #include "scp/SCP.h"
 #include "scp/Slot.h"
 #include "simulation/Simulation.h"
@@ -15,6 +16,8 @@
 #include "util/XDROperators.h"
 #include "xdrpp/marshal.h"
 #include "xdrpp/printer.h"
+#include <chrono>
+#include <fmt/chrono.h>
 #include <fmt/format.h>
 
 // General convention in this file is that numbers in parenthesis
@@ -123,6 +126,12 @@ class TestSCP : public SCPDriver
         mEnvs.push_back(envelope);
     }
 
+    std::shared_ptr<Slot>
+    getSlot(uint64 slotIndex)
+    {
+        return mSCP.getSlot(slotIndex, true);
+    }
+
     // used to test BallotProtocol and bypass nomination
     bool
     bumpState(uint64 slotIndex, Value const& v)
@@ -476,6 +485,139 @@ TEST_CASE("vblocking and quorum", "[scp]")
     REQUIRE(LocalNode::isVBlocking(qSet, nodeSet) == true);
 }
 
+TEST_CASE("quorum set bitmaps", "[scp]")
+{
+    std::vector<NodeID> nodes;
+    for (int i = 0; i < 20; i++)
+    {
+        nodes.emplace_back(
+            SecretKey::fromSeed(sha256(fmt::format("NODE_SEED_{}", i)))
+                .getPublicKey());
+    }
+
+    // also covers repeated validators and thresholds that sane quorum sets
+    // can't have
+    std::function<SCPQuorumSet(int)> makeQSet = [&](int depth) {
+        SCPQuorumSet qSet;
+        auto nbValidators = rand_uniform<size_t>(0, 5);
+        for (size_t i = 0; i < nbValidators; i++)
+        {
+            qSet.validators.emplace_back(rand_element(nodes));
+        }
+        auto nbInner = depth == 0 ? 0 : rand_uniform<size_t>(0, 3);
+        for (size_t i = 0; i < nbInner; i++)
+        {
+            qSet.innerSets.emplace_back(makeQSet(depth - 1));
+        }
+        qSet.threshold = rand_uniform<uint32>(
+            0, static_cast<uint32>(nbValidators + nbInner + 1));
+        return qSet;
+    };
+
+    for (int i = 0; i < 1000; i++)
+    {
+        auto qSet = makeQSet(2);
+        NodeBitIndex index;
+        QuorumSetBitmap qSetBitmap(qSet, index);
+
+        std::vector<NodeID> nodeSet;
+        BitSet nodeBits;
+        for (auto const& n : nodes)
+        {
+            if (rand_flip())
+            {
+                nodeSet.emplace_back(n);
+                nodeBits.set(index.getBit(n));
+            }
+        }
+
+        REQUIRE(qSetBitmap.isQuorumSlice(nodeBits) ==
+                LocalNode::isQuorumSlice(qSet, nodeSet));
+        REQUIRE(qSetBitmap.isVBlocking(nodeBits) ==
+                LocalNode::isVBlocking(qSet, nodeSet));
+    }
+}
+
+TEST_CASE("quorum checks with 100 node transitive quorum",
+          "[scp][bench][!hide]")
+{
+    // 10 organizations of 10 validators, every node requiring 7 of its
+    // organization's validators in 7 of the organizations. Compares
+    // LocalNode::isQuorum and LocalNode::isVBlocking, which walk the quorum
+    // sets of every node on each call, with the checks of Slot that use
+    // bitmaps compiled once per slot.
+    setupValues();
+    size_t const nbOrgs = 10;
+    size_t const nodesPerOrg = 10;
+    std::vector<SecretKey> keys;
+    SCPQuorumSet qSet;
+    qSet.threshold = 7;
+    for (size_t i = 0; i < nbOrgs; i++)
+    {
+        SCPQuorumSet org;
+        org.threshold = 7;
+        for (size_t j = 0; j < nodesPerOrg; j++)
+        {
+            keys.emplace_back(SecretKey::fromSeed(
+                sha256(fmt::format("NODE_SEED_{}_{}", i, j))));
+            org.validators.emplace_back(keys.back().getPublicKey());
+        }
+        qSet.innerSets.emplace_back(org);
+    }
+
+    TestSCP scp(keys[0].getPublicKey(), qSet);
+    auto const& qSetHash = scp.mSCP.getLocalNode()->getQuorumSetHash();
+    auto slot = scp.getSlot(0);
+
+    std::map<NodeID, SCPEnvelopeWrapperPtr> envs;
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        SCPBallot b(i % nodesPerOrg < 8 ? 2 : 1, xValue);
+        envs.emplace(keys[i].getPublicKey(),
+                     scp.wrapEnvelope(makePrepare(keys[i], qSetHash, 0, b)));
+    }
+
+    // 8 nodes per organization are ahead: a quorum, and v-blocking
+    auto ahead = [](SCPStatement const& st) {
+        return st.pledges.prepare().ballot.counter > 1;
+    };
+    // 2 nodes per organization: neither
+    auto behind = [](SCPStatement const& st) {
+        return st.pledges.prepare().ballot.counter == 1;
+    };
+    auto qfun = [&](SCPStatement const& st) {
+        return slot->getQuorumSetFromStatement(st);
+    };
+
+    namespace ch = std::chrono;
+    size_t const iterations = 1000;
+    auto run = [&](std::string const& name, auto check) {
+        auto start = ch::steady_clock::now();
+        for (size_t i = 0; i < iterations; i++)
+        {
+            REQUIRE(check(ahead));
+            REQUIRE(!check(behind));
+        }
+        auto end = ch::steady_clock::now();
+        LOG_INFO(DEFAULT_LOG, "{}: {} checks in {}", name, 2 * iterations,
+                 ch::duration_cast<ch::milliseconds>(end - start));
+    };
+
+    auto const& localQSet = scp.mSCP.getLocalQuorumSet();
+    run("LocalNode::isQuorum", [&](StatementPredicate const& filter) {
+        return LocalNode::isQuorum(localQSet, envs, qfun, filter);
+    });
+    run("Slot::isQuorum", [&](StatementPredicate const& filter) {
+        return slot->isQuorum(envs, filter);
+    });
+    run("LocalNode::isVBlocking", [&](StatementPredicate const& filter) {
+        return LocalNode::isVBlocking(localQSet, envs, filter);
+    });
+    run("Slot::isVBlocking", [&](StatementPredicate const& filter) {
+        return slot->isVBlocking(envs, filter);
+    });
+}
+
 TEST_CASE("v blocking distance", "[scp]")
 {
     setupValues();
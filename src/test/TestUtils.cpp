@@ -139,8 +139,9 @@ BucketListDepthModifier::~BucketListDepthModifier()
 }
 }
 
-TestInvariantManager::TestInvariantManager(medida::MetricsRegistry& registry)
-    : InvariantManagerImpl(registry)
+TestInvariantManager::TestInvariantManager(medida::MetricsRegistry& registry,
+                                           Config const& cfg)
+    : InvariantManagerImpl(registry, cfg)
 {
 }
 
@@ -160,7 +161,7 @@ TestApplication::TestApplication(VirtualClock& clock, Config const& cfg)
 std::unique_ptr<InvariantManager>
 TestApplication::createInvariantManager()
 {
-    return std::make_unique<TestInvariantManager>(getMetrics());
+    return std::make_unique<TestInvariantManager>(getMetrics(), getConfig());
 }
 
 TimePoint
@@ -52,7 +52,7 @@ testBucketMetadata(uint32_t protocolVersion)
 class TestInvariantManager : public InvariantManagerImpl
 {
   public:
-    TestInvariantManager(medida::MetricsRegistry& registry);
+    TestInvariantManager(medida::MetricsRegistry& registry, Config const& cfg);
 
   private:
     virtual void
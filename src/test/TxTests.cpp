@@ -159,8 +159,11 @@ applyCheck(TransactionFramePtr tx, Application& app, bool checkSeqNum)
             // else, leave feeCharged as per checkValid
             try
             {
+                // Apply without meta, so every test also checks that
+                // skipping meta does not change the result
                 TransactionMetaFrame cleanTm(
-                    ltxCleanTx.loadHeader().current().ledgerVersion);
+                    ltxCleanTx.loadHeader().current().ledgerVersion,
+                    /*enabled=*/false);
                 checkedTxApplyRes = checkedTx->apply(app, ltxCleanTx, cleanTm);
             }
             catch (...)
@@ -105,7 +105,8 @@ AllowTrustOpFrame::isAuthRevocationValid(AbstractLedgerTxn& ltx,
     LedgerTxn ltxSource(ltx); // ltxSource will be rolled back
     auto header = ltxSource.loadHeader();
     auto sourceAccountEntry = loadSourceAccount(ltxSource, header);
-    auto const& sourceAccount = sourceAccountEntry.current().data.account();
+    auto const& sourceAccount =
+        sourceAccountEntry.currentConst().data.account();
 
     // Check if the source account doesn't require authorization check
     // Only valid for earlier versions.
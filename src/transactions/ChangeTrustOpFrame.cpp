@@ -196,7 +196,7 @@ ChangeTrustOpFrame::doApply(AbstractLedgerTxn& ltx)
         { // we are deleting a trustline
             // use a lambda so we don't hold a reference to the TrustLineEntry
             auto tlEntry = [&]() -> TrustLineEntry const& {
-                return trustLine.current().data.trustLine();
+                return trustLine.currentConst().data.trustLine();
             };
 
             bool isPoolShare = tlEntry().asset.type() == ASSET_TYPE_POOL_SHARE;
@@ -41,7 +41,9 @@ ClawbackClaimableBalanceOpFrame::doApply(AbstractLedgerTxn& ltx)
 
     // use a lambda so we don't hold a reference to the Asset
     auto asset = [&]() -> Asset const& {
-        return claimableBalanceLtxEntry.current().data.claimableBalance().asset;
+        return claimableBalanceLtxEntry.currentConst()
+            .data.claimableBalance()
+            .asset;
     };
 
     if (asset().type() == ASSET_TYPE_NATIVE)
@@ -57,7 +59,7 @@ ClawbackClaimableBalanceOpFrame::doApply(AbstractLedgerTxn& ltx)
     }
 
     if (!isClawbackEnabledOnClaimableBalance(
-            claimableBalanceLtxEntry.current()))
+            claimableBalanceLtxEntry.currentConst()))
     {
         innerResult().code(CLAWBACK_CLAIMABLE_BALANCE_NOT_CLAWBACK_ENABLED);
         return false;
@@ -54,6 +54,13 @@ FeeBumpTransactionFrame::sorobanResources() const
     return mInnerTx->sorobanResources();
 }
 
+void
+FeeBumpTransactionFrame::setSpeculativeHostFnOutput(
+    std::shared_ptr<SpeculativeHostFnOutput> output)
+{
+    mInnerTx->setSpeculativeHostFnOutput(std::move(output));
+}
+
 void
 FeeBumpTransactionFrame::maybeComputeSorobanResourceFee(
     uint32_t protocolVersion, SorobanNetworkConfig const& sorobanConfig,
@@ -121,7 +128,10 @@ FeeBumpTransactionFrame::apply(Application& app, AbstractLedgerTxn& ltx,
     {
         LedgerTxn ltxTx(ltx);
         removeOneTimeSignerKeyFromFeeSource(ltxTx);
-        meta.pushTxChangesBefore(ltxTx.getChanges());
+        if (meta.isEnabled())
+        {
+            meta.pushTxChangesBefore(ltxTx.getChanges());
+        }
         ltxTx.commit();
     }
     catch (std::exception& e)
@@ -276,7 +286,7 @@ FeeBumpTransactionFrame::commonValid(SignatureChecker& signatureChecker,
     auto feeSource = caiz::loadAccount(ltx, getFeeSourceID());
     if (!checkSignature(
             signatureChecker, feeSource,
-            feeSource.current().data.account().thresholds[THRESHOLD_LOW]))
+            feeSource.currentConst().data.account().thresholds[THRESHOLD_LOW]))
     {
         getResult().result.code(txBAD_AUTH);
         return res;
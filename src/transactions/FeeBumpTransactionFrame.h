@@ -111,6 +111,8 @@ class FeeBumpTransactionFrame : public TransactionFrameBase
     bool isSoroban() const override;
 #ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
     SorobanResources const& sorobanResources() const override;
+    void setSpeculativeHostFnOutput(
+        std::shared_ptr<SpeculativeHostFnOutput> output) override;
     void
     maybeComputeSorobanResourceFee(uint32_t protocolVersion,
                                    SorobanNetworkConfig const& sorobanConfig,
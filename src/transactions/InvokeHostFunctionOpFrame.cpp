@@ -26,6 +26,8 @@
 #include "ledger/LedgerTxnEntry.h"
 #include "rust/RustBridge.h"
 #include "transactions/InvokeHostFunctionOpFrame.h"
+#include "rust/XdrBufBatch.h"
+#include "transactions/ParallelSorobanApply.h"
 #include <crypto/SHA.h>
 
 namespace caiz
@@ -39,11 +41,10 @@ toCxxBuf(T const& t)
 }
 
 CxxLedgerInfo
-getLedgerInfo(AbstractLedgerTxn& ltx, Config const& cfg,
+getLedgerInfo(LedgerHeader const& hdr, Config const& cfg,
               SorobanNetworkConfig const& sorobanConfig)
 {
     CxxLedgerInfo info;
-    auto const& hdr = ltx.loadHeader().current();
     info.base_reserve = hdr.baseReserve;
     info.protocol_version = hdr.ledgerVersion;
     info.sequence_number = hdr.ledgerSeq;
@@ -156,6 +157,9 @@ struct HostFunctionMetrics
     size_t mCpuInsn{0};
     size_t mMemByte{0};
 
+    size_t mCodeCacheHit{0};
+    size_t mCodeCacheMiss{0};
+
     size_t mMetadataSizeByte{0};
 
     bool mSuccess{false};
@@ -245,6 +249,11 @@ struct HostFunctionMetrics
         mMetrics.NewMeter({"soroban", "host-fn-op", "mem-byte"}, "byte")
             .Mark(mMemByte);
 
+        mMetrics.NewMeter({"soroban", "host-fn-op", "code-cache-hit"}, "entry")
+            .Mark(mCodeCacheHit);
+        mMetrics.NewMeter({"soroban", "host-fn-op", "code-cache-miss"}, "entry")
+            .Mark(mCodeCacheMiss);
+
         if (mSuccess)
         {
             mMetrics.NewMeter({"soroban", "host-fn-op", "success"}, "call")
@@ -271,16 +280,17 @@ InvokeHostFunctionOpFrame::doApply(Application& app, AbstractLedgerTxn& ltx,
     HostFunctionMetrics metrics(app.getMetrics());
     auto const& sorobanConfig =
         app.getLedgerManager().getSorobanNetworkConfig(ltx);
+    auto speculative = mParentTx.takeSpeculativeHostFnOutput();
 
     // Get the entries for the footprint
-    rust::Vec<CxxBuf> ledgerEntryCxxBufs;
+    auto ledgerEntries = makeCxxBufBatch();
     UnorderedMap<LedgerKey, uint32_t> originalExpirations;
     auto const& resources = mParentTx.sorobanResources();
     auto const& footprint = resources.footprint;
     auto reserveSize = footprint.readOnly.size() + footprint.readWrite.size();
-    ledgerEntryCxxBufs.reserve(reserveSize);
+    ledgerEntries.sizes.reserve(reserveSize);
 
-    auto addReads = [&ledgerEntryCxxBufs, &ltx, &metrics, &sorobanConfig,
+    auto addReads = [&ledgerEntries, &ltx, &metrics, &sorobanConfig,
                      &originalExpirations](auto const& keys) -> bool {
         for (auto const& lk : keys)
         {
@@ -290,8 +300,7 @@ InvokeHostFunctionOpFrame::doApply(Application& app, AbstractLedgerTxn& ltx,
             if (ltxe)
             {
                 auto const& le = ltxe.current();
-                auto buf = toCxxBuf(le);
-                nByte = buf.data->size();
+                nByte = appendToCxxBufBatch(ledgerEntries, le);
                 // Typically invalid entry read should not happen unless some
                 // backward-incompatible change happened (e.g. reducing the
                 // contract data size limit) that renders previously valid
@@ -300,7 +309,6 @@ InvokeHostFunctionOpFrame::doApply(Application& app, AbstractLedgerTxn& ltx,
                 {
                     return false;
                 }
-                ledgerEntryCxxBufs.emplace_back(std::move(buf));
                 if (isSorobanEntry(le.data))
                 {
                     originalExpirations.emplace(LedgerEntryKey(le),
@@ -339,29 +347,38 @@ InvokeHostFunctionOpFrame::doApply(Application& app, AbstractLedgerTxn& ltx,
         return false;
     }
 
-    CxxBuf hostFnCxxBuf = toCxxBuf(mInvokeHostFunction.hostFunction);
-    rust::Vec<CxxBuf> authEntryCxxBufs;
-    authEntryCxxBufs.reserve(mInvokeHostFunction.auth.size());
-    for (auto const& authEntry : mInvokeHostFunction.auth)
-    {
-        authEntryCxxBufs.push_back(toCxxBuf(authEntry));
-    }
-
     InvokeHostFunctionOutput out{};
     try
     {
-        auto timeScope = metrics.getExecTimer();
-        CxxBuf basePrngSeedBuf;
-        basePrngSeedBuf.data = std::make_unique<std::vector<uint8_t>>();
-        basePrngSeedBuf.data->assign(sorobanBasePrngSeed.begin(),
-                                     sorobanBasePrngSeed.end());
-
-        out = rust_bridge::invoke_host_function(
-            cfg.CURRENT_LEDGER_PROTOCOL_VERSION,
-            cfg.ENABLE_SOROBAN_DIAGNOSTIC_EVENTS, hostFnCxxBuf,
-            toCxxBuf(resources), toCxxBuf(getSourceID()), authEntryCxxBufs,
-            getLedgerInfo(ltx, cfg, sorobanConfig), ledgerEntryCxxBufs,
-            basePrngSeedBuf);
+        // Reuse the output of an ahead-of-apply execution (see
+        // ParallelSorobanApply) if it ran against exactly the entries loaded
+        // above, the same ledger header fields and the same seed; the host
+        // function is deterministic in its inputs, so the output is the same
+        // as running it here.
+        if (speculative &&
+            speculative->matches(ledgerEntries, ltx.loadHeader().current(),
+                                 sorobanBasePrngSeed))
+        {
+            app.getMetrics()
+                .NewMeter({"soroban", "parallel-apply", "reused"}, "call")
+                .Mark();
+            out = std::move(speculative->mOutput);
+        }
+        else
+        {
+            if (speculative)
+            {
+                app.getMetrics()
+                    .NewMeter({"soroban", "parallel-apply", "mismatch"},
+                              "call")
+                    .Mark();
+            }
+            auto timeScope = metrics.getExecTimer();
+            out = invokeHostFunction(cfg, ltx.loadHeader().current(),
+                                     sorobanConfig, mInvokeHostFunction,
+                                     resources, getSourceID(),
+                                     ledgerEntries, sorobanBasePrngSeed);
+        }
 
         if (out.success)
         {
@@ -379,6 +396,8 @@ InvokeHostFunctionOpFrame::doApply(Application& app, AbstractLedgerTxn& ltx,
 
     metrics.mCpuInsn = out.cpu_insns;
     metrics.mMemByte = out.mem_bytes;
+    metrics.mCodeCacheHit = out.code_cache_hits;
+    metrics.mCodeCacheMiss = out.code_cache_misses;
     if (!metrics.mSuccess)
     {
         if (resources.instructions < out.cpu_insns ||
@@ -395,18 +414,18 @@ InvokeHostFunctionOpFrame::doApply(Application& app, AbstractLedgerTxn& ltx,
 
     // Create or update every entry returned
     std::unordered_set<LedgerKey> keys;
-    for (auto const& buf : out.modified_ledger_entries)
+    RustBufBatchReader modifiedEntries(out.modified_ledger_entries);
+    LedgerEntry le;
+    while (auto nByte = modifiedEntries.next(le))
     {
-        LedgerEntry le;
-        xdr::xdr_from_opaque(buf.data, le);
-        if (!validateContractLedgerEntry(le, buf.data.size(), sorobanConfig))
+        if (!validateContractLedgerEntry(le, *nByte, sorobanConfig))
         {
             innerResult().code(INVOKE_HOST_FUNCTION_RESOURCE_LIMIT_EXCEEDED);
             return false;
         }
 
         auto lk = LedgerEntryKey(le);
-        metrics.noteWriteEntry(lk, buf.data.size());
+        metrics.noteWriteEntry(lk, *nByte);
         if (resources.writeBytes < metrics.mLedgerWriteByte)
         {
             innerResult().code(INVOKE_HOST_FUNCTION_RESOURCE_LIMIT_EXCEEDED);
@@ -496,6 +515,34 @@ InvokeHostFunctionOpFrame::doApply(Application& app, AbstractLedgerTxn& ltx,
     return true;
 }
 
+InvokeHostFunctionOutput
+InvokeHostFunctionOpFrame::invokeHostFunction(
+    Config const& cfg, LedgerHeader const& header,
+    SorobanNetworkConfig const& sorobanConfig, InvokeHostFunctionOp const& op,
+    SorobanResources const& resources, AccountID const& sourceID,
+    CxxBufBatch const& ledgerEntries, Hash const& sorobanBasePrngSeed)
+{
+    CxxBuf hostFnCxxBuf = toCxxBuf(op.hostFunction);
+    rust::Vec<CxxBuf> authEntryCxxBufs;
+    authEntryCxxBufs.reserve(op.auth.size());
+    for (auto const& authEntry : op.auth)
+    {
+        authEntryCxxBufs.push_back(toCxxBuf(authEntry));
+    }
+
+    CxxBuf basePrngSeedBuf;
+    basePrngSeedBuf.data = std::make_unique<std::vector<uint8_t>>();
+    basePrngSeedBuf.data->assign(sorobanBasePrngSeed.begin(),
+                                 sorobanBasePrngSeed.end());
+
+    return rust_bridge::invoke_host_function(
+        cfg.CURRENT_LEDGER_PROTOCOL_VERSION,
+        cfg.ENABLE_SOROBAN_DIAGNOSTIC_EVENTS, hostFnCxxBuf,
+        toCxxBuf(resources), toCxxBuf(sourceID), authEntryCxxBufs,
+        getLedgerInfo(header, cfg, sorobanConfig), ledgerEntries,
+        basePrngSeedBuf);
+}
+
 bool
 InvokeHostFunctionOpFrame::doCheckValid(SorobanNetworkConfig const& config,
                                         uint32_t ledgerVersion)
@@ -47,6 +47,19 @@ class InvokeHostFunctionOpFrame : public OperationFrame
     void
     insertLedgerKeysToPrefetch(UnorderedSet<LedgerKey>& keys) const override;
 
+    // Runs the host function of `op` against the encoded footprint entries
+    // `ledgerEntries` and returns its output. Doesn't use any LedgerTxn,
+    // so it can run off the main thread. Throws if the host reports an
+    // error.
+    static InvokeHostFunctionOutput
+    invokeHostFunction(Config const& cfg, LedgerHeader const& header,
+                       SorobanNetworkConfig const& sorobanConfig,
+                       InvokeHostFunctionOp const& op,
+                       SorobanResources const& resources,
+                       AccountID const& sourceID,
+                       CxxBufBatch const& ledgerEntries,
+                       Hash const& sorobanBasePrngSeed);
+
     static InvokeHostFunctionResultCode
     getInnerCode(OperationResult const& res)
     {
@@ -155,7 +155,7 @@ MergeOpFrame::doApplyBeforeV16(AbstractLedgerTxn& ltx)
             return false;
         }
 
-        if (getNumSponsoring(sourceAccountEntry.current()) > 0)
+        if (getNumSponsoring(sourceAccountEntry.currentConst()) > 0)
         {
             innerResult().code(ACCOUNT_MERGE_IS_SPONSOR);
             return false;
@@ -206,7 +206,7 @@ MergeOpFrame::doApplyFromV16(AbstractLedgerTxn& ltx)
 
     // use a lambda so we don't hold a reference to the AccountEntry
     auto sourceAccount = [&]() -> AccountEntry const& {
-        return sourceAccountEntry.current().data.account();
+        return sourceAccountEntry.currentConst().data.account();
     };
 
     if (sourceAccount().numSubEntries != sourceAccount().signers.size())
@@ -227,7 +227,7 @@ MergeOpFrame::doApplyFromV16(AbstractLedgerTxn& ltx)
         return false;
     }
 
-    if (getNumSponsoring(sourceAccountEntry.current()) > 0)
+    if (getNumSponsoring(sourceAccountEntry.currentConst()) > 0)
     {
         innerResult().code(ACCOUNT_MERGE_IS_SPONSOR);
         return false;
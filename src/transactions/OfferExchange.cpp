@@ -177,15 +177,103 @@ exchangeV3(int64_t wheatReceived, Price price, int64_t maxWheatReceive,
     return result;
 }
 
+namespace
+{
+// The exchange arithmetic below is written against one of these policies. They
+// give bit-identical results, and throw for exactly the same inputs, as the
+// uint128_t helpers in util/numeric.h. PortableArithmetic is those helpers;
+// NativeArithmetic does the same work on the compiler's 128-bit integer, which
+// avoids the software multiplication and long division of uint128_t on every
+// offer crossed.
+struct PortableArithmetic
+{
+    using Wide = uint128_t;
+
+    static Wide
+    multiply(int64_t a, int64_t b)
+    {
+        return bigMultiply(a, b);
+    }
+
+    static int64_t
+    divideOrThrow(Wide const& a, int64_t b, Rounding rounding)
+    {
+        return bigDivideOrThrow128(a, b, rounding);
+    }
+
+    static int64_t
+    divideOrThrow(int64_t a, int64_t b, int64_t c, Rounding rounding)
+    {
+        return bigDivideOrThrow(a, b, c, rounding);
+    }
+};
+
+#ifdef __SIZEOF_INT128__
+struct NativeArithmetic
+{
+    using Wide = unsigned __int128;
+
+    static Wide
+    multiply(int64_t a, int64_t b)
+    {
+        releaseAssertOrThrow((a >= 0) && (b >= 0));
+        return static_cast<Wide>(a) * static_cast<uint64_t>(b);
+    }
+
+    static int64_t
+    toInt64OrThrow(Wide x)
+    {
+        if (x > static_cast<Wide>(INT64_MAX))
+        {
+            throw std::overflow_error("overflow while performing bigDivide");
+        }
+        return static_cast<int64_t>(x);
+    }
+
+    static int64_t
+    divideOrThrow(Wide a, int64_t b, Rounding rounding)
+    {
+        releaseAssertOrThrow(b > 0);
+        Wide const wb = static_cast<uint64_t>(b);
+        if (rounding == ROUND_DOWN)
+        {
+            return toInt64OrThrow(a / wb);
+        }
+        // See bigDivideUnsigned128 for why this is an overflow
+        if (a > ~Wide(0) - (wb - 1))
+        {
+            throw std::overflow_error("overflow while performing bigDivide");
+        }
+        return toInt64OrThrow((a + wb - 1) / wb);
+    }
+
+    static int64_t
+    divideOrThrow(int64_t a, int64_t b, int64_t c, Rounding rounding)
+    {
+        releaseAssertOrThrow((a >= 0) && (b >= 0) && (c > 0));
+        // a * b < 2^126, so rounding up cannot overflow
+        Wide const x = static_cast<Wide>(a) * static_cast<uint64_t>(b);
+        Wide const wc = static_cast<uint64_t>(c);
+        return toInt64OrThrow(rounding == ROUND_DOWN ? x / wc
+                                                     : (x + wc - 1) / wc);
+    }
+};
+using FastArithmetic = NativeArithmetic;
+#else
+using FastArithmetic = PortableArithmetic;
+#endif
+}
+
 // Check that the relative error between the price and the effective price does
 // not exceed 1%. If canFavorWheat == true then this function does an asymmetric
 // check such that error favoring the seller of wheat can be unbounded, while
 // the relative error between the price and the effective price does not exceed
 // 1% if it is favoring the seller of sheep. The functionality of canFavorWheat
 // is required for PathPayment.
-bool
-checkPriceErrorBound(Price price, int64_t wheatReceive, int64_t sheepSend,
-                     bool canFavorWheat)
+template <typename Arith>
+static bool
+checkPriceErrorBoundImpl(Price price, int64_t wheatReceive, int64_t sheepSend,
+                         bool canFavorWheat)
 {
     // Let K = 100 / threshold, where threshold is the maximum relative error in
     // percent (so in this case, threshold = 1%). Then we can rearrange the
@@ -202,28 +290,43 @@ checkPriceErrorBound(Price price, int64_t wheatReceive, int64_t sheepSend,
     int64_t errN = (int64_t)100 * (int64_t)price.n;
     int64_t errD = (int64_t)100 * (int64_t)price.d;
 
-    uint128_t lhs = bigMultiply(errN, wheatReceive);
-    uint128_t rhs = bigMultiply(errD, sheepSend);
+    auto lhs = Arith::multiply(errN, wheatReceive);
+    auto rhs = Arith::multiply(errD, sheepSend);
 
     if (canFavorWheat && rhs > lhs)
     {
         return true;
     }
 
-    uint128_t absDiff = (lhs > rhs) ? (lhs - rhs) : (rhs - lhs);
-    uint128_t cap = bigMultiply(price.n, wheatReceive);
+    auto absDiff = (lhs > rhs) ? (lhs - rhs) : (rhs - lhs);
+    auto cap = Arith::multiply(price.n, wheatReceive);
     return (absDiff <= cap);
 }
 
-static uint128_t
+bool
+checkPriceErrorBound(Price price, int64_t wheatReceive, int64_t sheepSend,
+                     bool canFavorWheat)
+{
+    return checkPriceErrorBoundImpl<FastArithmetic>(price, wheatReceive,
+                                                    sheepSend, canFavorWheat);
+}
+
+template <typename Arith>
+static typename Arith::Wide
 calculateOfferValue(int32_t priceN, int32_t priceD, int64_t maxSend,
                     int64_t maxReceive)
 {
-    uint128_t sendValue = bigMultiply(maxSend, priceN);
-    uint128_t receiveValue = bigMultiply(maxReceive, priceD);
+    auto sendValue = Arith::multiply(maxSend, priceN);
+    auto receiveValue = Arith::multiply(maxReceive, priceD);
     return std::min({sendValue, receiveValue});
 }
 
+template <typename Arith>
+static ExchangeResultV10
+exchangeV10Impl(Price price, int64_t maxWheatSend, int64_t maxWheatReceive,
+                int64_t maxSheepSend, int64_t maxSheepReceive,
+                RoundingType round);
+
 // exchangeV10 is a system for crossing offers that provides guarantees
 // regarding the direction and magnitude of rounding errors:
 // - When considering two crossing offers subject to a variety of limits,
@@ -553,12 +656,9 @@ exchangeV10(Price price, int64_t maxWheatSend, int64_t maxWheatReceive,
             int64_t maxSheepSend, int64_t maxSheepReceive, RoundingType round)
 {
     ZoneScoped;
-    auto beforeThresholds = exchangeV10WithoutPriceErrorThresholds(
-        price, maxWheatSend, maxWheatReceive, maxSheepSend, maxSheepReceive,
-        round);
-    return applyPriceErrorThresholds(price, beforeThresholds.numWheatReceived,
-                                     beforeThresholds.numSheepSend,
-                                     beforeThresholds.wheatStays, round);
+    return exchangeV10Impl<FastArithmetic>(price, maxWheatSend, maxWheatReceive,
+                                           maxSheepSend, maxSheepReceive,
+                                           round);
 }
 
 // See comment before exchangeV10 for proof of some important properties. We
@@ -628,17 +728,18 @@ exchangeV10(Price price, int64_t maxWheatSend, int64_t maxWheatReceive,
 // should have already been removed from the order book because no more can be
 // received. In either case, we have reached a contradiction because we would
 // not be crossing in either case. We conclude that sheepSend > 0.
-ExchangeResultV10
-exchangeV10WithoutPriceErrorThresholds(Price price, int64_t maxWheatSend,
-                                       int64_t maxWheatReceive,
-                                       int64_t maxSheepSend,
-                                       int64_t maxSheepReceive,
-                                       RoundingType round)
+template <typename Arith>
+static ExchangeResultV10
+exchangeV10WithoutPriceErrorThresholdsImpl(Price price, int64_t maxWheatSend,
+                                           int64_t maxWheatReceive,
+                                           int64_t maxSheepSend,
+                                           int64_t maxSheepReceive,
+                                           RoundingType round)
 {
-    uint128_t wheatValue =
-        calculateOfferValue(price.n, price.d, maxWheatSend, maxSheepReceive);
-    uint128_t sheepValue =
-        calculateOfferValue(price.d, price.n, maxSheepSend, maxWheatReceive);
+    auto wheatValue = calculateOfferValue<Arith>(price.n, price.d,
+                                                 maxWheatSend, maxSheepReceive);
+    auto sheepValue = calculateOfferValue<Arith>(price.d, price.n,
+                                                 maxSheepSend, maxWheatReceive);
     bool wheatStays = (wheatValue > sheepValue);
 
     int64_t wheatReceive;
@@ -647,36 +748,36 @@ exchangeV10WithoutPriceErrorThresholds(Price price, int64_t maxWheatSend,
     {
         if (round == RoundingType::PATH_PAYMENT_STRICT_SEND)
         {
-            wheatReceive = bigDivideOrThrow128(sheepValue, price.n, ROUND_DOWN);
+            wheatReceive = Arith::divideOrThrow(sheepValue, price.n, ROUND_DOWN);
             sheepSend = std::min({maxSheepSend, maxSheepReceive});
         }
         else if (price.n > price.d || // Wheat is more valuable
                  round == RoundingType::PATH_PAYMENT_STRICT_RECEIVE)
         {
-            wheatReceive = bigDivideOrThrow128(sheepValue, price.n, ROUND_DOWN);
+            wheatReceive = Arith::divideOrThrow(sheepValue, price.n, ROUND_DOWN);
             sheepSend =
-                bigDivideOrThrow(wheatReceive, price.n, price.d, ROUND_UP);
+                Arith::divideOrThrow(wheatReceive, price.n, price.d, ROUND_UP);
         }
         else // Sheep is more valuable
         {
-            sheepSend = bigDivideOrThrow128(sheepValue, price.d, ROUND_DOWN);
+            sheepSend = Arith::divideOrThrow(sheepValue, price.d, ROUND_DOWN);
             wheatReceive =
-                bigDivideOrThrow(sheepSend, price.d, price.n, ROUND_DOWN);
+                Arith::divideOrThrow(sheepSend, price.d, price.n, ROUND_DOWN);
         }
     }
     else
     {
         if (price.n > price.d) // Wheat is more valuable
         {
-            wheatReceive = bigDivideOrThrow128(wheatValue, price.n, ROUND_DOWN);
+            wheatReceive = Arith::divideOrThrow(wheatValue, price.n, ROUND_DOWN);
             sheepSend =
-                bigDivideOrThrow(wheatReceive, price.n, price.d, ROUND_DOWN);
+                Arith::divideOrThrow(wheatReceive, price.n, price.d, ROUND_DOWN);
         }
         else // Sheep is more valuable
         {
-            sheepSend = bigDivideOrThrow128(wheatValue, price.d, ROUND_DOWN);
+            sheepSend = Arith::divideOrThrow(wheatValue, price.d, ROUND_DOWN);
             wheatReceive =
-                bigDivideOrThrow(sheepSend, price.d, price.n, ROUND_UP);
+                Arith::divideOrThrow(sheepSend, price.d, price.n, ROUND_UP);
         }
     }
 
@@ -698,15 +799,29 @@ exchangeV10WithoutPriceErrorThresholds(Price price, int64_t maxWheatSend,
     return res;
 }
 
-// See comment before exchangeV10.
 ExchangeResultV10
-applyPriceErrorThresholds(Price price, int64_t wheatReceive, int64_t sheepSend,
-                          bool wheatStays, RoundingType round)
+exchangeV10WithoutPriceErrorThresholds(Price price, int64_t maxWheatSend,
+                                       int64_t maxWheatReceive,
+                                       int64_t maxSheepSend,
+                                       int64_t maxSheepReceive,
+                                       RoundingType round)
+{
+    return exchangeV10WithoutPriceErrorThresholdsImpl<FastArithmetic>(
+        price, maxWheatSend, maxWheatReceive, maxSheepSend, maxSheepReceive,
+        round);
+}
+
+// See comment before exchangeV10.
+template <typename Arith>
+static ExchangeResultV10
+applyPriceErrorThresholdsImpl(Price price, int64_t wheatReceive,
+                              int64_t sheepSend, bool wheatStays,
+                              RoundingType round)
 {
     if (wheatReceive > 0 && sheepSend > 0)
     {
-        uint128_t wheatReceiveValue = bigMultiply(wheatReceive, price.n);
-        uint128_t sheepSendValue = bigMultiply(sheepSend, price.d);
+        auto wheatReceiveValue = Arith::multiply(wheatReceive, price.n);
+        auto sheepSendValue = Arith::multiply(sheepSend, price.d);
 
         // ExchangeV10 guarantees that if wheat stays then the wheat seller
         // must be favored. Similarly, if sheep stays then the sheep seller
@@ -724,7 +839,8 @@ applyPriceErrorThresholds(Price price, int64_t wheatReceive, int64_t sheepSend,
         {
             // Both sellers must get a price no more than 1% worse than the
             // price crossed. Otherwise, no trade occurs.
-            if (!checkPriceErrorBound(price, wheatReceive, sheepSend, false))
+            if (!checkPriceErrorBoundImpl<Arith>(price, wheatReceive,
+                                                 sheepSend, false))
             {
                 sheepSend = 0;
                 wheatReceive = 0;
@@ -741,7 +857,8 @@ applyPriceErrorThresholds(Price price, int64_t wheatReceive, int64_t sheepSend,
             // be taken. But the offer was adjusted immediately before
             // exchangeV10, so we know that it satisfies the threshold in this
             // case.
-            if (!checkPriceErrorBound(price, wheatReceive, sheepSend, true))
+            if (!checkPriceErrorBoundImpl<Arith>(price, wheatReceive,
+                                                 sheepSend, true))
             {
                 throw std::runtime_error("exceeded price error bound");
             }
@@ -780,6 +897,48 @@ applyPriceErrorThresholds(Price price, int64_t wheatReceive, int64_t sheepSend,
     return res;
 }
 
+ExchangeResultV10
+applyPriceErrorThresholds(Price price, int64_t wheatReceive, int64_t sheepSend,
+                          bool wheatStays, RoundingType round)
+{
+    return applyPriceErrorThresholdsImpl<FastArithmetic>(
+        price, wheatReceive, sheepSend, wheatStays, round);
+}
+
+template <typename Arith>
+static ExchangeResultV10
+exchangeV10Impl(Price price, int64_t maxWheatSend, int64_t maxWheatReceive,
+                int64_t maxSheepSend, int64_t maxSheepReceive,
+                RoundingType round)
+{
+    auto beforeThresholds = exchangeV10WithoutPriceErrorThresholdsImpl<Arith>(
+        price, maxWheatSend, maxWheatReceive, maxSheepSend, maxSheepReceive,
+        round);
+    return applyPriceErrorThresholdsImpl<Arith>(
+        price, beforeThresholds.numWheatReceived, beforeThresholds.numSheepSend,
+        beforeThresholds.wheatStays, round);
+}
+
+#ifdef BUILD_TESTS
+ExchangeResultV10
+exchangeV10Portable(Price price, int64_t maxWheatSend,
+                    int64_t maxWheatReceive, int64_t maxSheepSend,
+                    int64_t maxSheepReceive, RoundingType round)
+{
+    return exchangeV10Impl<PortableArithmetic>(price, maxWheatSend,
+                                               maxWheatReceive, maxSheepSend,
+                                               maxSheepReceive, round);
+}
+
+bool
+checkPriceErrorBoundPortable(Price price, int64_t wheatReceive,
+                             int64_t sheepSend, bool canFavorWheat)
+{
+    return checkPriceErrorBoundImpl<PortableArithmetic>(
+        price, wheatReceive, sheepSend, canFavorWheat);
+}
+#endif
+
 void
 adjustOffer(LedgerTxnHeader const& header, LedgerTxnEntry& offer,
             LedgerTxnEntry const& account, Asset const& wheat,
@@ -283,6 +283,19 @@ int64_t adjustOffer(Price const& price, int64_t maxWheatSend,
 bool checkPriceErrorBound(Price price, int64_t wheatReceive, int64_t sheepSend,
                           bool canFavorWheat);
 
+#ifdef BUILD_TESTS
+// The functions above use native 128-bit arithmetic where the compiler has
+// it. These run the same code on the portable uint128_t, so tests can check
+// that both agree.
+ExchangeResultV10 exchangeV10Portable(Price price, int64_t maxWheatSend,
+                                      int64_t maxWheatReceive,
+                                      int64_t maxSheepSend,
+                                      int64_t maxSheepReceive,
+                                      RoundingType round);
+bool checkPriceErrorBoundPortable(Price price, int64_t wheatReceive,
+                                  int64_t sheepSend, bool canFavorWheat);
+#endif
+
 bool exchangeWithPool(int64_t reservesToPool, int64_t maxSendToPool,
                       int64_t& toPool, int64_t reservesFromPool,
                       int64_t maxReceiveFromPool, int64_t& fromPool,
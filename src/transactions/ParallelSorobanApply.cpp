@@ -0,0 +1,474 @@
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+// clang-format off
+// This needs to be included first
+#include "util/GlobalChecks.h"
+#include "xdr/Caiz-ledger-entries.h"
+#include <xdrpp/types.h>
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+#include "rust/RustVecXdrMarshal.h"
+#endif
+// clang-format on
+
+#include "transactions/ParallelSorobanApply.h"
+#include "crypto/SHA.h"
+#include "ledger/LedgerManager.h"
+#include "ledger/LedgerTxn.h"
+#include "ledger/LedgerTxnEntry.h"
+#include "ledger/LedgerTypeUtils.h"
+#include "main/Application.h"
+#include "transactions/InvokeHostFunctionOpFrame.h"
+#include "transactions/TransactionUtils.h"
+#include "util/Logging.h"
+#include "util/UnorderedMap.h"
+#include <Tracy.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <numeric>
+
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+#include "rust/XdrBufBatch.h"
+#endif
+
+namespace caiz
+{
+
+Hash
+getSorobanSubSeed(Hash const& sorobanBasePrngSeed, uint64_t txNum)
+{
+    SHA256 subSeedSha;
+    subSeedSha.add(sorobanBasePrngSeed);
+    subSeedSha.add(xdr::xdr_to_opaque(txNum));
+    return subSeedSha.finish();
+}
+
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+
+bool
+SpeculativeHostFnOutput::matches(CxxBufBatch const& ledgerEntries,
+                                 LedgerHeader const& header,
+                                 Hash const& seed) const
+{
+    return seed == mSeed && header.ledgerSeq == mLedgerSeq &&
+           header.ledgerVersion == mLedgerVersion &&
+           header.baseReserve == mBaseReserve &&
+           header.scpValue.closeTime == mCloseTime &&
+           *ledgerEntries.data == mInputData &&
+           std::equal(ledgerEntries.sizes.begin(), ledgerEntries.sizes.end(),
+                      mInputSizes.begin(), mInputSizes.end());
+}
+
+namespace
+{
+struct SpeculativeTx
+{
+    TransactionFrameBasePtr mTx;
+    InvokeHostFunctionOp const* mOp;
+    AccountID mOpSource;
+    Hash mSeed;
+};
+
+// Ledger state as seen by the transactions of one cluster: the entries read
+// from the ledger before apply, overlaid with the writes of the cluster's
+// transactions executed so far. A missing entry is std::nullopt.
+class ClusterState
+{
+    std::map<LedgerKey, std::optional<LedgerEntry>> const& mSnapshot;
+    std::map<LedgerKey, std::optional<LedgerEntry>> mWrites;
+
+  public:
+    explicit ClusterState(
+        std::map<LedgerKey, std::optional<LedgerEntry>> const& snapshot)
+        : mSnapshot(snapshot)
+    {
+    }
+
+    std::optional<LedgerEntry>*
+    find(LedgerKey const& lk)
+    {
+        auto it = mWrites.find(lk);
+        if (it == mWrites.end())
+        {
+            auto snap = mSnapshot.find(lk);
+            releaseAssert(snap != mSnapshot.end());
+            it = mWrites.emplace(lk, snap->second).first;
+        }
+        return &it->second;
+    }
+};
+
+// Executes one transaction of a cluster against state, and makes its writes
+// visible to the next transactions of the cluster.
+std::shared_ptr<SpeculativeHostFnOutput>
+executeSpeculativeTx(Config const& cfg, LedgerHeader const& header,
+                     SorobanNetworkConfig const& sorobanConfig,
+                     SpeculativeTx const& stx, ClusterState& state)
+{
+    auto const& resources = stx.mTx->sorobanResources();
+    auto const& footprint = resources.footprint;
+
+    auto output = std::make_shared<SpeculativeHostFnOutput>();
+    output->mSeed = stx.mSeed;
+    output->mLedgerSeq = header.ledgerSeq;
+    output->mLedgerVersion = header.ledgerVersion;
+    output->mBaseReserve = header.baseReserve;
+    output->mCloseTime = header.scpValue.closeTime;
+    auto ledgerEntries = makeCxxBufBatch();
+    // Same order as InvokeHostFunctionOpFrame::doApply
+    for (auto const* keys : {&footprint.readWrite, &footprint.readOnly})
+    {
+        for (auto const& lk : *keys)
+        {
+            auto const* le = state.find(lk);
+            if (*le)
+            {
+                appendToCxxBufBatch(ledgerEntries, **le);
+            }
+        }
+    }
+
+    try
+    {
+        output->mOutput = InvokeHostFunctionOpFrame::invokeHostFunction(
+            cfg, header, sorobanConfig, *stx.mOp, resources, stx.mOpSource,
+            ledgerEntries, stx.mSeed);
+    }
+    catch (std::exception& e)
+    {
+        // doApply treats this as a failed invocation, just like when
+        // running the host function itself.
+        CLOG_DEBUG(Tx, "Exception caught while invoking host fn: {}",
+                   e.what());
+        output->mOutput = InvokeHostFunctionOutput{};
+    }
+    output->mInputData = std::move(*ledgerEntries.data);
+    output->mInputSizes.assign(ledgerEntries.sizes.begin(),
+                               ledgerEntries.sizes.end());
+
+    // This mirrors how doApply writes back a successful invocation; if it
+    // doesn't (e.g. a resource limit is exceeded), the next transactions'
+    // inputs won't match and they will run again during apply.
+    auto const& out = output->mOutput;
+    if (out.success)
+    {
+        UnorderedSet<LedgerKey> written;
+        RustBufBatchReader modifiedEntries(out.modified_ledger_entries);
+        LedgerEntry modified;
+        while (modifiedEntries.next(modified))
+        {
+            auto lk = LedgerEntryKey(modified);
+            *state.find(lk) = modified;
+            written.emplace(lk);
+        }
+        for (auto const& bump : out.expiration_bumps)
+        {
+            LedgerKey lk;
+            xdr::xdr_from_opaque(bump.ledger_key.data, lk);
+            if (!isSorobanEntry(lk))
+            {
+                continue;
+            }
+            auto* le = state.find(lk);
+            if (*le && getExpirationLedger(**le) <= bump.min_expiration)
+            {
+                setExpirationLedger(**le, bump.min_expiration);
+            }
+        }
+        for (auto const& lk : footprint.readWrite)
+        {
+            if (written.find(lk) == written.end())
+            {
+                *state.find(lk) = std::nullopt;
+            }
+        }
+    }
+    return output;
+}
+
+void
+executeCluster(Config const& cfg, LedgerHeader const& header,
+               SorobanNetworkConfig const& sorobanConfig,
+               std::vector<SpeculativeTx> const& cluster,
+               std::map<LedgerKey, std::optional<LedgerEntry>> const& snapshot)
+{
+    ZoneScoped;
+    ClusterState state(snapshot);
+    for (auto const& stx : cluster)
+    {
+        std::shared_ptr<SpeculativeHostFnOutput> output;
+        try
+        {
+            output =
+                executeSpeculativeTx(cfg, header, sorobanConfig, stx, state);
+        }
+        catch (std::exception& e)
+        {
+            // Speculation is only an optimization: the state seen by the
+            // rest of the cluster is unknown now, so they run during apply.
+            CLOG_DEBUG(Tx,
+                       "Exception caught while executing ahead of apply: {}",
+                       e.what());
+            return;
+        }
+        stx.mTx->setSpeculativeHostFnOutput(std::move(output));
+    }
+}
+
+// Clusters of one ledger, shared by the calling thread and the pool tasks
+// helping it. Clusters are handed out through mNextCluster; once the calling
+// thread has run out of clusters, it closes the batch so that tasks starting
+// later return without touching it, and waits for the running ones.
+class SpeculativeBatch
+{
+    Config const& mConfig;
+    LedgerHeader const mHeader;
+    SorobanNetworkConfig const& mSorobanConfig;
+    std::vector<std::vector<SpeculativeTx>> const mClusters;
+    std::map<LedgerKey, std::optional<LedgerEntry>> const mSnapshot;
+    std::atomic<size_t> mNextCluster{0};
+
+    std::mutex mMutex;
+    std::condition_variable mWorkersDone;
+    bool mClosed{false};
+    size_t mRunningWorkers{0};
+    std::exception_ptr mError;
+
+    void
+    runClusters()
+    {
+        for (size_t i = mNextCluster++; i < mClusters.size();
+             i = mNextCluster++)
+        {
+            executeCluster(mConfig, mHeader, mSorobanConfig, mClusters[i],
+                           mSnapshot);
+        }
+    }
+
+  public:
+    SpeculativeBatch(Config const& cfg, LedgerHeader const& header,
+                     SorobanNetworkConfig const& sorobanConfig,
+                     std::vector<std::vector<SpeculativeTx>>&& clusters,
+                     std::map<LedgerKey, std::optional<LedgerEntry>>&& snapshot)
+        : mConfig(cfg)
+        , mHeader(header)
+        , mSorobanConfig(sorobanConfig)
+        , mClusters(std::move(clusters))
+        , mSnapshot(std::move(snapshot))
+    {
+    }
+
+    size_t
+    numClusters() const
+    {
+        return mClusters.size();
+    }
+
+    void
+    runOnWorker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mClosed)
+            {
+                return;
+            }
+            ++mRunningWorkers;
+        }
+        std::exception_ptr error;
+        try
+        {
+            runClusters();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (error && !mError)
+        {
+            mError = error;
+        }
+        if (--mRunningWorkers == 0)
+        {
+            mWorkersDone.notify_one();
+        }
+    }
+
+    // Runs clusters until there are none left, then waits for the workers
+    // still executing theirs and rethrows the first failure.
+    void
+    runOnCaller()
+    {
+        std::exception_ptr error;
+        try
+        {
+            runClusters();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        std::unique_lock<std::mutex> lock(mMutex);
+        mClosed = true;
+        mWorkersDone.wait(lock, [this] { return mRunningWorkers == 0; });
+        if (!error)
+        {
+            error = mError;
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+size_t
+findRoot(std::vector<size_t>& parent, size_t i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+}
+
+void
+speculativelyExecuteHostFunctions(
+    Application& app, AbstractLedgerTxn& ltx,
+    std::vector<TransactionFrameBasePtr> const& txs,
+    Hash const& sorobanBasePrngSeed, size_t threads)
+{
+    ZoneScoped;
+
+    std::vector<SpeculativeTx> sorobanTxs;
+    for (size_t txNum = 0; txNum < txs.size(); ++txNum)
+    {
+        auto const& tx = txs[txNum];
+        if (!tx->isSoroban())
+        {
+            continue;
+        }
+        auto const& ops = tx->getRawOperations();
+        if (ops.size() != 1 || ops[0].body.type() != INVOKE_HOST_FUNCTION)
+        {
+            continue;
+        }
+        auto const& op = ops[0];
+        sorobanTxs.emplace_back(SpeculativeTx{
+            tx, &op.body.invokeHostFunctionOp(),
+            op.sourceAccount ? toAccountID(*op.sourceAccount)
+                             : tx->getSourceID(),
+            getSorobanSubSeed(sorobanBasePrngSeed, txNum)});
+    }
+    if (sorobanTxs.size() < 2)
+    {
+        // Nothing to overlap with.
+        return;
+    }
+
+    // Partition into clusters of conflicting transactions. Source accounts
+    // count as written since fees and sequence numbers are charged to them.
+    std::vector<size_t> parent(sorobanTxs.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    UnorderedMap<LedgerKey, std::pair<std::vector<size_t>, bool>> accesses;
+    auto addAccess = [&](LedgerKey const& lk, size_t i, bool write) {
+        auto& access = accesses[lk];
+        access.first.emplace_back(i);
+        access.second = access.second || write;
+    };
+    std::map<LedgerKey, std::optional<LedgerEntry>> snapshot;
+    for (size_t i = 0; i < sorobanTxs.size(); ++i)
+    {
+        auto const& stx = sorobanTxs[i];
+        auto const& footprint = stx.mTx->sorobanResources().footprint;
+        for (auto const& lk : footprint.readWrite)
+        {
+            addAccess(lk, i, true);
+            snapshot.emplace(lk, std::nullopt);
+        }
+        for (auto const& lk : footprint.readOnly)
+        {
+            addAccess(lk, i, false);
+            snapshot.emplace(lk, std::nullopt);
+        }
+        addAccess(accountKey(stx.mTx->getSourceID()), i, true);
+        addAccess(accountKey(stx.mTx->getFeeSourceID()), i, true);
+        addAccess(accountKey(stx.mOpSource), i, true);
+    }
+    for (auto const& kv : accesses)
+    {
+        auto const& [txIndices, written] = kv.second;
+        if (!written)
+        {
+            continue;
+        }
+        for (size_t j = 1; j < txIndices.size(); ++j)
+        {
+            parent[findRoot(parent, txIndices[j])] =
+                findRoot(parent, txIndices[0]);
+        }
+    }
+
+    std::map<size_t, std::vector<SpeculativeTx>> clustersByRoot;
+    for (size_t i = 0; i < sorobanTxs.size(); ++i)
+    {
+        clustersByRoot[findRoot(parent, i)].emplace_back(sorobanTxs[i]);
+    }
+    std::vector<std::vector<SpeculativeTx>> clusters;
+    clusters.reserve(clustersByRoot.size());
+    for (auto& kv : clustersByRoot)
+    {
+        clusters.emplace_back(std::move(kv.second));
+    }
+    // Start with the longest clusters to balance the threads.
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](auto const& a, auto const& b) {
+                         return a.size() > b.size();
+                     });
+
+    // Read all inputs on the main thread.
+    for (auto& [lk, le] : snapshot)
+    {
+        auto ltxe = ltx.loadWithoutRecord(lk, /*loadExpiredEntry=*/false);
+        if (ltxe)
+        {
+            le = ltxe.current();
+        }
+    }
+
+    auto const& cfg = app.getConfig();
+    auto const header = ltx.loadHeader().current();
+    auto const& sorobanConfig =
+        app.getLedgerManager().getSorobanNetworkConfig(ltx);
+
+    app.getMetrics()
+        .NewHistogram({"soroban", "parallel-apply", "clusters"})
+        .Update(clusters.size());
+
+    // The calling thread takes a share of the clusters and the rest go to
+    // the worker pool. Worker threads live across ledgers, so their
+    // thread-local caches (e.g. of parsed contract code) stay warm.
+    //
+    // A pool task may only start after this function has returned (e.g. when
+    // the pool is busy with other work), so tasks own the shared state and
+    // the calling thread only waits for the tasks that actually joined in.
+    auto batch = std::make_shared<SpeculativeBatch>(
+        cfg, header, sorobanConfig, std::move(clusters), std::move(snapshot));
+    threads = std::min(threads, batch->numClusters());
+    for (size_t i = 1; i < threads; ++i)
+    {
+        app.postOnBackgroundThread([batch]() { batch->runOnWorker(); },
+                                   "speculativelyExecuteHostFunctions",
+                                   WorkerPool::Priority::LATENCY_SENSITIVE);
+    }
+    batch->runOnCaller();
+}
+#endif
+}
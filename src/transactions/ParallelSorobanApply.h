@@ -0,0 +1,75 @@
+#pragma once
+
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "transactions/TransactionFrameBase.h"
+#include "xdr/Caiz-ledger.h"
+#include "xdr/Caiz-types.h"
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+#include "rust/RustBridge.h"
+#endif
+#include <vector>
+
+namespace caiz
+{
+
+class AbstractLedgerTxn;
+class Application;
+
+// Returns the PRNG seed of the transaction at position `txNum` in apply order,
+// derived from the seed of the whole transaction set.
+Hash getSorobanSubSeed(Hash const& sorobanBasePrngSeed, uint64_t txNum);
+
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+
+// Output of a host function executed ahead of apply, together with the
+// encoded footprint entries, ledger header fields and PRNG seed it ran
+// against.
+struct SpeculativeHostFnOutput
+{
+    std::vector<uint8_t> mInputData;
+    std::vector<uint32_t> mInputSizes;
+    // The header fields passed to the host
+    uint32_t mLedgerSeq{0};
+    uint32_t mLedgerVersion{0};
+    uint32_t mBaseReserve{0};
+    TimePoint mCloseTime{0};
+    Hash mSeed;
+    InvokeHostFunctionOutput mOutput{};
+
+    // Returns true if `ledgerEntries`, `header` and `seed` are exactly the
+    // inputs this output was computed from.
+    bool matches(CxxBufBatch const& ledgerEntries, LedgerHeader const& header,
+                 Hash const& seed) const;
+};
+
+// ParallelSorobanApply runs the host functions of the Soroban transactions of
+// a ledger on up to `threads` threads (the calling thread and tasks on the
+// app's worker pool) before the transactions are applied, so that apply
+// itself only has to write back their effects.
+//
+// Transactions are partitioned into clusters: two transactions share a
+// cluster if one of them writes a key (a read-write footprint entry or a
+// source account) that the other one reads or writes. Clusters are executed
+// in parallel; transactions within a cluster run in apply order, each one
+// seeing the entries written by the previous ones. All inputs are read from
+// `ltx` up front, and no LedgerTxn is touched off the main thread.
+//
+// Apply is unchanged and still runs in canonical order on the main thread.
+// InvokeHostFunctionOpFrame::doApply only reuses a precomputed output if the
+// footprint entries it loads are byte-identical to the ones the output was
+// computed from, under the same ledger header fields and seed, and otherwise
+// runs the host function again. TransactionFrame::apply drops an output that
+// was not used. Since host
+// functions are deterministic in their inputs, results, meta and hashes are
+// identical to a serial apply whatever the speculation got wrong (e.g. a
+// transaction that fails validation, or classic transactions touching
+// footprint entries).
+void speculativelyExecuteHostFunctions(
+    Application& app, AbstractLedgerTxn& ltx,
+    std::vector<TransactionFrameBasePtr> const& txs,
+    Hash const& sorobanBasePrngSeed, size_t threads);
+#endif
+}
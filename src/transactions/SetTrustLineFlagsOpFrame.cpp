@@ -172,7 +172,7 @@ SetTrustLineFlagsOpFrame::isAuthRevocationValid(AbstractLedgerTxn& ltx,
     auto header = ltxSource.loadHeader();
     auto sourceAccountEntry = loadSourceAccount(ltxSource, header);
 
-    if ((sourceAccountEntry.current().data.account().flags &
+    if ((sourceAccountEntry.currentConst().data.account().flags &
          AUTH_REVOCABLE_FLAG) != 0)
     {
         return true;
@@ -18,6 +18,7 @@
 #include "ledger/LedgerTxn.h"
 #include "ledger/LedgerTxnEntry.h"
 #include "ledger/LedgerTxnHeader.h"
+#include "lib/util/finally.h"
 #include "main/Application.h"
 #include "transactions/SignatureChecker.h"
 #include "transactions/SignatureUtils.h"
@@ -746,6 +747,19 @@ TransactionFrame::consumeRefundableSorobanResource(uint32_t metadataSizeBytes)
     mConsumedSorobanMetadataSize += metadataSizeBytes;
 }
 
+void
+TransactionFrame::setSpeculativeHostFnOutput(
+    std::shared_ptr<SpeculativeHostFnOutput> output)
+{
+    mSpeculativeHostFnOutput = std::move(output);
+}
+
+std::shared_ptr<SpeculativeHostFnOutput>
+TransactionFrame::takeSpeculativeHostFnOutput()
+{
+    return std::move(mSpeculativeHostFnOutput);
+}
+
 #endif
 
 bool
@@ -1138,7 +1152,7 @@ TransactionFrame::commonValid(Application& app,
     {
         if (current == 0)
         {
-            current = sourceAccount.current().data.account().seqNum;
+            current = sourceAccount.currentConst().data.account().seqNum;
         }
         if (isBadSeq(header, current))
         {
@@ -1155,9 +1169,10 @@ TransactionFrame::commonValid(Application& app,
         return res;
     }
 
-    if (!checkSignature(
-            signatureChecker, sourceAccount,
-            sourceAccount.current().data.account().thresholds[THRESHOLD_LOW]))
+    if (!checkSignature(signatureChecker, sourceAccount,
+                        sourceAccount.currentConst()
+                            .data.account()
+                            .thresholds[THRESHOLD_LOW]))
     {
         getResult().result.code(txBAD_AUTH);
         return res;
@@ -1380,7 +1395,8 @@ bool
 TransactionFrame::apply(Application& app, AbstractLedgerTxn& ltx,
                         Hash const& sorobanBasePrngSeed)
 {
-    TransactionMetaFrame tm(ltx.loadHeader().current().ledgerVersion);
+    TransactionMetaFrame tm(ltx.loadHeader().current().ledgerVersion,
+                            /*enabled=*/false);
     return apply(app, ltx, tm, sorobanBasePrngSeed);
 }
 
@@ -1399,7 +1415,10 @@ TransactionFrame::applyOperations(SignatureChecker& signatureChecker,
         bool success = true;
 
         xdr::xvector<OperationMeta> operationMetas;
-        operationMetas.reserve(getNumOperations());
+        if (outerMeta.isEnabled())
+        {
+            operationMetas.reserve(getNumOperations());
+        }
 
         // shield outer scope of any side effects with LedgerTxn
         LedgerTxn ltxTx(ltx);
@@ -1439,12 +1458,16 @@ TransactionFrame::applyOperations(SignatureChecker& signatureChecker,
             if (success)
             {
                 app.getInvariantManager().checkOnOperationApply(
-                    op->getOperation(), op->getResult(), ltxOp.getDelta());
+                    op->getOperation(), op->getResult(), ltxOp.getDelta(),
+                    getContentsHash(), opNum - 1);
 
                 // The operation meta will be empty if the transaction
                 // doesn't succeed so we may as well not do any work in that
                 // case
-                operationMetas.emplace_back(ltxOp.getChanges());
+                if (outerMeta.isEnabled())
+                {
+                    operationMetas.emplace_back(ltxOp.getChanges());
+                }
             }
 
             if (txRes ||
@@ -1474,7 +1497,10 @@ TransactionFrame::applyOperations(SignatureChecker& signatureChecker,
                 // owner to remove that signer
                 LedgerTxn ltxAfter(ltxTx);
                 removeOneTimeSignerFromAllSourceAccounts(ltxAfter);
-                changesAfter = ltxAfter.getChanges();
+                if (outerMeta.isEnabled())
+                {
+                    changesAfter = ltxAfter.getChanges();
+                }
                 ltxAfter.commit();
             }
             else if (protocolVersionStartsFrom(ledgerVersion,
@@ -1759,6 +1785,12 @@ TransactionFrame::apply(Application& app, AbstractLedgerTxn& ltx,
                         Hash const& sorobanBasePrngSeed)
 {
     ZoneScoped;
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+    // An output computed ahead of apply is only taken if the host function
+    // runs, so drop it however apply ends
+    auto dropSpeculativeOutput =
+        gsl::finally([&]() { mSpeculativeHostFnOutput.reset(); });
+#endif
     try
     {
         mCachedAccount.reset();
@@ -1779,7 +1811,10 @@ TransactionFrame::apply(Application& app, AbstractLedgerTxn& ltx,
 
         bool signaturesValid = processSignatures(cv, signatureChecker, ltxTx);
 
-        meta.pushTxChangesBefore(ltxTx.getChanges());
+        if (meta.isEnabled())
+        {
+            meta.pushTxChangesBefore(ltxTx.getChanges());
+        }
         ltxTx.commit();
 
         bool ok = signaturesValid && cv == ValidationType::kMaybeValid;
@@ -1842,7 +1877,10 @@ TransactionFrame::processPostApply(Application& app,
     refundSorobanFee(ltx.loadHeader().current().ledgerVersion,
                      app.getLedgerManager().getSorobanNetworkConfig(ltx),
                      app.getConfig(), ltx);
-    meta.pushTxChangesAfter(ltx.getChanges());
+    if (meta.isEnabled())
+    {
+        meta.pushTxChangesAfter(ltx.getChanges());
+    }
     ltx.commit();
 #endif
 }
@@ -60,6 +60,7 @@ class TransactionFrame : public TransactionFrameBase
     // Size of the emitted Soroban metadata.
     uint32_t mConsumedSorobanMetadataSize{};
     UnorderedMap<LedgerKey, uint32_t> mOriginalExpirations;
+    std::shared_ptr<SpeculativeHostFnOutput> mSpeculativeHostFnOutput;
 #endif
 
     std::shared_ptr<InternalLedgerEntry const> mCachedAccount;
@@ -286,6 +287,11 @@ class TransactionFrame : public TransactionFrameBase
                                    SorobanNetworkConfig const& sorobanConfig,
                                    Config const& cfg) override;
     void consumeRefundableSorobanResource(uint32_t metadataSizeBytes);
+    void setSpeculativeHostFnOutput(
+        std::shared_ptr<SpeculativeHostFnOutput> output) override;
+    // Returns and clears the output set by setSpeculativeHostFnOutput, if
+    // any.
+    std::shared_ptr<SpeculativeHostFnOutput> takeSpeculativeHostFnOutput();
 #endif
 };
 }
@@ -22,6 +22,9 @@ class AbstractLedgerTxn;
 class Application;
 class Database;
 class OperationFrame;
+#ifdef ENABLE_NEXT_PROTOCOL_VERSION_UNSAFE_FOR_PRODUCTION
+struct SpeculativeHostFnOutput;
+#endif
 
 class TransactionFrameBase;
 using TransactionFrameBasePtr = std::shared_ptr<TransactionFrameBase>;
@@ -95,6 +98,10 @@ class TransactionFrameBase
     maybeComputeSorobanResourceFee(uint32_t protocolVersion,
                                    SorobanNetworkConfig const& sorobanConfig,
                                    Config const& cfg) = 0;
+    // Hands the output of an ahead-of-apply host function execution to the
+    // next apply of this transaction (see ParallelSorobanApply).
+    virtual void setSpeculativeHostFnOutput(
+        std::shared_ptr<SpeculativeHostFnOutput> output) = 0;
 #endif
 };
 }
@@ -13,7 +13,9 @@
 
 namespace caiz
 {
-TransactionMetaFrame::TransactionMetaFrame(uint32_t protocolVersion)
+TransactionMetaFrame::TransactionMetaFrame(uint32_t protocolVersion,
+                                           bool enabled)
+    : mEnabled(enabled)
 {
     // The TransactionMeta v() switch can be in 4 positions 0, 1, 2, 3. We
     // do not support 0 or 1 at all -- core does not produce it anymore and we
@@ -29,6 +31,12 @@ TransactionMetaFrame::TransactionMetaFrame(uint32_t protocolVersion)
     mTransactionMeta.v(mVersion);
 }
 
+bool
+TransactionMetaFrame::isEnabled() const
+{
+    return mEnabled;
+}
+
 template <typename T>
 void
 vecAppend(xdr::xvector<T>& a, xdr::xvector<T>&& b)
@@ -11,10 +11,16 @@ namespace caiz
 
 // Wrapper around TransactionMeta XDR that provides mutable access to fields
 // in the proper version of meta.
+//
+// A TransactionMetaFrame that is not enabled is never read, so whoever applies
+// the transaction checks isEnabled() and skips building the ledger entry
+// changes that would otherwise be pushed into it.
 class TransactionMetaFrame
 {
   public:
-    TransactionMetaFrame(uint32_t protocolVersion);
+    TransactionMetaFrame(uint32_t protocolVersion, bool enabled = true);
+
+    bool isEnabled() const;
 
     void pushTxChangesBefore(LedgerEntryChanges&& changes);
     size_t getNumChangesBefore() const;
@@ -37,6 +43,7 @@ class TransactionMetaFrame
   private:
     TransactionMeta mTransactionMeta;
     int mVersion;
+    bool mEnabled;
 };
 
 }
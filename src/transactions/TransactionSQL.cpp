@@ -4,6 +4,7 @@
 
 #include "transactions/TransactionSQL.h"
 #include "crypto/Hex.h"
+#include "database/BulkUpsert.h"
 #include "database/Database.h"
 #include "database/DatabaseUtils.h"
 #include "herder/TxSetFrame.h"
@@ -347,42 +348,100 @@ writeTxSetToStream(
 
 } // namespace
 
+TransactionHistoryBatch::TransactionHistoryBatch(uint32_t ledgerSeq,
+                                                 size_t expectedTxs)
+    : mLedgerSeq(ledgerSeq)
+{
+    mTxRows.reserve(expectedTxs);
+    mTxBodies.reserve(expectedTxs);
+    mTxResults.reserve(expectedTxs);
+    mTxMetas.reserve(expectedTxs);
+    mFeeRows.reserve(expectedTxs);
+    mFeeChanges.reserve(expectedTxs);
+}
+
 void
-storeTransaction(Database& db, uint32_t ledgerSeq,
-                 TransactionFrameBasePtr const& tx, TransactionMeta const& tm,
-                 TransactionResultSet const& resultSet)
+TransactionHistoryBatch::Rows::reserve(size_t n)
 {
-    ZoneScoped;
-    std::string txBody =
-        decoder::encode_b64(xdr::xdr_to_opaque(tx->getEnvelope()));
-    std::string txResult =
-        decoder::encode_b64(xdr::xdr_to_opaque(resultSet.results.back()));
-    std::string meta = decoder::encode_b64(xdr::xdr_to_opaque(tm));
+    mTxIDs.reserve(n);
+    mLedgerSeqs.reserve(n);
+    mTxIndexes.reserve(n);
+}
 
-    std::string txIDString = binToHex(tx->getContentsHash());
-    uint32_t txIndex = static_cast<uint32_t>(resultSet.results.size());
+void
+TransactionHistoryBatch::Rows::add(TransactionFrameBasePtr const& tx,
+                                   uint32_t ledgerSeq, uint32_t txIndex)
+{
+    mTxIDs.emplace_back(binToHex(tx->getContentsHash()));
+    mLedgerSeqs.emplace_back(ledgerSeq);
+    mTxIndexes.emplace_back(txIndex);
+}
 
-    auto prep = db.getPreparedStatement(
-        "INSERT INTO txhistory "
-        "( txid, ledgerseq, txindex,  txbody, txresult, txmeta) VALUES "
-        "(:id,  :seq,      :txindex, :txb,   :txres,   :meta)");
+void
+TransactionHistoryBatch::Rows::clear()
+{
+    mTxIDs.clear();
+    mLedgerSeqs.clear();
+    mTxIndexes.clear();
+}
 
-    auto& st = prep.statement();
-    st.exchange(soci::use(txIDString));
-    st.exchange(soci::use(ledgerSeq));
-    st.exchange(soci::use(txIndex));
-    st.exchange(soci::use(txBody));
-    st.exchange(soci::use(txResult));
-    st.exchange(soci::use(meta));
-    st.define_and_bind();
+void
+TransactionHistoryBatch::storeTransaction(TransactionFrameBasePtr const& tx,
+                                          TransactionMeta const& tm,
+                                          TransactionResultSet const& resultSet)
+{
+    ZoneScoped;
+    mTxRows.add(tx, mLedgerSeq,
+                static_cast<uint32_t>(resultSet.results.size()));
+    mTxBodies.emplace_back(
+        decoder::encode_b64(xdr::xdr_to_opaque(tx->getEnvelope())));
+    mTxResults.emplace_back(
+        decoder::encode_b64(xdr::xdr_to_opaque(resultSet.results.back())));
+    mTxMetas.emplace_back(decoder::encode_b64(xdr::xdr_to_opaque(tm)));
+}
+
+void
+TransactionHistoryBatch::storeTransactionFee(TransactionFrameBasePtr const& tx,
+                                             LedgerEntryChanges const& changes,
+                                             uint32_t txIndex)
+{
+    ZoneScoped;
+    mFeeRows.add(tx, mLedgerSeq, txIndex);
+    mFeeChanges.emplace_back(decoder::encode_b64(xdr::xdr_to_opaque(changes)));
+}
+
+void
+TransactionHistoryBatch::flush(Database& db)
+{
+    ZoneScoped;
+    if (!mTxRows.mTxIDs.empty())
     {
-        auto timer = db.getInsertTimer("txhistory");
-        st.execute(true);
+        BulkUpsert insert(db, "txhistory", "txhistory", {});
+        insert.addColumn("txid", mTxRows.mTxIDs);
+        insert.addColumn("ledgerseq", mTxRows.mLedgerSeqs);
+        insert.addColumn("txindex", mTxRows.mTxIndexes);
+        insert.addColumn("txbody", mTxBodies);
+        insert.addColumn("txresult", mTxResults);
+        insert.addColumn("txmeta", mTxMetas);
+        insert.execute();
+
+        mTxRows.clear();
+        mTxBodies.clear();
+        mTxResults.clear();
+        mTxMetas.clear();
     }
 
-    if (st.get_affected_rows() != 1)
+    if (!mFeeRows.mTxIDs.empty())
     {
-        throw std::runtime_error("Could not update data in SQL");
+        BulkUpsert insert(db, "txfeehistory", "txfeehistory", {});
+        insert.addColumn("txid", mFeeRows.mTxIDs);
+        insert.addColumn("ledgerseq", mFeeRows.mLedgerSeqs);
+        insert.addColumn("txindex", mFeeRows.mTxIndexes);
+        insert.addColumn("txchanges", mFeeChanges);
+        insert.execute();
+
+        mFeeRows.clear();
+        mFeeChanges.clear();
     }
 }
 
@@ -419,38 +478,6 @@ storeTxSet(Database& db, uint32_t ledgerSeq, TxSetFrame const& txSet)
     }
 }
 
-void
-storeTransactionFee(Database& db, uint32_t ledgerSeq,
-                    TransactionFrameBasePtr const& tx,
-                    LedgerEntryChanges const& changes, uint32_t txIndex)
-{
-    ZoneScoped;
-    std::string txChanges = decoder::encode_b64(xdr::xdr_to_opaque(changes));
-
-    std::string txIDString = binToHex(tx->getContentsHash());
-
-    auto prep = db.getPreparedStatement(
-        "INSERT INTO txfeehistory "
-        "( txid, ledgerseq, txindex,  txchanges) VALUES "
-        "(:id,  :seq,      :txindex, :txchanges)");
-
-    auto& st = prep.statement();
-    st.exchange(soci::use(txIDString));
-    st.exchange(soci::use(ledgerSeq));
-    st.exchange(soci::use(txIndex));
-    st.exchange(soci::use(txChanges));
-    st.define_and_bind();
-    {
-        auto timer = db.getInsertTimer("txfeehistory");
-        st.execute(true);
-    }
-
-    if (st.get_affected_rows() != 1)
-    {
-        throw std::runtime_error("Could not update data in SQL");
-    }
-}
-
 TransactionResultSet
 getTransactionHistoryResults(Database& db, uint32 ledgerSeq)
 {
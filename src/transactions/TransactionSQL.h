@@ -14,16 +14,50 @@ namespace caiz
 class Application;
 class XDROutputFileStream;
 
-void storeTransaction(Database& db, uint32_t ledgerSeq,
-                      TransactionFrameBasePtr const& tx,
-                      TransactionMeta const& tm,
-                      TransactionResultSet const& resultSet);
+// TransactionHistoryBatch collects the txhistory and txfeehistory rows of one
+// ledger as its transactions are applied, and writes them with one bulk
+// insert per table when flushed.
+class TransactionHistoryBatch
+{
+  public:
+    TransactionHistoryBatch(uint32_t ledgerSeq, size_t expectedTxs);
 
-void storeTxSet(Database& db, uint32_t ledgerSeq, TxSetFrame const& txSet);
+    void storeTransaction(TransactionFrameBasePtr const& tx,
+                          TransactionMeta const& tm,
+                          TransactionResultSet const& resultSet);
+
+    void storeTransactionFee(TransactionFrameBasePtr const& tx,
+                             LedgerEntryChanges const& changes,
+                             uint32_t txIndex);
+
+    // Writes the rows stored so far and clears the batch
+    void flush(Database& db);
+
+  private:
+    struct Rows
+    {
+        std::vector<std::string> mTxIDs;
+        std::vector<int64_t> mLedgerSeqs;
+        std::vector<int64_t> mTxIndexes;
 
-void storeTransactionFee(Database& db, uint32_t ledgerSeq,
-                         TransactionFrameBasePtr const& tx,
-                         LedgerEntryChanges const& changes, uint32_t txIndex);
+        void reserve(size_t n);
+        void add(TransactionFrameBasePtr const& tx, uint32_t ledgerSeq,
+                 uint32_t txIndex);
+        void clear();
+    };
+
+    uint32_t const mLedgerSeq;
+
+    Rows mTxRows;
+    std::vector<std::string> mTxBodies;
+    std::vector<std::string> mTxResults;
+    std::vector<std::string> mTxMetas;
+
+    Rows mFeeRows;
+    std::vector<std::string> mFeeChanges;
+};
+
+void storeTxSet(Database& db, uint32_t ledgerSeq, TxSetFrame const& txSet);
 
 TransactionResultSet getTransactionHistoryResults(Database& db,
                                                   uint32 ledgerSeq);
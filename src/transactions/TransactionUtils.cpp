@@ -1519,7 +1519,7 @@ removeOffersAndPoolShareTrustLines(AbstractLedgerTxn& ltx,
         // use a lambda so we don't hold a reference to the internals of
         // TrustLineEntry
         auto poolTL = [&]() -> TrustLineEntry const& {
-            return poolShareTrustLine.current().data.trustLine();
+            return poolShareTrustLine.currentConst().data.trustLine();
         };
 
         auto poolID = poolTL().asset.liquidityPoolID();
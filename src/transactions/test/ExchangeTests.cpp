@@ -6,7 +6,12 @@
 #include "lib/catch.hpp"
 #include "transactions/OfferExchange.h"
 #include "transactions/TransactionUtils.h"
+#include "util/Logging.h"
+#include "util/Math.h"
 #include "util/numeric128.h"
+#include <chrono>
+#include <fmt/chrono.h>
+#include <tuple>
 
 using namespace caiz;
 
@@ -1119,3 +1124,145 @@ TEST_CASE("Exchange with liquidity pools", "[exchange]")
         }
     }
 }
+
+namespace
+{
+int64_t
+randomExchangeAmount()
+{
+    switch (rand_uniform(0, 3))
+    {
+    case 0:
+        return rand_uniform<int64_t>(0, 100);
+    case 1:
+        return rand_uniform<int64_t>(0, 1'000'000'000);
+    case 2:
+        return rand_uniform<int64_t>(INT64_MAX - 2, INT64_MAX);
+    default:
+        return rand_uniform<int64_t>(0, INT64_MAX);
+    }
+}
+
+int32_t
+randomPriceComponent()
+{
+    switch (rand_uniform(0, 3))
+    {
+    case 0:
+        return rand_uniform<int32_t>(0, 10);
+    case 1:
+        return rand_uniform<int32_t>(INT32_MAX - 2, INT32_MAX);
+    default:
+        return rand_uniform<int32_t>(1, INT32_MAX);
+    }
+}
+
+// Runs f, returning 0 if it succeeds, 1 if it throws std::overflow_error and 2
+// if it throws any other std::runtime_error
+template <typename F>
+int
+outcome(F f)
+{
+    try
+    {
+        f();
+        return 0;
+    }
+    catch (std::overflow_error&)
+    {
+        return 1;
+    }
+    catch (std::runtime_error&)
+    {
+        return 2;
+    }
+}
+}
+
+TEST_CASE("ExchangeV10 native arithmetic matches portable arithmetic",
+          "[exchange]")
+{
+    auto const rounding = {RoundingType::NORMAL,
+                           RoundingType::PATH_PAYMENT_STRICT_SEND,
+                           RoundingType::PATH_PAYMENT_STRICT_RECEIVE};
+    for (size_t i = 0; i < 100'000; ++i)
+    {
+        Price price{randomPriceComponent(), randomPriceComponent()};
+        auto maxWheatSend = randomExchangeAmount();
+        auto maxWheatReceive = randomExchangeAmount();
+        auto maxSheepSend = randomExchangeAmount();
+        auto maxSheepReceive = randomExchangeAmount();
+        for (auto round : rounding)
+        {
+            ExchangeResultV10 native{};
+            ExchangeResultV10 portable{};
+            auto nativeOutcome = outcome([&]() {
+                native = exchangeV10(price, maxWheatSend, maxWheatReceive,
+                                     maxSheepSend, maxSheepReceive, round);
+            });
+            auto portableOutcome = outcome([&]() {
+                portable = exchangeV10Portable(price, maxWheatSend,
+                                               maxWheatReceive, maxSheepSend,
+                                               maxSheepReceive, round);
+            });
+            REQUIRE(nativeOutcome == portableOutcome);
+            REQUIRE(native.numWheatReceived == portable.numWheatReceived);
+            REQUIRE(native.numSheepSend == portable.numSheepSend);
+            REQUIRE(native.wheatStays == portable.wheatStays);
+        }
+
+        auto wheatReceive = randomExchangeAmount();
+        auto sheepSend = randomExchangeAmount();
+        for (bool canFavorWheat : {false, true})
+        {
+            bool native = false;
+            bool portable = false;
+            auto nativeOutcome = outcome([&]() {
+                native = checkPriceErrorBound(price, wheatReceive, sheepSend,
+                                              canFavorWheat);
+            });
+            auto portableOutcome = outcome([&]() {
+                portable = checkPriceErrorBoundPortable(
+                    price, wheatReceive, sheepSend, canFavorWheat);
+            });
+            REQUIRE(nativeOutcome == portableOutcome);
+            REQUIRE(native == portable);
+        }
+    }
+}
+
+TEST_CASE("ExchangeV10 arithmetic benchmark", "[exchange][bench][!hide]")
+{
+    size_t const iterations = 1'000'000;
+    std::vector<std::tuple<Price, int64_t, int64_t>> crossings;
+    crossings.reserve(iterations);
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        crossings.emplace_back(Price{rand_uniform<int32_t>(1, INT32_MAX),
+                                     rand_uniform<int32_t>(1, INT32_MAX)},
+                               rand_uniform<int64_t>(1, INT64_MAX / 2),
+                               rand_uniform<int64_t>(1, INT64_MAX / 2));
+    }
+
+    auto measure = [&](auto exchange) {
+        uint64_t total = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (auto const& [price, maxWheatSend, maxSheepReceive] : crossings)
+        {
+            // The same shape of call as adjustOffer
+            auto res = exchange(price, maxWheatSend, INT64_MAX, INT64_MAX,
+                                maxSheepReceive, RoundingType::NORMAL);
+            total += res.numWheatReceived;
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        return std::make_pair(stop - start, total);
+    };
+
+    auto native = measure(exchangeV10);
+    auto portable = measure(exchangeV10Portable);
+    REQUIRE(native.second == portable.second);
+    LOG_INFO(DEFAULT_LOG,
+             "{} crossings: {} with native arithmetic, {} with portable "
+             "arithmetic",
+             iterations, native.first, portable.first);
+}
@@ -13,18 +13,23 @@
 #include "lib/catch.hpp"
 #include "main/Application.h"
 #include "rust/RustBridge.h"
+#include "rust/XdrBufBatch.h"
 #include "test/TestAccount.h"
 #include "test/TestUtils.h"
 #include "test/TxTests.h"
 #include "test/test.h"
 #include "transactions/InvokeHostFunctionOpFrame.h"
+#include "transactions/ParallelSorobanApply.h"
 #include "transactions/SignatureUtils.h"
 #include "transactions/TransactionUtils.h"
 #include "util/Decoder.h"
+#include "util/Logging.h"
 #include "util/XDRCereal.h"
 #include "xdr/Caiz-contract.h"
 #include "xdr/Caiz-ledger-entries.h"
 #include <autocheck/autocheck.hpp>
+#include <chrono>
+#include <fmt/chrono.h>
 #include <fmt/format.h>
 #include <limits>
 #include <type_traits>
@@ -422,6 +427,32 @@ TEST_CASE("basic contract invocation", "[tx][soroban]")
                     .count() != 0);
     }
 
+    SECTION("contract code cache")
+    {
+        auto& hits = app->getMetrics().NewMeter(
+            {"soroban", "host-fn-op", "code-cache-hit"}, "entry");
+        auto& misses = app->getMetrics().NewMeter(
+            {"soroban", "host-fn-op", "code-cache-miss"}, "entry");
+        auto checkCached = [&]() {
+            auto hitsBefore = hits.count();
+            auto missesBefore = misses.count();
+            call(resources, {scContractID, scFunc, sc7, sc16}, true);
+            REQUIRE(hits.count() == hitsBefore + 1);
+            REQUIRE(misses.count() == missesBefore);
+        };
+        call(resources, {scContractID, scFunc, sc7, sc16}, true);
+        // The code entry is reused by the next call, even after its
+        // expiration is bumped
+        checkCached();
+        {
+            LedgerTxn ltx(app->getLedgerTxnRoot());
+            auto ltxe = ltx.load(contractKeys[1]);
+            ltxe.current().data.contractCode().expirationLedgerSeq += 1000;
+            ltx.commit();
+        }
+        checkCached();
+    }
+
     SECTION("incorrect invocation parameters")
     {
         // Too few parameters
@@ -445,6 +476,175 @@ TEST_CASE("basic contract invocation", "[tx][soroban]")
     }
 }
 
+TEST_CASE("host functions executed ahead of apply", "[tx][soroban]")
+{
+    VirtualClock clock;
+    auto cfg = getTestConfig();
+    cfg.EXPERIMENTAL_BUCKETLIST_DB = false;
+    auto app = createTestApplication(clock, cfg);
+    auto root = TestAccount::createRoot(*app);
+    auto a1 = root.create(
+        "a1", app->getLedgerManager().getLastMinBalance(0) * 100);
+
+    auto const addI32Wasm = rust_bridge::get_test_wasm_add_i32();
+    auto contractKeys = deployContractWithSourceAccount(*app, addI32Wasm);
+    SCVal scContractID(SCValType::SCV_ADDRESS);
+    scContractID.address() = contractKeys[0].contractData().contract;
+
+    SorobanResources resources;
+    resources.footprint.readOnly = contractKeys;
+    resources.instructions = 2'000'000;
+    resources.readBytes = 2000;
+    resources.writeBytes = 1000;
+    resources.extendedMetaDataSizeBytes = 3000;
+
+    auto makeTx = [&](TestAccount& source, int32_t a, int32_t b) {
+        Operation op;
+        op.body.type(INVOKE_HOST_FUNCTION);
+        auto& ihf = op.body.invokeHostFunctionOp().hostFunction;
+        ihf.type(HOST_FUNCTION_TYPE_INVOKE_CONTRACT);
+        ihf.invokeContract() = {scContractID, makeSymbol("add"), makeI32(a),
+                                makeI32(b)};
+        return sorobanTransactionFrameFromOps(app->getNetworkID(), source,
+                                              {op}, {}, resources, 100'000,
+                                              1200);
+    };
+    std::vector<TransactionFrameBasePtr> txs = {makeTx(root, 7, 16),
+                                                makeTx(a1, 1, 2)};
+    {
+        LedgerTxn ltx(app->getLedgerTxnRoot());
+        for (auto const& tx : txs)
+        {
+            REQUIRE(tx->checkValid(*app, ltx, 0, 0, 0));
+            tx->processFeeSeqNum(ltx, 100);
+        }
+        ltx.commit();
+    }
+
+    auto& reused = app->getMetrics().NewMeter(
+        {"soroban", "parallel-apply", "reused"}, "call");
+    auto& mismatch = app->getMetrics().NewMeter(
+        {"soroban", "parallel-apply", "mismatch"}, "call");
+    auto const baseSeed = sha256("ahead of apply");
+
+    auto applyAll = [&](Hash const& applySeed, TimePoint closeTimeDelta) {
+        LedgerTxn ltx(app->getLedgerTxnRoot());
+        speculativelyExecuteHostFunctions(*app, ltx, txs, baseSeed, 2);
+        ltx.loadHeader().current().scpValue.closeTime += closeTimeDelta;
+        std::vector<SCVal> results;
+        for (size_t i = 0; i < txs.size(); ++i)
+        {
+            TransactionMetaFrame txm(
+                ltx.loadHeader().current().ledgerVersion);
+            REQUIRE(txs[i]->apply(*app, ltx, txm,
+                                  getSorobanSubSeed(applySeed, i)));
+            results.emplace_back(txm.getXDR().v3().sorobanMeta->returnValue);
+        }
+        REQUIRE(results == std::vector<SCVal>{makeI32(23), makeI32(3)});
+    };
+
+    SECTION("outputs are reused")
+    {
+        applyAll(baseSeed, 0);
+        REQUIRE(reused.count() == 2);
+        REQUIRE(mismatch.count() == 0);
+    }
+    SECTION("outputs computed from different inputs are discarded")
+    {
+        applyAll(sha256("another seed"), 0);
+        REQUIRE(reused.count() == 0);
+        REQUIRE(mismatch.count() == 2);
+    }
+    SECTION("outputs computed against a different header are discarded")
+    {
+        applyAll(baseSeed, 1);
+        REQUIRE(reused.count() == 0);
+        REQUIRE(mismatch.count() == 2);
+    }
+}
+
+TEST_CASE("host function bridge overhead", "[tx][soroban][bench][!hide]")
+{
+    VirtualClock clock;
+    auto cfg = getTestConfig();
+    cfg.EXPERIMENTAL_BUCKETLIST_DB = false;
+    auto app = createTestApplication(clock, cfg);
+    auto root = TestAccount::createRoot(*app);
+
+    auto contractKeys = deployContractWithSourceAccount(
+        *app, rust_bridge::get_test_wasm_add_i32());
+    auto const& contractID = contractKeys[0].contractData().contract;
+
+    LedgerTxn ltx(app->getLedgerTxnRoot());
+    auto const header = ltx.loadHeader().current();
+    auto const& sorobanConfig =
+        app->getLedgerManager().getSorobanNetworkConfig(ltx);
+    std::vector<LedgerEntry> contractEntries;
+    for (auto const& lk : contractKeys)
+    {
+        contractEntries.emplace_back(
+            ltx.loadWithoutRecord(lk, /*loadExpiredEntry=*/false).current());
+    }
+
+    InvokeHostFunctionOp op;
+    op.hostFunction.type(HOST_FUNCTION_TYPE_INVOKE_CONTRACT);
+    SCVal scContractID(SCValType::SCV_ADDRESS);
+    scContractID.address() = contractID;
+    op.hostFunction.invokeContract() = {scContractID, makeSymbol("add"),
+                                        makeI32(7), makeI32(16)};
+
+    // The contract only reads its instance and code, the other footprint
+    // entries are only passed across the bridge and into the host storage.
+    size_t const iterations = 1000;
+    for (uint32_t extraEntries : {0, 10, 100})
+    {
+        SorobanResources resources;
+        resources.footprint.readOnly = contractKeys;
+        resources.instructions = 100'000'000;
+        auto entries = contractEntries;
+        for (uint32_t i = 0; i < extraEntries; ++i)
+        {
+            LedgerEntry le;
+            le.lastModifiedLedgerSeq = header.ledgerSeq;
+            le.data.type(CONTRACT_DATA);
+            auto& cd = le.data.contractData();
+            cd.contract = contractID;
+            cd.key = makeU32(i);
+            cd.durability = ContractDataDurability::PERSISTENT;
+            cd.body.bodyType(DATA_ENTRY);
+            cd.body.data().val.type(SCV_BYTES);
+            cd.body.data().val.bytes().resize(512);
+            cd.expirationLedgerSeq = header.ledgerSeq + 1000;
+            resources.footprint.readOnly.emplace_back(LedgerEntryKey(le));
+            entries.emplace_back(le);
+        }
+
+        std::chrono::nanoseconds marshal{0};
+        std::chrono::nanoseconds invoke{0};
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            auto ledgerEntries = makeCxxBufBatch();
+            for (auto const& le : entries)
+            {
+                appendToCxxBufBatch(ledgerEntries, le);
+            }
+            auto step = std::chrono::high_resolution_clock::now();
+            auto out = InvokeHostFunctionOpFrame::invokeHostFunction(
+                app->getConfig(), header, sorobanConfig, op, resources,
+                root.getPublicKey(), ledgerEntries, Hash{});
+            auto stop = std::chrono::high_resolution_clock::now();
+            REQUIRE(out.success);
+            marshal += step - start;
+            invoke += stop - step;
+        }
+        LOG_INFO(DEFAULT_LOG,
+                 "{} extra footprint entries: {} to marshal, {} to invoke, "
+                 "per call",
+                 extraEntries, marshal / iterations, invoke / iterations);
+    }
+}
+
 TEST_CASE("contract storage", "[tx][soroban]")
 {
     VirtualClock clock;
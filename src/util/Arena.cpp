@@ -0,0 +1,136 @@
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/Arena.h"
+#include "util/GlobalChecks.h"
+#include "util/Logging.h"
+#include <new>
+
+namespace caiz
+{
+
+namespace
+{
+thread_local Arena* gCurrentArena = nullptr;
+}
+
+Arena::Arena(size_t chunkSize) : mChunkSize(chunkSize)
+{
+    releaseAssert(mChunkSize >= MAX_BLOCK_SIZE);
+}
+
+Arena::~Arena()
+{
+    for (auto chunk : mChunks)
+    {
+        ::operator delete(chunk);
+    }
+}
+
+bool
+Arena::isSmall(size_t bytes, size_t alignment)
+{
+    return bytes != 0 && bytes <= MAX_BLOCK_SIZE && alignment <= GRANULARITY;
+}
+
+void*
+Arena::allocate(size_t bytes, size_t alignment)
+{
+    if (!isSmall(bytes, alignment))
+    {
+        return ::operator new(bytes, std::align_val_t(alignment));
+    }
+
+    auto sizeClass = (bytes - 1) / GRANULARITY;
+    auto& freeList = mFreeLists[sizeClass];
+    if (freeList)
+    {
+        auto block = freeList;
+        freeList = block->mNext;
+        ++mOutstanding;
+        return block;
+    }
+
+    // Chunks come from ::operator new, so they are aligned to at least
+    // GRANULARITY, and every block is a multiple of GRANULARITY in size
+    auto blockSize = (sizeClass + 1) * GRANULARITY;
+    if (static_cast<size_t>(mEnd - mCursor) < blockSize)
+    {
+        mChunks.reserve(mChunks.size() + 1);
+        auto chunk = static_cast<char*>(::operator new(mChunkSize));
+        mChunks.emplace_back(chunk);
+        mCursor = chunk;
+        mEnd = chunk + mChunkSize;
+    }
+    auto block = mCursor;
+    mCursor += blockSize;
+    ++mOutstanding;
+    return block;
+}
+
+void
+Arena::deallocate(void* p, size_t bytes, size_t alignment) noexcept
+{
+    if (!isSmall(bytes, alignment))
+    {
+        ::operator delete(p, std::align_val_t(alignment));
+        return;
+    }
+
+    auto& freeList = mFreeLists[(bytes - 1) / GRANULARITY];
+    auto block = static_cast<FreeBlock*>(p);
+    block->mNext = freeList;
+    freeList = block;
+    --mOutstanding;
+}
+
+bool
+Arena::reset() noexcept
+{
+    if (mOutstanding != 0)
+    {
+        return false;
+    }
+    for (auto chunk : mChunks)
+    {
+        ::operator delete(chunk);
+    }
+    mChunks.clear();
+    mCursor = nullptr;
+    mEnd = nullptr;
+    mFreeLists.fill(nullptr);
+    return true;
+}
+
+size_t
+Arena::reservedBytes() const
+{
+    return mChunks.size() * mChunkSize;
+}
+
+Arena::Scope::Scope(Arena& arena) : mArena(arena), mPrevious(gCurrentArena)
+{
+    gCurrentArena = &mArena;
+}
+
+Arena::Scope::~Scope()
+{
+    gCurrentArena = mPrevious;
+    if (!mArena.reset())
+    {
+        // Something allocated in this scope outlived it, so the arena can't
+        // release its chunks until a later reset.
+        CLOG_WARNING(Perf,
+                     "Arena has {} outstanding allocations at the end of its "
+                     "scope, keeping {} bytes reserved",
+                     mArena.outstandingAllocations(), mArena.reservedBytes());
+    }
+}
+
+Arena*
+Arena::current()
+{
+    return gCurrentArena;
+}
+}
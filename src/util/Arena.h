@@ -0,0 +1,150 @@
+#pragma once
+
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace caiz
+{
+
+// Arena serves small, short-lived allocations (such as the nodes of the maps
+// inside a LedgerTxn) without going to the global heap. Blocks are carved out
+// of large chunks and recycled through free lists, one per size class, and
+// reset() returns every chunk to the heap at once. Allocations that are too
+// large or over-aligned go straight to the heap.
+//
+// An Arena is not thread safe. reset() only releases the chunks if every
+// block allocated from the arena has been deallocated, and returns false
+// otherwise.
+class Arena : public NonMovableOrCopyable
+{
+  public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 256 * 1024;
+
+    explicit Arena(size_t chunkSize = DEFAULT_CHUNK_SIZE);
+    ~Arena();
+
+    void* allocate(size_t bytes, size_t alignment);
+    void deallocate(void* p, size_t bytes, size_t alignment) noexcept;
+
+    bool reset() noexcept;
+
+    size_t
+    outstandingAllocations() const
+    {
+        return mOutstanding;
+    }
+
+    size_t reservedBytes() const;
+
+    // Arena::Scope makes an arena the current arena of this thread for its
+    // lifetime, then resets it, warning if that fails. Scopes nest.
+    class Scope : public NonMovableOrCopyable
+    {
+        Arena& mArena;
+        Arena* mPrevious;
+
+      public:
+        explicit Scope(Arena& arena);
+        ~Scope();
+    };
+
+    // Returns the arena of the innermost Scope on this thread, or nullptr
+    static Arena* current();
+
+  private:
+    static constexpr size_t GRANULARITY = alignof(std::max_align_t);
+    static constexpr size_t MAX_BLOCK_SIZE = 1024;
+
+    struct FreeBlock
+    {
+        FreeBlock* mNext;
+    };
+
+    static bool isSmall(size_t bytes, size_t alignment);
+
+    size_t const mChunkSize;
+    std::vector<void*> mChunks;
+    char* mCursor{nullptr};
+    char* mEnd{nullptr};
+    std::array<FreeBlock*, MAX_BLOCK_SIZE / GRANULARITY> mFreeLists{};
+    size_t mOutstanding{0};
+};
+
+// ArenaAllocator is a standard allocator backed by an Arena, or by the global
+// heap if it has no arena. Containers that share one keep sharing it across
+// copies, moves and swaps.
+template <typename T> class ArenaAllocator
+{
+    template <typename U> friend class ArenaAllocator;
+
+    Arena* mArena;
+
+  public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit ArenaAllocator(Arena* arena = nullptr) noexcept : mArena(arena)
+    {
+    }
+
+    template <typename U>
+    ArenaAllocator(ArenaAllocator<U> const& other) noexcept
+        : mArena(other.mArena)
+    {
+    }
+
+    T*
+    allocate(size_t n)
+    {
+        if (mArena)
+        {
+            return static_cast<T*>(
+                mArena->allocate(n * sizeof(T), alignof(T)));
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void
+    deallocate(T* p, size_t n) noexcept
+    {
+        if (mArena)
+        {
+            mArena->deallocate(p, n * sizeof(T), alignof(T));
+        }
+        else
+        {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    Arena*
+    arena() const
+    {
+        return mArena;
+    }
+
+    template <typename U>
+    bool
+    operator==(ArenaAllocator<U> const& other) const
+    {
+        return mArena == other.mArena;
+    }
+
+    template <typename U>
+    bool
+    operator!=(ArenaAllocator<U> const& other) const
+    {
+        return mArena != other.mArena;
+    }
+};
+}
@@ -0,0 +1,237 @@
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/EventLoopProfiler.h"
+#include "lib/json/json.h"
+#include "util/Timer.h"
+#include <algorithm>
+
+namespace caiz
+{
+
+namespace
+{
+char const*
+phaseName(size_t phase)
+{
+    switch (static_cast<EventLoopProfiler::Phase>(phase))
+    {
+    case EventLoopProfiler::Phase::TIMERS:
+        return "timers";
+    case EventLoopProfiler::Phase::IO:
+        return "io";
+    case EventLoopProfiler::Phase::ACTIONS:
+        return "actions";
+    case EventLoopProfiler::Phase::IDLE:
+        return "idle";
+    }
+    return "unknown";
+}
+
+double
+toMs(std::chrono::nanoseconds d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+bool
+shorterStall(EventLoopProfiler::Stall const& a,
+             EventLoopProfiler::Stall const& b)
+{
+    // std heap functions keep the largest element first, so invert for a
+    // min-heap
+    return a.mRunTime > b.mRunTime;
+}
+
+Json::Value
+histogramJson(EventLoopProfiler::Histogram const& h)
+{
+    Json::Value res;
+    res["total_ms"] = toMs(h.total());
+    res["max_ms"] = toMs(h.max());
+    res["p50_ms"] = toMs(h.quantile(0.5));
+    res["p99_ms"] = toMs(h.quantile(0.99));
+    return res;
+}
+}
+
+void
+EventLoopProfiler::Histogram::add(nsecs d)
+{
+    auto us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+    // bucket i holds [2^(i-1), 2^i) microseconds
+    size_t bucket = 0;
+    while (us != 0 && bucket < NUM_BUCKETS - 1)
+    {
+        us >>= 1;
+        ++bucket;
+    }
+    ++mBuckets[bucket];
+    ++mCount;
+    mTotal += d;
+    mMax = std::max(mMax, d);
+}
+
+EventLoopProfiler::nsecs
+EventLoopProfiler::Histogram::quantile(double q) const
+{
+    if (mCount == 0)
+    {
+        return nsecs::zero();
+    }
+    auto rank = static_cast<uint64_t>(q * static_cast<double>(mCount - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS - 1; ++i)
+    {
+        seen += mBuckets[i];
+        if (seen > rank)
+        {
+            return std::min<nsecs>(std::chrono::microseconds(1ULL << i), mMax);
+        }
+    }
+    return mMax;
+}
+
+EventLoopProfiler::EventLoopProfiler()
+    : mStartedAt(std::chrono::system_clock::now())
+{
+    mStalls.reserve(NUM_STALLS);
+}
+
+void
+EventLoopProfiler::recordPhase(Phase phase, nsecs d)
+{
+    mPhases[static_cast<size_t>(phase)] += d;
+}
+
+void
+EventLoopProfiler::recordAction(std::string const& name, nsecs queueDelay,
+                                nsecs runTime)
+{
+    auto it = mActions.find(name);
+    if (it == mActions.end())
+    {
+        it = mActions.emplace(name, ActionEntry{}).first;
+        mRecentActions.emplace_front(&it->first);
+        it->second.mRecent = mRecentActions.begin();
+        if (mActions.size() > MAX_ACTIONS)
+        {
+            auto oldest = mActions.find(*mRecentActions.back());
+            mRecentActions.pop_back();
+            mActions.erase(oldest);
+            ++mDroppedActions;
+        }
+    }
+    else
+    {
+        mRecentActions.splice(mRecentActions.begin(), mRecentActions,
+                              it->second.mRecent);
+    }
+    auto& profile = it->second.mProfile;
+    profile.mRunTime.add(runTime);
+    profile.mQueueDelay.add(queueDelay);
+
+    if (mStalls.size() == NUM_STALLS)
+    {
+        if (runTime <= mStalls.front().mRunTime)
+        {
+            return;
+        }
+        std::pop_heap(mStalls.begin(), mStalls.end(), shorterStall);
+        mStalls.pop_back();
+    }
+    mStalls.emplace_back(
+        Stall{name, runTime, queueDelay, std::chrono::system_clock::now()});
+    std::push_heap(mStalls.begin(), mStalls.end(), shorterStall);
+}
+
+void
+EventLoopProfiler::reset()
+{
+    mPhases.fill(nsecs::zero());
+    mActions.clear();
+    mRecentActions.clear();
+    mDroppedActions = 0;
+    mStalls.clear();
+    mStartedAt = std::chrono::system_clock::now();
+}
+
+EventLoopProfiler::ActionProfile const*
+EventLoopProfiler::getActionProfile(std::string const& name) const
+{
+    auto it = mActions.find(name);
+    return it == mActions.end() ? nullptr : &it->second.mProfile;
+}
+
+std::vector<EventLoopProfiler::Stall>
+EventLoopProfiler::getStalls() const
+{
+    auto res = mStalls;
+    std::sort(res.begin(), res.end(), shorterStall);
+    return res;
+}
+
+Json::Value
+EventLoopProfiler::getJsonInfo(size_t limit) const
+{
+    Json::Value res;
+    res["since"] = VirtualClock::systemPointToISOString(mStartedAt);
+
+    nsecs total{0};
+    for (auto d : mPhases)
+    {
+        total += d;
+    }
+    auto& phases = res["phases"];
+    for (size_t i = 0; i < NUM_PHASES; ++i)
+    {
+        auto& phase = phases[phaseName(i)];
+        phase["total_ms"] = toMs(mPhases[i]);
+        phase["fraction"] =
+            total.count() == 0
+                ? 0.0
+                : static_cast<double>(mPhases[i].count()) / total.count();
+    }
+
+    std::vector<std::pair<std::string const*, ActionProfile const*>> actions;
+    actions.reserve(mActions.size());
+    for (auto const& kv : mActions)
+    {
+        actions.emplace_back(&kv.first, &kv.second.mProfile);
+    }
+    limit = std::min(limit, actions.size());
+    std::partial_sort(actions.begin(), actions.begin() + limit, actions.end(),
+                      [](auto const& a, auto const& b) {
+                          return a.second->mRunTime.total() >
+                                 b.second->mRunTime.total();
+                      });
+    res["dropped_actions"] = static_cast<Json::UInt64>(mDroppedActions);
+    auto& actionsJson = res["actions"];
+    actionsJson = Json::Value(Json::arrayValue);
+    for (size_t i = 0; i < limit; ++i)
+    {
+        Json::Value a;
+        a["name"] = *actions[i].first;
+        auto const& profile = *actions[i].second;
+        a["count"] = static_cast<Json::UInt64>(profile.mRunTime.count());
+        a["run"] = histogramJson(profile.mRunTime);
+        a["delay"] = histogramJson(profile.mQueueDelay);
+        actionsJson.append(a);
+    }
+
+    auto& stallsJson = res["stalls"];
+    stallsJson = Json::Value(Json::arrayValue);
+    for (auto const& s : getStalls())
+    {
+        Json::Value st;
+        st["name"] = s.mName;
+        st["run_ms"] = toMs(s.mRunTime);
+        st["delay_ms"] = toMs(s.mQueueDelay);
+        st["at"] = VirtualClock::systemPointToISOString(s.mAt);
+        stallsJson.append(st);
+    }
+    return res;
+}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "lib/json/json-forwards.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace caiz
+{
+
+// Accounts for where the main thread spends its time in VirtualClock::crank:
+// how long it dispatches timers, polls IO and runs Scheduler actions, and for
+// each action name how long the actions run and wait in their queue. The
+// longest single actions are kept as "stalls", since one of them is what
+// delays everything queued behind it.
+//
+// Every sample is a hash lookup by action name and a handful of additions into
+// its histograms, with times the caller measured anyway, so the profiler is
+// always on. Some action names embed a peer (e.g. "broadcast to {peer}"), so
+// at most MAX_ACTIONS names are kept and the least recently recorded one is
+// dropped beyond that, much like Scheduler drops idle action queues. It is
+// only used from the main thread.
+class EventLoopProfiler
+{
+  public:
+    using nsecs = std::chrono::nanoseconds;
+
+    enum class Phase
+    {
+        TIMERS = 0,
+        IO = 1,
+        ACTIONS = 2,
+        // blocked waiting for IO when there was nothing else to do, including
+        // the IO completion that ends the wait
+        IDLE = 3
+    };
+    static constexpr size_t NUM_PHASES = 4;
+
+    // Histogram of durations in buckets of powers of 2 microseconds, the last
+    // bucket holding everything longer than about 4 seconds.
+    class Histogram
+    {
+      public:
+        static constexpr size_t NUM_BUCKETS = 24;
+
+        void add(nsecs d);
+        // upper bound of the bucket holding the q-th quantile
+        nsecs quantile(double q) const;
+
+        uint64_t
+        count() const
+        {
+            return mCount;
+        }
+        nsecs
+        total() const
+        {
+            return mTotal;
+        }
+        nsecs
+        max() const
+        {
+            return mMax;
+        }
+
+      private:
+        std::array<uint64_t, NUM_BUCKETS> mBuckets{};
+        uint64_t mCount{0};
+        nsecs mTotal{0};
+        nsecs mMax{0};
+    };
+
+    struct ActionProfile
+    {
+        Histogram mRunTime;
+        Histogram mQueueDelay;
+    };
+
+    struct Stall
+    {
+        std::string mName;
+        nsecs mRunTime;
+        nsecs mQueueDelay;
+        std::chrono::system_clock::time_point mAt;
+    };
+
+    static constexpr size_t NUM_STALLS = 10;
+    static constexpr size_t MAX_ACTIONS = 1024;
+
+    EventLoopProfiler();
+
+    void recordPhase(Phase phase, nsecs d);
+    void recordAction(std::string const& name, nsecs queueDelay,
+                      nsecs runTime);
+
+    // Forgets everything recorded so far
+    void reset();
+
+    // Time per phase, the `limit` action names with the most total run time,
+    // and the longest single actions, since the last reset.
+    Json::Value getJsonInfo(size_t limit) const;
+
+    ActionProfile const* getActionProfile(std::string const& name) const;
+    std::vector<Stall> getStalls() const;
+
+  private:
+    struct ActionEntry
+    {
+        ActionProfile mProfile;
+        std::list<std::string const*>::iterator mRecent;
+    };
+
+    std::array<nsecs, NUM_PHASES> mPhases{};
+    std::unordered_map<std::string, ActionEntry> mActions;
+    // Keys of mActions, the most recently recorded first
+    std::list<std::string const*> mRecentActions;
+    uint64_t mDroppedActions{0};
+    // min-heap on mRunTime, so the shortest stall is the one replaced
+    std::vector<Stall> mStalls;
+    std::chrono::system_clock::time_point mStartedAt;
+};
+}
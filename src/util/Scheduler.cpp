@@ -109,6 +109,13 @@ class Scheduler::ActionQueue
         return mActions.empty();
     }
 
+    VirtualClock::time_point
+    nextEnqueueTime() const
+    {
+        releaseAssert(!mActions.empty());
+        return mActions.front().mEnqueueTime;
+    }
+
     bool
     isOverloaded(nsecs latencyWindow, VirtualClock::time_point now) const
     {
@@ -146,6 +153,7 @@ class Scheduler::ActionQueue
         ZoneScoped;
         ZoneText(mName.c_str(), mName.size());
         auto before = clock.now();
+        auto enqueueTime = mActions.front().mEnqueueTime;
         Action action = std::move(mActions.front().mAction);
         mActions.pop_front();
 
@@ -154,6 +162,9 @@ class Scheduler::ActionQueue
             nsecs duration = std::chrono::duration_cast<nsecs>(after - before);
             mTotalService = std::max(mTotalService + duration, minTotalService);
             mLastService = after;
+            clock.getEventLoopProfiler().recordAction(
+                mName, std::chrono::duration_cast<nsecs>(before - enqueueTime),
+                duration);
         });
 
         action();
@@ -165,6 +176,9 @@ Scheduler::Scheduler(VirtualClock& clock,
     : mRunnableActionQueues([](Qptr a, Qptr b) -> bool {
         return a->totalService() > b->totalService();
     })
+    , mRunnableCriticalActionQueues([](Qptr a, Qptr b) -> bool {
+        return a->nextEnqueueTime() > b->nextEnqueueTime();
+    })
     , mClock(clock)
     , mLatencyWindow(latencyWindow)
 {
@@ -179,6 +193,38 @@ Scheduler::trimSingleActionQueue(Qptr q, VirtualClock::time_point now)
     mSize -= trimmed;
 }
 
+void
+Scheduler::pushRunnable(Qptr q)
+{
+    if (q->type() == ActionType::CRITICAL_ACTION)
+    {
+        mRunnableCriticalActionQueues.push(q);
+    }
+    else
+    {
+        mRunnableActionQueues.push(q);
+    }
+}
+
+bool
+Scheduler::nextIsCritical() const
+{
+    if (mRunnableCriticalActionQueues.empty())
+    {
+        return false;
+    }
+    if (mRunnableActionQueues.empty())
+    {
+        return true;
+    }
+    // Critical actions are due when enqueued, others a latency window later
+    auto criticalDeadline =
+        mRunnableCriticalActionQueues.top()->nextEnqueueTime();
+    auto otherDeadline =
+        mRunnableActionQueues.top()->nextEnqueueTime() + mLatencyWindow;
+    return criticalDeadline <= otherDeadline;
+}
+
 void
 Scheduler::trimIdleActionQueues(VirtualClock::time_point now)
 {
@@ -205,6 +251,9 @@ Scheduler::shutdown()
         mRunnableActionQueues =
             std::priority_queue<Qptr, std::vector<Qptr>,
                                 std::function<bool(Qptr, Qptr)>>();
+        mRunnableCriticalActionQueues =
+            std::priority_queue<Qptr, std::vector<Qptr>,
+                                std::function<bool(Qptr, Qptr)>>();
         mIdleActionQueues.clear();
     }
 }
@@ -237,7 +286,7 @@ Scheduler::enqueue(std::string&& name, Action&& action, ActionType type)
         mStats.mQueuesActivatedFromFresh++;
         auto q = std::make_shared<ActionQueue>(name, type, mIdleActionQueues);
         qi = mAllActionQueues.emplace(key, q).first;
-        mRunnableActionQueues.push(qi->second);
+        pushRunnable(qi->second);
     }
     else
     {
@@ -246,7 +295,7 @@ Scheduler::enqueue(std::string&& name, Action&& action, ActionType type)
             releaseAssert(qi->second->isEmpty());
             mStats.mQueuesActivatedFromIdle++;
             qi->second->removeFromIdleList();
-            mRunnableActionQueues.push(qi->second);
+            pushRunnable(qi->second);
         }
     }
     mStats.mActionsEnqueued++;
@@ -259,15 +308,17 @@ Scheduler::runOne()
 {
     auto start = mClock.now();
     trimIdleActionQueues(start);
-    if (mRunnableActionQueues.empty())
+    if (mRunnableActionQueues.empty() && mRunnableCriticalActionQueues.empty())
     {
         releaseAssert(mSize == 0);
         return 0;
     }
     else
     {
-        auto q = mRunnableActionQueues.top();
-        mRunnableActionQueues.pop();
+        auto& runnable = nextIsCritical() ? mRunnableCriticalActionQueues
+                                          : mRunnableActionQueues;
+        auto q = runnable.top();
+        runnable.pop();
         trimSingleActionQueue(q, start);
 
         auto putQueueBackInIdleOrActive = gsl::finally([&]() {
@@ -302,7 +353,7 @@ Scheduler::runOne()
             }
             else
             {
-                mRunnableActionQueues.push(q);
+                pushRunnable(q);
             }
         });
 
@@ -314,8 +365,13 @@ Scheduler::runOne()
             mSize -= 1;
             mStats.mActionsDequeued++;
             auto updateMaxTotalService = gsl::finally([&]() {
-                mMaxTotalService =
-                    std::max(q->totalService(), mMaxTotalService);
+                // Critical queues aren't scheduled by service time, so they
+                // don't move the floor for the others
+                if (q->type() != ActionType::CRITICAL_ACTION)
+                {
+                    mMaxTotalService =
+                        std::max(q->totalService(), mMaxTotalService);
+                }
                 mCurrentActionType = ActionType::NORMAL_ACTION;
             });
             mCurrentActionType = q->type();
@@ -366,6 +422,10 @@ std::string const&
 Scheduler::nextQueueToRun() const
 {
     static std::string empty;
+    if (nextIsCritical())
+    {
+        return mRunnableCriticalActionQueues.top()->name();
+    }
     if (mRunnableActionQueues.empty())
     {
         return empty;
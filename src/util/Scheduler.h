@@ -99,6 +99,17 @@
 //
 //   - We record the enqueue time and "droppability" of an action, to allow us
 //     to measure load level and perform load shedding.
+//
+//   - Consensus can't wait for its fair share when there are many queues:
+//     flooding to each peer is its own queue, so a busy node would run a
+//     round of every one of them before each SCP message. CRITICAL_ACTIONs
+//     therefore run earliest-deadline-first ahead of the fair-share queues.
+//     A critical action is due as soon as it is enqueued, any other action
+//     once it has waited a latency window (see below); the next action to run
+//     is the critical one with the earliest deadline, unless the fair-share
+//     queue's next action is due even earlier. So critical actions go first,
+//     but can't hold back the rest by more than the latency window unless
+//     they alone take up the main thread.
 
 namespace caiz
 {
@@ -112,7 +123,9 @@ class Scheduler
     enum class ActionType
     {
         NORMAL_ACTION,
-        DROPPABLE_ACTION
+        DROPPABLE_ACTION,
+        // runs ahead of other actions, see above; never dropped
+        CRITICAL_ACTION
     };
 
     struct Stats
@@ -140,6 +153,12 @@ class Scheduler
                         std::function<bool(Qptr, Qptr)>>
         mRunnableActionQueues;
 
+    // Same for the runnable CRITICAL_ACTION ActionQueues, with top() being
+    // the ActionQueue whose next action was enqueued first.
+    std::priority_queue<Qptr, std::vector<Qptr>,
+                        std::function<bool(Qptr, Qptr)>>
+        mRunnableCriticalActionQueues;
+
     Stats mStats;
 
     // Clock we get time from.
@@ -187,6 +206,11 @@ class Scheduler
 
     void trimSingleActionQueue(Qptr q,
                                std::chrono::steady_clock::time_point now);
+
+    void pushRunnable(Qptr q);
+    // Whether the next action to run is the top critical one rather than the
+    // top fair-share one
+    bool nextIsCritical() const;
     void trimIdleActionQueues(std::chrono::steady_clock::time_point now);
 
     // List of ActionQueues that are currently idle. Idle ActionQueues maintain
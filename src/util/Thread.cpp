@@ -10,7 +10,7 @@
 #else
 #include <unistd.h>
 #endif
-#if defined(__APPLE__)
+#if defined(__APPLE__) || defined(__linux__)
 #include <pthread.h>
 #endif
 
@@ -46,6 +46,20 @@ runCurrentThreadWithLowPriority()
     }
 }
 
+void
+pinCurrentThreadToCpu(uint32_t cpu)
+{
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (ret != 0)
+    {
+        LOG_WARNING(DEFAULT_LOG, "Unable to pin thread to CPU {}: {}", cpu,
+                    ret);
+    }
+}
+
 #elif defined(__APPLE__)
 
 void
@@ -78,5 +92,15 @@ runCurrentThreadWithLowPriority()
 {
 }
 
+#endif
+
+#if !defined(__linux__)
+void
+pinCurrentThreadToCpu(uint32_t cpu)
+{
+    LOG_DEBUG(DEFAULT_LOG, "Pinning threads to CPUs is not supported, CPU {} "
+                           "ignored",
+              cpu);
+}
 #endif
 }
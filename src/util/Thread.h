@@ -5,6 +5,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include <chrono>
+#include <cstdint>
 #include <future>
 #include <thread>
 
@@ -13,6 +14,10 @@ namespace caiz
 
 void runCurrentThreadWithLowPriority();
 
+// Restricts the current thread to run on the given CPU, where the platform
+// supports it
+void pinCurrentThreadToCpu(uint32_t cpu);
+
 template <typename T>
 bool
 futureIsReady(std::future<T> const& fut)
@@ -368,7 +368,10 @@ VirtualClock::crank(bool block)
         }
 
         // Dispatch some IO event completions.
+        auto timersStart = mLastDispatchStart;
         mLastDispatchStart = now();
+        mEventLoopProfiler.recordPhase(EventLoopProfiler::Phase::TIMERS,
+                                       mLastDispatchStart - timersStart);
         // Bias towards the execution queue exponentially based on how long the
         // scheduler has been overloaded.
         auto overloadedDuration =
@@ -386,12 +389,17 @@ VirtualClock::crank(bool block)
         }
 
         // Dispatch some scheduled actions.
+        auto ioStart = mLastDispatchStart;
         mLastDispatchStart = now();
+        mEventLoopProfiler.recordPhase(EventLoopProfiler::Phase::IO,
+                                       mLastDispatchStart - ioStart);
         {
             ZoneNamedN(schedZone, "scheduler", true);
             progressCount += crankStep(
                 *this, [this] { return this->mActionScheduler->runOne(); });
         }
+        mEventLoopProfiler.recordPhase(EventLoopProfiler::Phase::ACTIONS,
+                                       now() - mLastDispatchStart);
 
         // Subtract out any timer cancellations from the above two steps.
         progressCount -= nRealTimerCancelEvents;
@@ -422,7 +430,10 @@ VirtualClock::crank(bool block)
     {
         ZoneNamedN(blockingZone, "ASIO blocking", true);
         // If we didn't make progress and caller wants blocking, block now.
+        auto blockStart = now();
         progressCount += mIOContext.run_one();
+        mEventLoopProfiler.recordPhase(EventLoopProfiler::Phase::IDLE,
+                                       now() - blockStart);
     }
     return progressCount;
 }
@@ -483,6 +494,12 @@ VirtualClock::actionQueueIsOverloaded() const
     return mActionScheduler->getOverloadedDuration().count() != 0;
 }
 
+EventLoopProfiler&
+VirtualClock::getEventLoopProfiler()
+{
+    return mEventLoopProfiler;
+}
+
 Scheduler::ActionType
 VirtualClock::currentSchedulerActionType() const
 {
@@ -8,6 +8,7 @@
 // first to include <windows.h> -- so we try to include it before everything
 // else.
 #include "util/asio.h"
+#include "util/EventLoopProfiler.h"
 #include "util/NonCopyable.h"
 #include "util/Scheduler.h"
 
@@ -151,6 +152,7 @@ class VirtualClock
     // dispatch of timers as virtual time advances past them.
     std::chrono::steady_clock::time_point mLastDispatchStart;
     std::unique_ptr<Scheduler> mActionScheduler;
+    EventLoopProfiler mEventLoopProfiler;
 
     mutable std::mutex mPendingActionQueueMutex;
     std::queue<
@@ -216,6 +218,9 @@ class VirtualClock
                     Scheduler::ActionType type);
 
     size_t getActionQueueSize() const;
+
+    // Where crank has spent its time, see EventLoopProfiler. Main thread only.
+    EventLoopProfiler& getEventLoopProfiler();
     bool actionQueueIsOverloaded() const;
     Scheduler::ActionType currentSchedulerActionType() const;
 };
@@ -36,10 +36,25 @@ TmpDir::TmpDir(std::string const& prefix)
     }
 }
 
-TmpDir::TmpDir(TmpDir&& other) : mPath(std::move(other.mPath))
+TmpDir::TmpDir(TmpDir&& other)
+    : mPath(std::move(other.mPath)), mKeep(other.mKeep)
 {
 }
 
+TmpDir
+TmpDir::persistent(std::string const& path)
+{
+    if (!fs::mkpath(path))
+    {
+        throw std::runtime_error(
+            fmt::format(FMT_STRING("Could not create directory {}"), path));
+    }
+    TmpDir dir;
+    dir.mPath = std::make_unique<std::string>(path);
+    dir.mKeep = true;
+    return dir;
+}
+
 std::string const&
 TmpDir::getName() const
 {
@@ -49,7 +64,7 @@ TmpDir::getName() const
 TmpDir::~TmpDir()
 {
     ZoneScoped;
-    if (!mPath)
+    if (!mPath || mKeep)
     {
         return;
     }
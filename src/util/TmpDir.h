@@ -12,12 +12,20 @@ namespace caiz
 class TmpDir
 {
     std::unique_ptr<std::string> mPath;
+    bool mKeep{false};
+
+    TmpDir() = default;
 
   public:
     TmpDir(std::string const& prefix);
     TmpDir(TmpDir&&);
     ~TmpDir();
     std::string const& getName() const;
+
+    // Creates (if needed) the directory at `path`, which, unlike a TmpDir
+    // created from a prefix, has a fixed name and is kept on destruction so
+    // that its contents survive restarts.
+    static TmpDir persistent(std::string const& path);
 };
 
 class TmpDirManager
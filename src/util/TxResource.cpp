@@ -48,8 +48,9 @@ Resource
 multiplyByDouble(Resource const& res, double m)
 {
     auto newRes = res;
-    for (auto& resource : newRes.mResources)
+    for (size_t i = 0; i < newRes.mSize; i++)
     {
+        auto& resource = newRes.mResources[i];
         auto tempResultDbl = resource * m;
         // Multiple each resource dimension by the rate
         releaseAssertOrThrow(tempResultDbl >= 0.0);
@@ -64,8 +65,9 @@ Resource
 bigDivideOrThrow(Resource const& res, int64_t B, int64_t C, Rounding rounding)
 {
     auto newRes = res;
-    for (auto& resource : newRes.mResources)
+    for (size_t i = 0; i < newRes.mSize; i++)
     {
+        auto& resource = newRes.mResources[i];
         resource = bigDivideOrThrow(resource, B, C, rounding);
     }
 
@@ -75,7 +77,8 @@ bigDivideOrThrow(Resource const& res, int64_t B, int64_t C, Rounding rounding)
 bool
 operator==(Resource const& lhs, Resource const& rhs)
 {
-    return lhs.mResources == rhs.mResources;
+    // Entries past the size are zero, so comparing them all is fine
+    return lhs.mSize == rhs.mSize && lhs.mResources == rhs.mResources;
 }
 
 Resource
@@ -131,7 +134,7 @@ Resource&
 Resource::operator+=(Resource const& other)
 {
     releaseAssert(canAdd(other));
-    for (size_t i = 0; i < mResources.size(); i++)
+    for (size_t i = 0; i < mSize; i++)
     {
         mResources[i] += other.mResources[i];
     }
@@ -141,8 +144,8 @@ Resource::operator+=(Resource const& other)
 Resource&
 Resource::operator-=(Resource const& other)
 {
-    releaseAssert(mResources.size() == other.mResources.size());
-    for (size_t i = 0; i < mResources.size(); i++)
+    releaseAssert(mSize == other.mSize);
+    for (size_t i = 0; i < mSize; i++)
     {
         releaseAssert(mResources[i] >= other.mResources[i]);
         mResources[i] -= other.mResources[i];
@@ -154,8 +157,8 @@ Resource
 limitTo(Resource const& curr, Resource const& limit)
 {
     releaseAssert(curr.size() == limit.size());
-    Resource limited(std::vector<int64_t>(curr.size(), 0));
-    for (int i = 0; i < limited.size(); i++)
+    Resource limited(curr);
+    for (size_t i = 0; i < limited.size(); i++)
     {
         limited.mResources[i] =
             std::min<int64_t>(curr.mResources[i], limit.mResources[i]);
@@ -6,6 +6,7 @@
 
 #include "util/numeric.h"
 #include <algorithm>
+#include <array>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -19,7 +20,11 @@ constexpr size_t NUM_SOROBAN_TX_RESOURCES(7);
 // Small helper class to allow arithmetic operations on tuples
 class Resource
 {
-    std::vector<int64_t> mResources;
+    // The counts are stored inline rather than in a std::vector, as Resources
+    // are created and combined in the innermost loops of surge pricing.
+    // Entries past mSize are always zero.
+    std::array<int64_t, NUM_SOROBAN_TX_RESOURCES> mResources{};
+    size_t mSize;
 
   public:
     enum class Type
@@ -33,48 +38,48 @@ class Resource
         WRITE_LEDGER_ENTRIES = 6
     };
 
-    Resource(std::vector<int64_t> args)
+    Resource(std::vector<int64_t> const& args) : mSize(args.size())
     {
         if (args.size() != NUM_CLASSIC_TX_RESOURCES &&
             args.size() != NUM_SOROBAN_TX_RESOURCES)
         {
             throw std::runtime_error("Invalid number of resources");
         }
-        mResources = args;
+        std::copy(args.begin(), args.end(), mResources.begin());
     }
 
-    Resource(int64_t arg)
+    Resource(int64_t arg) : mSize(1)
     {
-        mResources = std::vector<int64_t>(1, arg);
+        mResources[0] = arg;
     }
 
     bool
     isZero() const
     {
-        return std::all_of(mResources.begin(), mResources.end(),
+        return std::all_of(mResources.begin(), mResources.begin() + mSize,
                            [](int64_t x) { return x == 0; });
     }
 
     bool
     anyPositive() const
     {
-        return std::any_of(mResources.begin(), mResources.end(),
+        return std::any_of(mResources.begin(), mResources.begin() + mSize,
                            [](int64_t x) { return x > 0; });
     }
 
     size_t
     size() const
     {
-        return mResources.size();
+        return mSize;
     }
 
     std::string
     toString() const
     {
         std::string res = "";
-        for (auto const& r : mResources)
+        for (size_t i = 0; i < mSize; ++i)
         {
-            res += std::to_string(r) + ", ";
+            res += std::to_string(mResources[i]) + ", ";
         }
         return res;
     }
@@ -85,16 +90,21 @@ class Resource
     static Resource
     makeEmpty(bool isSoroban)
     {
-        std::vector<int64_t> res;
-        res.resize(
-            isSoroban ? NUM_SOROBAN_TX_RESOURCES : NUM_CLASSIC_TX_RESOURCES, 0);
-        return Resource(res);
+        Resource res(0);
+        res.mSize =
+            isSoroban ? NUM_SOROBAN_TX_RESOURCES : NUM_CLASSIC_TX_RESOURCES;
+        return res;
     }
 
     int64_t
     getVal(Resource::Type valType) const
     {
-        return mResources.at(static_cast<size_t>(valType));
+        auto i = static_cast<size_t>(valType);
+        if (i >= mSize)
+        {
+            throw std::out_of_range("Invalid resource type");
+        }
+        return mResources[i];
     }
 
     bool canAdd(Resource const& other) const;
@@ -3,6 +3,7 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #pragma once
+#include "util/Arena.h"
 #include "util/RandHasher.h"
 #include <unordered_map>
 
@@ -10,4 +11,12 @@ namespace caiz
 {
 template <class KeyT, class ValT, class Hasher = std::hash<KeyT>>
 using UnorderedMap = std::unordered_map<KeyT, ValT, RandHasher<KeyT, Hasher>>;
+
+// ArenaUnorderedMap allocates its nodes and buckets through an ArenaAllocator,
+// which must be passed to the constructor to use an Arena
+template <class KeyT, class ValT, class Hasher = std::hash<KeyT>>
+using ArenaUnorderedMap =
+    std::unordered_map<KeyT, ValT, RandHasher<KeyT, Hasher>,
+                       std::equal_to<KeyT>,
+                       ArenaAllocator<std::pair<KeyT const, ValT>>>;
 }
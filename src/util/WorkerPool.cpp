@@ -0,0 +1,231 @@
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/WorkerPool.h"
+#include "util/GlobalChecks.h"
+#include "util/Thread.h"
+#include "medida/counter.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
+#include "medida/timer.h"
+#include <Tracy.hpp>
+#include <optional>
+
+namespace caiz
+{
+
+namespace
+{
+// The pool and index of the pool's thread running on this thread, if any
+thread_local WorkerPool const* tPool = nullptr;
+thread_local size_t tIndex = 0;
+
+char const*
+priorityName(WorkerPool::Priority priority)
+{
+    switch (priority)
+    {
+    case WorkerPool::Priority::LATENCY_SENSITIVE:
+        return "latency-sensitive";
+    case WorkerPool::Priority::BULK:
+        return "bulk";
+    }
+    releaseAssert(false);
+    return nullptr;
+}
+}
+
+WorkerPool::WorkerPool(size_t threads, medida::MetricsRegistry& metrics,
+                       std::vector<uint32_t> const& cpus)
+    : mMaxRunningBulk(threads > 1 ? threads - 1 : 1)
+    , mSteals(metrics.NewMeter({"app", "worker-pool", "steal"}, "task"))
+{
+    releaseAssert(threads > 0);
+    for (size_t i = 0; i < NUM_PRIORITIES; ++i)
+    {
+        auto name = priorityName(static_cast<Priority>(i));
+        mMetrics.emplace_back(PriorityMetrics{
+            metrics.NewCounter({"app", "worker-pool", name}),
+            metrics.NewTimer(
+                {"app", "worker-pool", std::string(name) + "-delay"})});
+    }
+
+    mWorkers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i)
+    {
+        mWorkers.emplace_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threads; ++i)
+    {
+        std::optional<uint32_t> cpu;
+        if (!cpus.empty())
+        {
+            cpu = cpus[i % cpus.size()];
+        }
+        mWorkers[i]->mThread = std::thread{[this, i, cpu]() {
+            runCurrentThreadWithLowPriority();
+            if (cpu)
+            {
+                pinCurrentThreadToCpu(*cpu);
+            }
+            run(i);
+        }};
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    shutdown();
+}
+
+void
+WorkerPool::post(std::function<void()>&& f, Priority priority)
+{
+    auto p = static_cast<size_t>(priority);
+    size_t index = tPool == this ? tIndex
+                                 : mNextWorker.fetch_add(1) % mWorkers.size();
+    {
+        std::lock_guard<std::mutex> lock(mWorkers[index]->mMutex);
+        mWorkers[index]->mQueues[p].emplace_back(
+            Task{std::move(f), std::chrono::steady_clock::now()});
+    }
+    mMetrics[p].mQueued.inc();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mUnclaimed[p];
+    }
+    // Any idle thread can take the task, unless it is BULK and no thread can
+    // run BULK tasks until one finishes, which notifies again
+    mCV.notify_one();
+}
+
+void
+WorkerPool::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCV.notify_all();
+    for (auto& w : mWorkers)
+    {
+        if (w->mThread.joinable())
+        {
+            w->mThread.join();
+        }
+    }
+}
+
+bool
+WorkerPool::claim(Priority& priority)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    auto const ls = static_cast<size_t>(Priority::LATENCY_SENSITIVE);
+    auto const bulk = static_cast<size_t>(Priority::BULK);
+    while (true)
+    {
+        if (mUnclaimed[ls] > 0)
+        {
+            --mUnclaimed[ls];
+            ++mRunning;
+            priority = Priority::LATENCY_SENSITIVE;
+            return true;
+        }
+        if (mUnclaimed[bulk] > 0 && mRunningBulk < mMaxRunningBulk)
+        {
+            --mUnclaimed[bulk];
+            ++mRunning;
+            ++mRunningBulk;
+            priority = Priority::BULK;
+            return true;
+        }
+        // Running tasks may still post more
+        if (mStopping && mUnclaimed[bulk] == 0 && mRunning == 0)
+        {
+            return false;
+        }
+        mCV.wait(lock);
+    }
+}
+
+WorkerPool::Task
+WorkerPool::take(size_t index, Priority priority)
+{
+    auto p = static_cast<size_t>(priority);
+    // Oldest task from our own queue first
+    {
+        auto& own = *mWorkers[index];
+        std::lock_guard<std::mutex> lock(own.mMutex);
+        auto& q = own.mQueues[p];
+        if (!q.empty())
+        {
+            Task t = std::move(q.front());
+            q.pop_front();
+            return t;
+        }
+    }
+
+    // Then the newest from someone else's. Claiming made sure there is a task
+    // for us, but it may have been posted to a queue we already looked at
+    // after we looked at it, so keep looking until we find it.
+    while (true)
+    {
+        for (size_t i = 1; i <= mWorkers.size(); ++i)
+        {
+            auto& other = *mWorkers[(index + i) % mWorkers.size()];
+            std::lock_guard<std::mutex> lock(other.mMutex);
+            auto& q = other.mQueues[p];
+            if (!q.empty())
+            {
+                Task t = std::move(q.back());
+                q.pop_back();
+                if (&other != mWorkers[index].get())
+                {
+                    mSteals.Mark();
+                }
+                return t;
+            }
+        }
+    }
+}
+
+void
+WorkerPool::run(size_t index)
+{
+    tPool = this;
+    tIndex = index;
+
+    Priority priority;
+    while (claim(priority))
+    {
+        auto task = take(index, priority);
+        auto& metrics = mMetrics[static_cast<size_t>(priority)];
+        metrics.mQueued.dec();
+        metrics.mDelay.Update(std::chrono::steady_clock::now() -
+                              task.mPostedAt);
+        {
+            ZoneScopedN("worker pool task");
+            task.mFunction();
+        }
+
+        bool notify;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            --mRunning;
+            if (priority == Priority::BULK)
+            {
+                --mRunningBulk;
+            }
+            // Wakes threads waiting for a BULK slot, or to exit
+            notify = priority == Priority::BULK || mStopping;
+        }
+        if (notify)
+        {
+            mCV.notify_all();
+        }
+    }
+
+    tPool = nullptr;
+}
+}
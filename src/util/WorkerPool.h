@@ -0,0 +1,118 @@
+#pragma once
+
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace medida
+{
+class MetricsRegistry;
+class Counter;
+class Meter;
+class Timer;
+}
+
+namespace caiz
+{
+
+// WorkerPool runs the tasks posted with Application::postOnBackgroundThread on
+// a fixed set of threads.
+//
+// Each thread owns a queue per priority. Tasks posted from one of the pool's
+// threads go to that thread's queue, other tasks are spread round-robin. An
+// idle thread runs the oldest task of its own queue and otherwise steals the
+// newest task from another thread's queue, so that one thread stuck behind a
+// long task doesn't hold up the tasks queued behind it.
+//
+// LATENCY_SENSITIVE tasks always run before BULK ones. In addition, BULK tasks
+// never occupy every thread of a pool with more than one: the last thread is
+// kept for LATENCY_SENSITIVE tasks, which therefore never wait for a long
+// merge to finish.
+//
+// Threads may be pinned to CPUs, thread i to cpus[i % cpus.size()].
+class WorkerPool : public NonMovableOrCopyable
+{
+  public:
+    enum class Priority
+    {
+        // short tasks that something is waiting on, like prefetching or
+        // verification
+        LATENCY_SENSITIVE = 0,
+        // long-running work like bucket merges and index builds
+        BULK = 1
+    };
+    static constexpr size_t NUM_PRIORITIES = 2;
+
+    WorkerPool(size_t threads, medida::MetricsRegistry& metrics,
+               std::vector<uint32_t> const& cpus = {});
+    ~WorkerPool();
+
+    void post(std::function<void()>&& f, Priority priority);
+
+    // Runs every task posted so far, including tasks they post in turn, then
+    // joins the threads. Tasks posted from other threads after this is called
+    // may never run.
+    void shutdown();
+
+    size_t
+    numThreads() const
+    {
+        return mWorkers.size();
+    }
+
+  private:
+    struct Task
+    {
+        std::function<void()> mFunction;
+        std::chrono::steady_clock::time_point mPostedAt;
+    };
+
+    struct Worker
+    {
+        std::mutex mMutex;
+        std::array<std::deque<Task>, NUM_PRIORITIES> mQueues;
+        std::thread mThread;
+    };
+
+    struct PriorityMetrics
+    {
+        medida::Counter& mQueued;
+        medida::Timer& mDelay;
+    };
+
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    size_t const mMaxRunningBulk;
+
+    // guards the fields below, which decide which priority the next idle
+    // thread runs; the queues themselves are guarded by each Worker's mutex
+    std::mutex mMutex;
+    std::condition_variable mCV;
+    // tasks queued and not yet claimed by a thread, per priority
+    std::array<size_t, NUM_PRIORITIES> mUnclaimed{};
+    size_t mRunning{0};
+    size_t mRunningBulk{0};
+    bool mStopping{false};
+
+    std::atomic<size_t> mNextWorker{0};
+
+    std::vector<PriorityMetrics> mMetrics;
+    medida::Meter& mSteals;
+
+    void run(size_t index);
+    bool claim(Priority& priority);
+    Task take(size_t index, Priority priority);
+};
+}
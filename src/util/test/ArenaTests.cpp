@@ -0,0 +1,92 @@
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "lib/catch.hpp"
+#include "util/Arena.h"
+#include "util/UnorderedMap.h"
+#include <cstdint>
+#include <string>
+
+using namespace caiz;
+
+TEST_CASE("Arena recycles blocks of the same size", "[arena]")
+{
+    Arena arena(4096);
+
+    auto a = arena.allocate(40, 8);
+    auto b = arena.allocate(40, 8);
+    REQUIRE(a != b);
+    REQUIRE(arena.outstandingAllocations() == 2);
+    REQUIRE(arena.reservedBytes() == 4096);
+
+    arena.deallocate(a, 40, 8);
+    REQUIRE(arena.allocate(33, 8) == a);
+
+    // Large and over-aligned blocks come from the heap
+    auto large = arena.allocate(8192, 8);
+    auto aligned = arena.allocate(64, 64);
+    REQUIRE(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+    REQUIRE(arena.reservedBytes() == 4096);
+    arena.deallocate(large, 8192, 8);
+    arena.deallocate(aligned, 64, 64);
+
+    // Only released once everything has been deallocated
+    REQUIRE(!arena.reset());
+    arena.deallocate(a, 33, 8);
+    arena.deallocate(b, 40, 8);
+    REQUIRE(arena.outstandingAllocations() == 0);
+    REQUIRE(arena.reset());
+    REQUIRE(arena.reservedBytes() == 0);
+}
+
+TEST_CASE("Arena backs unordered maps", "[arena]")
+{
+    Arena arena;
+    using Map = ArenaUnorderedMap<int, std::string>;
+
+    {
+        Arena::Scope scope(arena);
+        REQUIRE(Arena::current() == &arena);
+
+        Map map(Map::allocator_type(Arena::current()));
+        for (int i = 0; i < 1000; ++i)
+        {
+            map.emplace(i, std::to_string(i));
+        }
+        REQUIRE(arena.outstandingAllocations() >= 1000);
+
+        // Copies share the arena, so swapping them is fine
+        auto copy = map;
+        REQUIRE(copy.get_allocator().arena() == &arena);
+        copy.erase(0);
+        copy.swap(map);
+        REQUIRE(map.size() == 999);
+        REQUIRE(copy.at(0) == "0");
+
+        Map heapMap;
+        heapMap.emplace(0, "0");
+        REQUIRE(heapMap.get_allocator().arena() == nullptr);
+    }
+
+    REQUIRE(Arena::current() == nullptr);
+    REQUIRE(arena.outstandingAllocations() == 0);
+    REQUIRE(arena.reservedBytes() == 0);
+}
+
+TEST_CASE("Arena scope keeps chunks of allocations that outlive it",
+          "[arena]")
+{
+    Arena arena(4096);
+    void* escaped = nullptr;
+    {
+        Arena::Scope scope(arena);
+        escaped = arena.allocate(40, 8);
+    }
+    REQUIRE(arena.outstandingAllocations() == 1);
+    REQUIRE(arena.reservedBytes() == 4096);
+
+    arena.deallocate(escaped, 40, 8);
+    REQUIRE(arena.reset());
+    REQUIRE(arena.reservedBytes() == 0);
+}
@@ -5,6 +5,7 @@
 #include "util/Scheduler.h"
 
 #include "lib/catch.hpp"
+#include "lib/json/json.h"
 #include "util/Logging.h"
 #include "util/Timer.h"
 #include <chrono>
@@ -125,3 +126,138 @@ TEST_CASE("scheduler load shedding -- overload", "[scheduler]")
                sched.stats().mActionsDroppedDueToOverload;
     CHECK(sched.stats().mActionsEnqueued == tot);
 }
+
+TEST_CASE("scheduler feeds the event loop profiler", "[scheduler]")
+{
+    std::chrono::seconds window(10);
+    VirtualClock clock;
+    Scheduler sched(clock, window);
+    auto& profiler = clock.getEventLoopProfiler();
+
+    auto sleeper = [&](std::chrono::microseconds us) {
+        return [&clock, us] { clock.sleep_for(us); };
+    };
+    sched.enqueue("short", sleeper(std::chrono::microseconds(10)),
+                  Scheduler::ActionType::NORMAL_ACTION);
+    sched.enqueue("long", sleeper(std::chrono::milliseconds(50)),
+                  Scheduler::ActionType::NORMAL_ACTION);
+    sched.enqueue("short", sleeper(std::chrono::microseconds(10)),
+                  Scheduler::ActionType::NORMAL_ACTION);
+    while (sched.runOne() != 0)
+        ;
+
+    auto shortProfile = profiler.getActionProfile("short");
+    REQUIRE(shortProfile);
+    CHECK(shortProfile->mRunTime.count() == 2);
+    CHECK(shortProfile->mRunTime.total() == std::chrono::microseconds(20));
+    CHECK(shortProfile->mRunTime.quantile(0.5) <=
+          std::chrono::microseconds(16));
+    // the second "short" action waited behind both others
+    CHECK(shortProfile->mQueueDelay.max() >= std::chrono::milliseconds(50));
+
+    auto stalls = profiler.getStalls();
+    REQUIRE(stalls.size() == 3);
+    CHECK(stalls.front().mName == "long");
+    CHECK(stalls.front().mRunTime == std::chrono::milliseconds(50));
+
+    auto json = profiler.getJsonInfo(1);
+    REQUIRE(json["actions"].size() == 1);
+    CHECK(json["actions"][0]["name"].asString() == "long");
+    CHECK(json["stalls"].size() == 3);
+
+    profiler.reset();
+    CHECK(!profiler.getActionProfile("short"));
+    CHECK(profiler.getStalls().empty());
+}
+
+TEST_CASE("event loop profiler keeps a bounded number of actions",
+          "[scheduler]")
+{
+    EventLoopProfiler profiler;
+    std::chrono::microseconds us(1);
+    profiler.recordAction("kept", us, us);
+    for (size_t i = 0; i < EventLoopProfiler::MAX_ACTIONS * 2; ++i)
+    {
+        profiler.recordAction(fmt::format("broadcast to peer {}", i), us, us);
+        // "kept" is recorded often enough to never be the oldest name
+        if (i % 100 == 0)
+        {
+            profiler.recordAction("kept", us, us);
+        }
+    }
+
+    auto kept = profiler.getActionProfile("kept");
+    REQUIRE(kept);
+    CHECK(kept->mRunTime.count() ==
+          1 + (EventLoopProfiler::MAX_ACTIONS * 2 + 99) / 100);
+    CHECK(!profiler.getActionProfile("broadcast to peer 0"));
+    CHECK(profiler.getActionProfile(fmt::format(
+        "broadcast to peer {}", EventLoopProfiler::MAX_ACTIONS * 2 - 1)));
+
+    auto json = profiler.getJsonInfo(EventLoopProfiler::MAX_ACTIONS * 2);
+    CHECK(json["actions"].size() == EventLoopProfiler::MAX_ACTIONS);
+    CHECK(json["dropped_actions"].asUInt64() ==
+          EventLoopProfiler::MAX_ACTIONS + 1);
+}
+
+TEST_CASE("scheduler runs critical actions by deadline", "[scheduler]")
+{
+    std::chrono::milliseconds window(10);
+    VirtualClock clock;
+    Scheduler sched(clock, window);
+
+    std::vector<std::string> ran;
+    auto record = [&](std::string const& name) {
+        return [&ran, name] { ran.emplace_back(name); };
+    };
+    auto const normal = Scheduler::ActionType::NORMAL_ACTION;
+    auto const critical = Scheduler::ActionType::CRITICAL_ACTION;
+
+    SECTION("critical actions go ahead of fair-share queues")
+    {
+        sched.enqueue("a", record("a"), normal);
+        sched.enqueue("b", record("b"), normal);
+        sched.enqueue("c", record("c1"), critical);
+        clock.sleep_for(std::chrono::milliseconds(1));
+        sched.enqueue("d", record("d"), critical);
+        clock.sleep_for(std::chrono::milliseconds(1));
+        sched.enqueue("c", record("c2"), critical);
+        CHECK(sched.nextQueueToRun() == "c");
+        while (sched.runOne() != 0)
+            ;
+        REQUIRE(ran.size() == 5);
+        // earliest enqueued first among critical actions
+        CHECK(ran[0] == "c1");
+        CHECK(ran[1] == "d");
+        CHECK(ran[2] == "c2");
+    }
+
+    SECTION("actions waiting longer than the window go ahead of critical ones")
+    {
+        sched.enqueue("a", record("a"), normal);
+        clock.sleep_for(window + std::chrono::milliseconds(1));
+        sched.enqueue("c", record("c"), critical);
+        CHECK(sched.nextQueueToRun() == "a");
+        CHECK(sched.runOne() == 1);
+        CHECK(sched.runOne() == 1);
+        REQUIRE(ran == std::vector<std::string>{"a", "c"});
+    }
+
+    SECTION("critical actions are never dropped")
+    {
+        auto const droppable = Scheduler::ActionType::DROPPABLE_ACTION;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            sched.enqueue("c", record("c"), critical);
+            sched.enqueue("d", record("d"), droppable);
+        }
+        // Both queues have now waited longer than the window: the critical
+        // one runs in full, the droppable one is trimmed when its turn comes
+        clock.sleep_for(window * 2);
+        while (sched.runOne() != 0)
+            ;
+        CHECK(ran == std::vector<std::string>{"c", "c", "c"});
+        CHECK(sched.stats().mActionsDroppedDueToOverload == 3);
+        CHECK(sched.stats().mActionsDequeued == 3);
+    }
+}
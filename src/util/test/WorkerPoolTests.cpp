@@ -0,0 +1,77 @@
+// Copyright 2023 Caiz Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "lib/catch.hpp"
+#include "medida/counter.h"
+#include "medida/metrics_registry.h"
+#include "util/WorkerPool.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+
+using namespace caiz;
+
+TEST_CASE("WorkerPool keeps a thread for latency sensitive tasks",
+          "[workerpool]")
+{
+    medida::MetricsRegistry metrics;
+    WorkerPool pool(3, metrics);
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<size_t> bulkStarted{0};
+    std::atomic<size_t> bulkDone{0};
+    for (size_t i = 0; i < 3; ++i)
+    {
+        pool.post(
+            [&, released]() {
+                ++bulkStarted;
+                released.wait();
+                ++bulkDone;
+            },
+            WorkerPool::Priority::BULK);
+    }
+
+    // Only two of the three BULK tasks can be running, the third thread
+    // picks this up
+    std::promise<size_t> ran;
+    auto ranFuture = ran.get_future();
+    pool.post([&]() { ran.set_value(bulkStarted.load()); },
+              WorkerPool::Priority::LATENCY_SENSITIVE);
+    REQUIRE(ranFuture.wait_for(std::chrono::seconds(10)) ==
+            std::future_status::ready);
+    REQUIRE(ranFuture.get() <= 2);
+    REQUIRE(metrics.NewCounter({"app", "worker-pool", "bulk"}).count() >= 1);
+
+    release.set_value();
+    pool.shutdown();
+    REQUIRE(bulkDone == 3);
+    REQUIRE(metrics.NewCounter({"app", "worker-pool", "bulk"}).count() == 0);
+    REQUIRE(metrics
+                .NewCounter({"app", "worker-pool", "latency-sensitive"})
+                .count() == 0);
+}
+
+TEST_CASE("WorkerPool shutdown runs queued tasks", "[workerpool]")
+{
+    medida::MetricsRegistry metrics;
+    WorkerPool pool(2, metrics);
+
+    std::atomic<size_t> done{0};
+    for (size_t i = 0; i < 100; ++i)
+    {
+        auto priority = i % 2 == 0 ? WorkerPool::Priority::BULK
+                                   : WorkerPool::Priority::LATENCY_SENSITIVE;
+        pool.post(
+            [&pool, &done, priority]() {
+                // Tasks posted by running tasks go to the same thread's queue
+                // and still run before shutdown returns
+                pool.post([&done]() { ++done; }, priority);
+                ++done;
+            },
+            priority);
+    }
+    pool.shutdown();
+    REQUIRE(done == 200);
+}